@@ -31,8 +31,10 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/assets/Loader.cpp \
     ../../ouzel/assets/LoaderBMF.cpp \
     ../../ouzel/assets/LoaderCollada.cpp \
+    ../../ouzel/assets/LoaderDDS.cpp \
 	../../ouzel/assets/LoaderGLTF.cpp \
     ../../ouzel/assets/LoaderImage.cpp \
+    ../../ouzel/assets/LoaderKTX.cpp \
     ../../ouzel/assets/LoaderMTL.cpp \
     ../../ouzel/assets/LoaderOBJ.cpp \
     ../../ouzel/assets/LoaderParticleSystem.cpp \
@@ -70,9 +72,11 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/core/Timer.cpp \
     ../../ouzel/core/Window.cpp \
     ../../ouzel/events/EventDispatcher.cpp \
+    ../../ouzel/events/Event.cpp \
     ../../ouzel/events/EventHandler.cpp \
     ../../ouzel/files/Archive.cpp \
     ../../ouzel/files/File.cpp \
+    ../../ouzel/files/MappedFile.cpp \
     ../../ouzel/files/FileSystem.cpp \
     ../../ouzel/graphics/empty/RenderDeviceEmpty.cpp \
     ../../ouzel/graphics/opengl/android/RenderDeviceOGLAndroid.cpp \
@@ -84,6 +88,8 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/graphics/opengl/ShaderResourceOGL.cpp \
     ../../ouzel/graphics/opengl/TextureResourceOGL.cpp \
     ../../ouzel/graphics/BlendState.cpp \
+    ../../ouzel/graphics/CommandTrace.cpp \
+    ../../ouzel/graphics/BlockEncoder.cpp \
     ../../ouzel/graphics/Buffer.cpp \
 	../../ouzel/graphics/DepthStencilState.cpp \
     ../../ouzel/graphics/ImageData.cpp \
@@ -94,8 +100,10 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/graphics/Shader.cpp \
     ../../ouzel/graphics/Texture.cpp \
     ../../ouzel/graphics/Vertex.cpp \
+    ../../ouzel/graphics/VertexLayout.cpp \
     ../../ouzel/gui/BMFont.cpp \
     ../../ouzel/gui/TTFont.cpp \
+    ../../ouzel/gui/GlyphAtlas.cpp \
     ../../ouzel/gui/Button.cpp \
     ../../ouzel/gui/CheckBox.cpp \
     ../../ouzel/gui/ComboBox.cpp \
@@ -145,16 +153,20 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/scene/ActorContainer.cpp \
     ../../ouzel/scene/Camera.cpp \
     ../../ouzel/scene/Component.cpp \
+    ../../ouzel/scene/DrawQueue.cpp \
     ../../ouzel/scene/Layer.cpp \
     ../../ouzel/scene/Light.cpp \
     ../../ouzel/scene/ParticleSystem.cpp \
     ../../ouzel/scene/ParticleSystemData.cpp \
     ../../ouzel/scene/Scene.cpp \
+    ../../ouzel/scene/SpatialIndex.cpp \
     ../../ouzel/scene/SceneManager.cpp \
     ../../ouzel/scene/ShapeRenderer.cpp \
     ../../ouzel/scene/SkinnedMeshData.cpp \
     ../../ouzel/scene/SkinnedMeshRenderer.cpp \
     ../../ouzel/scene/Sprite.cpp \
+    ../../ouzel/scene/SpriteBatch.cpp \
+    ../../ouzel/scene/StaticMeshBatch.cpp \
     ../../ouzel/scene/SpriteData.cpp \
     ../../ouzel/scene/StaticMeshData.cpp \
     ../../ouzel/scene/StaticMeshRenderer.cpp \
@@ -164,6 +176,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/utils/Log.cpp \
     ../../ouzel/utils/OBF.cpp \
     ../../ouzel/utils/Utils.cpp \
+    ../../ouzel/utils/ThreadPool.cpp \
     ../../ouzel/utils/XML.cpp
 
 include $(BUILD_STATIC_LIBRARY)
@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
 #include "Bundle.hpp"
@@ -20,11 +21,18 @@ namespace ouzel
         Bundle::~Bundle()
         {
             cache.removeBundle(this);
+
+            // worker threads must not outlive the bundle
+            for (const std::shared_ptr<Batch>& batch : batches)
+            {
+                std::unique_lock<std::mutex> lock(batch->mutex);
+                while (batch->running) batch->condition.wait(lock);
+            }
         }
 
         void Bundle::loadAsset(uint32_t loaderType, const std::string& filename, bool mipmaps)
         {
-            std::vector<uint8_t> data = fileSystem.readFile(filename);
+            FileData data = fileSystem.readFileData(filename);
 
             auto loaders = cache.getLoaders();
 
@@ -41,7 +49,8 @@ namespace ouzel
 
         void Bundle::loadAssets(const std::string& filename)
         {
-            json::Data data(fileSystem.readFile(filename));
+            FileData file = fileSystem.readFileData(filename);
+            json::Data data(file.getData(), file.getSize());
 
             for (const json::Value& asset : data["assets"].as<json::Value::Array>())
             {
@@ -56,6 +65,173 @@ namespace ouzel
                 loadAsset(asset.type, asset.filename, asset.mipmaps);
         }
 
+        // assets of the lower ranks can be dependencies of the assets of the higher ranks
+        static uint32_t getDependencyRank(uint32_t loaderType)
+        {
+            switch (loaderType)
+            {
+                case Loader::IMAGE:
+                case Loader::SOUND:
+                case Loader::FONT:
+                    return 0;
+                case Loader::MATERIAL:
+                    return 1;
+                default:
+                    return 2;
+            }
+        }
+
+        std::future<void> Bundle::loadAssetsAsync(const std::vector<Asset>& assets)
+        {
+            std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+
+            std::vector<Asset> sortedAssets(assets);
+            std::stable_sort(sortedAssets.begin(), sortedAssets.end(), [](const Asset& a, const Asset& b) {
+                return getDependencyRank(a.type) < getDependencyRank(b.type);
+            });
+
+            auto loaders = cache.getLoaders();
+
+            batch->assets.reserve(sortedAssets.size());
+
+            for (const Asset& asset : sortedAssets)
+            {
+                PendingAsset pendingAsset(asset);
+
+                for (auto i = loaders.rbegin(); i != loaders.rend(); ++i)
+                    if ((*i)->getType() == asset.type)
+                        pendingAsset.loaders.push_back(*i);
+
+                batch->assets.push_back(pendingAsset);
+            }
+
+            std::future<void> future = batch->promise.get_future();
+
+            if (batch->assets.empty())
+            {
+                batch->promise.set_value();
+                return future;
+            }
+
+            batch->running = batch->assets.size();
+            batches.push_back(batch);
+
+            ThreadPool& threadPool = cache.getThreadPool();
+
+            // the tasks share the ownership of the batch, because update() can remove it as soon as the last asset is ready
+            for (size_t i = 0; i < batch->assets.size(); ++i)
+                threadPool.run(std::bind(&Bundle::prepareAsset, this, batch, i));
+
+            return future;
+        }
+
+        void Bundle::prepareAsset(const std::shared_ptr<Batch>& batchPointer, size_t index)
+        {
+            Batch& batch = *batchPointer;
+
+            std::unique_lock<std::mutex> lock(batch.mutex);
+            bool failed = batch.failed;
+            PendingAsset& pendingAsset = batch.assets[index];
+            lock.unlock();
+
+            if (!failed)
+            {
+                try
+                {
+                    FileData data = fileSystem.readFileData(pendingAsset.asset.filename);
+
+                    for (; pendingAsset.loaderIndex < pendingAsset.loaders.size(); ++pendingAsset.loaderIndex)
+                    {
+                        Loader* loader = pendingAsset.loaders[pendingAsset.loaderIndex];
+
+                        if ((pendingAsset.finish = loader->prepareAsset(*this, pendingAsset.asset.filename,
+                                                                        data, pendingAsset.asset.mipmaps)))
+                            break;
+                    }
+
+                    // keep the data for the loaders that are tried if the prepared one fails
+                    pendingAsset.data = data;
+                }
+                catch (...)
+                {
+                    pendingAsset.exception = std::current_exception();
+                }
+            }
+
+            // notify under the lock, so that the destructor doesn't return before the worker has stopped touching the batch
+            lock.lock();
+            pendingAsset.ready = true;
+            --batch.running;
+            batch.condition.notify_all();
+        }
+
+        void Bundle::finishAsset(PendingAsset& pendingAsset)
+        {
+            if (pendingAsset.exception)
+                std::rethrow_exception(pendingAsset.exception);
+
+            if (pendingAsset.finish && pendingAsset.finish())
+                return;
+
+            const std::string& filename = pendingAsset.asset.filename;
+
+            for (size_t i = pendingAsset.loaderIndex + 1; i < pendingAsset.loaders.size(); ++i)
+                if (pendingAsset.loaders[i]->loadAsset(*this, filename, pendingAsset.data, pendingAsset.asset.mipmaps))
+                    return;
+
+            throw std::runtime_error("Failed to load asset " + filename);
+        }
+
+        void Bundle::update()
+        {
+            for (auto i = batches.begin(); i != batches.end();)
+            {
+                Batch& batch = **i;
+
+                std::unique_lock<std::mutex> lock(batch.mutex);
+
+                // create the resources in the order of the batch
+                while (!batch.failed &&
+                       batch.next < batch.assets.size() &&
+                       batch.assets[batch.next].ready)
+                {
+                    PendingAsset& pendingAsset = batch.assets[batch.next];
+                    lock.unlock();
+
+                    try
+                    {
+                        finishAsset(pendingAsset);
+                    }
+                    catch (...)
+                    {
+                        batch.promise.set_exception(std::current_exception());
+                        lock.lock();
+                        batch.failed = true;
+                        break;
+                    }
+
+                    // release the file data and the decoded asset
+                    pendingAsset.data = FileData();
+                    pendingAsset.finish = nullptr;
+
+                    lock.lock();
+                    ++batch.next;
+                }
+
+                bool finished = (batch.next == batch.assets.size());
+                bool canRemove = (finished || batch.failed) && batch.running == 0;
+                lock.unlock();
+
+                if (finished && !batch.failed)
+                    batch.promise.set_value();
+
+                if (canRemove)
+                    i = batches.erase(i);
+                else
+                    ++i;
+            }
+        }
+
         std::shared_ptr<graphics::Texture> Bundle::getTexture(const std::string& filename) const
         {
             auto i = textures.find(filename);
@@ -142,7 +318,7 @@ namespace ouzel
         {
             std::string extension = FileSystem::getExtensionPart(filename);
             std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return std::tolower(c); });
-            std::vector<std::string> imageExtensions = {"jpg", "jpeg", "png", "bmp", "tga"};
+            std::vector<std::string> imageExtensions = {"jpg", "jpeg", "png", "bmp", "tga", "ktx", "dds"};
 
             if (std::find(imageExtensions.begin(), imageExtensions.end(),
                           extension) != imageExtensions.end())
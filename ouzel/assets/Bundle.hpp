@@ -3,9 +3,15 @@
 #ifndef OUZEL_ASSETS_BUNDLE_HPP
 #define OUZEL_ASSETS_BUNDLE_HPP
 
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "audio/SoundData.hpp"
 #include "files/FileSystem.hpp"
 #include "graphics/BlendState.hpp"
@@ -24,6 +30,7 @@ namespace ouzel
     namespace assets
     {
         class Cache;
+        class Loader;
 
         class Asset final
         {
@@ -58,6 +65,10 @@ namespace ouzel
             void loadAsset(uint32_t loaderType, const std::string& filename, bool mipmaps = true);
             void loadAssets(const std::string& filename);
             void loadAssets(const std::vector<Asset>& assets);
+            // reads and decodes the assets on worker threads and creates the resources on the update thread, images,
+            // sounds and fonts first, so that materials, sprites and meshes of the same batch find them in the cache,
+            // the future must not be waited for on the update thread
+            std::future<void> loadAssetsAsync(const std::vector<Asset>& assets);
 
             void clear();
 
@@ -109,8 +120,37 @@ namespace ouzel
             void releaseStaticMeshData();
 
         private:
+            struct PendingAsset final
+            {
+                explicit PendingAsset(const Asset& initAsset): asset(initAsset) {}
+
+                Asset asset;
+                std::vector<Loader*> loaders;
+                size_t loaderIndex = 0;
+                FileData data;
+                std::function<bool()> finish;
+                std::exception_ptr exception;
+                bool ready = false;
+            };
+
+            struct Batch final
+            {
+                std::vector<PendingAsset> assets;
+                size_t next = 0; // assets before this are finished
+                size_t running = 0; // number of assets on the worker threads
+                bool failed = false;
+                std::mutex mutex;
+                std::condition_variable condition;
+                std::promise<void> promise;
+            };
+
+            void prepareAsset(const std::shared_ptr<Batch>& batch, size_t index);
+            void finishAsset(PendingAsset& pendingAsset);
+            void update();
+
             Cache& cache;
             FileSystem& fileSystem;
+            std::vector<std::shared_ptr<Batch>> batches;
 
             std::map<std::string, std::shared_ptr<graphics::Texture>> textures;
             std::map<std::string, std::shared_ptr<graphics::Shader>> shaders;
@@ -21,8 +21,10 @@ namespace ouzel
         Cache::Cache():
             loaderBMF(*this),
             loaderCollada(*this),
+            loaderDDS(*this),
             loaderGLTF(*this),
             loaderImage(*this),
+            loaderKTX(*this),
             loaderMTL(*this),
             loaderOBJ(*this),
             loaderParticleSystem(*this),
@@ -33,6 +35,21 @@ namespace ouzel
         {
         }
 
+        void Cache::update()
+        {
+            for (Bundle* bundle : bundles)
+                bundle->update();
+        }
+
+        ThreadPool& Cache::getThreadPool()
+        {
+            // created on demand, so that applications that don't load assets asynchronously don't start the threads
+            if (!threadPool)
+                threadPool.reset(new ThreadPool("Asset loader"));
+
+            return *threadPool;
+        }
+
         void Cache::addBundle(Bundle* bundle)
         {
             auto i = std::find(bundles.begin(), bundles.end(), bundle);
@@ -9,8 +9,10 @@
 #include "assets/Bundle.hpp"
 #include "assets/LoaderBMF.hpp"
 #include "assets/LoaderCollada.hpp"
+#include "assets/LoaderDDS.hpp"
 #include "assets/LoaderGLTF.hpp"
 #include "assets/LoaderImage.hpp"
+#include "assets/LoaderKTX.hpp"
 #include "assets/LoaderMTL.hpp"
 #include "assets/LoaderOBJ.hpp"
 #include "assets/LoaderParticleSystem.hpp"
@@ -18,6 +20,7 @@
 #include "assets/LoaderTTF.hpp"
 #include "assets/LoaderVorbis.hpp"
 #include "assets/LoaderWave.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace ouzel
 {
@@ -42,6 +45,9 @@ namespace ouzel
             const std::vector<Bundle*>& getBundles() const { return bundles; }
             const std::vector<Loader*>& getLoaders() const { return loaders; }
 
+            // creates the resources of the assets loaded asynchronously, called every update
+            void update();
+
             std::shared_ptr<graphics::Texture> getTexture(const std::string& filename) const;
             std::shared_ptr<graphics::Shader> getShader(const std::string& shaderName) const;
             std::shared_ptr<graphics::BlendState> getBlendState(const std::string& blendStateName) const;
@@ -61,13 +67,17 @@ namespace ouzel
             void addLoader(Loader* loader);
             void removeLoader(Loader* loader);
 
+            ThreadPool& getThreadPool();
+
             std::vector<Bundle*> bundles;
             std::vector<Loader*> loaders;
 
             LoaderBMF loaderBMF;
             LoaderCollada loaderCollada;
+            LoaderDDS loaderDDS;
             LoaderGLTF loaderGLTF;
             LoaderImage loaderImage;
+            LoaderKTX loaderKTX;
             LoaderMTL loaderMTL;
             LoaderOBJ loaderOBJ;
             LoaderParticleSystem loaderParticleSystem;
@@ -75,6 +85,8 @@ namespace ouzel
             LoaderTTF loaderTTF;
             LoaderVorbis loaderVorbis;
             LoaderWave loaderWave;
+
+            std::unique_ptr<ThreadPool> threadPool;
         };
     } // namespace assets
 } // namespace ouzel
@@ -19,5 +19,14 @@ namespace ouzel
         {
             cache.removeLoader(this);
         }
+
+        std::function<bool()> Loader::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            // by default only the file is read on the worker thread
+            Bundle* bundlePointer = &bundle;
+            return [this, bundlePointer, filename, data, mipmaps]() {
+                return loadAsset(*bundlePointer, filename, data, mipmaps);
+            };
+        }
     } // namespace assets
 } // namespace ouzel
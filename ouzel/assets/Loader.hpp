@@ -3,8 +3,9 @@
 #ifndef OUZEL_ASSETS_LOADER_HPP
 #define OUZEL_ASSETS_LOADER_HPP
 
+#include <functional>
 #include <string>
-#include <vector>
+#include "files/FileData.hpp"
 
 namespace ouzel
 {
@@ -40,7 +41,12 @@ namespace ouzel
 
             inline uint32_t getType() const { return type; }
 
-            virtual bool loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps = true) = 0;
+            virtual bool loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps = true) = 0;
+
+            // called on a worker thread, must not access the bundle or the cache
+            // the returned function is called on the update thread to create the resources and returns false if the loader failed,
+            // empty function means that the asset can't be loaded by this loader
+            virtual std::function<bool()> prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps = true);
 
         protected:
             Cache& cache;
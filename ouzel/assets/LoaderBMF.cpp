@@ -13,12 +13,12 @@ namespace ouzel
         {
         }
 
-        bool LoaderBMF::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderBMF::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
         {
             try
             {
                 // TODO: move the loader here
-                std::shared_ptr<BMFont> font = std::make_shared<BMFont>(data);
+                std::shared_ptr<BMFont> font = std::make_shared<BMFont>(std::vector<uint8_t>(data.begin(), data.end()));
                 bundle.setFont(filename, font);
             }
             catch (const std::exception&)
@@ -15,16 +15,15 @@ namespace ouzel
         {
         }
 
-        bool LoaderCollada::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderCollada::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
         {
-            xml::Data colladaData(data);
+            // read the elements as they come instead of building the whole tree
+            xml::Reader reader(data.getData(), data.getSize());
 
-            if (colladaData.getChildren().empty())
-                throw std::runtime_error("Invalid Collada file");
-
-            xml::Node rootNode = colladaData.getChildren().front();
+            while (reader.next() && reader.getEvent() != xml::Reader::Event::START_TAG);
 
-            if (rootNode.getValue() != "COLLADA")
+            if (reader.getEvent() != xml::Reader::Event::START_TAG ||
+                reader.getName() != "COLLADA")
                 throw std::runtime_error("Invalid Collada file");
 
             scene::SkinnedMeshData meshData;
@@ -0,0 +1,223 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include "LoaderDDS.hpp"
+#include "Bundle.hpp"
+#include "core/Engine.hpp"
+#include "graphics/Texture.hpp"
+#include "utils/Utils.hpp"
+
+enum DDSFlags
+{
+    DDSD_MIPMAPCOUNT = 0x20000,
+    DDSD_DEPTH = 0x800000
+};
+
+enum DDSPixelFormatFlags
+{
+    DDPF_ALPHAPIXELS = 0x1,
+    DDPF_ALPHA = 0x2,
+    DDPF_FOURCC = 0x4,
+    DDPF_RGB = 0x40,
+    DDPF_LUMINANCE = 0x20000
+};
+
+enum DDSCaps2
+{
+    DDSCAPS2_CUBEMAP = 0x200,
+    DDSCAPS2_VOLUME = 0x200000
+};
+
+// the DXGI formats that can be stored in DDS files with the DX10 header
+enum DXGIFormat
+{
+    DXGI_R8G8B8A8_UNORM = 28,
+    DXGI_R8G8_UNORM = 49,
+    DXGI_R8_UNORM = 61,
+    DXGI_A8_UNORM = 65,
+    DXGI_BC1_UNORM = 71,
+    DXGI_BC3_UNORM = 77,
+    DXGI_BC7_UNORM = 98
+};
+
+namespace ouzel
+{
+    namespace assets
+    {
+        static const uint32_t DDS_MAGIC_SIZE = 4;
+        static const uint32_t DDS_MAX_SIZE = 16384;
+        static const uint32_t DDS_HEADER_SIZE = 124;
+        static const uint32_t DDS_HEADER_DX10_SIZE = 20;
+        static const uint32_t DDS_RESOURCE_DIMENSION_TEXTURE2D = 3;
+        static const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+        static inline uint32_t makeFourCC(char a, char b, char c, char d)
+        {
+            return static_cast<uint32_t>(a) |
+                (static_cast<uint32_t>(b) << 8) |
+                (static_cast<uint32_t>(c) << 16) |
+                (static_cast<uint32_t>(d) << 24);
+        }
+
+        LoaderDDS::LoaderDDS(Cache& initCache):
+            Loader(initCache, TYPE)
+        {
+        }
+
+        static graphics::PixelFormat getPixelFormat(uint32_t dxgiFormat)
+        {
+            switch (dxgiFormat)
+            {
+                case DXGI_R8G8B8A8_UNORM: return graphics::PixelFormat::RGBA8_UNORM;
+                case DXGI_R8G8_UNORM: return graphics::PixelFormat::RG8_UNORM;
+                case DXGI_R8_UNORM: return graphics::PixelFormat::R8_UNORM;
+                case DXGI_A8_UNORM: return graphics::PixelFormat::A8_UNORM;
+                case DXGI_BC1_UNORM: return graphics::PixelFormat::BC1_UNORM;
+                case DXGI_BC3_UNORM: return graphics::PixelFormat::BC3_UNORM;
+                case DXGI_BC7_UNORM: return graphics::PixelFormat::BC7_UNORM;
+                default: throw std::runtime_error("Unsupported pixel format");
+            }
+        }
+
+        static bool isDDS(const FileData& data)
+        {
+            return data.getSize() >= DDS_MAGIC_SIZE &&
+                decodeUInt32Little(data.getData()) == makeFourCC('D', 'D', 'S', ' ');
+        }
+
+        static std::vector<graphics::Texture::Level> decodeDDS(const FileData& data, graphics::PixelFormat& pixelFormat)
+        {
+            const uint8_t* bytes = data.getData();
+            const size_t size = data.getSize();
+
+            if (size < DDS_MAGIC_SIZE + DDS_HEADER_SIZE ||
+                decodeUInt32Little(bytes + 4) != DDS_HEADER_SIZE)
+                throw std::runtime_error("Failed to load DDS file, invalid header");
+
+            uint32_t flags = decodeUInt32Little(bytes + 8);
+            uint32_t height = decodeUInt32Little(bytes + 12);
+            uint32_t width = decodeUInt32Little(bytes + 16);
+            uint32_t depth = (flags & DDSD_DEPTH) ? decodeUInt32Little(bytes + 24) : 1;
+            uint32_t levelCount = (flags & DDSD_MIPMAPCOUNT) ? std::max(decodeUInt32Little(bytes + 28), 1U) : 1;
+            uint32_t pixelFormatFlags = decodeUInt32Little(bytes + 80);
+            uint32_t fourCC = decodeUInt32Little(bytes + 84);
+            uint32_t bitCount = decodeUInt32Little(bytes + 88);
+            uint32_t redMask = decodeUInt32Little(bytes + 92);
+            uint32_t greenMask = decodeUInt32Little(bytes + 96);
+            uint32_t blueMask = decodeUInt32Little(bytes + 100);
+            uint32_t alphaMask = decodeUInt32Little(bytes + 104);
+            uint32_t caps2 = decodeUInt32Little(bytes + 112);
+
+            if (width == 0 || height == 0 || depth > 1 || (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)))
+                throw std::runtime_error("Failed to load DDS file, only 2D textures are supported");
+
+            if (width > DDS_MAX_SIZE || height > DDS_MAX_SIZE)
+                throw std::runtime_error("Failed to load DDS file, texture too large");
+
+            if (levelCount > 32)
+                throw std::runtime_error("Failed to load DDS file, invalid mip map count");
+
+            size_t offset = DDS_MAGIC_SIZE + DDS_HEADER_SIZE;
+
+            if (pixelFormatFlags & DDPF_FOURCC)
+            {
+                if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+                    pixelFormat = graphics::PixelFormat::BC1_UNORM;
+                else if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+                    pixelFormat = graphics::PixelFormat::BC3_UNORM;
+                else if (fourCC == makeFourCC('D', 'X', '1', '0'))
+                {
+                    if (size < offset + DDS_HEADER_DX10_SIZE)
+                        throw std::runtime_error("Failed to load DDS file, file too small");
+
+                    if (decodeUInt32Little(bytes + offset + 4) != DDS_RESOURCE_DIMENSION_TEXTURE2D ||
+                        (decodeUInt32Little(bytes + offset + 8) & DDS_RESOURCE_MISC_TEXTURECUBE) ||
+                        decodeUInt32Little(bytes + offset + 12) > 1)
+                        throw std::runtime_error("Failed to load DDS file, only 2D textures are supported");
+
+                    pixelFormat = getPixelFormat(decodeUInt32Little(bytes + offset));
+                    offset += DDS_HEADER_DX10_SIZE;
+                }
+                else
+                    throw std::runtime_error("Unsupported pixel format");
+            }
+            else if ((pixelFormatFlags & DDPF_RGB) && (pixelFormatFlags & DDPF_ALPHAPIXELS) && bitCount == 32 &&
+                     redMask == 0x000000FF && greenMask == 0x0000FF00 && blueMask == 0x00FF0000 && alphaMask == 0xFF000000)
+                pixelFormat = graphics::PixelFormat::RGBA8_UNORM;
+            else if ((pixelFormatFlags & DDPF_ALPHA) && bitCount == 8)
+                pixelFormat = graphics::PixelFormat::A8_UNORM;
+            else if ((pixelFormatFlags & DDPF_LUMINANCE) && bitCount == 8)
+                pixelFormat = graphics::PixelFormat::R8_UNORM;
+            else
+                throw std::runtime_error("Unsupported pixel format");
+
+            std::vector<graphics::Texture::Level> levels;
+            levels.reserve(levelCount);
+
+            // the levels are tightly packed one after another
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                uint32_t levelWidth = std::max(width >> level, 1U);
+                uint32_t levelHeight = std::max(height >> level, 1U);
+                size_t levelSize = graphics::getLevelSize(pixelFormat, levelWidth, levelHeight);
+
+                // checked against the remaining data before anything is copied
+                if (levelSize > size - offset)
+                    throw std::runtime_error("Failed to load DDS file, file too small");
+
+                levels.push_back({Size2(static_cast<float>(levelWidth), static_cast<float>(levelHeight)),
+                                  static_cast<uint32_t>(graphics::getRowPitch(pixelFormat, levelWidth)),
+                                  std::vector<uint8_t>(bytes + offset, bytes + offset + levelSize)});
+
+                offset += levelSize;
+            }
+
+            return levels;
+        }
+
+        static std::shared_ptr<graphics::Texture> createTexture(const std::vector<graphics::Texture::Level>& levels,
+                                                                graphics::PixelFormat pixelFormat,
+                                                                bool mipmaps)
+        {
+            std::shared_ptr<graphics::Texture> texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
+
+            // generate the missing mip maps of uncompressed images
+            if (levels.size() == 1 && mipmaps && !graphics::isCompressed(pixelFormat))
+                texture->init(levels.front().data, levels.front().size, 0, 0, pixelFormat);
+            else
+                texture->init(std::vector<graphics::Texture::Level>(levels.begin(), levels.begin() + (mipmaps ? levels.size() : 1)),
+                              levels.front().size, 0, pixelFormat);
+
+            return texture;
+        }
+
+        bool LoaderDDS::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            if (!isDDS(data)) return false;
+
+            graphics::PixelFormat pixelFormat;
+            std::vector<graphics::Texture::Level> levels = decodeDDS(data, pixelFormat);
+
+            bundle.setTexture(filename, createTexture(levels, pixelFormat, mipmaps));
+
+            return true;
+        }
+
+        std::function<bool()> LoaderDDS::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            if (!isDDS(data)) return std::function<bool()>();
+
+            graphics::PixelFormat pixelFormat;
+            std::shared_ptr<std::vector<graphics::Texture::Level>> levels = std::make_shared<std::vector<graphics::Texture::Level>>(decodeDDS(data, pixelFormat));
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, levels, pixelFormat, mipmaps]() {
+                bundlePointer->setTexture(filename, createTexture(*levels, pixelFormat, mipmaps));
+
+                return true;
+            };
+        }
+    } // namespace assets
+} // namespace ouzel
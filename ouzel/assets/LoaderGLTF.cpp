@@ -12,7 +12,7 @@ namespace ouzel
         {
         }
 
-        bool LoaderGLTF::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderGLTF::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
         {
             return true;
         }
@@ -15,7 +15,7 @@ namespace ouzel
             static const uint32_t TYPE = Loader::SKINNED_MESH;
 
             explicit LoaderGLTF(Cache& initCache);
-            bool loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps = true) override;
+            bool loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps = true) override;
         };
     } // namespace assets
 } // namespace ouzel
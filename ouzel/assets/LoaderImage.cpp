@@ -28,80 +28,71 @@ namespace ouzel
         {
         }
 
-        bool LoaderImage::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        static graphics::ImageData decodeImage(const FileData& data)
         {
             int width;
             int height;
             int comp;
 
-            stbi_uc* tempData = stbi_load_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &comp, STBI_default);
+            if (!stbi_info_from_memory(data.getData(), static_cast<int>(data.getSize()), &width, &height, &comp))
+                throw std::runtime_error("Failed to load texture, reason: " + std::string(stbi_failure_reason()));
+
+            // there is no 3 channel pixel format, so let stb_image add the alpha channel while decoding
+            int desiredComp = (comp == STBI_rgb) ? STBI_rgb_alpha : STBI_default;
+
+            stbi_uc* tempData = stbi_load_from_memory(data.getData(), static_cast<int>(data.getSize()), &width, &height, &comp, desiredComp);
 
             if (!tempData)
                 throw std::runtime_error("Failed to load texture, reason: " + std::string(stbi_failure_reason()));
 
+            if (desiredComp != STBI_default) comp = desiredComp;
+
             size_t pixelSize;
             graphics::PixelFormat pixelFormat;
-            std::vector<uint8_t> imageData;
 
             switch (comp)
             {
                 case STBI_grey:
-                {
                     pixelFormat = graphics::PixelFormat::R8_UNORM;
                     pixelSize = 1;
-                    imageData.assign(tempData,
-                                     tempData + static_cast<size_t>(width * height) * pixelSize);
-                    stbi_image_free(tempData);
                     break;
-                }
                 case STBI_grey_alpha:
-                {
                     pixelFormat = graphics::PixelFormat::RG8_UNORM;
                     pixelSize = 2;
-                    imageData.assign(tempData,
-                                     tempData + static_cast<size_t>(width * height) * pixelSize);
-                    stbi_image_free(tempData);
-                    break;
-                }
-                case STBI_rgb:
-                {
-                    pixelFormat = graphics::PixelFormat::RGBA8_UNORM;
-                    pixelSize = 4;
-
-                    imageData.resize(static_cast<size_t>(width * height * 4));
-
-                    for (int y = 0; y < height; ++y)
-                    {
-                        for (int x = 0; x < width; ++x)
-                        {
-                            size_t sourceOffset = static_cast<size_t>((y * width + x) * 3);
-                            size_t destinationOffset = static_cast<size_t>((y * width + x) * 4);
-                            imageData[destinationOffset + 0] = tempData[sourceOffset + 0];
-                            imageData[destinationOffset + 1] = tempData[sourceOffset + 1];
-                            imageData[destinationOffset + 2] = tempData[sourceOffset + 2];
-                            imageData[destinationOffset + 3] = 255;
-                        }
-                    }
-                    stbi_image_free(tempData);
                     break;
-                }
                 case STBI_rgb_alpha:
-                {
                     pixelFormat = graphics::PixelFormat::RGBA8_UNORM;
                     pixelSize = 4;
-                    imageData.assign(tempData,
-                                     tempData + static_cast<size_t>(width * height) * pixelSize);
-                    stbi_image_free(tempData);
                     break;
-                }
                 default:
                     stbi_image_free(tempData);
                     throw std::runtime_error("Unsupported pixel format");
             }
 
-            graphics::ImageData image(pixelFormat,
-                                      Size2(static_cast<float>(width), static_cast<float>(height)),
-                                      imageData);
+            std::vector<uint8_t> imageData(tempData,
+                                           tempData + static_cast<size_t>(width * height) * pixelSize);
+            stbi_image_free(tempData);
+
+            return graphics::ImageData(pixelFormat,
+                                       Size2(static_cast<float>(width), static_cast<float>(height)),
+                                       imageData);
+        }
+
+        static bool isImage(const FileData& data)
+        {
+            int width;
+            int height;
+            int comp;
+
+            return stbi_info_from_memory(data.getData(), static_cast<int>(data.getSize()), &width, &height, &comp) != 0;
+        }
+
+        bool LoaderImage::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            // leave the formats that stb_image doesn't recognize to the other image loaders
+            if (!isImage(data)) return false;
+
+            graphics::ImageData image = decodeImage(data);
 
             std::shared_ptr<graphics::Texture> texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
             texture->init(image.getData(), image.getSize(), 0, mipmaps ? 0 : 1, image.getPixelFormat());
@@ -110,5 +101,22 @@ namespace ouzel
 
             return true;
         }
+
+        std::function<bool()> LoaderImage::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            if (!isImage(data)) return std::function<bool()>();
+
+            std::shared_ptr<graphics::ImageData> image = std::make_shared<graphics::ImageData>(decodeImage(data));
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, image, mipmaps]() {
+                std::shared_ptr<graphics::Texture> texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
+                texture->init(image->getData(), image->getSize(), 0, mipmaps ? 0 : 1, image->getPixelFormat());
+
+                bundlePointer->setTexture(filename, texture);
+
+                return true;
+            };
+        }
     } // namespace assets
 } // namespace ouzel
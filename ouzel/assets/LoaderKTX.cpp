@@ -0,0 +1,205 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include "LoaderKTX.hpp"
+#include "Bundle.hpp"
+#include "core/Engine.hpp"
+#include "graphics/Texture.hpp"
+#include "utils/Utils.hpp"
+
+// OpenGL internal formats that can be stored in KTX files
+enum KTXInternalFormat
+{
+    KTX_ALPHA8 = 0x803C,
+    KTX_RGBA8 = 0x8058,
+    KTX_R8 = 0x8229,
+    KTX_RG8 = 0x822B,
+    KTX_COMPRESSED_RGB_S3TC_DXT1 = 0x83F0,
+    KTX_COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1,
+    KTX_COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3,
+    KTX_COMPRESSED_RGBA_BPTC_UNORM = 0x8E8C,
+    KTX_COMPRESSED_RGB8_ETC2 = 0x9274,
+    KTX_COMPRESSED_RGBA8_ETC2_EAC = 0x9278,
+    KTX_COMPRESSED_RGBA_ASTC_4x4 = 0x93B0,
+    KTX_COMPRESSED_RGBA_ASTC_6x6 = 0x93B4,
+    KTX_COMPRESSED_RGBA_ASTC_8x8 = 0x93B7
+};
+
+namespace ouzel
+{
+    namespace assets
+    {
+        static const uint8_t KTX_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+        static const uint32_t KTX_HEADER_SIZE = 64;
+        static const uint32_t KTX_ENDIANNESS = 0x04030201;
+        static const uint32_t KTX_MAX_SIZE = 16384;
+
+        LoaderKTX::LoaderKTX(Cache& initCache):
+            Loader(initCache, TYPE)
+        {
+        }
+
+        static graphics::PixelFormat getPixelFormat(uint32_t internalFormat)
+        {
+            switch (internalFormat)
+            {
+                case KTX_ALPHA8: return graphics::PixelFormat::A8_UNORM;
+                case KTX_RGBA8: return graphics::PixelFormat::RGBA8_UNORM;
+                case KTX_R8: return graphics::PixelFormat::R8_UNORM;
+                case KTX_RG8: return graphics::PixelFormat::RG8_UNORM;
+                case KTX_COMPRESSED_RGB_S3TC_DXT1:
+                case KTX_COMPRESSED_RGBA_S3TC_DXT1: return graphics::PixelFormat::BC1_UNORM;
+                case KTX_COMPRESSED_RGBA_S3TC_DXT5: return graphics::PixelFormat::BC3_UNORM;
+                case KTX_COMPRESSED_RGBA_BPTC_UNORM: return graphics::PixelFormat::BC7_UNORM;
+                case KTX_COMPRESSED_RGB8_ETC2: return graphics::PixelFormat::ETC2_RGB8_UNORM;
+                case KTX_COMPRESSED_RGBA8_ETC2_EAC: return graphics::PixelFormat::ETC2_RGBA8_UNORM;
+                case KTX_COMPRESSED_RGBA_ASTC_4x4: return graphics::PixelFormat::ASTC_4X4_UNORM;
+                case KTX_COMPRESSED_RGBA_ASTC_6x6: return graphics::PixelFormat::ASTC_6X6_UNORM;
+                case KTX_COMPRESSED_RGBA_ASTC_8x8: return graphics::PixelFormat::ASTC_8X8_UNORM;
+                default: throw std::runtime_error("Unsupported pixel format");
+            }
+        }
+
+        static bool isKTX(const FileData& data)
+        {
+            return data.getSize() >= sizeof(KTX_IDENTIFIER) &&
+                std::memcmp(data.getData(), KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0;
+        }
+
+        static std::vector<graphics::Texture::Level> decodeKTX(const FileData& data, graphics::PixelFormat& pixelFormat)
+        {
+            const uint8_t* bytes = data.getData();
+            const size_t size = data.getSize();
+
+            if (size < KTX_HEADER_SIZE)
+                throw std::runtime_error("Failed to load KTX file, file too small");
+
+            // the header is stored in the byte order of the machine that wrote the file
+            bool bigEndian = decodeUInt32Little(bytes + 12) != KTX_ENDIANNESS;
+
+            if (bigEndian && decodeUInt32Big(bytes + 12) != KTX_ENDIANNESS)
+                throw std::runtime_error("Failed to load KTX file, invalid endianness");
+
+            auto readUInt32 = [bytes, bigEndian](size_t offset) {
+                return bigEndian ? decodeUInt32Big(bytes + offset) : decodeUInt32Little(bytes + offset);
+            };
+
+            uint32_t internalFormat = readUInt32(28);
+            uint32_t width = readUInt32(36);
+            uint32_t height = std::max(readUInt32(40), 1U);
+            uint32_t depth = readUInt32(44);
+            uint32_t arrayElements = readUInt32(48);
+            uint32_t faces = readUInt32(52);
+            uint32_t levelCount = std::max(readUInt32(56), 1U); // zero means that the mip maps have to be generated
+            uint32_t keyValueDataSize = readUInt32(60);
+
+            if (width == 0 || depth != 0 || arrayElements != 0 || faces != 1)
+                throw std::runtime_error("Failed to load KTX file, only 2D textures are supported");
+
+            if (width > KTX_MAX_SIZE || height > KTX_MAX_SIZE)
+                throw std::runtime_error("Failed to load KTX file, texture too large");
+
+            if (levelCount > 32)
+                throw std::runtime_error("Failed to load KTX file, invalid mip map count");
+
+            pixelFormat = getPixelFormat(internalFormat);
+
+            if (keyValueDataSize > size - KTX_HEADER_SIZE)
+                throw std::runtime_error("Failed to load KTX file, file too small");
+
+            size_t offset = KTX_HEADER_SIZE + static_cast<size_t>(keyValueDataSize);
+
+            std::vector<graphics::Texture::Level> levels;
+            levels.reserve(levelCount);
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                uint32_t levelWidth = std::max(width >> level, 1U);
+                uint32_t levelHeight = std::max(height >> level, 1U);
+                size_t pitch = graphics::getRowPitch(pixelFormat, levelWidth);
+                size_t rows = graphics::getRowCount(pixelFormat, levelHeight);
+
+                if (offset > size - 4)
+                    throw std::runtime_error("Failed to load KTX file, file too small");
+
+                size_t imageSize = readUInt32(offset);
+                offset += 4;
+
+                // checked against the remaining data before anything is allocated
+                if (imageSize > size - offset)
+                    throw std::runtime_error("Failed to load KTX file, file too small");
+
+                // rows of uncompressed images are aligned to 4 bytes
+                size_t sourcePitch = pitch;
+                if (imageSize != pitch * rows && !graphics::isCompressed(pixelFormat))
+                    sourcePitch = (pitch + 3) & ~static_cast<size_t>(3);
+
+                if (imageSize != sourcePitch * rows)
+                    throw std::runtime_error("Failed to load KTX file, invalid image size");
+
+                graphics::Texture::Level textureLevel;
+                textureLevel.size = Size2(static_cast<float>(levelWidth), static_cast<float>(levelHeight));
+                textureLevel.pitch = static_cast<uint32_t>(pitch);
+                textureLevel.data.resize(pitch * rows);
+
+                for (size_t row = 0; row < rows; ++row)
+                    std::copy(bytes + offset + row * sourcePitch,
+                              bytes + offset + row * sourcePitch + pitch,
+                              textureLevel.data.begin() + row * pitch);
+
+                levels.push_back(std::move(textureLevel));
+
+                // levels are aligned to 4 bytes
+                offset = (offset + imageSize + 3) & ~static_cast<size_t>(3);
+            }
+
+            return levels;
+        }
+
+        static std::shared_ptr<graphics::Texture> createTexture(const std::vector<graphics::Texture::Level>& levels,
+                                                                graphics::PixelFormat pixelFormat,
+                                                                bool mipmaps)
+        {
+            std::shared_ptr<graphics::Texture> texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
+
+            // generate the missing mip maps of uncompressed images
+            if (levels.size() == 1 && mipmaps && !graphics::isCompressed(pixelFormat))
+                texture->init(levels.front().data, levels.front().size, 0, 0, pixelFormat);
+            else
+                texture->init(std::vector<graphics::Texture::Level>(levels.begin(), levels.begin() + (mipmaps ? levels.size() : 1)),
+                              levels.front().size, 0, pixelFormat);
+
+            return texture;
+        }
+
+        bool LoaderKTX::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            if (!isKTX(data)) return false;
+
+            graphics::PixelFormat pixelFormat;
+            std::vector<graphics::Texture::Level> levels = decodeKTX(data, pixelFormat);
+
+            bundle.setTexture(filename, createTexture(levels, pixelFormat, mipmaps));
+
+            return true;
+        }
+
+        std::function<bool()> LoaderKTX::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            if (!isKTX(data)) return std::function<bool()>();
+
+            graphics::PixelFormat pixelFormat;
+            std::shared_ptr<std::vector<graphics::Texture::Level>> levels = std::make_shared<std::vector<graphics::Texture::Level>>(decodeKTX(data, pixelFormat));
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, levels, pixelFormat, mipmaps]() {
+                bundlePointer->setTexture(filename, createTexture(*levels, pixelFormat, mipmaps));
+
+                return true;
+            };
+        }
+    } // namespace assets
+} // namespace ouzel
@@ -0,0 +1,24 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_LOADERKTX_HPP
+#define OUZEL_ASSETS_LOADERKTX_HPP
+
+#include "assets/Loader.hpp"
+
+namespace ouzel
+{
+    namespace assets
+    {
+        class LoaderKTX final: public Loader
+        {
+        public:
+            static const uint32_t TYPE = Loader::IMAGE;
+
+            explicit LoaderKTX(Cache& initCache);
+            bool loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps = true) override;
+            std::function<bool()> prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps = true) override;
+        };
+    } // namespace assets
+} // namespace ouzel
+
+#endif // OUZEL_ASSETS_LOADERKTX_HPP
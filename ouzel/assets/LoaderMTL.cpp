@@ -27,8 +27,8 @@ namespace ouzel
             return c <= 0x1F;
         }
 
-        static void skipWhitespaces(const std::vector<uint8_t>& str,
-                                    std::vector<uint8_t>::const_iterator& iterator)
+        static void skipWhitespaces(const FileData& str,
+                                    const uint8_t*& iterator)
         {
             for (;;)
             {
@@ -41,8 +41,8 @@ namespace ouzel
             }
         }
 
-        static void skipLine(const std::vector<uint8_t>& str,
-                             std::vector<uint8_t>::const_iterator& iterator)
+        static void skipLine(const FileData& str,
+                             const uint8_t*& iterator)
         {
             for (;;)
             {
@@ -58,8 +58,8 @@ namespace ouzel
             }
         }
 
-        static std::string parseString(const std::vector<uint8_t>& str,
-                                       std::vector<uint8_t>::const_iterator& iterator)
+        static std::string parseString(const FileData& str,
+                                       const uint8_t*& iterator)
         {
             std::string result;
 
@@ -78,8 +78,8 @@ namespace ouzel
             return result;
         }
 
-        static float parseFloat(const std::vector<uint8_t>& str,
-                               std::vector<uint8_t>::const_iterator& iterator)
+        static float parseFloat(const FileData& str,
+                               const uint8_t*& iterator)
         {
             float result;
             std::string value;
@@ -129,7 +129,7 @@ namespace ouzel
         {
         }
 
-        bool LoaderMTL::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        bool LoaderMTL::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
         {
             std::string name = filename;
             std::shared_ptr<graphics::Texture> diffuseTexture;
@@ -139,7 +139,7 @@ namespace ouzel
 
             uint32_t materialCount = 0;
 
-            auto iterator = data.cbegin();
+            const uint8_t* iterator = data.begin();
 
             std::string keyword;
             std::string value;
@@ -169,7 +169,7 @@ namespace ouzel
                         {
                             std::shared_ptr<graphics::Material> material = std::make_shared<graphics::Material>();
                             material->blendState = cache.getBlendState(BLEND_ALPHA);
-                            material->shader = cache.getShader(SHADER_TEXTURE);
+                            material->shader = cache.getShader(SHADER_STATIC_MESH);
                             material->textures[0] = diffuseTexture;
                             material->textures[1] = ambientTexture;
                             material->diffuseColor = diffuseColor;
@@ -267,7 +267,7 @@ namespace ouzel
             {
                 std::shared_ptr<graphics::Material> material = std::make_shared<graphics::Material>();
                 material->blendState = cache.getBlendState(BLEND_ALPHA);
-                material->shader = cache.getShader(SHADER_TEXTURE);
+                material->shader = cache.getShader(SHADER_STATIC_MESH);
                 material->textures[0] = diffuseTexture;
                 material->textures[1] = ambientTexture;
                 material->diffuseColor = diffuseColor;
@@ -30,8 +30,8 @@ namespace ouzel
             return c <= 0x1F;
         }
 
-        static void skipWhitespaces(const std::vector<uint8_t>& str,
-                                    std::vector<uint8_t>::const_iterator& iterator)
+        static void skipWhitespaces(const FileData& str,
+                                    const uint8_t*& iterator)
         {
             for (;;)
             {
@@ -44,8 +44,8 @@ namespace ouzel
             }
         }
 
-        static void skipLine(const std::vector<uint8_t>& str,
-                             std::vector<uint8_t>::const_iterator& iterator)
+        static void skipLine(const FileData& str,
+                             const uint8_t*& iterator)
         {
             for (;;)
             {
@@ -61,8 +61,8 @@ namespace ouzel
             }
         }
 
-        static std::string parseString(const std::vector<uint8_t>& str,
-                                       std::vector<uint8_t>::const_iterator& iterator)
+        static std::string parseString(const FileData& str,
+                                       const uint8_t*& iterator)
         {
             std::string result;
 
@@ -81,8 +81,8 @@ namespace ouzel
             return result;
         }
 
-        static int32_t parseInt32(const std::vector<uint8_t>& str,
-                                  std::vector<uint8_t>::const_iterator& iterator)
+        static int32_t parseInt32(const FileData& str,
+                                  const uint8_t*& iterator)
         {
             int32_t result;
             std::string value;
@@ -111,8 +111,8 @@ namespace ouzel
             return result;
         }
 
-        static float parseFloat(const std::vector<uint8_t>& str,
-                               std::vector<uint8_t>::const_iterator& iterator)
+        static float parseFloat(const FileData& str,
+                               const uint8_t*& iterator)
         {
             float result;
             std::string value;
@@ -157,8 +157,8 @@ namespace ouzel
             return result;
         }
 
-        static bool parseToken(const std::vector<uint8_t>& str,
-                               std::vector<uint8_t>::const_iterator& iterator,
+        static bool parseToken(const FileData& str,
+                               const uint8_t*& iterator,
                                char token)
         {
             if (iterator == str.end() || *iterator != static_cast<uint8_t>(token)) return false;
@@ -173,7 +173,7 @@ namespace ouzel
         {
         }
 
-        bool LoaderOBJ::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        bool LoaderOBJ::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
         {
             std::string name = filename;
             std::shared_ptr<graphics::Material> material;
@@ -187,7 +187,7 @@ namespace ouzel
 
             uint32_t objectCount = 0;
 
-            auto iterator = data.cbegin();
+            const uint8_t* iterator = data.begin();
 
             std::string keyword;
             std::string value;
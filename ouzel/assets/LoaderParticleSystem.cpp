@@ -15,11 +15,11 @@ namespace ouzel
         {
         }
 
-        bool LoaderParticleSystem::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        bool LoaderParticleSystem::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
         {
             scene::ParticleSystemData particleSystemData;
 
-            json::Data document(data);
+            json::Data document(data.getData(), data.getSize());
 
             if (!document.hasMember("textureFileName") ||
                 !document.hasMember("configName"))
@@ -16,11 +16,11 @@ namespace ouzel
         {
         }
 
-        bool LoaderSprite::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        bool LoaderSprite::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
         {
             scene::SpriteData spriteData;
 
-            json::Data document(data);
+            json::Data document(data.getData(), data.getSize());
 
             if (!document.hasMember("meta") ||
                 !document.hasMember("frames"))
@@ -13,12 +13,12 @@ namespace ouzel
         {
         }
 
-        bool LoaderTTF::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        bool LoaderTTF::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
         {
             try
             {
                 // TODO: move the loader here
-                std::shared_ptr<TTFont> font = std::make_shared<TTFont>(data, mipmaps);
+                std::shared_ptr<TTFont> font = std::make_shared<TTFont>(std::vector<uint8_t>(data.begin(), data.end()), mipmaps);
                 bundle.setFont(filename, font);
             }
             catch (const std::exception&)
@@ -28,5 +28,27 @@ namespace ouzel
 
             return true;
         }
+
+        std::function<bool()> LoaderTTF::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool mipmaps)
+        {
+            std::shared_ptr<TTFont> font;
+
+            try
+            {
+                font = std::make_shared<TTFont>(std::vector<uint8_t>(data.begin(), data.end()), mipmaps);
+            }
+            catch (const std::exception&)
+            {
+                return []() { return false; };
+            }
+
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, font]() {
+                bundlePointer->setFont(filename, font);
+
+                return true;
+            };
+        }
     } // namespace assets
 } // namespace ouzel
@@ -13,7 +13,7 @@ namespace ouzel
         {
         }
 
-        bool LoaderVorbis::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderVorbis::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
         {
             try
             {
@@ -27,5 +27,27 @@ namespace ouzel
 
             return true;
         }
+
+        std::function<bool()> LoaderVorbis::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
+        {
+            std::shared_ptr<audio::SoundData> soundData;
+
+            try
+            {
+                soundData = std::make_shared<audio::SoundDataVorbis>(data);
+            }
+            catch (const std::exception&)
+            {
+                return []() { return false; };
+            }
+
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, soundData]() {
+                bundlePointer->setSoundData(filename, soundData);
+
+                return true;
+            };
+        }
     } // namespace assets
 } // namespace ouzel
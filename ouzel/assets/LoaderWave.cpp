@@ -13,11 +13,11 @@ namespace ouzel
         {
         }
 
-        bool LoaderWave::loadAsset(Bundle& bundle, const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderWave::loadAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
         {
             try
             {
-                std::shared_ptr<audio::SoundData> soundData = std::make_shared<audio::SoundDataWave>(data);
+                std::shared_ptr<audio::SoundData> soundData = std::make_shared<audio::SoundDataWave>(data.getData(), data.getSize());
                 bundle.setSoundData(filename, soundData);
             }
             catch (const std::exception&)
@@ -27,5 +27,27 @@ namespace ouzel
 
             return true;
         }
+
+        std::function<bool()> LoaderWave::prepareAsset(Bundle& bundle, const std::string& filename, const FileData& data, bool)
+        {
+            std::shared_ptr<audio::SoundData> soundData;
+
+            try
+            {
+                soundData = std::make_shared<audio::SoundDataWave>(data.getData(), data.getSize());
+            }
+            catch (const std::exception&)
+            {
+                return []() { return false; };
+            }
+
+            Bundle* bundlePointer = &bundle;
+
+            return [bundlePointer, filename, soundData]() {
+                bundlePointer->setSoundData(filename, soundData);
+
+                return true;
+            };
+        }
     } // namespace assets
 } // namespace ouzel
@@ -26,12 +26,6 @@ namespace ouzel
             Destination()
             {
             }
-
-            void process(std::vector<float>& samples, uint16_t& channels,
-                         uint32_t& sampleRate, Vector3& position) override
-            {
-                Node::process(samples, channels, sampleRate, position);
-            }
         };
 
         std::set<Driver> Audio::getAvailableAudioDrivers()
@@ -132,6 +126,7 @@ namespace ouzel
         void Audio::update()
         {
             // TODO: handle events from the audio device
+            device->update();
         }
 
         uintptr_t Audio::initNode(const std::function<std::unique_ptr<Node>(void)>& createFunction)
@@ -158,5 +153,21 @@ namespace ouzel
             command.updateFunction = updateFunction;
             device->addCommand(command);
         }
+
+        void Audio::addOutputNode(uintptr_t nodeId, uintptr_t outputNodeId)
+        {
+            AudioDevice::Command command(AudioDevice::Command::Type::ADD_OUTPUT_NODE);
+            command.nodeId = nodeId;
+            command.destinationNodeId = outputNodeId;
+            device->addCommand(command);
+        }
+
+        void Audio::removeOutputNode(uintptr_t nodeId, uintptr_t outputNodeId)
+        {
+            AudioDevice::Command command(AudioDevice::Command::Type::REMOVE_OUTPUT_NODE);
+            command.nodeId = nodeId;
+            command.destinationNodeId = outputNodeId;
+            device->addCommand(command);
+        }
     } // namespace audio
 } // namespace ouzel
@@ -44,6 +44,8 @@ namespace ouzel
             uintptr_t initNode(const std::function<std::unique_ptr<Node>(void)>& createFunction);
             void deleteNode(uintptr_t nodeId);
             void updateNode(uintptr_t nodeId, const std::function<void(Node*)>& updateFunction);
+            void addOutputNode(uintptr_t nodeId, uintptr_t outputNodeId);
+            void removeOutputNode(uintptr_t nodeId, uintptr_t outputNodeId);
 
         private:
             std::unique_ptr<AudioDevice> device;
@@ -1,124 +1,347 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <cstring>
+#include "core/Setup.h"
+#if OUZEL_SUPPORTS_NEON
+#include <arm_neon.h>
+#elif OUZEL_SUPPORTS_SSE
+#include <xmmintrin.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#endif
 #include "AudioDevice.hpp"
 #include "math/MathUtils.hpp"
+#include "utils/Utils.hpp"
 
 namespace ouzel
 {
     namespace audio
     {
+        constexpr uint32_t AudioDevice::MAX_FRAMES;
+
+        static inline bool isSimdAvailable()
+        {
+#if OUZEL_SUPPORTS_NEON_CHECK
+            return anrdoidNEONChecker.isNEONAvailable();
+#else
+            return true;
+#endif
+        }
+
+        static void mixSamples(float* destination, const float* source, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON
+            if (isSimdAvailable())
+                for (; i + 4 <= count; i += 4)
+                    vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vld1q_f32(source + i)));
+#elif OUZEL_SUPPORTS_SSE
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_loadu_ps(source + i)));
+#endif
+
+            for (; i < count; ++i)
+                destination[i] += source[i];
+        }
+
+        static void clampSamples(float* samples, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON
+            if (isSimdAvailable())
+            {
+                float32x4_t minimum = vdupq_n_f32(-1.0F);
+                float32x4_t maximum = vdupq_n_f32(1.0F);
+
+                for (; i + 4 <= count; i += 4)
+                    vst1q_f32(samples + i, vminq_f32(vmaxq_f32(vld1q_f32(samples + i), minimum), maximum));
+            }
+#elif OUZEL_SUPPORTS_SSE
+            __m128 minimum = _mm_set1_ps(-1.0F);
+            __m128 maximum = _mm_set1_ps(1.0F);
+
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), minimum), maximum));
+#endif
+
+            for (; i < count; ++i)
+                samples[i] = clamp(samples[i], -1.0F, 1.0F);
+        }
+
+        // samples must be clamped
+        static void convertSamples(const float* samples, int16_t* result, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON
+            if (isSimdAvailable())
+            {
+                float32x4_t scale = vdupq_n_f32(32767.0F);
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    int32x4_t low = vcvtq_s32_f32(vmulq_f32(vld1q_f32(samples + i), scale));
+                    int32x4_t high = vcvtq_s32_f32(vmulq_f32(vld1q_f32(samples + i + 4), scale));
+                    vst1q_s16(result + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+                }
+            }
+#elif OUZEL_SUPPORTS_SSE && defined(__SSE2__)
+            __m128 scale = _mm_set1_ps(32767.0F);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i low = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(samples + i), scale));
+                __m128i high = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(samples + i + 4), scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_packs_epi32(low, high));
+            }
+#endif
+
+            for (; i < count; ++i)
+                result[i] = static_cast<int16_t>(samples[i] * 32767.0F);
+        }
+
         AudioDevice::AudioDevice(Driver initDriver):
-            driver(initDriver)
+            driver(initDriver),
+            messageQueue(MESSAGE_QUEUE_SIZE),
+            returnQueue(MESSAGE_QUEUE_SIZE),
+            graph(new Graph()),
+            mixBuffer(MAX_FRAMES * channels)
         {
-            buffers.resize(1000);
         }
 
         AudioDevice::~AudioDevice()
         {
+            // the audio thread has been stopped by the subclass
+            Message* message;
+            while (messageQueue.pop(message)) delete message;
+            while (returnQueue.pop(message)) delete message;
+            for (Message* pendingMessage : pendingMessages) delete pendingMessage;
         }
 
         void AudioDevice::process()
         {
-            Command command;
-            for (;;)
+            Message* message;
+            while (messageQueue.pop(message))
             {
-                std::unique_lock<std::mutex> lock(commandMutex);
-                if (commandQueue.empty()) break;
-                command = std::move(commandQueue.front());
-                commandQueue.pop();
-                lock.unlock();
+                if (message->graph)
+                    graph.swap(message->graph);
+
+                if (message->updateFunction)
+                    message->updateFunction(message->node);
+
+                // can't fail, because at most MESSAGE_QUEUE_SIZE messages are sent before they are returned
+                returnQueue.push(message);
+            }
+        }
+
+        void AudioDevice::render(uint32_t frames)
+        {
+            uint32_t sampleCount = frames * channels;
 
-                switch (command.type)
+            for (Graph::Entry& entry : graph->entries)
+            {
+                entry.buffer.resize(sampleCount); // never exceeds the reserved size
+                entry.channels = channels;
+                entry.sampleRate = sampleRate;
+                entry.position = Vector3();
+
+                if (entry.inputCount)
                 {
-                    case Command::Type::INIT_NODE:
+                    for (uint32_t i = 0; i < entry.inputCount; ++i)
                     {
-                        if (command.nodeId > nodes.size())
-                            nodes.resize(command.nodeId);
+                        const Graph::Entry& input = graph->entries[graph->inputs[entry.firstInput + i]];
 
-                        nodes[command.nodeId - 1] = command.createFunction();
-                        break;
-                    }
-                    case Command::Type::DELETE_NODE:
-                    {
-                        nodes[command.nodeId - 1].reset();
-                        break;
-                    }
-                    case Command::Type::UPDATE_NODE:
-                    {
-                        command.updateFunction(nodes[command.nodeId - 1].get());
-                        break;
-                    }
-                    case Command::Type::ADD_OUTPUT_NODE:
-                    {
-                        nodes[command.nodeId - 1]->addOutputNode(nodes[command.destinationNodeId - 1].get());
-                        break;
-                    }
-                    case Command::Type::SET_DESTINATION_NODE:
-                    {
-                        destinationNode = command.nodeId ? nodes[command.nodeId - 1].get() : nullptr;
-                        break;
+                        if (i == 0)
+                            std::copy(input.buffer.begin(), input.buffer.end(), entry.buffer.begin());
+                        else
+                            mixSamples(entry.buffer.data(), input.buffer.data(), sampleCount);
+
+                        entry.channels = input.channels;
+                        entry.sampleRate = input.sampleRate;
+                        entry.position = input.position;
                     }
-                    default:
-                        throw std::runtime_error("Invalid command");
                 }
+                else
+                    std::fill(entry.buffer.begin(), entry.buffer.end(), 0.0F);
+
+                entry.node->process(entry.buffer, entry.channels, entry.sampleRate, entry.position);
             }
         }
 
         void AudioDevice::getData(uint32_t frames, std::vector<uint8_t>& result)
         {
-            currentBuffer = 0;
-            uint32_t buffer = currentBuffer;
+            uint32_t sampleSize = (sampleFormat == SampleFormat::SINT16) ? sizeof(int16_t) : sizeof(float);
+            result.resize(frames * channels * sampleSize);
 
-            if (++currentBuffer > buffers.size()) return; // out of buffers
+            for (uint32_t offset = 0; offset < frames;)
+            {
+                uint32_t count = std::min(frames - offset, MAX_FRAMES);
+                uint32_t sampleCount = count * channels;
 
-            buffers[buffer].resize(frames * channels);
-            std::fill(buffers[buffer].begin(), buffers[buffer].end(), 0.0F);
+                render(count);
 
-            if (destinationNode)
-            {
-                uint16_t inputChannels = channels;
-                uint32_t inputSampleRate = sampleRate;
-                Vector3 inputPosition;
+                // the destination node is the last one
+                float* samples = mixBuffer.data();
+                if (!graph->entries.empty())
+                    samples = graph->entries.back().buffer.data();
+                else
+                    std::fill(mixBuffer.begin(), mixBuffer.begin() + sampleCount, 0.0F);
 
-                destinationNode->process(buffers[buffer], inputChannels, inputSampleRate, inputPosition);
+                clampSamples(samples, sampleCount);
+
+                switch (sampleFormat)
+                {
+                    case SampleFormat::SINT16:
+                        convertSamples(samples, reinterpret_cast<int16_t*>(result.data()) + offset * channels, sampleCount);
+                        break;
+                    case SampleFormat::FLOAT32:
+                        std::memcpy(reinterpret_cast<float*>(result.data()) + offset * channels, samples, sampleCount * sizeof(float));
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid sample format");
+                }
+
+                offset += count;
             }
+        }
 
-            for (float& f : buffers[buffer])
-                f = clamp(f, -1.0F, 1.0F);
+        void AudioDevice::addCommand(const Command& command)
+        {
+            std::unique_lock<std::mutex> lock(commandMutex);
 
-            switch (sampleFormat)
+            switch (command.type)
             {
-                case SampleFormat::SINT16:
+                case Command::Type::INIT_NODE:
                 {
-                    result.resize(frames * channels * sizeof(int16_t));
-                    int16_t* resultPtr = reinterpret_cast<int16_t*>(result.data());
+                    // the node is not reachable from the destination yet, so the audio thread doesn't need to know about it
+                    nodes.insert(command.nodeId, command.createFunction());
+                    break;
+                }
+                case Command::Type::DELETE_NODE:
+                {
+                    std::unique_ptr<Node> node = nodes.take(command.nodeId);
+                    nodeIds.release(command.nodeId);
+                    if (destinationNode == node.get()) destinationNode = nullptr;
 
-                    for (uint32_t i = 0; i < buffers[buffer].size(); ++i)
-                    {
-                        *resultPtr = static_cast<int16_t>(buffers[buffer][i] * 32767.0F);
-                        ++resultPtr;
-                    }
+                    // detach the node from the graph, but free it only after the audio thread has stopped using it
+                    node->detach();
+
+                    compileGraph();
+
+                    Message* message = new Message();
+                    message->deletedNode = std::move(node);
+                    sendMessage(message);
+                    break;
+                }
+                case Command::Type::UPDATE_NODE:
+                {
+                    Message* message = new Message();
+                    message->node = nodes.get(command.nodeId);
+                    message->updateFunction = command.updateFunction;
+                    sendMessage(message);
+                    break;
+                }
+                case Command::Type::ADD_OUTPUT_NODE:
+                {
+                    nodes.get(command.nodeId)->addOutputNode(nodes.get(command.destinationNodeId));
+                    compileGraph();
                     break;
                 }
-                case SampleFormat::FLOAT32:
+                case Command::Type::REMOVE_OUTPUT_NODE:
                 {
-                    result.reserve(frames * channels * sizeof(float));
-                    result.assign(reinterpret_cast<uint8_t*>(buffers[buffer].data()),
-                                  reinterpret_cast<uint8_t*>(buffers[buffer].data()) + buffers[buffer].size() * sizeof(float));
+                    nodes.get(command.nodeId)->removeOutputNode(nodes.get(command.destinationNodeId));
+                    compileGraph();
+                    break;
+                }
+                case Command::Type::SET_DESTINATION_NODE:
+                {
+                    destinationNode = nodes.get(command.nodeId);
+                    compileGraph();
                     break;
                 }
                 default:
-                    throw std::runtime_error("Invalid sample format");
+                    throw std::runtime_error("Invalid command");
             }
         }
 
-        void AudioDevice::addCommand(const Command& command)
+        void AudioDevice::update()
         {
             std::unique_lock<std::mutex> lock(commandMutex);
-            commandQueue.push(command);
-            lock.unlock();
-            commandConditionVariable.notify_all();
+
+            sendMessage(nullptr);
+        }
+
+        uint32_t AudioDevice::addGraphNode(Graph& newGraph, std::vector<std::pair<Node*, uint32_t>>& visited, Node* node)
+        {
+            for (const std::pair<Node*, uint32_t>& visitedNode : visited)
+                if (visitedNode.first == node) return visitedNode.second;
+
+            // a node that is being visited is part of a cycle and its output is not available
+            visited.push_back(std::make_pair(node, UINT32_MAX));
+            size_t visitedIndex = visited.size() - 1;
+
+            std::vector<uint32_t> inputs;
+            for (Node* inputNode : node->inputNodes)
+            {
+                uint32_t input = addGraphNode(newGraph, visited, inputNode);
+                if (input != UINT32_MAX) inputs.push_back(input);
+            }
+
+            Graph::Entry entry;
+            entry.node = node;
+            entry.firstInput = static_cast<uint32_t>(newGraph.inputs.size());
+            entry.inputCount = static_cast<uint32_t>(inputs.size());
+            entry.buffer.reserve(MAX_FRAMES * channels);
+            entry.channels = channels;
+            entry.sampleRate = sampleRate;
+            newGraph.entries.push_back(std::move(entry));
+            newGraph.inputs.insert(newGraph.inputs.end(), inputs.begin(), inputs.end());
+
+            uint32_t index = static_cast<uint32_t>(newGraph.entries.size() - 1);
+            visited[visitedIndex].second = index;
+
+            return index;
+        }
+
+        void AudioDevice::compileGraph()
+        {
+            std::unique_ptr<Graph> newGraph(new Graph());
+
+            if (destinationNode)
+            {
+                std::vector<std::pair<Node*, uint32_t>> visited;
+                addGraphNode(*newGraph, visited, destinationNode);
+            }
+
+            Message* message = new Message();
+            message->graph = std::move(newGraph);
+            sendMessage(message);
+        }
+
+        void AudioDevice::sendMessage(Message* message)
+        {
+            // free the messages handled by the audio thread
+            Message* returnedMessage;
+            while (returnQueue.pop(returnedMessage))
+            {
+                delete returnedMessage;
+                --sentMessages;
+            }
+
+            if (message) pendingMessages.push_back(message);
+
+            auto i = pendingMessages.begin();
+            for (; i != pendingMessages.end() && sentMessages < messageQueue.getCapacity(); ++i)
+            {
+                messageQueue.push(*i);
+                ++sentMessages;
+            }
+
+            pendingMessages.erase(pendingMessages.begin(), i);
         }
     } // namespace audio
 } // namespace ouzel
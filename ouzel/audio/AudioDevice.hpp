@@ -3,18 +3,17 @@
 #ifndef OUZEL_AUDIO_AUDIODEVICE_HPP
 #define OUZEL_AUDIO_AUDIODEVICE_HPP
 
-#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
-#include <set>
 #include <vector>
 #include "audio/Driver.hpp"
 #include "audio/Node.hpp"
 #include "audio/SampleFormat.hpp"
 #include "math/Quaternion.hpp"
 #include "math/Vector3.hpp"
+#include "utils/HandleTable.hpp"
+#include "utils/SpscQueue.hpp"
 
 namespace ouzel
 {
@@ -36,6 +35,7 @@ namespace ouzel
                     DELETE_NODE,
                     UPDATE_NODE,
                     ADD_OUTPUT_NODE,
+                    REMOVE_OUTPUT_NODE,
                     SET_DESTINATION_NODE
                 };
 
@@ -61,30 +61,22 @@ namespace ouzel
             inline uint16_t getAPIMajorVersion() const { return apiMajorVersion; }
             inline uint16_t getAPIMinorVersion() const { return apiMinorVersion; }
 
+            // called by the audio thread before getData
             virtual void process();
 
+            // graph edits are applied on the calling thread and sent to the audio thread as a compiled graph
             void addCommand(const Command& command);
+            // frees the graphs and nodes that the audio thread no longer uses
+            void update();
 
             uintptr_t getNodeId()
             {
-                auto i = deletedNodeIds.begin();
-
-                if (i == deletedNodeIds.end())
-                    return ++lastNodeId; // zero is reserved for null node
-                else
-                {
-                    uintptr_t nodeId = *i;
-                    deletedNodeIds.erase(i);
-                    return nodeId;
-                }
-            }
-
-            void deleteNodeId(uintptr_t nodeId)
-            {
-                deletedNodeIds.insert(nodeId);
+                std::unique_lock<std::mutex> lock(commandMutex);
+                return nodeIds.allocate();
             }
 
         protected:
+            // doesn't allocate if the result is already large enough
             void getData(uint32_t frames, std::vector<uint8_t>& result);
 
             uint16_t apiMajorVersion = 0;
@@ -96,20 +88,58 @@ namespace ouzel
             const uint16_t channels = 2;
 
         private:
-            std::vector<std::vector<float>> buffers;
-            uint32_t currentBuffer = 0;
+            // maximum number of frames rendered at once
+            static constexpr uint32_t MAX_FRAMES = 1024;
+            static constexpr size_t MESSAGE_QUEUE_SIZE = 256;
+
+            // nodes reachable from the destination node, sorted so that every node comes after its inputs
+            struct Graph final
+            {
+                struct Entry final
+                {
+                    Node* node;
+                    uint32_t firstInput;
+                    uint32_t inputCount;
+                    std::vector<float> buffer; // reserved for MAX_FRAMES
+                    uint16_t channels;
+                    uint32_t sampleRate;
+                    Vector3 position;
+                };
 
-            uintptr_t lastNodeId = 0;
-            std::set<uintptr_t> deletedNodeIds;
+                std::vector<Entry> entries;
+                std::vector<uint32_t> inputs; // entry indices
+            };
+
+            // sent to the audio thread and returned to be freed on the producer thread
+            struct Message final
+            {
+                Node* node = nullptr;
+                std::function<void(Node*)> updateFunction;
+                std::unique_ptr<Graph> graph; // the replaced graph after the audio thread has handled the message
+                std::unique_ptr<Node> deletedNode;
+            };
 
-            std::vector<std::unique_ptr<Node>> nodes;
+            uint32_t addGraphNode(Graph& graph, std::vector<std::pair<Node*, uint32_t>>& visited, Node* node);
+            void compileGraph();
+            void sendMessage(Message* message);
+            void render(uint32_t frames);
 
             Driver driver;
 
-            Node* destinationNode = nullptr;
+            // producer thread
             std::mutex commandMutex;
-            std::condition_variable commandConditionVariable;
-            std::queue<Command> commandQueue;
+            HandlePool nodeIds;
+            HandleTable<Node> nodes;
+            Node* destinationNode = nullptr;
+            std::vector<Message*> pendingMessages; // not sent because the queue was full
+            size_t sentMessages = 0; // messages that have not been returned
+
+            SpscQueue<Message*> messageQueue;
+            SpscQueue<Message*> returnQueue;
+
+            // audio thread
+            std::unique_ptr<Graph> graph;
+            std::vector<float> mixBuffer;
         };
     } // namespace audio
 } // namespace ouzel
@@ -17,12 +17,6 @@ namespace ouzel
             ListenerProcessor()
             {
             }
-
-            void process(std::vector<float>& samples, uint16_t& channels,
-                         uint32_t& sampleRate, Vector3& position) override
-            {
-                Node::process(samples, channels, sampleRate, position);
-            }
         };
 
         Listener::Listener(Audio& initAudio):
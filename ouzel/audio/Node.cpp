@@ -9,23 +9,12 @@ namespace ouzel
     {
         Node::~Node()
         {
-            for (Node* outputNode : outputNodes)
-                outputNode->removeInputNode(this);
+            detach();
         }
 
-        void Node::process(std::vector<float>& samples, uint16_t& channels,
-                           uint32_t& sampleRate, Vector3& position)
+        void Node::process(std::vector<float>&, uint16_t&,
+                           uint32_t&, Vector3&)
         {
-            buffer.resize(samples.size());
-            std::fill(buffer.begin(), buffer.end(), 0.0F);
-
-            for (Node* inputNode : inputNodes)
-            {
-                inputNode->process(buffer, channels, sampleRate, position);
-
-                for (uint32_t i = 0; i < samples.size(); ++i)
-                    samples[i] += buffer[i];
-            }
         }
 
         void Node::addOutputNode(Node* node)
@@ -48,6 +37,22 @@ namespace ouzel
             }
         }
 
+        void Node::detach()
+        {
+            for (Node* outputNode : outputNodes)
+                outputNode->removeInputNode(this);
+
+            for (Node* inputNode : inputNodes)
+            {
+                auto i = std::find(inputNode->outputNodes.begin(), inputNode->outputNodes.end(), this);
+                if (i != inputNode->outputNodes.end())
+                    inputNode->outputNodes.erase(i);
+            }
+
+            outputNodes.clear();
+            inputNodes.clear();
+        }
+
         void Node::addInputNode(Node* node)
         {
             auto i = std::find(inputNodes.begin(), inputNodes.end(), node);
@@ -12,8 +12,11 @@ namespace ouzel
 {
     namespace audio
     {
+        class AudioDevice;
+
         class Node
         {
+            friend AudioDevice;
         public:
             Node() {}
             virtual ~Node();
@@ -24,20 +27,20 @@ namespace ouzel
             Node(Node&&) = delete;
             Node& operator=(Node&&) = delete;
 
+            // samples contain the mixed output of the input nodes
             virtual void process(std::vector<float>& samples, uint16_t& channels,
                                  uint32_t& sampleRate, Vector3& position);
 
+        private:
+            // edges are changed only through the audio device commands, which recompile the graph
             void addOutputNode(Node* node);
             void removeOutputNode(Node* node);
-
-        private:
+            void detach();
             void addInputNode(Node* node);
             void removeInputNode(Node* node);
 
             std::vector<Node*> inputNodes;
             std::vector<Node*> outputNodes;
-
-            std::vector<float> buffer;
         };
     } // namespace audio
 } // namespace ouzel
@@ -13,12 +13,6 @@ namespace ouzel
             PitchProcessor()
             {
             }
-
-            void process(std::vector<float>& samples, uint16_t& channels,
-                         uint32_t& sampleRate, Vector3& position) override
-            {
-                Node::process(samples, channels, sampleRate, position);
-            }
         };
 
         Pitch::Pitch(Audio& initAudio):
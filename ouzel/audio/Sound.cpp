@@ -40,7 +40,7 @@ namespace ouzel
             std::unique_ptr<SoundEvent> startEvent(new SoundEvent());
             startEvent->type = Event::Type::SOUND_START;
             startEvent->sound = this;
-            engine->getEventDispatcher().postEvent(std::move(startEvent));
+            engine->getEventDispatcher().postEventDetached(std::move(startEvent));
 
             if (stream)
             {
@@ -71,7 +71,7 @@ namespace ouzel
             std::unique_ptr<SoundEvent> event(new SoundEvent());
             event->type = Event::Type::SOUND_RESET;
             event->sound = this;
-            engine->getEventDispatcher().postEvent(std::move(event));
+            engine->getEventDispatcher().postEventDetached(std::move(event));
         }
 
         // executed on audio thread
@@ -82,7 +82,7 @@ namespace ouzel
             std::unique_ptr<SoundEvent> event(new SoundEvent());
             event->type = Event::Type::SOUND_FINISH;
             event->sound = this;
-            engine->getEventDispatcher().postEvent(std::move(event));
+            engine->getEventDispatcher().postEventDetached(std::move(event));
         }
     } // namespace audio
 } // namespace ouzel
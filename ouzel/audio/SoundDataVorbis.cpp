@@ -16,9 +16,14 @@ namespace ouzel
         }
 
         SoundDataVorbis::SoundDataVorbis(const std::vector<uint8_t>& initData):
+            SoundDataVorbis(FileData(initData))
+        {
+        }
+
+        SoundDataVorbis::SoundDataVorbis(const FileData& initData):
             data(initData)
         {
-            stb_vorbis* vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
+            stb_vorbis* vorbisStream = stb_vorbis_open_memory(data.getData(), static_cast<int>(data.getSize()), nullptr, nullptr);
 
             if (!vorbisStream)
                 throw std::runtime_error("Failed to load Vorbis stream");
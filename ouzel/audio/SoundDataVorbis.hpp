@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <vector>
 #include "audio/SoundData.hpp"
+#include "files/FileData.hpp"
 
 namespace ouzel
 {
@@ -16,13 +17,15 @@ namespace ouzel
         public:
             SoundDataVorbis();
             explicit SoundDataVorbis(const std::vector<uint8_t>& initData);
+            // the data is decoded while playing, so a mapped file stays mapped for the lifetime of the sound data
+            explicit SoundDataVorbis(const FileData& initData);
 
             std::shared_ptr<Stream> createStream() override;
 
         private:
             void readData(Stream* stream, uint32_t frames, std::vector<float>& result) override;
 
-            std::vector<uint8_t> data;
+            FileData data;
         };
     } // namespace audio
 } // namespace ouzel
@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cstring>
 #include <iterator>
 #include <stdexcept>
 #include "SoundDataWave.hpp"
@@ -20,11 +21,16 @@ namespace ouzel
         {
         }
 
-        SoundDataWave::SoundDataWave(const std::vector<uint8_t>& initData)
+        SoundDataWave::SoundDataWave(const std::vector<uint8_t>& initData):
+            SoundDataWave(initData.data(), initData.size())
+        {
+        }
+
+        SoundDataWave::SoundDataWave(const uint8_t* initData, size_t size)
         {
             uint32_t offset = 0;
 
-            if (initData.size() < 12) // RIFF + size + WAVE
+            if (size < 12) // RIFF + size + WAVE
                 throw std::runtime_error("Failed to load sound file, file too small");
 
             if (initData[offset + 0] != 'R' ||
@@ -35,11 +41,11 @@ namespace ouzel
 
             offset += 4;
 
-            uint32_t length = decodeUInt32Little(initData.data() + offset);
+            uint32_t length = decodeUInt32Little(initData + offset);
 
             offset += 4;
 
-            if (initData.size() < offset + length)
+            if (size < offset + length)
                 throw std::runtime_error("Failed to load sound file, size mismatch");
 
             if (length < 4 ||
@@ -56,11 +62,12 @@ namespace ouzel
 
             uint16_t bitsPerSample = 0;
             uint16_t formatTag = 0;
-            std::vector<uint8_t> soundData;
+            const uint8_t* soundData = nullptr;
+            uint32_t soundDataSize = 0;
 
-            while (offset < initData.size())
+            while (offset < size)
             {
-                if (initData.size() < offset + 8)
+                if (size < offset + 8)
                     throw std::runtime_error("Failed to load sound file, not enough data to read chunk");
 
                 uint8_t chunkHeader[4];
@@ -71,10 +78,10 @@ namespace ouzel
 
                 offset += 4;
 
-                uint32_t chunkSize = decodeUInt32Little(initData.data() + offset);
+                uint32_t chunkSize = decodeUInt32Little(initData + offset);
                 offset += 4;
 
-                if (initData.size() < offset + chunkSize)
+                if (size < offset + chunkSize)
                     throw std::runtime_error("Failed to load sound file, not enough data to read chunk");
 
                 if (chunkHeader[0] == 'f' && chunkHeader[1] == 'm' && chunkHeader[2] == 't' && chunkHeader[3] == ' ')
@@ -84,27 +91,28 @@ namespace ouzel
 
                     uint32_t i = offset;
 
-                    formatTag = decodeUInt16Little(initData.data() + i);
+                    formatTag = decodeUInt16Little(initData + i);
                     i += 2;
 
-                    channels = decodeUInt16Little(initData.data() + i);
+                    channels = decodeUInt16Little(initData + i);
                     i += 2;
 
-                    sampleRate = decodeUInt32Little(initData.data() + i);
+                    sampleRate = decodeUInt32Little(initData + i);
                     i += 4;
 
                     i += 4; // average bytes per second
 
                     i += 2; // block align
 
-                    bitsPerSample = decodeUInt16Little(initData.data() + i);
+                    bitsPerSample = decodeUInt16Little(initData + i);
                     i += 2;
 
                     formatChunkFound = true;
                 }
                 else if (chunkHeader[0] == 'd' && chunkHeader[1] == 'a' && chunkHeader[2] == 't' && chunkHeader[3] == 'a')
                 {
-                    soundData.assign(initData.begin() + static_cast<int>(offset), initData.begin() + static_cast<int>(offset + chunkSize));
+                    soundData = initData + offset;
+                    soundDataSize = chunkSize;
 
                     dataChunkFound = true;
                 }
@@ -123,7 +131,7 @@ namespace ouzel
                 throw std::runtime_error("Failed to load sound file, unsupported bit depth");
 
             uint32_t bytesPerSample = bitsPerSample / 8;
-            uint32_t samples = static_cast<uint32_t>(soundData.size() / bytesPerSample);
+            uint32_t samples = static_cast<uint32_t>(soundDataSize / bytesPerSample);
             data.resize(samples);
 
             if (formatTag == PCM)
@@ -153,8 +161,8 @@ namespace ouzel
             {
                 if (bitsPerSample == 32)
                 {
-                    for (uint32_t i = 0; i < samples; ++i)
-                        data[i] = reinterpret_cast<float*>(soundData.data())[i];
+                    // the data chunk in a mapped file is not guaranteed to be aligned
+                    std::memcpy(data.data(), soundData, samples * sizeof(float));
                 }
                 else
                     throw std::runtime_error("Failed to load sound file, unsupported bit depth");
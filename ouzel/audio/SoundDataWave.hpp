@@ -16,6 +16,7 @@ namespace ouzel
         public:
             SoundDataWave();
             explicit SoundDataWave(const std::vector<uint8_t>& initData);
+            SoundDataWave(const uint8_t* initData, size_t size);
 
             std::shared_ptr<Stream> createStream() override;
 
@@ -9,9 +9,9 @@ namespace ouzel
 {
     namespace audio
     {
-        StreamVorbis::StreamVorbis(const std::vector<uint8_t>& data)
+        StreamVorbis::StreamVorbis(const FileData& data)
         {
-            vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
+            vorbisStream = stb_vorbis_open_memory(data.getData(), static_cast<int>(data.getSize()), nullptr, nullptr);
         }
 
         StreamVorbis::~StreamVorbis()
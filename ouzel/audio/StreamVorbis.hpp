@@ -4,8 +4,8 @@
 #define OUZEL_AUDIO_STREAMVORBIS_HPP
 
 #include <cstdint>
-#include <vector>
 #include "Stream.hpp"
+#include "files/FileData.hpp"
 
 struct stb_vorbis;
 
@@ -16,7 +16,7 @@ namespace ouzel
         class StreamVorbis final: public Stream
         {
         public:
-            explicit StreamVorbis(const std::vector<uint8_t>& data);
+            explicit StreamVorbis(const FileData& data);
             ~StreamVorbis();
             void reset() override;
 
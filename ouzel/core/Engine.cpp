@@ -20,6 +20,7 @@
 #    include "opengl/ColorVSGLES3.h"
 #    include "opengl/TexturePSGLES3.h"
 #    include "opengl/TextureVSGLES3.h"
+#    include "opengl/TextureInstancedVSGLES3.h"
 #  else
 #    include "opengl/ColorPSGL2.h"
 #    include "opengl/ColorVSGL2.h"
@@ -29,10 +30,12 @@
 #    include "opengl/ColorVSGL3.h"
 #    include "opengl/TexturePSGL3.h"
 #    include "opengl/TextureVSGL3.h"
+#    include "opengl/TextureInstancedVSGL3.h"
 #    include "opengl/ColorPSGL4.h"
 #    include "opengl/ColorVSGL4.h"
 #    include "opengl/TexturePSGL4.h"
 #    include "opengl/TextureVSGL4.h"
+#    include "opengl/TextureInstancedVSGL4.h"
 #  endif
 #endif
 
@@ -97,7 +100,7 @@ namespace ouzel
         {
             std::unique_ptr<SystemEvent> event(new SystemEvent());
             event->type = Event::Type::ENGINE_STOP;
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
         }
 
         paused = true;
@@ -130,6 +133,8 @@ namespace ouzel
         bool verticalSync = true;
         bool depth = false;
         bool debugRenderer = false;
+        uint32_t framesInFlight = 2; // frames recorded ahead of the render device
+        std::string captureFile; // command buffers of all frames are written to this trace file
         bool exclusiveFullscreen = false;
         bool highDpi = true; // should high DPI resolution be used
         audio::Driver audioDriver = audio::Driver::DEFAULT;
@@ -212,6 +217,11 @@ namespace ouzel
         std::string debugRendererValue = userEngineSection.getValue("debugRenderer", defaultEngineSection.getValue("debugRenderer"));
         if (!debugRendererValue.empty()) debugRenderer = (debugRendererValue == "true" || debugRendererValue == "1" || debugRendererValue == "yes");
 
+        std::string framesInFlightValue = userEngineSection.getValue("framesInFlight", defaultEngineSection.getValue("framesInFlight"));
+        if (!framesInFlightValue.empty()) framesInFlight = static_cast<uint32_t>(std::stoul(framesInFlightValue));
+
+        captureFile = userEngineSection.getValue("captureFile", defaultEngineSection.getValue("captureFile"));
+
         std::string highDpiValue = userEngineSection.getValue("highDpi", defaultEngineSection.getValue("highDpi"));
         if (!highDpiValue.empty()) highDpi = (highDpiValue == "true" || highDpiValue == "1" || highDpiValue == "yes");
 
@@ -275,6 +285,11 @@ namespace ouzel
                                               depth,
                                               debugRenderer));
 
+        renderer->getDevice()->setMaxFramesInFlight(framesInFlight);
+
+        // started before the default assets are created, so that the trace contains all resources
+        if (!captureFile.empty()) renderer->startCapture(captureFile);
+
         if (audioDriver == audio::Driver::DEFAULT)
         {
             auto availableDrivers = audio::Audio::getAvailableAudioDrivers();
@@ -300,107 +315,61 @@ namespace ouzel
         inputManager.reset(new input::InputManager());
 
         // default assets
+        std::vector<uint8_t> textureFragmentShader;
+        std::vector<uint8_t> textureVertexShader;
+        std::vector<uint8_t> instancedTextureVertexShader;
+        std::vector<uint8_t> colorFragmentShader;
+        std::vector<uint8_t> colorVertexShader;
+        uint32_t shaderDataAlignment = 0;
+        std::string fragmentShaderFunction;
+        std::string vertexShaderFunction;
+
         switch (graphicsDriver)
         {
 #if OUZEL_COMPILE_OPENGL
             case graphics::Driver::OPENGL:
             {
-                std::shared_ptr<graphics::Shader> textureShader = std::make_shared<graphics::Shader>(*renderer);
-
-                switch (renderer->getDevice()->getAPIMajorVersion())
-                {
-#  if OUZEL_SUPPORTS_OPENGLES
-                    case 2:
-                        textureShader->init(std::vector<uint8_t>(std::begin(TexturePSGLES2_glsl), std::end(TexturePSGLES2_glsl)),
-                                            std::vector<uint8_t>(std::begin(TextureVSGLES2_glsl), std::end(TextureVSGLES2_glsl)),
-                                            {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                            {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                            {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-                        break;
-                    case 3:
-                        textureShader->init(std::vector<uint8_t>(std::begin(TexturePSGLES3_glsl), std::end(TexturePSGLES3_glsl)),
-                                            std::vector<uint8_t>(std::begin(TextureVSGLES3_glsl), std::end(TextureVSGLES3_glsl)),
-                                            {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                            {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                            {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-                        break;
-#  else
-                    case 2:
-                        textureShader->init(std::vector<uint8_t>(std::begin(TexturePSGL2_glsl), std::end(TexturePSGL2_glsl)),
-                                            std::vector<uint8_t>(std::begin(TextureVSGL2_glsl), std::end(TextureVSGL2_glsl)),
-                                            {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                            {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                            {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-                        break;
-                    case 3:
-                        textureShader->init(std::vector<uint8_t>(std::begin(TexturePSGL3_glsl), std::end(TexturePSGL3_glsl)),
-                                            std::vector<uint8_t>(std::begin(TextureVSGL3_glsl), std::end(TextureVSGL3_glsl)),
-                                            {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                            {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                            {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-                        break;
-                    case 4:
-                        textureShader->init(std::vector<uint8_t>(std::begin(TexturePSGL4_glsl), std::end(TexturePSGL4_glsl)),
-                                            std::vector<uint8_t>(std::begin(TextureVSGL4_glsl), std::end(TextureVSGL4_glsl)),
-                                            {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                            {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                            {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-                        break;
-#  endif
-                    default:
-                        throw std::runtime_error("Unsupported OpenGL version");
-                }
-
-                assetBundle.setShader(SHADER_TEXTURE, textureShader);
-
-                std::shared_ptr<graphics::Shader> colorShader = std::make_shared<graphics::Shader>(*renderer);
-
                 switch (renderer->getDevice()->getAPIMajorVersion())
                 {
 #  if OUZEL_SUPPORTS_OPENGLES
                     case 2:
-                        colorShader->init(std::vector<uint8_t>(std::begin(ColorPSGLES2_glsl), std::end(ColorPSGLES2_glsl)),
-                                          std::vector<uint8_t>(std::begin(ColorVSGLES2_glsl), std::end(ColorVSGLES2_glsl)),
-                                          {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-
+                        textureFragmentShader.assign(std::begin(TexturePSGLES2_glsl), std::end(TexturePSGLES2_glsl));
+                        textureVertexShader.assign(std::begin(TextureVSGLES2_glsl), std::end(TextureVSGLES2_glsl));
+                        colorFragmentShader.assign(std::begin(ColorPSGLES2_glsl), std::end(ColorPSGLES2_glsl));
+                        colorVertexShader.assign(std::begin(ColorVSGLES2_glsl), std::end(ColorVSGLES2_glsl));
                         break;
                     case 3:
-                        colorShader->init(std::vector<uint8_t>(std::begin(ColorPSGLES3_glsl), std::end(ColorPSGLES3_glsl)),
-                                          std::vector<uint8_t>(std::begin(ColorVSGLES3_glsl), std::end(ColorVSGLES3_glsl)),
-                                          {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        textureFragmentShader.assign(std::begin(TexturePSGLES3_glsl), std::end(TexturePSGLES3_glsl));
+                        textureVertexShader.assign(std::begin(TextureVSGLES3_glsl), std::end(TextureVSGLES3_glsl));
+                        instancedTextureVertexShader.assign(std::begin(TextureInstancedVSGLES3_glsl), std::end(TextureInstancedVSGLES3_glsl));
+                        colorFragmentShader.assign(std::begin(ColorPSGLES3_glsl), std::end(ColorPSGLES3_glsl));
+                        colorVertexShader.assign(std::begin(ColorVSGLES3_glsl), std::end(ColorVSGLES3_glsl));
                         break;
 #  else
                     case 2:
-                        colorShader->init(std::vector<uint8_t>(std::begin(ColorPSGL2_glsl), std::end(ColorPSGL2_glsl)),
-                                          std::vector<uint8_t>(std::begin(ColorVSGL2_glsl), std::end(ColorVSGL2_glsl)),
-                                          {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        textureFragmentShader.assign(std::begin(TexturePSGL2_glsl), std::end(TexturePSGL2_glsl));
+                        textureVertexShader.assign(std::begin(TextureVSGL2_glsl), std::end(TextureVSGL2_glsl));
+                        colorFragmentShader.assign(std::begin(ColorPSGL2_glsl), std::end(ColorPSGL2_glsl));
+                        colorVertexShader.assign(std::begin(ColorVSGL2_glsl), std::end(ColorVSGL2_glsl));
                         break;
                     case 3:
-                        colorShader->init(std::vector<uint8_t>(std::begin(ColorPSGL3_glsl), std::end(ColorPSGL3_glsl)),
-                                          std::vector<uint8_t>(std::begin(ColorVSGL3_glsl), std::end(ColorVSGL3_glsl)),
-                                          {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        textureFragmentShader.assign(std::begin(TexturePSGL3_glsl), std::end(TexturePSGL3_glsl));
+                        textureVertexShader.assign(std::begin(TextureVSGL3_glsl), std::end(TextureVSGL3_glsl));
+                        instancedTextureVertexShader.assign(std::begin(TextureInstancedVSGL3_glsl), std::end(TextureInstancedVSGL3_glsl));
+                        colorFragmentShader.assign(std::begin(ColorPSGL3_glsl), std::end(ColorPSGL3_glsl));
+                        colorVertexShader.assign(std::begin(ColorVSGL3_glsl), std::end(ColorVSGL3_glsl));
                         break;
                     case 4:
-                        colorShader->init(std::vector<uint8_t>(std::begin(ColorPSGL4_glsl), std::end(ColorPSGL4_glsl)),
-                                          std::vector<uint8_t>(std::begin(ColorVSGL4_glsl), std::end(ColorVSGL4_glsl)),
-                                          {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        textureFragmentShader.assign(std::begin(TexturePSGL4_glsl), std::end(TexturePSGL4_glsl));
+                        textureVertexShader.assign(std::begin(TextureVSGL4_glsl), std::end(TextureVSGL4_glsl));
+                        instancedTextureVertexShader.assign(std::begin(TextureInstancedVSGL4_glsl), std::end(TextureInstancedVSGL4_glsl));
+                        colorFragmentShader.assign(std::begin(ColorPSGL4_glsl), std::end(ColorPSGL4_glsl));
+                        colorVertexShader.assign(std::begin(ColorVSGL4_glsl), std::end(ColorVSGL4_glsl));
                         break;
 #  endif
                     default:
                         throw std::runtime_error("Unsupported OpenGL version");
                 }
-
-                assetBundle.setShader(SHADER_COLOR, colorShader);
                 break;
             }
 #endif
@@ -408,23 +377,10 @@ namespace ouzel
 #if OUZEL_COMPILE_DIRECT3D11
             case graphics::Driver::DIRECT3D11:
             {
-                std::shared_ptr<graphics::Shader> textureShader = std::make_shared<graphics::Shader>(*renderer);
-                textureShader->init(std::vector<uint8_t>(std::begin(TEXTURE_PIXEL_SHADER_D3D11), std::end(TEXTURE_PIXEL_SHADER_D3D11)),
-                                    std::vector<uint8_t>(std::begin(TEXTURE_VERTEX_SHADER_D3D11), std::end(TEXTURE_VERTEX_SHADER_D3D11)),
-                                    {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                    {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                    {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-
-                assetBundle.setShader(SHADER_TEXTURE, textureShader);
-
-                std::shared_ptr<graphics::Shader> colorShader = std::make_shared<graphics::Shader>(*renderer);
-                colorShader->init(std::vector<uint8_t>(std::begin(COLOR_PIXEL_SHADER_D3D11), std::end(COLOR_PIXEL_SHADER_D3D11)),
-                                  std::vector<uint8_t>(std::begin(COLOR_VERTEX_SHADER_D3D11), std::end(COLOR_VERTEX_SHADER_D3D11)),
-                                  {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                  {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                  {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
-
-                assetBundle.setShader(SHADER_COLOR, colorShader);
+                textureFragmentShader.assign(std::begin(TEXTURE_PIXEL_SHADER_D3D11), std::end(TEXTURE_PIXEL_SHADER_D3D11));
+                textureVertexShader.assign(std::begin(TEXTURE_VERTEX_SHADER_D3D11), std::end(TEXTURE_VERTEX_SHADER_D3D11));
+                colorFragmentShader.assign(std::begin(COLOR_PIXEL_SHADER_D3D11), std::end(COLOR_PIXEL_SHADER_D3D11));
+                colorVertexShader.assign(std::begin(COLOR_VERTEX_SHADER_D3D11), std::end(COLOR_VERTEX_SHADER_D3D11));
                 break;
             }
 #endif
@@ -432,55 +388,70 @@ namespace ouzel
 #if OUZEL_COMPILE_METAL
             case graphics::Driver::METAL:
             {
-                std::shared_ptr<graphics::Shader> textureShader = std::make_shared<graphics::Shader>(*renderer);
-                textureShader->init(std::vector<uint8_t>(std::begin(TEXTURE_PIXEL_SHADER_METAL), std::end(TEXTURE_PIXEL_SHADER_METAL)),
-                                    std::vector<uint8_t>(std::begin(TEXTURE_VERTEX_SHADER_METAL), std::end(TEXTURE_VERTEX_SHADER_METAL)),
-                                    {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                    {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                    {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}},
-                                    256, 256,
-                                    "mainPS", "mainVS");
-
-                assetBundle.setShader(SHADER_TEXTURE, textureShader);
-
-                std::shared_ptr<graphics::Shader> colorShader = std::make_shared<graphics::Shader>(*renderer);
-                colorShader->init(std::vector<uint8_t>(std::begin(COLOR_PIXEL_SHADER_METAL), std::end(COLOR_PIXEL_SHADER_METAL)),
-                                  std::vector<uint8_t>(std::begin(COLOR_VERTEX_SHADER_METAL), std::end(COLOR_VERTEX_SHADER_METAL)),
-                                  {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                  {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                  {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}},
-                                  256, 256,
-                                  "mainPS", "mainVS");
-
-                assetBundle.setShader(SHADER_COLOR, colorShader);
+                textureFragmentShader.assign(std::begin(TEXTURE_PIXEL_SHADER_METAL), std::end(TEXTURE_PIXEL_SHADER_METAL));
+                textureVertexShader.assign(std::begin(TEXTURE_VERTEX_SHADER_METAL), std::end(TEXTURE_VERTEX_SHADER_METAL));
+                colorFragmentShader.assign(std::begin(COLOR_PIXEL_SHADER_METAL), std::end(COLOR_PIXEL_SHADER_METAL));
+                colorVertexShader.assign(std::begin(COLOR_VERTEX_SHADER_METAL), std::end(COLOR_VERTEX_SHADER_METAL));
+                shaderDataAlignment = 256;
+                fragmentShaderFunction = "mainPS";
+                vertexShaderFunction = "mainVS";
                 break;
             }
 #endif
 
             default:
-            {
-                std::shared_ptr<graphics::Shader> textureShader = std::make_shared<graphics::Shader>(*renderer);
+                break;
+        }
 
-                textureShader->init(std::vector<uint8_t>(),
-                                    std::vector<uint8_t>(),
-                                    {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0},
-                                    {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                    {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+        // the compact layouts are fed to the same texture shader, the GPU fills in the missing position components
+        const std::vector<std::pair<std::string, graphics::VertexLayout>> textureShaderLayouts = {
+            {SHADER_TEXTURE, graphics::VertexLayout({graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR, graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0})},
+            {SHADER_SPRITE, graphics::VertexLayout::SPRITE},
+            {SHADER_PARTICLE, graphics::VertexLayout::PARTICLE},
+            {SHADER_TEXT, graphics::VertexLayout::TEXT},
+            {SHADER_STATIC_MESH, graphics::VertexLayout::STATIC_MESH}
+        };
 
-                assetBundle.setShader(SHADER_TEXTURE, textureShader);
+        for (const std::pair<std::string, graphics::VertexLayout>& textureShaderLayout : textureShaderLayouts)
+        {
+            std::shared_ptr<graphics::Shader> textureShader = std::make_shared<graphics::Shader>(*renderer);
+            textureShader->init(textureFragmentShader,
+                                textureVertexShader,
+                                textureShaderLayout.second,
+                                {{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}},
+                                shaderDataAlignment, shaderDataAlignment,
+                                fragmentShaderFunction, vertexShaderFunction);
+
+            assetBundle.setShader(textureShaderLayout.first, textureShader);
+        }
 
-                std::shared_ptr<graphics::Shader> colorShader = std::make_shared<graphics::Shader>(*renderer);
+        // the instanced shader reads the transform and the color of every instance from the instance buffer,
+        // only the OpenGL 3+ drivers have its vertex shader, the static meshes are drawn one by one on the others
+        if (!instancedTextureVertexShader.empty() && renderer->getDevice()->isInstancingSupported())
+        {
+            std::shared_ptr<graphics::Shader> instancedMeshShader = std::make_shared<graphics::Shader>(*renderer);
+            instancedMeshShader->init(textureFragmentShader,
+                                      instancedTextureVertexShader,
+                                      graphics::VertexLayout::INSTANCED_MESH,
+                                      {{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                      {},
+                                      shaderDataAlignment, shaderDataAlignment,
+                                      fragmentShaderFunction, vertexShaderFunction);
+
+            assetBundle.setShader(SHADER_INSTANCED_MESH, instancedMeshShader);
+        }
 
-                colorShader->init(std::vector<uint8_t>(),
-                                  std::vector<uint8_t>(),
-                                  {graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR},
-                                  {{"color", graphics::DataType::FLOAT_VECTOR4}},
-                                  {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+        std::shared_ptr<graphics::Shader> colorShader = std::make_shared<graphics::Shader>(*renderer);
+        colorShader->init(colorFragmentShader,
+                          colorVertexShader,
+                          graphics::VertexLayout({graphics::Vertex::Attribute::Usage::POSITION, graphics::Vertex::Attribute::Usage::COLOR}),
+                          {{"color", graphics::DataType::FLOAT_VECTOR4}},
+                          {{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}},
+                          shaderDataAlignment, shaderDataAlignment,
+                          fragmentShaderFunction, vertexShaderFunction);
 
-                assetBundle.setShader(SHADER_COLOR, colorShader);
-                break;
-            }
-        }
+        assetBundle.setShader(SHADER_COLOR, colorShader);
 
         std::shared_ptr<graphics::BlendState> noBlendState = std::make_shared<graphics::BlendState>(*renderer);
 
@@ -543,7 +514,7 @@ namespace ouzel
         {
             std::unique_ptr<SystemEvent> event(new SystemEvent());
             event->type = Event::Type::ENGINE_START;
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
 
             active = true;
             paused = false;
@@ -562,7 +533,7 @@ namespace ouzel
         {
             std::unique_ptr<SystemEvent> event(new SystemEvent());
             event->type = Event::Type::ENGINE_PAUSE;
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
 
             paused = true;
         }
@@ -574,7 +545,7 @@ namespace ouzel
         {
             std::unique_ptr<SystemEvent> event(new SystemEvent());
             event->type = Event::Type::ENGINE_RESUME;
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
 
             paused = false;
 
@@ -592,7 +563,7 @@ namespace ouzel
         {
             std::unique_ptr<SystemEvent> event(new SystemEvent());
             event->type = Event::Type::ENGINE_STOP;
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
 
             active = false;
         }
@@ -611,7 +582,10 @@ namespace ouzel
 
     void Engine::update()
     {
+        renderer->beginFrame();
+
         eventDispatcher.dispatchEvents();
+        cache.update();
 
         std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
         auto diff = currentTime - previousUpdateTime;
@@ -33,6 +33,11 @@ namespace ouzel
 
     const std::string SHADER_TEXTURE = "shaderTexture";
     const std::string SHADER_COLOR = "shaderColor";
+    const std::string SHADER_SPRITE = "shaderSprite";
+    const std::string SHADER_PARTICLE = "shaderParticle";
+    const std::string SHADER_TEXT = "shaderText";
+    const std::string SHADER_STATIC_MESH = "shaderStaticMesh";
+    const std::string SHADER_INSTANCED_MESH = "shaderInstancedMesh";
 
     const std::string BLEND_NO_BLEND = "blendNoBlend";
     const std::string BLEND_ADD = "blendAdd";
@@ -58,7 +63,8 @@ namespace ouzel
 
         inline const std::vector<std::string>& getArgs() const { return args; }
 
-        inline Log log(Log::Level level = Log::Level::INFO) const { return Log(level, logThreshold); }
+        inline Log log(Log::Level level = Log::Level::INFO) const { return Log(level, logThreshold, &logger); }
+        inline Logger& getLogger() { return logger; }
         inline Log::Level getLogThreshold() { return logThreshold; }
         inline void setLogThreshold(Log::Level newThreshold) { logThreshold = newThreshold; }
 
@@ -99,6 +105,7 @@ namespace ouzel
     protected:
         virtual void main();
 
+        mutable Logger logger; // destroyed last, so that the other members can log until the end
         std::atomic<Log::Level> logThreshold;
         FileSystem fileSystem;
         EventDispatcher eventDispatcher;
@@ -199,7 +199,7 @@ namespace ouzel
                     break;
             }
 
-            eventDispatcher.postEvent(std::move(event));
+            eventDispatcher.postEventDetached(std::move(event));
         }
     }
 
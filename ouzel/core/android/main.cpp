@@ -79,7 +79,7 @@ extern "C" JNIEXPORT void JNICALL Java_org_ouzel_OuzelLibJNIWrapper_onLowMemory(
 {
     std::unique_ptr<ouzel::SystemEvent> event(new ouzel::SystemEvent());
     event->type = ouzel::Event::Type::LOW_MEMORY;
-    engine->getEventDispatcher().postEvent(std::move(event));
+    engine->getEventDispatcher().postEventDetached(std::move(event));
 }
 
 static const std::unordered_map<jint, ouzel::input::Keyboard::Key> keyMap = {
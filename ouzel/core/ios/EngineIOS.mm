@@ -59,7 +59,7 @@
         std::unique_ptr<ouzel::SystemEvent> event(new ouzel::SystemEvent());
         event->type = ouzel::Event::Type::LOW_MEMORY;
 
-        ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+        ouzel::engine->getEventDispatcher().postEventDetached(std::move(event));
     }
 }
 
@@ -96,7 +96,7 @@
             break;
     }
 
-    ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+    ouzel::engine->getEventDispatcher().postEventDetached(std::move(event));
 }
 
 @end
@@ -38,7 +38,7 @@
         std::unique_ptr<ouzel::SystemEvent> event(new ouzel::SystemEvent());
         event->type = ouzel::Event::Type::OPEN_FILE;
         event->filename = [filename cStringUsingEncoding:NSUTF8StringEncoding];
-        ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+        ouzel::engine->getEventDispatcher().postEventDetached(std::move(event));
     }
 
     return YES;
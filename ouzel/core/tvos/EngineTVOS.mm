@@ -54,7 +54,7 @@
         std::unique_ptr<ouzel::SystemEvent> event(new ouzel::SystemEvent());
         event->type = ouzel::Event::Type::LOW_MEMORY;
 
-        ouzel::engine->getEventDispatcher().postEvent(std::move(event));
+        ouzel::engine->getEventDispatcher().postEventDetached(std::move(event));
     }
 }
 
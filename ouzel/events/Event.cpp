@@ -0,0 +1,91 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <mutex>
+#include <new>
+#include "Event.hpp"
+
+namespace ouzel
+{
+    // blocks are grouped by size in steps of BLOCK_ALIGNMENT bytes
+    static const size_t BLOCK_ALIGNMENT = 32;
+    static const size_t BLOCK_CLASS_COUNT = 8;
+    // blocks kept for reuse per size class, the rest are freed
+    static const size_t MAX_FREE_BLOCKS = 256;
+
+    struct FreeBlock final
+    {
+        FreeBlock* next;
+    };
+
+    class EventPool final
+    {
+    public:
+        void* allocate(size_t blockClass)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (FreeBlock* freeBlock = freeBlocks[blockClass])
+            {
+                freeBlocks[blockClass] = freeBlock->next;
+                --freeBlockCounts[blockClass];
+                return freeBlock;
+            }
+
+            lock.unlock();
+
+            return ::operator new((blockClass + 1) * BLOCK_ALIGNMENT);
+        }
+
+        void deallocate(void* pointer, size_t blockClass)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (freeBlockCounts[blockClass] < MAX_FREE_BLOCKS)
+            {
+                FreeBlock* freeBlock = static_cast<FreeBlock*>(pointer);
+                freeBlock->next = freeBlocks[blockClass];
+                freeBlocks[blockClass] = freeBlock;
+                ++freeBlockCounts[blockClass];
+            }
+            else
+            {
+                lock.unlock();
+                ::operator delete(pointer);
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        FreeBlock* freeBlocks[BLOCK_CLASS_COUNT] = {};
+        size_t freeBlockCounts[BLOCK_CLASS_COUNT] = {};
+    };
+
+    static EventPool& getEventPool()
+    {
+        // never destroyed, because events can outlive the static objects
+        static EventPool* eventPool = new EventPool();
+        return *eventPool;
+    }
+
+    void* Event::operator new(size_t size)
+    {
+        size_t blockClass = (size - 1) / BLOCK_ALIGNMENT;
+
+        if (blockClass < BLOCK_CLASS_COUNT)
+            return getEventPool().allocate(blockClass);
+        else
+            return ::operator new(size);
+    }
+
+    void Event::operator delete(void* pointer, size_t size)
+    {
+        if (!pointer) return;
+
+        size_t blockClass = (size - 1) / BLOCK_ALIGNMENT;
+
+        if (blockClass < BLOCK_CLASS_COUNT)
+            getEventPool().deallocate(pointer, blockClass);
+        else
+            ::operator delete(pointer);
+    }
+}
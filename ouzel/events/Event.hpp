@@ -3,6 +3,7 @@
 #ifndef OUZEL_EVENTS_EVENT_HPP
 #define OUZEL_EVENTS_EVENT_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -19,6 +20,12 @@ namespace ouzel
 {
     struct Event
     {
+        virtual ~Event() {}
+
+        // events are allocated from a pool, because they are created and destroyed every frame
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer, size_t size);
+
         enum class Type
         {
             // gamepad events
@@ -8,63 +8,95 @@
 
 namespace ouzel
 {
+    template<class T>
+    static bool dispatch(const std::vector<EventHandler*>& eventHandlers,
+                         EventHandler::Function<T> EventHandler::*handler,
+                         const T& event)
+    {
+        // handlers can be removed during the dispatch, but the list doesn't change its size until the next update
+        for (size_t i = 0; i < eventHandlers.size(); ++i)
+            if (const EventHandler* eventHandler = eventHandlers[i])
+                if ((eventHandler->*handler) && (eventHandler->*handler)(event)) return true;
+
+        return false;
+    }
+
     EventDispatcher::EventDispatcher()
     {
     }
 
     EventDispatcher::~EventDispatcher()
     {
-        for (EventHandler* eventHandler : eventHandlerAddSet)
+        for (EventHandler* eventHandler : addedEventHandlers)
             eventHandler->eventDispatcher = nullptr;
 
-        for (EventHandler* eventHandler : eventHandlers)
+        for (const std::vector<EventHandler*>& categoryEventHandlers : eventHandlers)
         {
-            auto i = std::find(eventHandlerDeleteSet.begin(), eventHandlerDeleteSet.end(), eventHandler);
-            if (i == eventHandlerDeleteSet.end()) eventHandler->eventDispatcher = nullptr;
+            for (EventHandler* eventHandler : categoryEventHandlers)
+            {
+                if (eventHandler)
+                {
+                    eventHandler->eventDispatcher = nullptr;
+                    for (uint32_t& position : eventHandler->positions) position = EventHandler::NO_POSITION;
+                }
+            }
         }
     }
 
-    void EventDispatcher::dispatchEvents()
+    void EventDispatcher::updateEventHandlers()
     {
-        for (EventHandler* eventHandler : eventHandlerDeleteSet)
-        {
-            auto i = std::find(eventHandlers.begin(), eventHandlers.end(), eventHandler);
-
-            if (i != eventHandlers.end())
-                eventHandlers.erase(i);
-        }
-
-        eventHandlerDeleteSet.clear();
+        if (!eventHandlersRemoved && addedEventHandlers.empty()) return;
 
-        for (EventHandler* eventHandler : eventHandlerAddSet)
+        for (uint32_t category = 0; category < EventHandler::CATEGORY_COUNT; ++category)
         {
-            auto i = std::find(eventHandlers.begin(), eventHandlers.end(), eventHandler);
+            std::vector<EventHandler*>& categoryEventHandlers = eventHandlers[category];
 
-            if (i == eventHandlers.end())
+            if (eventHandlersRemoved)
+                categoryEventHandlers.erase(std::remove(categoryEventHandlers.begin(), categoryEventHandlers.end(), nullptr),
+                                            categoryEventHandlers.end());
+
+            for (EventHandler* eventHandler : addedEventHandlers)
             {
-                auto upperBound = std::upper_bound(eventHandlers.begin(), eventHandlers.end(), eventHandler,
-                                                   [](const EventHandler* a, const EventHandler* b) {
-                                                       return a->priority > b->priority;
-                                                   });
+                // handlers added again after setting a function are only missing from some of the lists
+                if (eventHandler->positions[category] == EventHandler::NO_POSITION &&
+                    eventHandler->hasHandler(static_cast<EventHandler::Category>(category)))
+                {
+                    auto upperBound = std::upper_bound(categoryEventHandlers.begin(), categoryEventHandlers.end(), eventHandler,
+                                                       [](const EventHandler* a, const EventHandler* b) {
+                                                           return a->priority > b->priority;
+                                                       });
 
-                eventHandlers.insert(upperBound, eventHandler);
+                    categoryEventHandlers.insert(upperBound, eventHandler);
+                }
             }
+
+            for (uint32_t position = 0; position < categoryEventHandlers.size(); ++position)
+                categoryEventHandlers[position]->positions[category] = position;
         }
 
-        eventHandlerAddSet.clear();
+        addedEventHandlers.clear();
+        eventHandlersRemoved = false;
+    }
 
-        std::pair<std::promise<bool>, std::unique_ptr<Event>> event;
+    void EventDispatcher::dispatchEvents()
+    {
+        updateEventHandlers();
 
+        // events posted by the handlers are dispatched in the same call, until the queue is empty
         for (;;)
         {
             std::unique_lock<std::mutex> lock(eventQueueMutex);
             if (eventQueue.empty()) break;
-
-            event = std::move(eventQueue.front());
-            eventQueue.pop();
+            dispatchQueue.swap(eventQueue);
             lock.unlock();
 
-            event.first.set_value(dispatchEvent(std::move(event.second)));
+            for (QueuedEvent& queuedEvent : dispatchQueue)
+            {
+                bool handled = dispatchEvent(std::move(queuedEvent.event));
+                if (queuedEvent.promise) queuedEvent.promise->set_value(handled);
+            }
+
+            dispatchQueue.clear();
         }
     }
 
@@ -72,105 +104,80 @@ namespace ouzel
     {
         if (!event) return false;
 
-        bool handled = false;
-
-        for (const EventHandler* eventHandler : eventHandlers)
+        switch (event->type)
         {
-            auto i = std::find(eventHandlerDeleteSet.begin(), eventHandlerDeleteSet.end(), eventHandler);
-
-            if (i == eventHandlerDeleteSet.end())
-            {
-                switch (event->type)
-                {
-                    case Event::Type::KEYBOARD_CONNECT:
-                    case Event::Type::KEYBOARD_DISCONNECT:
-                    case Event::Type::KEY_PRESS:
-                    case Event::Type::KEY_RELEASE:
-                        if (eventHandler->keyboardHandler)
-                            handled = eventHandler->keyboardHandler(*static_cast<KeyboardEvent*>(event.get()));
-                        break;
-                    case Event::Type::MOUSE_CONNECT:
-                    case Event::Type::MOUSE_DISCONNECT:
-                    case Event::Type::MOUSE_PRESS:
-                    case Event::Type::MOUSE_RELEASE:
-                    case Event::Type::MOUSE_SCROLL:
-                    case Event::Type::MOUSE_MOVE:
-                    case Event::Type::MOUSE_CURSOR_LOCK_CHANGE:
-                        if (eventHandler->mouseHandler)
-                            handled = eventHandler->mouseHandler(*static_cast<MouseEvent*>(event.get()));
-                        break;
-                    case Event::Type::TOUCHPAD_CONNECT:
-                    case Event::Type::TOUCHPAD_DISCONNECT:
-                    case Event::Type::TOUCH_BEGIN:
-                    case Event::Type::TOUCH_MOVE:
-                    case Event::Type::TOUCH_END:
-                    case Event::Type::TOUCH_CANCEL:
-                        if (eventHandler->touchHandler)
-                            handled = eventHandler->touchHandler(*static_cast<TouchEvent*>(event.get()));
-                        break;
-                    case Event::Type::GAMEPAD_CONNECT:
-                    case Event::Type::GAMEPAD_DISCONNECT:
-                    case Event::Type::GAMEPAD_BUTTON_CHANGE:
-                        if (eventHandler->gamepadHandler)
-                            handled = eventHandler->gamepadHandler(*static_cast<GamepadEvent*>(event.get()));
-                        break;
-                    case Event::Type::WINDOW_SIZE_CHANGE:
-                    case Event::Type::WINDOW_TITLE_CHANGE:
-                    case Event::Type::FULLSCREEN_CHANGE:
-                    case Event::Type::SCREEN_CHANGE:
-                    case Event::Type::RESOLUTION_CHANGE:
-                        if (eventHandler->windowHandler)
-                            handled = eventHandler->windowHandler(*static_cast<WindowEvent*>(event.get()));
-                        break;
-                    case Event::Type::ENGINE_START:
-                    case Event::Type::ENGINE_STOP:
-                    case Event::Type::ENGINE_RESUME:
-                    case Event::Type::ENGINE_PAUSE:
-                    case Event::Type::ORIENTATION_CHANGE:
-                    case Event::Type::LOW_MEMORY:
-                    case Event::Type::OPEN_FILE:
-                        if (eventHandler->systemHandler)
-                            handled = eventHandler->systemHandler(*static_cast<SystemEvent*>(event.get()));
-                        break;
-                    case Event::Type::ACTOR_ENTER:
-                    case Event::Type::ACTOR_LEAVE:
-                    case Event::Type::ACTOR_PRESS:
-                    case Event::Type::ACTOR_RELEASE:
-                    case Event::Type::ACTOR_CLICK:
-                    case Event::Type::ACTOR_DRAG:
-                    case Event::Type::WIDGET_CHANGE:
-                        if (eventHandler->uiHandler)
-                            handled = eventHandler->uiHandler(*static_cast<UIEvent*>(event.get()));
-                        break;
-                    case Event::Type::ANIMATION_START:
-                    case Event::Type::ANIMATION_RESET:
-                    case Event::Type::ANIMATION_FINISH:
-                        if (eventHandler->animationHandler)
-                            handled = eventHandler->animationHandler(*static_cast<AnimationEvent*>(event.get()));
-                        break;
-                    case Event::Type::SOUND_START:
-                    case Event::Type::SOUND_RESET:
-                    case Event::Type::SOUND_FINISH:
-                        if (eventHandler->soundHandler)
-                            handled = eventHandler->soundHandler(*static_cast<SoundEvent*>(event.get()));
-                        break;
-                    case Event::Type::UPDATE:
-                        if (eventHandler->updateHandler)
-                            handled = eventHandler->updateHandler(*static_cast<UpdateEvent*>(event.get()));
-                        break;
-                    case Event::Type::USER:
-                        if (eventHandler->userHandler)
-                            handled = eventHandler->userHandler(*static_cast<UserEvent*>(event.get()));
-                        break;
-                    default:
-                        return false; // custom event should not be sent
-                }
-            }
-
-            if (handled) break;
+            case Event::Type::KEYBOARD_CONNECT:
+            case Event::Type::KEYBOARD_DISCONNECT:
+            case Event::Type::KEY_PRESS:
+            case Event::Type::KEY_RELEASE:
+                return dispatch(eventHandlers[EventHandler::KEYBOARD_CATEGORY], &EventHandler::keyboardHandler,
+                                *static_cast<KeyboardEvent*>(event.get()));
+            case Event::Type::MOUSE_CONNECT:
+            case Event::Type::MOUSE_DISCONNECT:
+            case Event::Type::MOUSE_PRESS:
+            case Event::Type::MOUSE_RELEASE:
+            case Event::Type::MOUSE_SCROLL:
+            case Event::Type::MOUSE_MOVE:
+            case Event::Type::MOUSE_CURSOR_LOCK_CHANGE:
+                return dispatch(eventHandlers[EventHandler::MOUSE_CATEGORY], &EventHandler::mouseHandler,
+                                *static_cast<MouseEvent*>(event.get()));
+            case Event::Type::TOUCHPAD_CONNECT:
+            case Event::Type::TOUCHPAD_DISCONNECT:
+            case Event::Type::TOUCH_BEGIN:
+            case Event::Type::TOUCH_MOVE:
+            case Event::Type::TOUCH_END:
+            case Event::Type::TOUCH_CANCEL:
+                return dispatch(eventHandlers[EventHandler::TOUCH_CATEGORY], &EventHandler::touchHandler,
+                                *static_cast<TouchEvent*>(event.get()));
+            case Event::Type::GAMEPAD_CONNECT:
+            case Event::Type::GAMEPAD_DISCONNECT:
+            case Event::Type::GAMEPAD_BUTTON_CHANGE:
+                return dispatch(eventHandlers[EventHandler::GAMEPAD_CATEGORY], &EventHandler::gamepadHandler,
+                                *static_cast<GamepadEvent*>(event.get()));
+            case Event::Type::WINDOW_SIZE_CHANGE:
+            case Event::Type::WINDOW_TITLE_CHANGE:
+            case Event::Type::FULLSCREEN_CHANGE:
+            case Event::Type::SCREEN_CHANGE:
+            case Event::Type::RESOLUTION_CHANGE:
+                return dispatch(eventHandlers[EventHandler::WINDOW_CATEGORY], &EventHandler::windowHandler,
+                                *static_cast<WindowEvent*>(event.get()));
+            case Event::Type::ENGINE_START:
+            case Event::Type::ENGINE_STOP:
+            case Event::Type::ENGINE_RESUME:
+            case Event::Type::ENGINE_PAUSE:
+            case Event::Type::ORIENTATION_CHANGE:
+            case Event::Type::LOW_MEMORY:
+            case Event::Type::OPEN_FILE:
+                return dispatch(eventHandlers[EventHandler::SYSTEM_CATEGORY], &EventHandler::systemHandler,
+                                *static_cast<SystemEvent*>(event.get()));
+            case Event::Type::ACTOR_ENTER:
+            case Event::Type::ACTOR_LEAVE:
+            case Event::Type::ACTOR_PRESS:
+            case Event::Type::ACTOR_RELEASE:
+            case Event::Type::ACTOR_CLICK:
+            case Event::Type::ACTOR_DRAG:
+            case Event::Type::WIDGET_CHANGE:
+                return dispatch(eventHandlers[EventHandler::UI_CATEGORY], &EventHandler::uiHandler,
+                                *static_cast<UIEvent*>(event.get()));
+            case Event::Type::ANIMATION_START:
+            case Event::Type::ANIMATION_RESET:
+            case Event::Type::ANIMATION_FINISH:
+                return dispatch(eventHandlers[EventHandler::ANIMATION_CATEGORY], &EventHandler::animationHandler,
+                                *static_cast<AnimationEvent*>(event.get()));
+            case Event::Type::SOUND_START:
+            case Event::Type::SOUND_RESET:
+            case Event::Type::SOUND_FINISH:
+                return dispatch(eventHandlers[EventHandler::SOUND_CATEGORY], &EventHandler::soundHandler,
+                                *static_cast<SoundEvent*>(event.get()));
+            case Event::Type::UPDATE:
+                return dispatch(eventHandlers[EventHandler::UPDATE_CATEGORY], &EventHandler::updateHandler,
+                                *static_cast<UpdateEvent*>(event.get()));
+            case Event::Type::USER:
+                return dispatch(eventHandlers[EventHandler::USER_CATEGORY], &EventHandler::userHandler,
+                                *static_cast<UserEvent*>(event.get()));
+            default:
+                return false; // custom event should not be sent
         }
-
-        return handled;
     }
 
     void EventDispatcher::addEventHandler(EventHandler* eventHandler)
@@ -180,39 +187,68 @@ namespace ouzel
 
         eventHandler->eventDispatcher = this;
 
-        eventHandlerAddSet.insert(eventHandler);
-
-        auto setIterator = eventHandlerDeleteSet.find(eventHandler);
+        addedEventHandlers.push_back(eventHandler);
+    }
 
-        if (setIterator != eventHandlerDeleteSet.end())
-            eventHandlerDeleteSet.erase(setIterator);
+    void EventDispatcher::refreshEventHandler(EventHandler* eventHandler)
+    {
+        if (std::find(addedEventHandlers.begin(), addedEventHandlers.end(), eventHandler) == addedEventHandlers.end())
+            addedEventHandlers.push_back(eventHandler);
     }
 
     void EventDispatcher::removeEventHandler(EventHandler* eventHandler)
     {
         if (eventHandler->eventDispatcher == this)
+        {
             eventHandler->eventDispatcher = nullptr;
 
-        eventHandlerDeleteSet.insert(eventHandler);
+            // the slots are erased on the next update, so that the handler lists can be iterated while dispatching
+            for (uint32_t category = 0; category < EventHandler::CATEGORY_COUNT; ++category)
+            {
+                uint32_t& position = eventHandler->positions[category];
+
+                if (position != EventHandler::NO_POSITION)
+                {
+                    eventHandlers[category][position] = nullptr;
+                    position = EventHandler::NO_POSITION;
+                    eventHandlersRemoved = true;
+                }
+            }
+        }
 
-        auto setIterator = eventHandlerAddSet.find(eventHandler);
+        auto i = std::find(addedEventHandlers.begin(), addedEventHandlers.end(), eventHandler);
 
-        if (setIterator != eventHandlerAddSet.end())
-            eventHandlerAddSet.erase(setIterator);
+        if (i != addedEventHandlers.end())
+            addedEventHandlers.erase(i);
     }
 
     std::future<bool> EventDispatcher::postEvent(std::unique_ptr<Event>&& event)
     {
-        std::promise<bool> promise;
-        std::future<bool> future = promise.get_future();
+        std::unique_ptr<std::promise<bool>> promise(new std::promise<bool>());
+        std::future<bool> future = promise->get_future();
 
 #if OUZEL_MULTITHREADED
         std::unique_lock<std::mutex> lock(eventQueueMutex);
-        eventQueue.push(std::pair<std::promise<bool>, std::unique_ptr<Event>>(std::move(promise), std::move(event)));
+        QueuedEvent queuedEvent;
+        queuedEvent.event = std::move(event);
+        queuedEvent.promise = std::move(promise);
+        eventQueue.push_back(std::move(queuedEvent));
 #else
-        promise.set_value(dispatchEvent(std::move(event)));
+        promise->set_value(dispatchEvent(std::move(event)));
 #endif
 
         return future;
     }
+
+    void EventDispatcher::postEventDetached(std::unique_ptr<Event>&& event)
+    {
+#if OUZEL_MULTITHREADED
+        std::unique_lock<std::mutex> lock(eventQueueMutex);
+        QueuedEvent queuedEvent;
+        queuedEvent.event = std::move(event);
+        eventQueue.push_back(std::move(queuedEvent));
+#else
+        dispatchEvent(std::move(event));
+#endif
+    }
 }
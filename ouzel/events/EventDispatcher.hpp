@@ -6,8 +6,7 @@
 #include <cstdint>
 #include <future>
 #include <memory>
-#include <queue>
-#include <set>
+#include <mutex>
 #include <vector>
 #include "events/Event.hpp"
 #include "events/EventHandler.hpp"
@@ -16,6 +15,7 @@ namespace ouzel
 {
     class EventDispatcher final
     {
+        friend EventHandler;
     public:
         EventDispatcher();
         ~EventDispatcher();
@@ -34,17 +34,30 @@ namespace ouzel
 
         // posts the event for dispatching on the game thread
         std::future<bool> postEvent(std::unique_ptr<Event>&& event);
+        // posts the event for dispatching on the game thread without reporting whether it was handled
+        void postEventDetached(std::unique_ptr<Event>&& event);
 
         // dispatches all queued events on the game thread
         void dispatchEvents();
 
     private:
-        std::vector<EventHandler*> eventHandlers;
-        std::set<EventHandler*> eventHandlerAddSet;
-        std::set<EventHandler*> eventHandlerDeleteSet;
+        struct QueuedEvent final
+        {
+            std::unique_ptr<Event> event;
+            std::unique_ptr<std::promise<bool>> promise; // null for detached events
+        };
+
+        void refreshEventHandler(EventHandler* eventHandler);
+        void updateEventHandlers();
+
+        // sorted by priority, removed handlers are set to null until the next update
+        std::vector<EventHandler*> eventHandlers[EventHandler::CATEGORY_COUNT];
+        std::vector<EventHandler*> addedEventHandlers;
+        bool eventHandlersRemoved = false;
 
         std::mutex eventQueueMutex;
-        std::queue<std::pair<std::promise<bool>, std::unique_ptr<Event>>> eventQueue;
+        std::vector<QueuedEvent> eventQueue;
+        std::vector<QueuedEvent> dispatchQueue; // swapped with the event queue to keep the capacity of both
     };
 }
 
@@ -18,4 +18,29 @@ namespace ouzel
             eventDispatcher = nullptr;
         }
     }
+
+    void EventHandler::functionSet()
+    {
+        // the dispatcher adds the handler to the lists of the events it isn't registered for yet
+        if (eventDispatcher) eventDispatcher->refreshEventHandler(this);
+    }
+
+    bool EventHandler::hasHandler(Category category) const
+    {
+        switch (category)
+        {
+            case KEYBOARD_CATEGORY: return static_cast<bool>(keyboardHandler);
+            case MOUSE_CATEGORY: return static_cast<bool>(mouseHandler);
+            case TOUCH_CATEGORY: return static_cast<bool>(touchHandler);
+            case GAMEPAD_CATEGORY: return static_cast<bool>(gamepadHandler);
+            case WINDOW_CATEGORY: return static_cast<bool>(windowHandler);
+            case SYSTEM_CATEGORY: return static_cast<bool>(systemHandler);
+            case UI_CATEGORY: return static_cast<bool>(uiHandler);
+            case ANIMATION_CATEGORY: return static_cast<bool>(animationHandler);
+            case SOUND_CATEGORY: return static_cast<bool>(soundHandler);
+            case UPDATE_CATEGORY: return static_cast<bool>(updateHandler);
+            case USER_CATEGORY: return static_cast<bool>(userHandler);
+            default: return false;
+        }
+    }
 }
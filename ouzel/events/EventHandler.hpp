@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <cstdint>
+#include <utility>
 #include "events/Event.hpp"
 
 namespace ouzel
@@ -17,26 +18,93 @@ namespace ouzel
     public:
         static const int32_t PRIORITY_MAX = 0x1000;
 
-        explicit EventHandler(int32_t initPriority = 0): priority(initPriority) {}
+        // assigned like a std::function, setting it on an added handler registers the handler for its events
+        template<class T>
+        class Function final
+        {
+        public:
+            explicit Function(EventHandler& initEventHandler): eventHandler(initEventHandler) {}
+
+            Function(const Function&) = delete;
+            Function& operator=(const Function&) = delete;
+
+            Function(Function&&) = delete;
+            Function& operator=(Function&&) = delete;
+
+            template<class F>
+            Function& operator=(F&& newFunction)
+            {
+                bool wasSet = static_cast<bool>(function);
+                function = std::forward<F>(newFunction);
+                if (!wasSet && function) eventHandler.functionSet();
+                return *this;
+            }
+
+            explicit operator bool() const { return static_cast<bool>(function); }
+            bool operator()(const T& event) const { return function(event); }
+
+        private:
+            EventHandler& eventHandler;
+            std::function<bool(const T&)> function;
+        };
+
+        explicit EventHandler(int32_t initPriority = 0):
+            keyboardHandler(*this), mouseHandler(*this), touchHandler(*this), gamepadHandler(*this),
+            windowHandler(*this), systemHandler(*this), uiHandler(*this), animationHandler(*this),
+            soundHandler(*this), updateHandler(*this), userHandler(*this),
+            priority(initPriority)
+        {
+            for (uint32_t& position : positions) position = NO_POSITION;
+        }
         ~EventHandler();
 
+        EventHandler(const EventHandler&) = delete;
+        EventHandler& operator=(const EventHandler&) = delete;
+
+        EventHandler(EventHandler&&) = delete;
+        EventHandler& operator=(EventHandler&&) = delete;
+
         void remove();
 
-        std::function<bool(const KeyboardEvent&)> keyboardHandler;
-        std::function<bool(const MouseEvent&)> mouseHandler;
-        std::function<bool(const TouchEvent&)> touchHandler;
-        std::function<bool(const GamepadEvent&)> gamepadHandler;
-        std::function<bool(const WindowEvent&)> windowHandler;
-        std::function<bool(const SystemEvent&)> systemHandler;
-        std::function<bool(const UIEvent&)> uiHandler;
-        std::function<bool(const AnimationEvent&)> animationHandler;
-        std::function<bool(const SoundEvent&)> soundHandler;
-        std::function<bool(const UpdateEvent&)> updateHandler;
-        std::function<bool(const UserEvent&)> userHandler;
+        // a function set on an added handler is called starting from the next dispatchEvents call,
+        // a cleared function keeps the handler in the list of its events and is skipped while dispatching
+        Function<KeyboardEvent> keyboardHandler;
+        Function<MouseEvent> mouseHandler;
+        Function<TouchEvent> touchHandler;
+        Function<GamepadEvent> gamepadHandler;
+        Function<WindowEvent> windowHandler;
+        Function<SystemEvent> systemHandler;
+        Function<UIEvent> uiHandler;
+        Function<AnimationEvent> animationHandler;
+        Function<SoundEvent> soundHandler;
+        Function<UpdateEvent> updateHandler;
+        Function<UserEvent> userHandler;
 
     private:
+        enum Category
+        {
+            KEYBOARD_CATEGORY,
+            MOUSE_CATEGORY,
+            TOUCH_CATEGORY,
+            GAMEPAD_CATEGORY,
+            WINDOW_CATEGORY,
+            SYSTEM_CATEGORY,
+            UI_CATEGORY,
+            ANIMATION_CATEGORY,
+            SOUND_CATEGORY,
+            UPDATE_CATEGORY,
+            USER_CATEGORY,
+            CATEGORY_COUNT
+        };
+
+        static const uint32_t NO_POSITION = UINT32_MAX;
+
+        bool hasHandler(Category category) const;
+        void functionSet();
+
         int32_t priority;
         EventDispatcher* eventDispatcher = nullptr;
+        uint32_t positions[CATEGORY_COUNT]; // in the handler lists of the dispatcher
     };
 }
 
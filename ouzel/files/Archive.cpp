@@ -4,72 +4,100 @@
 #include "Archive.hpp"
 #include "FileSystem.hpp"
 #include "utils/Utils.hpp"
+#include "stb_image.h"
 
 namespace ouzel
 {
-    Archive::Archive(FileSystem& initFileSystem, const std::string& filename):
-        fileSystem(initFileSystem)
-    {
-        fileSystem.addArchive(this);
+    static const uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034B50;
+    static const uint32_t CENTRAL_DIRECTORY_SIGNATURE = 0x02014B50;
+    static const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054B50;
 
-        file = File(fileSystem.getPath(filename), File::READ);
+    static const size_t LOCAL_FILE_HEADER_SIZE = 30;
+    static const size_t CENTRAL_DIRECTORY_HEADER_SIZE = 46;
+    static const size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    static const size_t MAX_COMMENT_SIZE = 65535;
 
-        for (;;)
-        {
-            uint32_t signature;
-
-            file.read(&signature, sizeof(signature), true);
+    static const uint16_t ENCRYPTED_FLAG = 0x0001;
 
-            if (decodeUInt32Little(&signature) == 0x02014b50) // central directory
-                break;
+    Archive::Archive(FileSystem& initFileSystem, const std::string& filename):
+        fileSystem(initFileSystem),
+        mappedFile(std::make_shared<MappedFile>(fileSystem.getPath(filename)))
+    {
+        const uint8_t* data = mappedFile->getData();
+        size_t size = mappedFile->getSize();
 
-            if (decodeUInt32Little(&signature) != 0x04034b50)
-                throw std::runtime_error("Bad signature");
+        if (size < END_OF_CENTRAL_DIRECTORY_SIZE)
+            throw std::runtime_error("Archive " + filename + " is too small");
 
-            uint8_t version[2];
+        // the end of central directory record is followed only by the archive comment
+        size_t endOffset = size - END_OF_CENTRAL_DIRECTORY_SIZE;
+        size_t minEndOffset = (endOffset > MAX_COMMENT_SIZE) ? endOffset - MAX_COMMENT_SIZE : 0;
 
-            file.read(version, sizeof(version), true);
+        while (decodeUInt32Little(data + endOffset) != END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+        {
+            if (endOffset == minEndOffset)
+                throw std::runtime_error("Failed to find the central directory of " + filename);
 
-            uint16_t flags;
+            --endOffset;
+        }
 
-            file.read(&flags, sizeof(flags), true);
+        const uint8_t* end = data + endOffset;
+        uint16_t entryCount = decodeUInt16Little(end + 10);
+        uint32_t directorySize = decodeUInt32Little(end + 12);
+        uint32_t directoryOffset = decodeUInt32Little(end + 16);
 
-            uint16_t compression;
-            file.read(&compression, sizeof(compression), true);
+        if (entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF)
+            throw std::runtime_error("ZIP64 archives are not supported");
 
-            if (compression != 0x00)
-                throw std::runtime_error("Unsupported compression");
+        if (static_cast<size_t>(directoryOffset) + directorySize > endOffset)
+            throw std::runtime_error("Invalid central directory");
 
-            file.seek(4, File::CURRENT); // skip modification time
-            file.seek(4, File::CURRENT); // skip CRC-32
+        entries.reserve(entryCount);
 
-            uint32_t compressedSize;
-            file.read(&compressedSize, sizeof(compressedSize), true);
+        size_t offset = directoryOffset;
+        size_t directoryEnd = static_cast<size_t>(directoryOffset) + directorySize;
 
-            uint32_t uncompressedSize;
-            file.read(&uncompressedSize, sizeof(uncompressedSize), true);
+        for (uint16_t i = 0; i < entryCount; ++i)
+        {
+            if (offset + CENTRAL_DIRECTORY_HEADER_SIZE > directoryEnd)
+                throw std::runtime_error("Invalid central directory");
 
-            uint16_t fileNameLength;
-            file.read(&fileNameLength, sizeof(fileNameLength), true);
+            const uint8_t* header = data + offset;
 
-            uint16_t extraFieldLength;
-            file.read(&extraFieldLength, sizeof(extraFieldLength), true);
+            if (decodeUInt32Little(header) != CENTRAL_DIRECTORY_SIGNATURE)
+                throw std::runtime_error("Bad signature");
 
-            std::vector<char> name(decodeUInt16Little(&fileNameLength) + 1);
+            uint16_t fileNameLength = decodeUInt16Little(header + 28);
+            uint16_t extraFieldLength = decodeUInt16Little(header + 30);
+            uint16_t commentLength = decodeUInt16Little(header + 32);
 
-            file.read(name.data(), decodeUInt16Little(&fileNameLength), true);
+            if (offset + CENTRAL_DIRECTORY_HEADER_SIZE + fileNameLength > directoryEnd)
+                throw std::runtime_error("Invalid central directory");
 
-            name[decodeUInt16Little(&fileNameLength)] = '\0';
+            std::string name(reinterpret_cast<const char*>(header + CENTRAL_DIRECTORY_HEADER_SIZE), fileNameLength);
 
-            Entry& entry = entries[name.data()];
-            entry.size = decodeUInt32Little(&uncompressedSize);
+            // skip directories
+            if (!name.empty() && name.back() != '/')
+            {
+                Entry entry;
+                entry.flags = decodeUInt16Little(header + 8);
+                entry.compression = decodeUInt16Little(header + 10);
+                entry.compressedSize = decodeUInt32Little(header + 20);
+                entry.size = decodeUInt32Little(header + 24);
+                entry.localHeaderOffset = decodeUInt32Little(header + 42);
 
-            file.seek(decodeUInt16Little(&extraFieldLength), File::CURRENT); // skip extra field
+                if (entry.compressedSize == 0xFFFFFFFF ||
+                    entry.size == 0xFFFFFFFF ||
+                    entry.localHeaderOffset == 0xFFFFFFFF)
+                    throw std::runtime_error("ZIP64 archives are not supported");
 
-            entry.offset = file.getOffset();
+                entries[name] = entry;
+            }
 
-            file.seek(decodeInt32Little(&uncompressedSize), File::CURRENT); // skip uncompressed size
+            offset += CENTRAL_DIRECTORY_HEADER_SIZE + fileNameLength + extraFieldLength + commentLength;
         }
+
+        fileSystem.addArchive(this);
     }
 
     Archive::~Archive()
@@ -79,24 +107,80 @@ namespace ouzel
 
     std::vector<uint8_t> Archive::readFile(const std::string& filename) const
     {
-        std::vector<uint8_t> data;
-
-        auto i = entries.find(filename);
+        const Entry& entry = getEntry(filename);
+        const uint8_t* compressedData = getCompressedData(filename, entry);
 
-        if (i == entries.end())
-            throw std::runtime_error("File " + filename + " does not exist");
+        if (entry.compression == STORED)
+            return std::vector<uint8_t>(compressedData, compressedData + entry.size);
 
-        file.seek(static_cast<int32_t>(i->second.offset), File::BEGIN);
+        std::vector<uint8_t> data(entry.size);
 
-        data.resize(i->second.size);
+        // stb_image's inflate keeps all of its state on the stack, so it is safe to call from multiple threads
+        int size = stbi_zlib_decode_noheader_buffer(reinterpret_cast<char*>(data.data()),
+                                                    static_cast<int>(data.size()),
+                                                    reinterpret_cast<const char*>(compressedData),
+                                                    static_cast<int>(entry.compressedSize));
 
-        file.read(data.data(), i->second.size, true);
+        if (size < 0 || static_cast<uint32_t>(size) != entry.size)
+            throw std::runtime_error("Failed to inflate " + filename);
 
         return data;
     }
 
+    FileData Archive::readFileData(const std::string& filename) const
+    {
+        const Entry& entry = getEntry(filename);
+
+        if (entry.compression == STORED)
+            return FileData(mappedFile, getCompressedData(filename, entry), entry.size);
+        else
+            return FileData(readFile(filename));
+    }
+
     bool Archive::fileExists(const std::string& filename) const
     {
         return entries.find(filename) != entries.end();
     }
+
+    const Archive::Entry& Archive::getEntry(const std::string& filename) const
+    {
+        auto i = entries.find(filename);
+
+        if (i == entries.end())
+            throw std::runtime_error("File " + filename + " does not exist");
+
+        return i->second;
+    }
+
+    const uint8_t* Archive::getCompressedData(const std::string& filename, const Entry& entry) const
+    {
+        if (entry.flags & ENCRYPTED_FLAG)
+            throw std::runtime_error("File " + filename + " is encrypted");
+
+        if (entry.compression != STORED && entry.compression != DEFLATED)
+            throw std::runtime_error("Unsupported compression of " + filename);
+
+        if (entry.compression == STORED && entry.compressedSize != entry.size)
+            throw std::runtime_error("Invalid size of " + filename);
+
+        const uint8_t* data = mappedFile->getData();
+        size_t size = mappedFile->getSize();
+
+        if (static_cast<size_t>(entry.localHeaderOffset) + LOCAL_FILE_HEADER_SIZE > size)
+            throw std::runtime_error("Invalid offset of " + filename);
+
+        const uint8_t* header = data + entry.localHeaderOffset;
+
+        if (decodeUInt32Little(header) != LOCAL_FILE_HEADER_SIGNATURE)
+            throw std::runtime_error("Bad signature");
+
+        // the extra field of the local header can differ from the one in the central directory
+        size_t dataOffset = static_cast<size_t>(entry.localHeaderOffset) + LOCAL_FILE_HEADER_SIZE +
+            decodeUInt16Little(header + 26) + decodeUInt16Little(header + 28);
+
+        if (dataOffset + entry.compressedSize > size)
+            throw std::runtime_error("Invalid size of " + filename);
+
+        return data + dataOffset;
+    }
 }
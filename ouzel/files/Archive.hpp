@@ -4,15 +4,18 @@
 #define OUZEL_FILES_ARCHIVE_HPP
 
 #include <cstdint>
-#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include "files/File.hpp"
+#include "files/FileData.hpp"
+#include "files/MappedFile.hpp"
 
 namespace ouzel
 {
     class FileSystem;
 
+    // ZIP archive, all the read methods can be called from multiple threads at the same time
     class Archive final
     {
     public:
@@ -27,20 +30,34 @@ namespace ouzel
         Archive& operator=(Archive&& other) = delete;
 
         std::vector<uint8_t> readFile(const std::string& filename) const;
+        // stored files are returned without copying, compressed files are inflated
+        FileData readFileData(const std::string& filename) const;
 
         bool fileExists(const std::string& filename) const;
 
     private:
-        FileSystem& fileSystem;
-        File file;
+        enum Compression
+        {
+            STORED = 0,
+            DEFLATED = 8
+        };
 
         struct Entry final
         {
-            uint32_t offset;
+            uint32_t localHeaderOffset;
+            uint32_t compressedSize;
             uint32_t size;
+            uint16_t compression;
+            uint16_t flags;
         };
 
-        std::map<std::string, Entry> entries;
+        const Entry& getEntry(const std::string& filename) const;
+        const uint8_t* getCompressedData(const std::string& filename, const Entry& entry) const;
+
+        FileSystem& fileSystem;
+        std::shared_ptr<const MappedFile> mappedFile;
+
+        std::unordered_map<std::string, Entry> entries;
     };
 }
 
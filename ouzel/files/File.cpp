@@ -201,6 +201,21 @@ namespace ouzel
         if (ret == -1)
             throw std::system_error(errno, std::system_category(), "Failed to seek file");
         return static_cast<uint32_t>(ret);
+#endif
+    }
+
+    uint32_t File::getSize() const
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to get file size");
+        return static_cast<uint32_t>(size.QuadPart);
+#else
+        struct stat buf;
+        if (fstat(fd, &buf) == -1)
+            throw std::system_error(errno, std::system_category(), "Failed to get file size");
+        return static_cast<uint32_t>(buf.st_size);
 #endif
     }
 }
@@ -60,6 +60,7 @@ namespace ouzel
         uint32_t write(const void* buffer, uint32_t size, bool all = false) const;
         void seek(int32_t offset, int method) const;
         uint32_t getOffset() const;
+        uint32_t getSize() const;
 
     private:
 #if defined(_WIN32)
@@ -0,0 +1,51 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FILES_FILEDATA_HPP
+#define OUZEL_FILES_FILEDATA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "files/MappedFile.hpp"
+
+namespace ouzel
+{
+    // read-only file contents that either point into a memory mapped file or own a buffer, cheap to copy
+    class FileData final
+    {
+    public:
+        FileData() {}
+
+        explicit FileData(std::vector<uint8_t> initBuffer):
+            buffer(std::make_shared<std::vector<uint8_t>>(std::move(initBuffer))),
+            data(buffer->data()),
+            size(buffer->size())
+        {
+        }
+
+        FileData(const std::shared_ptr<const MappedFile>& initMapping, const uint8_t* initData, size_t initSize):
+            mapping(initMapping),
+            data(initData),
+            size(initSize)
+        {
+        }
+
+        inline const uint8_t* getData() const { return data; }
+        inline size_t getSize() const { return size; }
+        inline bool isEmpty() const { return size == 0; }
+
+        inline const uint8_t* begin() const { return data; }
+        inline const uint8_t* end() const { return data + size; }
+
+        inline uint8_t operator[](size_t index) const { return data[index]; }
+
+    private:
+        std::shared_ptr<const MappedFile> mapping;
+        std::shared_ptr<std::vector<uint8_t>> buffer;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+}
+
+#endif // OUZEL_FILES_FILEDATA_HPP
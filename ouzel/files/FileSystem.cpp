@@ -309,25 +309,30 @@ namespace ouzel
         }
 
         std::vector<uint8_t> data;
-        char buffer[1024];
 
 #if OUZEL_PLATFORM_ANDROID
         if (!isAbsolutePath(filename))
         {
             EngineAndroid& engineAndroid = static_cast<EngineAndroid&>(engine);
 
-            AAsset* asset = AAssetManager_open(engineAndroid.getAssetManager(), filename.c_str(), AASSET_MODE_STREAMING);
+            AAsset* asset = AAssetManager_open(engineAndroid.getAssetManager(), filename.c_str(), AASSET_MODE_BUFFER);
 
             if (!asset)
                 throw std::runtime_error("Failed to open file " + filename);
 
+            data.resize(static_cast<size_t>(AAsset_getLength(asset)));
+
+            size_t offset = 0;
             int bytesRead = 0;
 
-            while ((bytesRead = AAsset_read(asset, buffer, sizeof(buffer))) > 0)
-                data.insert(data.end(), reinterpret_cast<uint8_t*>(buffer), reinterpret_cast<uint8_t*>(buffer + bytesRead));
+            while (offset < data.size() &&
+                   (bytesRead = AAsset_read(asset, data.data() + offset, data.size() - offset)) > 0)
+                offset += static_cast<size_t>(bytesRead);
 
             AAsset_close(asset);
 
+            data.resize(offset);
+
             return data;
         }
 #endif
@@ -340,12 +345,51 @@ namespace ouzel
 
         File file(path, File::Mode::READ);
 
-        while (uint32_t size = file.read(buffer, sizeof(buffer)))
-            data.insert(data.end(), buffer, buffer + size);
+        // read the whole file at once
+        data.resize(file.getSize());
+
+        uint32_t offset = 0;
+
+        while (offset < data.size())
+        {
+            uint32_t size = file.read(data.data() + offset, static_cast<uint32_t>(data.size()) - offset);
+            if (size == 0) break;
+            offset += size;
+        }
+
+        data.resize(offset);
 
         return data;
     }
 
+    FileData FileSystem::readFileData(const std::string& filename, bool searchResources) const
+    {
+        if (searchResources)
+        {
+            for (const auto& archive : archives)
+            {
+                if (archive->fileExists(filename))
+                    return archive->readFileData(filename);
+            }
+        }
+
+#if OUZEL_PLATFORM_ANDROID
+        // assets are read through the asset manager, they can't be mapped
+        if (!isAbsolutePath(filename))
+            return FileData(readFile(filename, searchResources));
+#endif
+
+        std::string path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.empty())
+            throw std::runtime_error("Failed to find file " + filename);
+
+        std::shared_ptr<const MappedFile> mappedFile = std::make_shared<MappedFile>(path);
+
+        return FileData(mappedFile, mappedFile->getData(), mappedFile->getSize());
+    }
+
     void FileSystem::writeFile(const std::string& filename, const std::vector<uint8_t>& data) const
     {
         File file(filename, File::Mode::WRITE | File::Mode::CREATE | File::Mode::TRUNCATE);
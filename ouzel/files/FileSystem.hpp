@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "files/FileData.hpp"
 
 namespace ouzel
 {
@@ -28,6 +29,8 @@ namespace ouzel
         std::string getTempDirectory() const;
 
         std::vector<uint8_t> readFile(const std::string& filename, bool searchResources = true) const;
+        // maps the file into memory instead of copying it when possible
+        FileData readFileData(const std::string& filename, bool searchResources = true) const;
         void writeFile(const std::string& filename, const std::vector<uint8_t>& data) const;
 
         bool resourceFileExists(const std::string& filename) const;
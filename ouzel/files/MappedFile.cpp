@@ -0,0 +1,106 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <system_error>
+#include <vector>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.hpp"
+
+namespace ouzel
+{
+    MappedFile::MappedFile(const std::string& filename)
+    {
+#if defined(_WIN32)
+        int bufferSize = MultiByteToWideChar(CP_UTF8, 0, filename.c_str(), -1, nullptr, 0);
+        if (bufferSize == 0)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to convert UTF-8 to wide char");
+
+        std::vector<WCHAR> buffer(bufferSize);
+        if (MultiByteToWideChar(CP_UTF8, 0, filename.c_str(), -1, buffer.data(), bufferSize) == 0)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to convert the filename to wide char");
+
+        // relative paths longer than MAX_PATH are not supported
+        if (buffer.size() > MAX_PATH)
+            buffer.insert(buffer.begin(), {L'\\', L'\\', L'?', L'\\'});
+
+        file = CreateFileW(buffer.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to open file");
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            DWORD error = GetLastError();
+            CloseHandle(file);
+            throw std::system_error(error, std::system_category(), "Failed to get file size");
+        }
+
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        // empty files can't be mapped
+        if (size > 0)
+        {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping)
+            {
+                DWORD error = GetLastError();
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to create file mapping");
+            }
+
+            data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!data)
+            {
+                DWORD error = GetLastError();
+                CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to map file");
+            }
+        }
+#else
+        fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::system_error(errno, std::system_category(), "Failed to open file");
+
+        struct stat buf;
+        if (fstat(fd, &buf) == -1)
+        {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::system_category(), "Failed to get file size");
+        }
+
+        size = static_cast<size_t>(buf.st_size);
+
+        // empty files can't be mapped
+        if (size > 0)
+        {
+            void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::system_category(), "Failed to map file");
+            }
+
+            data = static_cast<const uint8_t*>(address);
+        }
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+        if (fd != -1) close(fd);
+#endif
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FILES_MAPPEDFILE_HPP
+#define OUZEL_FILES_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#  define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace ouzel
+{
+    // read-only memory mapping of a whole file
+    class MappedFile final
+    {
+    public:
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        inline const uint8_t* getData() const { return data; }
+        inline size_t getSize() const { return size; }
+
+    private:
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+}
+
+#endif // OUZEL_FILES_MAPPEDFILE_HPP
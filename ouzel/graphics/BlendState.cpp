@@ -10,7 +10,7 @@ namespace ouzel
     {
         BlendState::BlendState(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::BLEND_STATE))
         {
         }
 
@@ -22,7 +22,7 @@ namespace ouzel
                                Operation initAlphaOperation,
                                uint8_t initColorMask):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::BLEND_STATE)),
             colorBlendSource(initColorBlendSource),
             colorBlendDest(initColorBlendDest),
             colorOperation(initColorOperation),
@@ -32,22 +32,22 @@ namespace ouzel
             colorMask(initColorMask),
             enableBlending(initEnableBlending)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new InitBlendStateCommand(resource,
-                                                                                   initEnableBlending,
-                                                                                   initColorBlendSource, initColorBlendDest,
-                                                                                   initColorOperation,
-                                                                                   initAlphaBlendSource, initAlphaBlendDest,
-                                                                                   initAlphaOperation,
-                                                                                   initColorMask)));
+            renderer.addCommand(InitBlendStateCommand(resource,
+                                                      initEnableBlending,
+                                                      initColorBlendSource, initColorBlendDest,
+                                                      initColorOperation,
+                                                      initAlphaBlendSource, initAlphaBlendDest,
+                                                      initAlphaOperation,
+                                                      initColorMask));
         }
 
         BlendState::~BlendState()
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::BLEND_STATE, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::BLEND_STATE, resource);
             }
         }
 
@@ -67,13 +67,13 @@ namespace ouzel
             alphaOperation = newAlphaOperation;
             colorMask = newColorMask;
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitBlendStateCommand(resource,
-                                                                                   newEnableBlending,
-                                                                                   newColorBlendSource, newColorBlendDest,
-                                                                                   newColorOperation,
-                                                                                   newAlphaBlendSource, newAlphaBlendDest,
-                                                                                   newAlphaOperation,
-                                                                                   newColorMask)));
+            renderer.addCommand(InitBlendStateCommand(resource,
+                                                      newEnableBlending,
+                                                      newColorBlendSource, newColorBlendDest,
+                                                      newColorOperation,
+                                                      newAlphaBlendSource, newAlphaBlendDest,
+                                                      newAlphaOperation,
+                                                      newColorMask));
         }
     } // namespace graphics
 } // namespace ouzel
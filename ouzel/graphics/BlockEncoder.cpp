@@ -0,0 +1,317 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <stdexcept>
+#include "BlockEncoder.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        static inline uint16_t encodeColor565(const uint8_t* color)
+        {
+            return static_cast<uint16_t>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+        }
+
+        static inline void decodeColor565(uint16_t value, uint32_t* color)
+        {
+            uint32_t r = (value >> 11) & 0x1F;
+            uint32_t g = (value >> 5) & 0x3F;
+            uint32_t b = value & 0x1F;
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+        }
+
+        // fills the color palette of a BC1 block, returns the number of opaque colors
+        static uint32_t getColorPalette(uint16_t color0, uint16_t color1, bool alwaysOpaque, uint32_t palette[4][4])
+        {
+            decodeColor565(color0, palette[0]);
+            decodeColor565(color1, palette[1]);
+            palette[0][3] = palette[1][3] = 255;
+
+            if (color0 > color1 || alwaysOpaque)
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                palette[2][3] = palette[3][3] = 255;
+
+                return 4;
+            }
+            else
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+                palette[2][3] = 255;
+                palette[3][3] = 0;
+
+                return 3;
+            }
+        }
+
+        // pixels with alpha below 128 are encoded as transparent if transparency is allowed (BC1), BC3 colors are always opaque
+        static void encodeColorBlock(const uint8_t pixels[16][4], bool allowTransparency, uint8_t* dst)
+        {
+            uint8_t minColor[3] = {255, 255, 255};
+            uint8_t maxColor[3] = {0, 0, 0};
+            bool transparent = false;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                if (allowTransparency && pixels[i][3] < 128)
+                {
+                    transparent = true;
+                    continue;
+                }
+
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    minColor[c] = std::min(minColor[c], pixels[i][c]);
+                    maxColor[c] = std::max(maxColor[c], pixels[i][c]);
+                }
+            }
+
+            // move the end points a bit towards each other to reduce the error of the quantization
+            for (uint32_t c = 0; c < 3 && minColor[c] <= maxColor[c]; ++c)
+            {
+                uint8_t inset = static_cast<uint8_t>((maxColor[c] - minColor[c]) >> 4);
+                minColor[c] = static_cast<uint8_t>(minColor[c] + inset);
+                maxColor[c] = static_cast<uint8_t>(maxColor[c] - inset);
+            }
+
+            uint16_t color0 = encodeColor565(maxColor);
+            uint16_t color1 = encodeColor565(minColor);
+
+            // the order of the end points selects between the opaque four color and the transparent three color mode
+            if (transparent ? color0 > color1 : color0 < color1)
+                std::swap(color0, color1);
+
+            uint32_t palette[4][4];
+            uint32_t paletteSize = getColorPalette(color0, color1, !allowTransparency, palette);
+
+            // equal end points can't select the four color mode, so only the first color is used
+            if (color0 == color1 && !transparent) paletteSize = 1;
+
+            uint32_t indices = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t bestIndex = 0;
+
+                if (transparent && pixels[i][3] < 128)
+                    bestIndex = 3;
+                else
+                {
+                    uint32_t bestDistance = UINT32_MAX;
+
+                    for (uint32_t index = 0; index < paletteSize; ++index)
+                    {
+                        uint32_t distance = 0;
+                        for (uint32_t c = 0; c < 3; ++c)
+                        {
+                            int32_t difference = static_cast<int32_t>(pixels[i][c]) - static_cast<int32_t>(palette[index][c]);
+                            distance += static_cast<uint32_t>(difference * difference);
+                        }
+
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            bestIndex = index;
+                        }
+                    }
+                }
+
+                indices |= bestIndex << (i * 2);
+            }
+
+            encodeUInt16Little(dst, color0);
+            encodeUInt16Little(dst + 2, color1);
+            encodeUInt32Little(dst + 4, indices);
+        }
+
+        static void getAlphaPalette(uint32_t alpha0, uint32_t alpha1, uint32_t palette[8])
+        {
+            palette[0] = alpha0;
+            palette[1] = alpha1;
+
+            if (alpha0 > alpha1)
+            {
+                for (uint32_t i = 1; i < 7; ++i)
+                    palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            }
+            else
+            {
+                for (uint32_t i = 1; i < 5; ++i)
+                    palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        static void encodeAlphaBlock(const uint8_t pixels[16][4], uint8_t* dst)
+        {
+            uint8_t minAlpha = 255;
+            uint8_t maxAlpha = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                minAlpha = std::min(minAlpha, pixels[i][3]);
+                maxAlpha = std::max(maxAlpha, pixels[i][3]);
+            }
+
+            uint32_t palette[8];
+            getAlphaPalette(maxAlpha, minAlpha, palette);
+
+            uint64_t indices = 0;
+
+            if (maxAlpha > minAlpha)
+            {
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    uint32_t bestIndex = 0;
+                    uint32_t bestDistance = UINT32_MAX;
+
+                    for (uint32_t index = 0; index < 8; ++index)
+                    {
+                        int32_t difference = static_cast<int32_t>(pixels[i][3]) - static_cast<int32_t>(palette[index]);
+                        uint32_t distance = static_cast<uint32_t>(difference * difference);
+
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            bestIndex = index;
+                        }
+                    }
+
+                    indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+                }
+            }
+
+            dst[0] = maxAlpha;
+            dst[1] = minAlpha;
+            for (uint32_t i = 0; i < 6; ++i)
+                dst[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+        }
+
+        static void checkFormat(PixelFormat pixelFormat)
+        {
+            if (pixelFormat != PixelFormat::BC1_UNORM &&
+                pixelFormat != PixelFormat::BC3_UNORM)
+                throw std::runtime_error("Unsupported pixel format");
+        }
+
+        std::vector<uint8_t> encodeBlocks(PixelFormat pixelFormat, uint32_t width, uint32_t height, const uint8_t* data)
+        {
+            checkFormat(pixelFormat);
+
+            std::vector<uint8_t> result(getLevelSize(pixelFormat, width, height));
+            uint8_t* dst = result.data();
+            uint8_t pixels[16][4];
+
+            for (uint32_t blockY = 0; blockY < height; blockY += 4)
+            {
+                for (uint32_t blockX = 0; blockX < width; blockX += 4)
+                {
+                    for (uint32_t y = 0; y < 4; ++y)
+                    {
+                        const uint8_t* row = data + std::min(blockY + y, height - 1) * width * 4;
+
+                        for (uint32_t x = 0; x < 4; ++x)
+                            std::copy(row + std::min(blockX + x, width - 1) * 4,
+                                      row + std::min(blockX + x, width - 1) * 4 + 4,
+                                      pixels[y * 4 + x]);
+                    }
+
+                    if (pixelFormat == PixelFormat::BC3_UNORM)
+                    {
+                        encodeAlphaBlock(pixels, dst);
+                        encodeColorBlock(pixels, false, dst + 8);
+                        dst += 16;
+                    }
+                    else
+                    {
+                        encodeColorBlock(pixels, true, dst);
+                        dst += 8;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        std::vector<Texture::Level> encodeLevels(PixelFormat pixelFormat, const std::vector<Texture::Level>& levels)
+        {
+            std::vector<Texture::Level> result;
+            result.reserve(levels.size());
+
+            for (const Texture::Level& level : levels)
+            {
+                uint32_t width = static_cast<uint32_t>(level.size.width);
+                uint32_t height = static_cast<uint32_t>(level.size.height);
+
+                if (level.data.size() != getLevelSize(PixelFormat::RGBA8_UNORM, width, height))
+                    throw std::runtime_error("Invalid level size");
+
+                result.push_back({level.size, static_cast<uint32_t>(getRowPitch(pixelFormat, width)), encodeBlocks(pixelFormat, width, height, level.data.data())});
+            }
+
+            return result;
+        }
+
+        std::vector<uint8_t> decodeBlocks(PixelFormat pixelFormat, uint32_t width, uint32_t height, const uint8_t* data)
+        {
+            checkFormat(pixelFormat);
+
+            std::vector<uint8_t> result(width * height * 4);
+            const uint8_t* src = data;
+
+            for (uint32_t blockY = 0; blockY < height; blockY += 4)
+            {
+                for (uint32_t blockX = 0; blockX < width; blockX += 4)
+                {
+                    uint32_t alphaPalette[8];
+                    uint64_t alphaIndices = 0;
+
+                    if (pixelFormat == PixelFormat::BC3_UNORM)
+                    {
+                        getAlphaPalette(src[0], src[1], alphaPalette);
+                        for (uint32_t i = 0; i < 6; ++i)
+                            alphaIndices |= static_cast<uint64_t>(src[2 + i]) << (i * 8);
+                        src += 8;
+                    }
+
+                    uint32_t palette[4][4];
+                    getColorPalette(decodeUInt16Little(src), decodeUInt16Little(src + 2),
+                                    pixelFormat == PixelFormat::BC3_UNORM, palette);
+                    uint32_t indices = decodeUInt32Little(src + 4);
+                    src += 8;
+
+                    for (uint32_t i = 0; i < 16; ++i)
+                    {
+                        uint32_t x = blockX + (i & 3);
+                        uint32_t y = blockY + (i >> 2);
+                        if (x >= width || y >= height) continue;
+
+                        uint8_t* pixel = result.data() + (y * width + x) * 4;
+                        const uint32_t* color = palette[(indices >> (i * 2)) & 0x03];
+
+                        pixel[0] = static_cast<uint8_t>(color[0]);
+                        pixel[1] = static_cast<uint8_t>(color[1]);
+                        pixel[2] = static_cast<uint8_t>(color[2]);
+                        pixel[3] = static_cast<uint8_t>(pixelFormat == PixelFormat::BC3_UNORM ?
+                                                        alphaPalette[(alphaIndices >> (i * 3)) & 0x07] : color[3]);
+                    }
+                }
+            }
+
+            return result;
+        }
+    } // namespace graphics
+} // namespace ouzel
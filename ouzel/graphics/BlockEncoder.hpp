@@ -0,0 +1,25 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_BLOCKENCODER_HPP
+#define OUZEL_GRAPHICS_BLOCKENCODER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "graphics/PixelFormat.hpp"
+#include "graphics/Texture.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // CPU encoder for preparing compressed textures offline, supports BC1 and BC3
+        // the source is tightly packed RGBA8 data, the blocks on the right and bottom edges repeat the edge pixels
+        std::vector<uint8_t> encodeBlocks(PixelFormat pixelFormat, uint32_t width, uint32_t height, const uint8_t* data);
+        std::vector<Texture::Level> encodeLevels(PixelFormat pixelFormat, const std::vector<Texture::Level>& levels);
+
+        // decodes BC1 and BC3 blocks to tightly packed RGBA8 data
+        std::vector<uint8_t> decodeBlocks(PixelFormat pixelFormat, uint32_t width, uint32_t height, const uint8_t* data);
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_BLOCKENCODER_HPP
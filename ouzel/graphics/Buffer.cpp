@@ -11,42 +11,42 @@ namespace ouzel
     {
         Buffer::Buffer(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::BUFFER))
         {
         }
 
         Buffer::Buffer(Renderer& initRenderer, Usage initUsage, uint32_t initFlags, uint32_t initSize):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::BUFFER)),
             usage(initUsage),
             flags(initFlags),
             size(initSize)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource,
-                                                                               initUsage,
-                                                                               initFlags,
-                                                                               std::vector<uint8_t>(),
-                                                                               initSize)));
+            renderer.addCommand(InitBufferCommand(resource,
+                                                  initUsage,
+                                                  initFlags,
+                                                  std::vector<uint8_t>(),
+                                                  initSize));
         }
 
         Buffer::Buffer(Renderer& initRenderer, Usage initUsage, uint32_t initFlags, const void* initData, uint32_t initSize):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::BUFFER)),
             usage(initUsage),
             flags(initFlags),
             size(initSize)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource,
-                                                                               initUsage,
-                                                                               initFlags,
-                                                                               std::vector<uint8_t>(static_cast<const uint8_t*>(initData),
-                                                                                                    static_cast<const uint8_t*>(initData) + initSize),
-                                                                               initSize)));
+            renderer.addCommand(InitBufferCommand(resource,
+                                                  initUsage,
+                                                  initFlags,
+                                                  std::vector<uint8_t>(static_cast<const uint8_t*>(initData),
+                                                                       static_cast<const uint8_t*>(initData) + initSize),
+                                                  initSize));
         }
 
         Buffer::Buffer(Renderer& initRenderer, Usage initUsage, uint32_t initFlags, const std::vector<uint8_t>& initData, uint32_t initSize):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::BUFFER)),
             usage(initUsage),
             flags(initFlags),
             size(initSize)
@@ -54,20 +54,20 @@ namespace ouzel
             if (!initData.empty() && initSize != initData.size())
                 throw std::runtime_error("Invalid buffer data");
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource,
-                                                                               initUsage,
-                                                                               initFlags,
-                                                                               initData,
-                                                                               initSize)));
+            renderer.addCommand(InitBufferCommand(resource,
+                                                  initUsage,
+                                                  initFlags,
+                                                  initData,
+                                                  initSize));
         }
 
         Buffer::~Buffer()
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::BUFFER, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::BUFFER, resource);
             }
         }
 
@@ -77,11 +77,11 @@ namespace ouzel
             flags = newFlags;
             size = newSize;
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource,
-                                                                               newUsage,
-                                                                               newFlags,
-                                                                               std::vector<uint8_t>(),
-                                                                               newSize)));
+            renderer.addCommand(InitBufferCommand(resource,
+                                                  newUsage,
+                                                  newFlags,
+                                                  std::vector<uint8_t>(),
+                                                  newSize));
         }
 
         void Buffer::init(Usage newUsage, uint32_t newFlags, const void* newData, uint32_t newSize)
@@ -102,18 +102,18 @@ namespace ouzel
             flags = newFlags;
             size = newSize;
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource,
-                                                                               newUsage,
-                                                                               newFlags,
-                                                                               newData,
-                                                                               newSize)));
+            renderer.addCommand(InitBufferCommand(resource,
+                                                  newUsage,
+                                                  newFlags,
+                                                  newData,
+                                                  newSize));
         }
 
         void Buffer::setData(const void* newData, uint32_t newSize)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new SetBufferDataCommand(resource,
-                                                                                  std::vector<uint8_t>(static_cast<const uint8_t*>(newData),
-                                                                                                       static_cast<const uint8_t*>(newData) + newSize))));
+            renderer.addCommand(SetBufferDataCommand(resource,
+                                                     std::vector<uint8_t>(static_cast<const uint8_t*>(newData),
+                                                                          static_cast<const uint8_t*>(newData) + newSize)));
         }
 
         void Buffer::setData(const std::vector<uint8_t>& newData)
@@ -126,8 +126,8 @@ namespace ouzel
 
             if (newData.size() > size) size = static_cast<uint32_t>(newData.size());
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetBufferDataCommand(resource,
-                                                                                  newData)));
+            renderer.addCommand(SetBufferDataCommand(resource,
+                                                     newData));
         }
     } // namespace graphics
 } // namespace ouzel
@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <vector>
+#include "graphics/VertexLayout.hpp"
 
 namespace ouzel
 {
@@ -52,6 +53,11 @@ namespace ouzel
             inline uint32_t getFlags() const { return flags; }
             inline uint32_t getSize() const { return size; }
 
+            // layout of the vertices in a vertex buffer, it must match the layout of the shader it is drawn with
+            inline const VertexLayout& getVertexLayout() const { return vertexLayout; }
+            inline void setVertexLayout(const VertexLayout& newVertexLayout) { vertexLayout = newVertexLayout; }
+            inline uint32_t getVertexCount() const { return vertexLayout.getStride() ? size / vertexLayout.getStride() : 0; }
+
         private:
             Renderer& renderer;
             uintptr_t resource = 0;
@@ -59,6 +65,7 @@ namespace ouzel
             Buffer::Usage usage;
             uint32_t flags = 0;
             uint32_t size = 0;
+            VertexLayout vertexLayout;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -0,0 +1,940 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "core/Setup.h"
+#include "CommandTrace.hpp"
+#include "Renderer.hpp"
+#include "RenderDevice.hpp"
+#include "core/Engine.hpp"
+#include "utils/Log.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        static const uint8_t TRACE_MAGIC[] = {'O', 'C', 'T', 'R'};
+
+        static void writeUInt8(std::vector<uint8_t>& data, uint8_t value)
+        {
+            data.push_back(value);
+        }
+
+        static void writeUInt32(std::vector<uint8_t>& data, uint32_t value)
+        {
+            uint8_t buffer[4];
+            encodeUInt32Little(buffer, value);
+            data.insert(data.end(), std::begin(buffer), std::end(buffer));
+        }
+
+        static void writeFloat(std::vector<uint8_t>& data, float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            writeUInt32(data, bits);
+        }
+
+        static void writeResource(std::vector<uint8_t>& data, uintptr_t resource)
+        {
+            writeUInt32(data, static_cast<uint32_t>(resource));
+        }
+
+        static void writeData(std::vector<uint8_t>& data, const std::vector<uint8_t>& value)
+        {
+            writeUInt32(data, static_cast<uint32_t>(value.size()));
+            data.insert(data.end(), value.begin(), value.end());
+        }
+
+        static void writeString(std::vector<uint8_t>& data, const std::string& value)
+        {
+            writeUInt32(data, static_cast<uint32_t>(value.size()));
+            data.insert(data.end(), value.begin(), value.end());
+        }
+
+        static void writeRect(std::vector<uint8_t>& data, const Rect& rect)
+        {
+            writeFloat(data, rect.position.x);
+            writeFloat(data, rect.position.y);
+            writeFloat(data, rect.size.width);
+            writeFloat(data, rect.size.height);
+        }
+
+        static void writeVertexElements(std::vector<uint8_t>& data, const std::vector<VertexLayout::Element>& elements)
+        {
+            writeUInt32(data, static_cast<uint32_t>(elements.size()));
+
+            for (const VertexLayout::Element& element : elements)
+            {
+                writeUInt8(data, static_cast<uint8_t>(element.usage));
+                writeUInt8(data, static_cast<uint8_t>(element.dataType));
+                writeUInt32(data, element.offset);
+            }
+        }
+
+        static void writeConstantInfo(std::vector<uint8_t>& data, const std::vector<Shader::ConstantInfo>& constantInfo)
+        {
+            writeUInt32(data, static_cast<uint32_t>(constantInfo.size()));
+
+            for (const Shader::ConstantInfo& info : constantInfo)
+            {
+                writeString(data, info.name);
+                writeUInt8(data, static_cast<uint8_t>(info.dataType));
+            }
+        }
+
+        static void writeLevels(std::vector<uint8_t>& data, const std::vector<Texture::Level>& levels)
+        {
+            writeUInt32(data, static_cast<uint32_t>(levels.size()));
+
+            for (const Texture::Level& level : levels)
+            {
+                writeFloat(data, level.size.width);
+                writeFloat(data, level.size.height);
+                writeUInt32(data, level.pitch);
+                writeData(data, level.data);
+            }
+        }
+
+        CommandTraceWriter::CommandTraceWriter(const std::string& filename):
+            file(filename, File::WRITE | File::CREATE | File::TRUNCATE)
+        {
+            data.assign(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC));
+            writeUInt32(data, VERSION);
+            file.write(data.data(), static_cast<uint32_t>(data.size()), true);
+        }
+
+        void CommandTraceWriter::write(const CommandBuffer& commandBuffer)
+        {
+            data.clear();
+
+            writeString(data, commandBuffer.name);
+            writeUInt32(data, static_cast<uint32_t>(commandBuffer.size()));
+
+            // only the constant blocks used by the commands are written, without the alignment padding between them
+            constantBlocks.clear();
+
+            for (const Command* command : commandBuffer)
+            {
+                if (command->type == Command::Type::SET_SHADER_CONSTANTS)
+                {
+                    auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
+                    if (setShaderConstantsCommand->fragmentShaderConstants.size)
+                        constantBlocks.push_back(setShaderConstantsCommand->fragmentShaderConstants);
+                    if (setShaderConstantsCommand->vertexShaderConstants.size)
+                        constantBlocks.push_back(setShaderConstantsCommand->vertexShaderConstants);
+                }
+            }
+
+            std::sort(constantBlocks.begin(), constantBlocks.end(), [](const ConstantBlock& a, const ConstantBlock& b) {
+                return a.offset < b.offset;
+            });
+
+            // merge the shared and overlapping blocks
+            size_t blockCount = 0;
+            for (const ConstantBlock& block : constantBlocks)
+            {
+                if (blockCount && block.offset <= constantBlocks[blockCount - 1].offset + constantBlocks[blockCount - 1].size)
+                {
+                    ConstantBlock& previousBlock = constantBlocks[blockCount - 1];
+                    previousBlock.size = std::max(previousBlock.size, block.offset + block.size - previousBlock.offset);
+                }
+                else
+                    constantBlocks[blockCount++] = block;
+            }
+            constantBlocks.resize(blockCount);
+
+            const std::vector<uint8_t>& constantData = commandBuffer.getConstantData();
+            writeUInt32(data, static_cast<uint32_t>(constantData.size()));
+            writeUInt32(data, static_cast<uint32_t>(constantBlocks.size()));
+
+            for (const ConstantBlock& block : constantBlocks)
+            {
+                writeUInt32(data, block.offset);
+                writeUInt32(data, block.size);
+                data.insert(data.end(),
+                            constantData.begin() + block.offset,
+                            constantData.begin() + block.offset + block.size);
+            }
+
+            for (const Command* command : commandBuffer)
+            {
+                writeUInt8(data, static_cast<uint8_t>(command->type));
+
+                switch (command->type)
+                {
+                    case Command::Type::PRESENT:
+                        break;
+                    case Command::Type::DELETE_RESOURCE:
+                    {
+                        auto deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
+                        writeUInt8(data, static_cast<uint8_t>(deleteResourceCommand->resourceType));
+                        writeResource(data, deleteResourceCommand->resource);
+                        break;
+                    }
+                    case Command::Type::INIT_RENDER_TARGET:
+                    {
+                        auto initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
+                        writeResource(data, initRenderTargetCommand->renderTarget);
+                        writeUInt32(data, initRenderTargetCommand->width);
+                        writeUInt32(data, initRenderTargetCommand->height);
+                        writeUInt32(data, initRenderTargetCommand->sampleCount);
+                        writeUInt32(data, static_cast<uint32_t>(initRenderTargetCommand->pixelFormat));
+                        break;
+                    }
+                    case Command::Type::SET_RENDER_TARGET_PARAMETERS:
+                    {
+                        auto setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command);
+                        writeResource(data, setRenderTargetParametersCommand->renderTarget);
+                        writeUInt8(data, setRenderTargetParametersCommand->clearColorBuffer ? 1 : 0);
+                        writeUInt8(data, setRenderTargetParametersCommand->clearDepthBuffer ? 1 : 0);
+                        writeUInt32(data, setRenderTargetParametersCommand->clearColor.getIntValue());
+                        writeFloat(data, setRenderTargetParametersCommand->clearDepth);
+                        break;
+                    }
+                    case Command::Type::SET_RENDER_TARGET:
+                    {
+                        auto setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
+                        writeResource(data, setRenderTargetCommand->renderTarget);
+                        break;
+                    }
+                    case Command::Type::CLEAR_RENDER_TARGET:
+                    {
+                        auto clearRenderTargetCommand = static_cast<const ClearRenderTargetCommand*>(command);
+                        writeResource(data, clearRenderTargetCommand->renderTarget);
+                        break;
+                    }
+                    case Command::Type::BLIT:
+                    {
+                        auto blitCommand = static_cast<const BlitCommand*>(command);
+                        writeResource(data, blitCommand->sourceTexture);
+                        writeUInt32(data, blitCommand->sourceLevel);
+                        writeUInt32(data, blitCommand->sourceX);
+                        writeUInt32(data, blitCommand->sourceY);
+                        writeUInt32(data, blitCommand->sourceWidth);
+                        writeUInt32(data, blitCommand->sourceHeight);
+                        writeResource(data, blitCommand->destinationTexture);
+                        writeUInt32(data, blitCommand->destinationLevel);
+                        writeUInt32(data, blitCommand->destinationX);
+                        writeUInt32(data, blitCommand->destinationY);
+                        break;
+                    }
+                    case Command::Type::COMPUTE:
+                    {
+                        auto computeCommand = static_cast<const ComputeCommand*>(command);
+                        writeResource(data, computeCommand->shader);
+                        break;
+                    }
+                    case Command::Type::SET_CULL_MODE:
+                    {
+                        auto setCullModeCommand = static_cast<const SetCullModeCommad*>(command);
+                        writeUInt8(data, static_cast<uint8_t>(setCullModeCommand->cullMode));
+                        break;
+                    }
+                    case Command::Type::SET_FILL_MODE:
+                    {
+                        auto setFillModeCommand = static_cast<const SetFillModeCommad*>(command);
+                        writeUInt8(data, static_cast<uint8_t>(setFillModeCommand->fillMode));
+                        break;
+                    }
+                    case Command::Type::SET_SCISSOR_TEST:
+                    {
+                        auto setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
+                        writeUInt8(data, setScissorTestCommand->enabled ? 1 : 0);
+                        writeRect(data, setScissorTestCommand->rectangle);
+                        break;
+                    }
+                    case Command::Type::SET_VIEWPORT:
+                    {
+                        auto setViewportCommand = static_cast<const SetViewportCommand*>(command);
+                        writeRect(data, setViewportCommand->viewport);
+                        break;
+                    }
+                    case Command::Type::INIT_DEPTH_STENCIL_STATE:
+                    {
+                        auto initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
+                        writeResource(data, initDepthStencilStateCommand->depthStencilState);
+                        writeUInt8(data, initDepthStencilStateCommand->depthTest ? 1 : 0);
+                        writeUInt8(data, initDepthStencilStateCommand->depthWrite ? 1 : 0);
+                        writeUInt8(data, static_cast<uint8_t>(initDepthStencilStateCommand->compareFunction));
+                        break;
+                    }
+                    case Command::Type::SET_DEPTH_STENCIL_STATE:
+                    {
+                        auto setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
+                        writeResource(data, setDepthStencilStateCommand->depthStencilState);
+                        break;
+                    }
+                    case Command::Type::SET_PIPELINE_STATE:
+                    {
+                        auto setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
+                        writeResource(data, setPipelineStateCommand->blendState);
+                        writeResource(data, setPipelineStateCommand->shader);
+                        break;
+                    }
+                    case Command::Type::DRAW:
+                    {
+                        auto drawCommand = static_cast<const DrawCommand*>(command);
+                        writeResource(data, drawCommand->indexBuffer);
+                        writeUInt32(data, drawCommand->indexCount);
+                        writeUInt32(data, drawCommand->indexSize);
+                        writeResource(data, drawCommand->vertexBuffer);
+                        writeUInt8(data, static_cast<uint8_t>(drawCommand->drawMode));
+                        writeUInt32(data, drawCommand->startIndex);
+                        writeResource(data, drawCommand->instanceBuffer);
+                        writeUInt32(data, drawCommand->instanceCount);
+                        break;
+                    }
+                    case Command::Type::PUSH_DEBUG_MARKER:
+                    {
+                        auto pushDebugMarkerCommand = static_cast<const PushDebugMarkerCommand*>(command);
+                        writeString(data, pushDebugMarkerCommand->name);
+                        break;
+                    }
+                    case Command::Type::POP_DEBUG_MARKER:
+                        break;
+                    case Command::Type::INIT_BLEND_STATE:
+                    {
+                        auto initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
+                        writeResource(data, initBlendStateCommand->blendState);
+                        writeUInt8(data, initBlendStateCommand->enableBlending ? 1 : 0);
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->colorBlendSource));
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->colorBlendDest));
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->colorOperation));
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->alphaBlendSource));
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->alphaBlendDest));
+                        writeUInt8(data, static_cast<uint8_t>(initBlendStateCommand->alphaOperation));
+                        writeUInt8(data, initBlendStateCommand->colorMask);
+                        break;
+                    }
+                    case Command::Type::INIT_BUFFER:
+                    {
+                        auto initBufferCommand = static_cast<const InitBufferCommand*>(command);
+                        writeResource(data, initBufferCommand->buffer);
+                        writeUInt8(data, static_cast<uint8_t>(initBufferCommand->usage));
+                        writeUInt32(data, initBufferCommand->flags);
+                        writeData(data, initBufferCommand->data);
+                        writeUInt32(data, initBufferCommand->size);
+                        break;
+                    }
+                    case Command::Type::SET_BUFFER_DATA:
+                    {
+                        auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
+                        writeResource(data, setBufferDataCommand->buffer);
+                        writeData(data, setBufferDataCommand->data);
+                        break;
+                    }
+                    case Command::Type::INIT_SHADER:
+                    {
+                        auto initShaderCommand = static_cast<const InitShaderCommand*>(command);
+                        writeResource(data, initShaderCommand->shader);
+                        writeData(data, initShaderCommand->fragmentShader);
+                        writeData(data, initShaderCommand->vertexShader);
+                        writeVertexElements(data, initShaderCommand->vertexLayout.getElements());
+                        writeUInt32(data, initShaderCommand->vertexLayout.getStride());
+                        writeVertexElements(data, initShaderCommand->vertexLayout.getInstanceElements());
+                        writeUInt32(data, initShaderCommand->vertexLayout.getInstanceStride());
+                        writeConstantInfo(data, initShaderCommand->fragmentShaderConstantInfo);
+                        writeConstantInfo(data, initShaderCommand->vertexShaderConstantInfo);
+                        writeUInt32(data, initShaderCommand->fragmentShaderDataAlignment);
+                        writeUInt32(data, initShaderCommand->vertexShaderDataAlignment);
+                        writeString(data, initShaderCommand->fragmentShaderFunction);
+                        writeString(data, initShaderCommand->vertexShaderFunction);
+                        break;
+                    }
+                    case Command::Type::SET_SHADER_CONSTANTS:
+                    {
+                        auto setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
+                        writeUInt32(data, setShaderConstantsCommand->fragmentShaderConstants.offset);
+                        writeUInt32(data, setShaderConstantsCommand->fragmentShaderConstants.size);
+                        writeUInt32(data, setShaderConstantsCommand->vertexShaderConstants.offset);
+                        writeUInt32(data, setShaderConstantsCommand->vertexShaderConstants.size);
+                        break;
+                    }
+                    case Command::Type::INIT_TEXTURE:
+                    {
+                        auto initTextureCommand = static_cast<const InitTextureCommand*>(command);
+                        writeResource(data, initTextureCommand->texture);
+                        writeLevels(data, initTextureCommand->levels);
+                        writeUInt32(data, initTextureCommand->flags);
+                        writeUInt32(data, initTextureCommand->sampleCount);
+                        writeUInt32(data, static_cast<uint32_t>(initTextureCommand->pixelFormat));
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_DATA:
+                    {
+                        auto setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
+                        writeResource(data, setTextureDataCommand->texture);
+                        writeLevels(data, setTextureDataCommand->levels);
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_REGION_DATA:
+                    {
+                        auto setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command);
+                        writeResource(data, setTextureRegionDataCommand->texture);
+                        writeUInt32(data, setTextureRegionDataCommand->level);
+                        writeUInt32(data, setTextureRegionDataCommand->x);
+                        writeUInt32(data, setTextureRegionDataCommand->y);
+                        writeUInt32(data, setTextureRegionDataCommand->width);
+                        writeUInt32(data, setTextureRegionDataCommand->height);
+                        writeData(data, setTextureRegionDataCommand->data);
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_PARAMETERS:
+                    {
+                        auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
+                        writeResource(data, setTextureParametersCommand->texture);
+                        writeUInt8(data, static_cast<uint8_t>(setTextureParametersCommand->filter));
+                        writeUInt8(data, static_cast<uint8_t>(setTextureParametersCommand->addressX));
+                        writeUInt8(data, static_cast<uint8_t>(setTextureParametersCommand->addressY));
+                        writeUInt32(data, setTextureParametersCommand->maxAnisotropy);
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURES:
+                    {
+                        auto setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
+                        for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
+                            writeResource(data, setTexturesCommand->textures[layer]);
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("Invalid command");
+                }
+            }
+
+            file.write(data.data(), static_cast<uint32_t>(data.size()), true);
+            ++commandBufferCount;
+        }
+
+        CommandTraceReader::CommandTraceReader(const std::string& filename, RenderDevice& initDevice):
+            device(initDevice)
+        {
+            // the whole trace is loaded up front, so that the replay is not slowed down by the file reads
+            File file(filename, File::READ);
+            data.resize(file.getSize());
+            if (!data.empty()) file.read(data.data(), static_cast<uint32_t>(data.size()), true);
+
+            if (data.size() < sizeof(TRACE_MAGIC) ||
+                !std::equal(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC), data.begin()))
+                throw std::runtime_error("Invalid trace file " + filename);
+
+            offset = sizeof(TRACE_MAGIC);
+
+            uint32_t version = readUInt32();
+            if (version != CommandTraceWriter::VERSION)
+                throw std::runtime_error("Unsupported trace version " + std::to_string(version));
+        }
+
+        bool CommandTraceReader::read(CommandBuffer& commandBuffer)
+        {
+            if (offset == data.size()) return false;
+
+            commandBuffer.clear();
+            commandBuffer.name = readString();
+
+            uint32_t commandCount = readUInt32();
+
+            uint32_t constantDataSize = readUInt32();
+            uint32_t constantBlockCount = readUInt32();
+            constantData.assign(constantDataSize, 0);
+
+            for (uint32_t i = 0; i < constantBlockCount; ++i)
+            {
+                uint32_t blockOffset = readUInt32();
+                uint32_t blockSize = readUInt32();
+
+                if (blockOffset > constantDataSize || constantDataSize - blockOffset < blockSize ||
+                    data.size() - offset < blockSize)
+                    throw std::runtime_error("Invalid shader constant block");
+
+                std::copy(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                          data.begin() + static_cast<std::ptrdiff_t>(offset + blockSize),
+                          constantData.begin() + blockOffset);
+                offset += blockSize;
+            }
+
+            // the constant data is pushed as one block, so that the traced offsets stay valid
+            commandBuffer.pushConstants(constantData.data(), constantDataSize);
+
+            for (uint32_t i = 0; i < commandCount; ++i)
+            {
+                Command::Type type = static_cast<Command::Type>(readUInt8());
+
+                switch (type)
+                {
+                    case Command::Type::PRESENT:
+                        commandBuffer.push(PresentCommand());
+                        break;
+                    case Command::Type::DELETE_RESOURCE:
+                    {
+                        uint8_t resourceType = readUInt8();
+                        if (resourceType >= RESOURCE_TYPE_COUNT)
+                            throw std::runtime_error("Invalid resource type");
+
+                        uintptr_t resource = releaseResource(static_cast<ResourceType>(resourceType));
+                        commandBuffer.push(DeleteResourceCommand(static_cast<ResourceType>(resourceType), resource));
+                        break;
+                    }
+                    case Command::Type::INIT_RENDER_TARGET:
+                    {
+                        uintptr_t renderTarget = readResource(ResourceType::RENDER_TARGET);
+                        uint32_t width = readUInt32();
+                        uint32_t height = readUInt32();
+                        uint32_t sampleCount = readUInt32();
+                        PixelFormat pixelFormat = static_cast<PixelFormat>(readUInt32());
+                        commandBuffer.push(InitRenderTargetCommand(renderTarget, width, height, sampleCount, pixelFormat));
+                        break;
+                    }
+                    case Command::Type::SET_RENDER_TARGET_PARAMETERS:
+                    {
+                        uintptr_t renderTarget = readResource(ResourceType::TEXTURE);
+                        bool clearColorBuffer = readUInt8() != 0;
+                        bool clearDepthBuffer = readUInt8() != 0;
+                        Color clearColor(readUInt32());
+                        float clearDepth = readFloat();
+                        commandBuffer.push(SetRenderTargetParametersCommand(renderTarget,
+                                                                            clearColorBuffer,
+                                                                            clearDepthBuffer,
+                                                                            clearColor,
+                                                                            clearDepth));
+                        break;
+                    }
+                    case Command::Type::SET_RENDER_TARGET:
+                    {
+                        uintptr_t renderTarget = readResource(ResourceType::TEXTURE);
+                        commandBuffer.push(SetRenderTargetCommand(renderTarget));
+                        break;
+                    }
+                    case Command::Type::CLEAR_RENDER_TARGET:
+                    {
+                        uintptr_t renderTarget = readResource(ResourceType::TEXTURE);
+                        commandBuffer.push(ClearRenderTargetCommand(renderTarget));
+                        break;
+                    }
+                    case Command::Type::BLIT:
+                    {
+                        uintptr_t sourceTexture = readResource(ResourceType::TEXTURE);
+                        uint32_t sourceLevel = readUInt32();
+                        uint32_t sourceX = readUInt32();
+                        uint32_t sourceY = readUInt32();
+                        uint32_t sourceWidth = readUInt32();
+                        uint32_t sourceHeight = readUInt32();
+                        uintptr_t destinationTexture = readResource(ResourceType::TEXTURE);
+                        uint32_t destinationLevel = readUInt32();
+                        uint32_t destinationX = readUInt32();
+                        uint32_t destinationY = readUInt32();
+                        commandBuffer.push(BlitCommand(sourceTexture, sourceLevel,
+                                                       sourceX, sourceY, sourceWidth, sourceHeight,
+                                                       destinationTexture, destinationLevel,
+                                                       destinationX, destinationY));
+                        break;
+                    }
+                    case Command::Type::COMPUTE:
+                    {
+                        uintptr_t shader = readResource(ResourceType::SHADER);
+                        commandBuffer.push(ComputeCommand(shader));
+                        break;
+                    }
+                    case Command::Type::SET_CULL_MODE:
+                        commandBuffer.push(SetCullModeCommad(static_cast<CullMode>(readUInt8())));
+                        break;
+                    case Command::Type::SET_FILL_MODE:
+                        commandBuffer.push(SetFillModeCommad(static_cast<FillMode>(readUInt8())));
+                        break;
+                    case Command::Type::SET_SCISSOR_TEST:
+                    {
+                        bool enabled = readUInt8() != 0;
+                        Rect rectangle = readRect();
+                        commandBuffer.push(SetScissorTestCommand(enabled, rectangle));
+                        break;
+                    }
+                    case Command::Type::SET_VIEWPORT:
+                        commandBuffer.push(SetViewportCommand(readRect()));
+                        break;
+                    case Command::Type::INIT_DEPTH_STENCIL_STATE:
+                    {
+                        uintptr_t depthStencilState = readResource(ResourceType::DEPTH_STENCIL_STATE);
+                        bool depthTest = readUInt8() != 0;
+                        bool depthWrite = readUInt8() != 0;
+                        auto compareFunction = static_cast<DepthStencilState::CompareFunction>(readUInt8());
+                        commandBuffer.push(InitDepthStencilStateCommand(depthStencilState,
+                                                                        depthTest,
+                                                                        depthWrite,
+                                                                        compareFunction));
+                        break;
+                    }
+                    case Command::Type::SET_DEPTH_STENCIL_STATE:
+                    {
+                        uintptr_t depthStencilState = readResource(ResourceType::DEPTH_STENCIL_STATE);
+                        commandBuffer.push(SetDepthStencilStateCommand(depthStencilState));
+                        break;
+                    }
+                    case Command::Type::SET_PIPELINE_STATE:
+                    {
+                        uintptr_t blendState = readResource(ResourceType::BLEND_STATE);
+                        uintptr_t shader = readResource(ResourceType::SHADER);
+                        commandBuffer.push(SetPipelineStateCommand(blendState, shader));
+                        break;
+                    }
+                    case Command::Type::DRAW:
+                    {
+                        uintptr_t indexBuffer = readResource(ResourceType::BUFFER);
+                        uint32_t indexCount = readUInt32();
+                        uint32_t indexSize = readUInt32();
+                        uintptr_t vertexBuffer = readResource(ResourceType::BUFFER);
+                        DrawMode drawMode = static_cast<DrawMode>(readUInt8());
+                        uint32_t startIndex = readUInt32();
+                        uintptr_t instanceBuffer = readResource(ResourceType::BUFFER);
+                        uint32_t instanceCount = readUInt32();
+                        commandBuffer.push(DrawCommand(indexBuffer, indexCount, indexSize,
+                                                       vertexBuffer, drawMode, startIndex,
+                                                       instanceBuffer, instanceCount));
+                        break;
+                    }
+                    case Command::Type::PUSH_DEBUG_MARKER:
+                        commandBuffer.push(PushDebugMarkerCommand(readString()));
+                        break;
+                    case Command::Type::POP_DEBUG_MARKER:
+                        commandBuffer.push(PopDebugMarkerCommand());
+                        break;
+                    case Command::Type::INIT_BLEND_STATE:
+                    {
+                        uintptr_t blendState = readResource(ResourceType::BLEND_STATE);
+                        bool enableBlending = readUInt8() != 0;
+                        auto colorBlendSource = static_cast<BlendState::Factor>(readUInt8());
+                        auto colorBlendDest = static_cast<BlendState::Factor>(readUInt8());
+                        auto colorOperation = static_cast<BlendState::Operation>(readUInt8());
+                        auto alphaBlendSource = static_cast<BlendState::Factor>(readUInt8());
+                        auto alphaBlendDest = static_cast<BlendState::Factor>(readUInt8());
+                        auto alphaOperation = static_cast<BlendState::Operation>(readUInt8());
+                        uint8_t colorMask = readUInt8();
+                        commandBuffer.push(InitBlendStateCommand(blendState,
+                                                                 enableBlending,
+                                                                 colorBlendSource, colorBlendDest,
+                                                                 colorOperation,
+                                                                 alphaBlendSource, alphaBlendDest,
+                                                                 alphaOperation,
+                                                                 colorMask));
+                        break;
+                    }
+                    case Command::Type::INIT_BUFFER:
+                    {
+                        uintptr_t buffer = readResource(ResourceType::BUFFER);
+                        auto usage = static_cast<Buffer::Usage>(readUInt8());
+                        uint32_t flags = readUInt32();
+                        std::vector<uint8_t> bufferData = readData();
+                        uint32_t size = readUInt32();
+                        commandBuffer.push(InitBufferCommand(buffer, usage, flags, bufferData, size));
+                        break;
+                    }
+                    case Command::Type::SET_BUFFER_DATA:
+                    {
+                        uintptr_t buffer = readResource(ResourceType::BUFFER);
+                        std::vector<uint8_t> bufferData = readData();
+                        commandBuffer.push(SetBufferDataCommand(buffer, bufferData));
+                        break;
+                    }
+                    case Command::Type::INIT_SHADER:
+                    {
+                        uintptr_t shader = readResource(ResourceType::SHADER);
+                        std::vector<uint8_t> fragmentShader = readData();
+                        std::vector<uint8_t> vertexShader = readData();
+
+                        std::vector<VertexLayout::Element> elements(readUInt32(), VertexLayout::Element(Vertex::Attribute::Usage::NONE, DataType::NONE, 0));
+                        for (VertexLayout::Element& element : elements) element = readVertexElement();
+                        uint32_t stride = readUInt32();
+
+                        std::vector<VertexLayout::Element> instanceElements(readUInt32(), VertexLayout::Element(Vertex::Attribute::Usage::NONE, DataType::NONE, 0));
+                        for (VertexLayout::Element& element : instanceElements) element = readVertexElement();
+                        uint32_t instanceStride = readUInt32();
+
+                        std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo = readConstantInfo();
+                        std::vector<Shader::ConstantInfo> vertexShaderConstantInfo = readConstantInfo();
+                        uint32_t fragmentShaderDataAlignment = readUInt32();
+                        uint32_t vertexShaderDataAlignment = readUInt32();
+                        std::string fragmentShaderFunction = readString();
+                        std::string vertexShaderFunction = readString();
+
+                        commandBuffer.push(InitShaderCommand(shader,
+                                                             fragmentShader,
+                                                             vertexShader,
+                                                             VertexLayout(elements, stride, instanceElements, instanceStride),
+                                                             fragmentShaderConstantInfo,
+                                                             vertexShaderConstantInfo,
+                                                             fragmentShaderDataAlignment,
+                                                             vertexShaderDataAlignment,
+                                                             fragmentShaderFunction,
+                                                             vertexShaderFunction));
+                        break;
+                    }
+                    case Command::Type::SET_SHADER_CONSTANTS:
+                    {
+                        ConstantBlock fragmentShaderConstants;
+                        fragmentShaderConstants.offset = readUInt32();
+                        fragmentShaderConstants.size = readUInt32();
+                        ConstantBlock vertexShaderConstants;
+                        vertexShaderConstants.offset = readUInt32();
+                        vertexShaderConstants.size = readUInt32();
+
+                        if (fragmentShaderConstants.offset + fragmentShaderConstants.size > constantDataSize ||
+                            vertexShaderConstants.offset + vertexShaderConstants.size > constantDataSize)
+                            throw std::runtime_error("Invalid shader constant block");
+
+                        commandBuffer.push(SetShaderConstantsCommand(fragmentShaderConstants, vertexShaderConstants));
+                        break;
+                    }
+                    case Command::Type::INIT_TEXTURE:
+                    {
+                        uintptr_t texture = readResource(ResourceType::TEXTURE);
+                        std::vector<Texture::Level> levels = readLevels();
+                        uint32_t flags = readUInt32();
+                        uint32_t sampleCount = readUInt32();
+                        PixelFormat pixelFormat = static_cast<PixelFormat>(readUInt32());
+                        commandBuffer.push(InitTextureCommand(texture, levels, flags, sampleCount, pixelFormat));
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_DATA:
+                    {
+                        uintptr_t texture = readResource(ResourceType::TEXTURE);
+                        std::vector<Texture::Level> levels = readLevels();
+                        commandBuffer.push(SetTextureDataCommand(texture, levels));
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_REGION_DATA:
+                    {
+                        uintptr_t texture = readResource(ResourceType::TEXTURE);
+                        uint32_t level = readUInt32();
+                        uint32_t x = readUInt32();
+                        uint32_t y = readUInt32();
+                        uint32_t width = readUInt32();
+                        uint32_t height = readUInt32();
+                        std::vector<uint8_t> textureData = readData();
+                        commandBuffer.push(SetTextureRegionDataCommand(texture, level, x, y, width, height, textureData));
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURE_PARAMETERS:
+                    {
+                        uintptr_t texture = readResource(ResourceType::TEXTURE);
+                        auto filter = static_cast<Texture::Filter>(readUInt8());
+                        auto addressX = static_cast<Texture::Address>(readUInt8());
+                        auto addressY = static_cast<Texture::Address>(readUInt8());
+                        uint32_t maxAnisotropy = readUInt32();
+                        commandBuffer.push(SetTextureParametersCommand(texture, filter, addressX, addressY, maxAnisotropy));
+                        break;
+                    }
+                    case Command::Type::SET_TEXTURES:
+                    {
+                        uintptr_t textures[Texture::LAYERS];
+                        for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
+                            textures[layer] = readResource(ResourceType::TEXTURE);
+                        commandBuffer.push(SetTexturesCommand(textures));
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("Invalid command in trace");
+                }
+            }
+
+            return true;
+        }
+
+        uint8_t CommandTraceReader::readUInt8()
+        {
+            if (data.size() - offset < 1)
+                throw std::runtime_error("Unexpected end of trace");
+
+            return data[offset++];
+        }
+
+        uint32_t CommandTraceReader::readUInt32()
+        {
+            if (data.size() - offset < 4)
+                throw std::runtime_error("Unexpected end of trace");
+
+            uint32_t result = decodeUInt32Little(data.data() + offset);
+            offset += 4;
+            return result;
+        }
+
+        float CommandTraceReader::readFloat()
+        {
+            uint32_t bits = readUInt32();
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        uintptr_t CommandTraceReader::readResource(ResourceType type)
+        {
+            uint32_t resource = readUInt32();
+            if (resource == 0) return 0; // null resource
+
+            // traced ids can collide with the resources the application already created on the device
+            uintptr_t& result = resources[static_cast<uint32_t>(type)][resource];
+            if (!result) result = device.getResourceId(type);
+
+            return result;
+        }
+
+        uintptr_t CommandTraceReader::releaseResource(ResourceType type)
+        {
+            uint32_t resource = readUInt32();
+
+            std::map<uint32_t, uintptr_t>& typeResources = resources[static_cast<uint32_t>(type)];
+            auto i = typeResources.find(resource);
+            if (i == typeResources.end())
+                throw std::runtime_error("Deleting a resource that was not created");
+
+            uintptr_t result = i->second;
+            typeResources.erase(i);
+            device.deleteResourceId(type, result);
+
+            return result;
+        }
+
+        std::vector<uint8_t> CommandTraceReader::readData()
+        {
+            uint32_t size = readUInt32();
+            if (data.size() - offset < size)
+                throw std::runtime_error("Unexpected end of trace");
+
+            std::vector<uint8_t> result(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                                        data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+            offset += size;
+            return result;
+        }
+
+        std::string CommandTraceReader::readString()
+        {
+            uint32_t size = readUInt32();
+            if (data.size() - offset < size)
+                throw std::runtime_error("Unexpected end of trace");
+
+            std::string result(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                               data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+            offset += size;
+            return result;
+        }
+
+        Rect CommandTraceReader::readRect()
+        {
+            Rect result;
+            result.position.x = readFloat();
+            result.position.y = readFloat();
+            result.size.width = readFloat();
+            result.size.height = readFloat();
+            return result;
+        }
+
+        VertexLayout::Element CommandTraceReader::readVertexElement()
+        {
+            auto usage = static_cast<Vertex::Attribute::Usage>(readUInt8());
+            auto dataType = static_cast<DataType>(readUInt8());
+            uint32_t elementOffset = readUInt32();
+            return VertexLayout::Element(usage, dataType, elementOffset);
+        }
+
+        std::vector<Shader::ConstantInfo> CommandTraceReader::readConstantInfo()
+        {
+            std::vector<Shader::ConstantInfo> result;
+            uint32_t count = readUInt32();
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::string name = readString();
+                auto dataType = static_cast<DataType>(readUInt8());
+                result.push_back(Shader::ConstantInfo(name, dataType));
+            }
+
+            return result;
+        }
+
+        std::vector<Texture::Level> CommandTraceReader::readLevels()
+        {
+            std::vector<Texture::Level> result;
+            uint32_t count = readUInt32();
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Texture::Level level;
+                level.size.width = readFloat();
+                level.size.height = readFloat();
+                level.pitch = readUInt32();
+                level.data = readData();
+                result.push_back(std::move(level));
+            }
+
+            return result;
+        }
+
+        CommandTracePlayer::CommandTracePlayer(Renderer& initRenderer, const std::string& filename):
+            renderer(initRenderer),
+            reader(filename, *initRenderer.getDevice())
+        {
+#if !OUZEL_MULTITHREADED
+            throw std::runtime_error("Trace replay requires a multithreaded build");
+#endif
+            // the render device signals a new frame before it starts waiting for the command buffers
+            renderer.waitForNextFrame();
+        }
+
+        bool CommandTracePlayer::playFrame()
+        {
+            RenderDevice* device = renderer.getDevice();
+
+            // the frame is deserialized before the timing starts
+            std::vector<CommandBuffer> commandBuffers;
+            bool present = false;
+
+            while (!present)
+            {
+                CommandBuffer commandBuffer = device->acquireCommandBuffer();
+                if (!reader.read(commandBuffer)) break;
+
+                for (const Command* command : commandBuffer)
+                    if (command->type == Command::Type::PRESENT) present = true;
+
+                commandBuffers.push_back(std::move(commandBuffer));
+            }
+
+            if (commandBuffers.empty()) return false;
+
+            // the device only finishes the frame on a present, which is missing if the capture was stopped mid-frame
+            if (!present)
+            {
+                CommandBuffer commandBuffer = device->acquireCommandBuffer();
+                commandBuffer.push(PresentCommand());
+                commandBuffers.push_back(std::move(commandBuffer));
+            }
+
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+            for (CommandBuffer& commandBuffer : commandBuffers)
+                device->submitCommandBuffer(std::move(commandBuffer));
+
+            renderer.waitForNextFrame();
+
+            auto diff = std::chrono::steady_clock::now() - startTime;
+            frameTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(diff).count() / 1000000.0F);
+
+            return true;
+        }
+
+        void CommandTracePlayer::play()
+        {
+            while (playFrame());
+
+            if (frameTimes.empty()) return;
+
+            float totalTime = 0.0F;
+            for (float frameTime : frameTimes) totalTime += frameTime;
+
+            engine->log(Log::Level::INFO) << "Replayed " << frameTimes.size() << " frames in " << totalTime * 1000.0F << " ms, " <<
+                "min: " << *std::min_element(frameTimes.begin(), frameTimes.end()) * 1000.0F << " ms, " <<
+                "average: " << totalTime * 1000.0F / frameTimes.size() << " ms, " <<
+                "max: " << *std::max_element(frameTimes.begin(), frameTimes.end()) * 1000.0F << " ms";
+        }
+    } // namespace graphics
+} // namespace ouzel
@@ -0,0 +1,109 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_COMMANDTRACE_HPP
+#define OUZEL_GRAPHICS_COMMANDTRACE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "files/File.hpp"
+#include "graphics/Commands.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        class Renderer;
+        class RenderDevice;
+
+        // serializes the command buffers, including the buffer and texture data, to a binary trace file
+        class CommandTraceWriter final
+        {
+        public:
+            static const uint32_t VERSION = 3;
+
+            explicit CommandTraceWriter(const std::string& filename);
+
+            CommandTraceWriter(const CommandTraceWriter&) = delete;
+            CommandTraceWriter& operator=(const CommandTraceWriter&) = delete;
+
+            CommandTraceWriter(CommandTraceWriter&&) = delete;
+            CommandTraceWriter& operator=(CommandTraceWriter&&) = delete;
+
+            void write(const CommandBuffer& commandBuffer);
+
+            inline uint32_t getCommandBufferCount() const { return commandBufferCount; }
+
+        private:
+            File file;
+            std::vector<uint8_t> data;
+            std::vector<ConstantBlock> constantBlocks;
+            uint32_t commandBufferCount = 0;
+        };
+
+        // deserializes the command buffers of a trace file, the traced resources get new ids from the render device
+        class CommandTraceReader final
+        {
+        public:
+            CommandTraceReader(const std::string& filename, RenderDevice& initDevice);
+
+            CommandTraceReader(const CommandTraceReader&) = delete;
+            CommandTraceReader& operator=(const CommandTraceReader&) = delete;
+
+            CommandTraceReader(CommandTraceReader&&) = delete;
+            CommandTraceReader& operator=(CommandTraceReader&&) = delete;
+
+            // returns false at the end of the trace
+            bool read(CommandBuffer& commandBuffer);
+
+        private:
+            uint8_t readUInt8();
+            uint32_t readUInt32();
+            float readFloat();
+            uintptr_t readResource(ResourceType type);
+            uintptr_t releaseResource(ResourceType type);
+            std::vector<uint8_t> readData();
+            std::string readString();
+            Rect readRect();
+            VertexLayout::Element readVertexElement();
+            std::vector<Shader::ConstantInfo> readConstantInfo();
+            std::vector<Texture::Level> readLevels();
+
+            RenderDevice& device;
+            std::vector<uint8_t> data;
+            size_t offset = 0;
+            std::vector<uint8_t> constantData;
+            std::map<uint32_t, uintptr_t> resources[RESOURCE_TYPE_COUNT]; // device resource ids of the traced resources
+        };
+
+        // submits the command buffers of a trace to the render device as fast as it can process them,
+        // the render device must run on its own thread
+        class CommandTracePlayer final
+        {
+        public:
+            CommandTracePlayer(Renderer& initRenderer, const std::string& filename);
+
+            CommandTracePlayer(const CommandTracePlayer&) = delete;
+            CommandTracePlayer& operator=(const CommandTracePlayer&) = delete;
+
+            CommandTracePlayer(CommandTracePlayer&&) = delete;
+            CommandTracePlayer& operator=(CommandTracePlayer&&) = delete;
+
+            // returns false at the end of the trace
+            bool playFrame();
+            // plays the rest of the trace and logs the frame times
+            void play();
+
+            // time it took the render device to process each frame, in seconds
+            inline const std::vector<float>& getFrameTimes() const { return frameTimes; }
+
+        private:
+            Renderer& renderer;
+            CommandTraceReader reader;
+            std::vector<float> frameTimes;
+        };
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_COMMANDTRACE_HPP
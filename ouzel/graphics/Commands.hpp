@@ -3,14 +3,21 @@
 #ifndef OUZEL_GRAPHICS_COMMANDS_HPP
 #define OUZEL_GRAPHICS_COMMANDS_HPP
 
-#include <queue>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <vector>
 #include "graphics/BlendState.hpp"
 #include "graphics/Buffer.hpp"
 #include "graphics/DepthStencilState.hpp"
 #include "graphics/DrawMode.hpp"
 #include "graphics/RasterizerState.hpp"
 #include "graphics/RenderTarget.hpp"
+#include "graphics/ResourceType.hpp"
 #include "graphics/Shader.hpp"
 #include "graphics/Texture.hpp"
 #include "math/Rect.hpp"
@@ -49,6 +56,7 @@ namespace ouzel
                 SET_SHADER_CONSTANTS,
                 INIT_TEXTURE,
                 SET_TEXTURE_DATA,
+                SET_TEXTURE_REGION_DATA,
                 SET_TEXTURE_PARAMETERS,
                 SET_TEXTURES
             };
@@ -58,8 +66,6 @@ namespace ouzel
             {
             }
 
-            virtual ~Command() {}
-
             const Type type;
         };
 
@@ -72,11 +78,14 @@ namespace ouzel
         class DeleteResourceCommand: public Command
         {
         public:
-            DeleteResourceCommand(uintptr_t initResource):
+            DeleteResourceCommand(ResourceType initResourceType,
+                                  uintptr_t initResource):
                 Command(Command::Type::DELETE_RESOURCE),
+                resourceType(initResourceType),
                 resource(initResource)
             {}
 
+            ResourceType resourceType;
             uintptr_t resource;
         };
 
@@ -312,14 +321,18 @@ namespace ouzel
                         uint32_t initIndexSize,
                         uintptr_t initVertexBuffer,
                         DrawMode initDrawMode,
-                        uint32_t initStartIndex):
+                        uint32_t initStartIndex,
+                        uintptr_t initInstanceBuffer = 0,
+                        uint32_t initInstanceCount = 0):
                 Command(Command::Type::DRAW),
                 indexBuffer(initIndexBuffer),
                 indexCount(initIndexCount),
                 indexSize(initIndexSize),
                 vertexBuffer(initVertexBuffer),
                 drawMode(initDrawMode),
-                startIndex(initStartIndex)
+                startIndex(initStartIndex),
+                instanceBuffer(initInstanceBuffer),
+                instanceCount(initInstanceCount)
             {
             }
 
@@ -329,6 +342,9 @@ namespace ouzel
             uintptr_t vertexBuffer;
             DrawMode drawMode;
             uint32_t startIndex;
+            // instanced draws read the instance attributes of the shader's vertex layout from this buffer
+            uintptr_t instanceBuffer;
+            uint32_t instanceCount;
         };
 
         class PushDebugMarkerCommand: public Command
@@ -431,7 +447,7 @@ namespace ouzel
             InitShaderCommand(uintptr_t initShader,
                               const std::vector<uint8_t>& initFragmentShader,
                               const std::vector<uint8_t>& initVertexShader,
-                              const std::set<Vertex::Attribute::Usage>& initVertexAttributes,
+                              const VertexLayout& initVertexLayout,
                               const std::vector<Shader::ConstantInfo>& initFragmentShaderConstantInfo,
                               const std::vector<Shader::ConstantInfo>& initVertexShaderConstantInfo,
                               uint32_t initFragmentShaderDataAlignment,
@@ -442,7 +458,7 @@ namespace ouzel
                 shader(initShader),
                 fragmentShader(initFragmentShader),
                 vertexShader(initVertexShader),
-                vertexAttributes(initVertexAttributes),
+                vertexLayout(initVertexLayout),
                 fragmentShaderConstantInfo(initFragmentShaderConstantInfo),
                 vertexShaderConstantInfo(initVertexShaderConstantInfo),
                 fragmentShaderDataAlignment(initFragmentShaderDataAlignment),
@@ -455,7 +471,7 @@ namespace ouzel
             uintptr_t shader;
             std::vector<uint8_t> fragmentShader;
             std::vector<uint8_t> vertexShader;
-            std::set<Vertex::Attribute::Usage> vertexAttributes;
+            VertexLayout vertexLayout;
             std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo;
             std::vector<Shader::ConstantInfo> vertexShaderConstantInfo;
             uint32_t fragmentShaderDataAlignment;
@@ -464,19 +480,26 @@ namespace ouzel
             std::string vertexShaderFunction;
         };
 
+        // range of shader constants in the constant data of a command buffer
+        struct ConstantBlock final
+        {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+        };
+
         class SetShaderConstantsCommand: public Command
         {
         public:
-            SetShaderConstantsCommand(std::vector<std::vector<float>> initFragmentShaderConstants,
-                                      std::vector<std::vector<float>> initVertexShaderConstants):
+            SetShaderConstantsCommand(ConstantBlock initFragmentShaderConstants,
+                                      ConstantBlock initVertexShaderConstants):
                 Command(Command::Type::SET_SHADER_CONSTANTS),
                 fragmentShaderConstants(initFragmentShaderConstants),
                 vertexShaderConstants(initVertexShaderConstants)
             {
             }
 
-            std::vector<std::vector<float>> fragmentShaderConstants;
-            std::vector<std::vector<float>> vertexShaderConstants;
+            ConstantBlock fragmentShaderConstants;
+            ConstantBlock vertexShaderConstants;
         };
 
         class InitTextureCommand: public Command
@@ -518,6 +541,36 @@ namespace ouzel
             std::vector<Texture::Level> levels;
         };
 
+        class SetTextureRegionDataCommand: public Command
+        {
+        public:
+            SetTextureRegionDataCommand(uintptr_t initTexture,
+                                        uint32_t initLevel,
+                                        uint32_t initX,
+                                        uint32_t initY,
+                                        uint32_t initWidth,
+                                        uint32_t initHeight,
+                                        const std::vector<uint8_t>& initData):
+                Command(Command::Type::SET_TEXTURE_REGION_DATA),
+                texture(initTexture),
+                level(initLevel),
+                x(initX),
+                y(initY),
+                width(initWidth),
+                height(initHeight),
+                data(initData)
+            {
+            }
+
+            uintptr_t texture;
+            uint32_t level;
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+            uint32_t height;
+            std::vector<uint8_t> data; // tightly packed rows
+        };
+
         class SetTextureParametersCommand: public Command
         {
         public:
@@ -555,11 +608,193 @@ namespace ouzel
             uintptr_t textures[Texture::LAYERS];
         };
 
-        class CommandBuffer
+        class CommandBuffer final
         {
+            struct Entry
+            {
+                Command* command;
+                void (*destroy)(Command*);
+            };
+
+            struct Block
+            {
+                explicit Block(size_t initSize):
+                    data(new uint8_t[initSize]),
+                    size(initSize)
+                {
+                }
+
+                std::unique_ptr<uint8_t[]> data;
+                size_t size;
+            };
+
         public:
+            static constexpr size_t BLOCK_SIZE = 64 * 1024;
+            static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+            // satisfies the uniform buffer offset alignment of all supported GPUs
+            static constexpr uint32_t CONSTANT_ALIGNMENT = 256;
+
+            class Iterator
+            {
+            public:
+                explicit Iterator(std::vector<Entry>::const_iterator initIterator):
+                    iterator(initIterator)
+                {
+                }
+
+                inline const Command* operator*() const { return iterator->command; }
+                inline Iterator& operator++() { ++iterator; return *this; }
+                inline bool operator==(const Iterator& other) const { return iterator == other.iterator; }
+                inline bool operator!=(const Iterator& other) const { return iterator != other.iterator; }
+
+            private:
+                std::vector<Entry>::const_iterator iterator;
+            };
+
+            CommandBuffer() {}
+            explicit CommandBuffer(const std::string& initName):
+                name(initName)
+            {
+            }
+
+            ~CommandBuffer()
+            {
+                clear();
+            }
+
+            CommandBuffer(const CommandBuffer&) = delete;
+            CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+            CommandBuffer(CommandBuffer&& other):
+                name(std::move(other.name)),
+                beginTime(other.beginTime),
+                submitTime(other.submitTime),
+                renderStartTime(other.renderStartTime),
+                blocks(std::move(other.blocks)),
+                commands(std::move(other.commands)),
+                constantData(std::move(other.constantData)),
+                currentBlock(other.currentBlock),
+                blockOffset(other.blockOffset)
+            {
+                other.blocks.clear();
+                other.commands.clear();
+                other.constantData.clear();
+                other.currentBlock = 0;
+                other.blockOffset = 0;
+            }
+
+            CommandBuffer& operator=(CommandBuffer&& other)
+            {
+                if (&other != this)
+                {
+                    clear();
+
+                    name = std::move(other.name);
+                    beginTime = other.beginTime;
+                    submitTime = other.submitTime;
+                    renderStartTime = other.renderStartTime;
+                    blocks = std::move(other.blocks);
+                    commands = std::move(other.commands);
+                    constantData = std::move(other.constantData);
+                    currentBlock = other.currentBlock;
+                    blockOffset = other.blockOffset;
+
+                    other.blocks.clear();
+                    other.commands.clear();
+                    other.constantData.clear();
+                    other.currentBlock = 0;
+                    other.blockOffset = 0;
+                }
+
+                return *this;
+            }
+
+            template<class T>
+            void push(T&& command)
+            {
+                typedef typename std::decay<T>::type CommandType;
+                static_assert(std::is_base_of<Command, CommandType>::value, "Not a command");
+                static_assert(alignof(CommandType) <= ALIGNMENT, "Invalid command alignment");
+
+                void* memory = allocate(sizeof(CommandType));
+                Entry entry;
+                entry.command = new (memory) CommandType(std::forward<T>(command));
+                entry.destroy = std::is_trivially_destructible<CommandType>::value ? nullptr : &destroy<CommandType>;
+                commands.push_back(entry);
+            }
+
+            // copies the shader constants to the constant data, every block starts at a multiple of CONSTANT_ALIGNMENT
+            ConstantBlock pushConstants(const void* data, uint32_t size)
+            {
+                ConstantBlock block;
+                block.offset = (static_cast<uint32_t>(constantData.size()) + CONSTANT_ALIGNMENT - 1) & ~(CONSTANT_ALIGNMENT - 1);
+                block.size = size;
+
+                constantData.resize(block.offset + size);
+                if (size) std::memcpy(constantData.data() + block.offset, data, size);
+
+                return block;
+            }
+
+            // destroys all commands but keeps the memory blocks for reuse
+            void clear()
+            {
+                for (const Entry& entry : commands)
+                    if (entry.destroy) entry.destroy(entry.command);
+
+                commands.clear();
+                constantData.clear();
+                currentBlock = 0;
+                blockOffset = 0;
+            }
+
+            inline bool empty() const { return commands.empty(); }
+            inline size_t size() const { return commands.size(); }
+            inline size_t getBlockCount() const { return blocks.size(); }
+            inline const std::vector<uint8_t>& getConstantData() const { return constantData; }
+
+            inline Iterator begin() const { return Iterator(commands.begin()); }
+            inline Iterator end() const { return Iterator(commands.end()); }
+
             std::string name;
-            std::queue<std::unique_ptr<Command>> commands;
+
+            // timestamps of a frame, submitTime is only set for the command buffers submitted as frames
+            std::chrono::steady_clock::time_point beginTime; // the update that recorded the frame started
+            std::chrono::steady_clock::time_point submitTime;
+            std::chrono::steady_clock::time_point renderStartTime;
+
+        private:
+            template<class T>
+            static void destroy(Command* command)
+            {
+                static_cast<T*>(command)->~T();
+            }
+
+            void* allocate(size_t size)
+            {
+                size_t offset = (blockOffset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+                if (blocks.empty() || offset + size > blocks[currentBlock].size)
+                {
+                    size_t nextBlock = blocks.empty() ? 0 : currentBlock + 1;
+
+                    if (nextBlock == blocks.size() || blocks[nextBlock].size < size)
+                        blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(nextBlock),
+                                      Block((size > BLOCK_SIZE) ? size : BLOCK_SIZE));
+
+                    currentBlock = nextBlock;
+                    offset = 0;
+                }
+
+                blockOffset = offset + size;
+                return blocks[currentBlock].data.get() + offset;
+            }
+
+            std::vector<Block> blocks;
+            std::vector<Entry> commands;
+            std::vector<uint8_t> constantData;
+            size_t currentBlock = 0;
+            size_t blockOffset = 0;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -10,7 +10,7 @@ namespace ouzel
     {
         DepthStencilState::DepthStencilState(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::DEPTH_STENCIL_STATE))
         {
         }
 
@@ -19,24 +19,24 @@ namespace ouzel
                                              bool initDepthWrite,
                                              CompareFunction initCompareFunction):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::DEPTH_STENCIL_STATE)),
             depthTest(initDepthTest),
             depthWrite(initDepthWrite),
             compareFunction(initCompareFunction)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new InitDepthStencilStateCommand(resource,
-                                                                                          initDepthTest,
-                                                                                          initDepthWrite,
-                                                                                          initCompareFunction)));
+            renderer.addCommand(InitDepthStencilStateCommand(resource,
+                                                             initDepthTest,
+                                                             initDepthWrite,
+                                                             initCompareFunction));
         }
 
         DepthStencilState::~DepthStencilState()
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::DEPTH_STENCIL_STATE, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::DEPTH_STENCIL_STATE, resource);
             }
         }
 
@@ -48,10 +48,10 @@ namespace ouzel
             depthWrite = newDepthWrite;
             compareFunction = newCompareFunction;
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitDepthStencilStateCommand(resource,
-                                                                                          newDepthTest,
-                                                                                          newDepthWrite,
-                                                                                          newCompareFunction)));
+            renderer.addCommand(InitDepthStencilStateCommand(resource,
+                                                             newDepthTest,
+                                                             newDepthWrite,
+                                                             newCompareFunction));
         }
     } // namespace graphics
 } // namespace ouzel
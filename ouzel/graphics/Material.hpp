@@ -25,6 +25,18 @@ namespace ouzel
             Material(Material&&) = delete;
             Material& operator=(Material&&) = delete;
 
+            // packs the shader, blend state and first texture for grouping draws with the same state
+            uint32_t getStateKey() const
+            {
+                uintptr_t shaderResource = shader ? shader->getResource() : 0;
+                uintptr_t blendStateResource = blendState ? blendState->getResource() : 0;
+                uintptr_t textureResource = textures[0] ? textures[0]->getResource() : 0;
+
+                return static_cast<uint32_t>(((shaderResource & 0xFF) << 24) |
+                                             ((blendStateResource & 0xFF) << 16) |
+                                             (textureResource & 0xFFFF));
+            }
+
             std::shared_ptr<BlendState> blendState;
             std::shared_ptr<Shader> shader;
             std::shared_ptr<Texture> textures[Texture::LAYERS];
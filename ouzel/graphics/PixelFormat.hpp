@@ -3,6 +3,9 @@
 #ifndef OUZEL_GRAPHICS_PIXELFORMAT_HPP
 #define OUZEL_GRAPHICS_PIXELFORMAT_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 namespace ouzel
 {
     namespace graphics
@@ -38,7 +41,15 @@ namespace ouzel
             RGBA16_FLOAT,
             RGBA32_UINT,
             RGBA32_SINT,
-            RGBA32_FLOAT
+            RGBA32_FLOAT,
+            BC1_UNORM,
+            BC3_UNORM,
+            BC7_UNORM,
+            ETC2_RGB8_UNORM,
+            ETC2_RGBA8_UNORM,
+            ASTC_4X4_UNORM,
+            ASTC_6X6_UNORM,
+            ASTC_8X8_UNORM
         };
 
         inline uint32_t getPixelSize(PixelFormat pixelFormat)
@@ -105,6 +116,14 @@ namespace ouzel
                 case PixelFormat::RGBA8_SNORM:
                 case PixelFormat::RGBA8_UINT:
                 case PixelFormat::RGBA8_SINT:
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                case PixelFormat::ASTC_4X4_UNORM:
+                case PixelFormat::ASTC_6X6_UNORM:
+                case PixelFormat::ASTC_8X8_UNORM:
                     return 1;
                 case PixelFormat::R16_UNORM:
                 case PixelFormat::R16_SNORM:
@@ -166,13 +185,104 @@ namespace ouzel
                 case PixelFormat::RGBA32_UINT:
                 case PixelFormat::RGBA32_SINT:
                 case PixelFormat::RGBA32_FLOAT:
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                case PixelFormat::ASTC_4X4_UNORM:
+                case PixelFormat::ASTC_6X6_UNORM:
+                case PixelFormat::ASTC_8X8_UNORM:
                     return 4;
+                case PixelFormat::ETC2_RGB8_UNORM:
+                    return 3;
                 case PixelFormat::DEFAULT:
                     return 0;
                 default:
                     return 0;
             }
         }
+
+        inline bool isCompressed(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                case PixelFormat::ASTC_4X4_UNORM:
+                case PixelFormat::ASTC_6X6_UNORM:
+                case PixelFormat::ASTC_8X8_UNORM:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // uncompressed formats have blocks of a single pixel
+        inline uint32_t getBlockWidth(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                case PixelFormat::ASTC_4X4_UNORM:
+                    return 4;
+                case PixelFormat::ASTC_6X6_UNORM:
+                    return 6;
+                case PixelFormat::ASTC_8X8_UNORM:
+                    return 8;
+                default:
+                    return 1;
+            }
+        }
+
+        inline uint32_t getBlockHeight(PixelFormat pixelFormat)
+        {
+            // all of the supported block formats have square blocks
+            return getBlockWidth(pixelFormat);
+        }
+
+        inline uint32_t getBlockSize(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                    return 8;
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                case PixelFormat::ASTC_4X4_UNORM:
+                case PixelFormat::ASTC_6X6_UNORM:
+                case PixelFormat::ASTC_8X8_UNORM:
+                    return 16;
+                default:
+                    return getPixelSize(pixelFormat);
+            }
+        }
+
+        // size of a row of blocks in bytes, calculated in size_t so that large dimensions don't wrap around
+        inline size_t getRowPitch(PixelFormat pixelFormat, uint32_t width)
+        {
+            size_t blockWidth = getBlockWidth(pixelFormat);
+            return (static_cast<size_t>(width) + blockWidth - 1) / blockWidth * getBlockSize(pixelFormat);
+        }
+
+        inline size_t getRowCount(PixelFormat pixelFormat, uint32_t height)
+        {
+            size_t blockHeight = getBlockHeight(pixelFormat);
+            return (static_cast<size_t>(height) + blockHeight - 1) / blockHeight;
+        }
+
+        inline size_t getLevelSize(PixelFormat pixelFormat, uint32_t width, uint32_t height)
+        {
+            return getRowPitch(pixelFormat, width) * getRowCount(pixelFormat, height);
+        }
     } // namespace graphics
 } // namespace ouzel
 
@@ -1,20 +1,30 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <stdexcept>
+#include "core/Setup.h"
 #include "RenderDevice.hpp"
 
 namespace ouzel
 {
     namespace graphics
     {
+        // every frame in flight and the one being recorded
+        static const size_t MAX_POOLED_COMMAND_BUFFERS = RenderDevice::MAX_FRAMES_IN_FLIGHT + 1;
+
         RenderDevice::RenderDevice(Driver initDriver,
                                    const std::function<void(const Event&)>& initCallback):
             driver(initDriver),
             callback(initCallback),
             projectionTransform(Matrix4::identity()),
             renderTargetProjectionTransform(Matrix4::identity()),
+            drawCallCount(0),
+            maxFramesInFlight(2),
+            framesInFlight(0),
             currentFPS(0.0F),
-            accumulatedFPS(0.0F)
+            accumulatedFPS(0.0F),
+            currentLatency(0.0F),
+            accumulatedLatency(0.0F)
         {
         }
 
@@ -67,6 +77,10 @@ namespace ouzel
                 accumulatedFPS = currentAccumulatedFPS;
                 accumulatedTime = 0.0F;
                 currentAccumulatedFPS = 0.0F;
+
+                accumulatedLatency = latencyCount ? latencySum / latencyCount : 0.0F;
+                latencySum = 0.0F;
+                latencyCount = 0;
             }
         }
 
@@ -106,5 +120,97 @@ namespace ouzel
                 if (func) func();
             }
         }
+
+        void RenderDevice::submitFrame(CommandBuffer&& commandBuffer)
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+#if OUZEL_MULTITHREADED
+            while (framesInFlight >= maxFramesInFlight) frameCondition.wait(lock);
+#endif
+            ++framesInFlight;
+            lock.unlock();
+
+            commandBuffer.submitTime = std::chrono::steady_clock::now();
+            // frames presented outside of Engine::update have no begin time
+            if (commandBuffer.beginTime == std::chrono::steady_clock::time_point())
+                commandBuffer.beginTime = commandBuffer.submitTime;
+            submitCommandBuffer(std::forward<CommandBuffer>(commandBuffer));
+        }
+
+        void RenderDevice::setMaxFramesInFlight(uint32_t newMaxFramesInFlight)
+        {
+            if (newMaxFramesInFlight < 1 || newMaxFramesInFlight > MAX_FRAMES_IN_FLIGHT)
+                throw std::runtime_error("Invalid number of frames in flight");
+
+            std::unique_lock<std::mutex> lock(frameMutex);
+            maxFramesInFlight = newMaxFramesInFlight;
+            lock.unlock();
+            frameCondition.notify_all();
+        }
+
+        RenderDevice::FrameTiming RenderDevice::getFrameTiming() const
+        {
+            std::unique_lock<std::mutex> lock(frameTimingMutex);
+            return frameTiming;
+        }
+
+        bool RenderDevice::popCommandBuffer(CommandBuffer& commandBuffer, bool wait)
+        {
+            std::unique_lock<std::mutex> lock(commandQueueMutex);
+
+            if (wait)
+                while (commandQueue.empty()) commandQueueCondition.wait(lock);
+            else if (commandQueue.empty())
+                return false;
+
+            commandBuffer = std::move(commandQueue.front());
+            commandQueue.pop();
+            lock.unlock();
+
+            commandBuffer.renderStartTime = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        static float getSeconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0F;
+        }
+
+        void RenderDevice::recycleCommandBuffer(CommandBuffer&& commandBuffer)
+        {
+            if (commandBuffer.submitTime != std::chrono::steady_clock::time_point())
+            {
+                std::chrono::steady_clock::time_point presentTime = std::chrono::steady_clock::now();
+
+                FrameTiming timing;
+                timing.recordTime = getSeconds(commandBuffer.submitTime - commandBuffer.beginTime);
+                timing.queueTime = getSeconds(commandBuffer.renderStartTime - commandBuffer.submitTime);
+                timing.renderTime = getSeconds(presentTime - commandBuffer.renderStartTime);
+                timing.latency = getSeconds(presentTime - commandBuffer.beginTime);
+
+                currentLatency = timing.latency;
+                latencySum += timing.latency;
+                ++latencyCount;
+
+                std::unique_lock<std::mutex> timingLock(frameTimingMutex);
+                frameTiming = timing;
+                timingLock.unlock();
+
+                std::unique_lock<std::mutex> frameLock(frameMutex);
+                --framesInFlight;
+                frameLock.unlock();
+                frameCondition.notify_all();
+            }
+
+            commandBuffer.clear();
+            commandBuffer.name.clear();
+            commandBuffer.beginTime = std::chrono::steady_clock::time_point();
+            commandBuffer.submitTime = std::chrono::steady_clock::time_point();
+            commandBuffer.renderStartTime = std::chrono::steady_clock::time_point();
+
+            std::unique_lock<std::mutex> lock(commandBufferPoolMutex);
+            if (commandBufferPool.size() < MAX_POOLED_COMMAND_BUFFERS)
+                commandBufferPool.push_back(std::forward<CommandBuffer>(commandBuffer));
+        }
     } // namespace graphics
 } // namespace ouzel
@@ -4,16 +4,19 @@
 #define OUZEL_GRAPHICS_RENDERDEVICE_HPP
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
-#include <set>
+#include <vector>
 #include "graphics/Commands.hpp"
 #include "graphics/Driver.hpp"
+#include "graphics/ResourceType.hpp"
 #include "graphics/Texture.hpp"
 #include "graphics/Vertex.hpp"
 #include "math/Matrix4.hpp"
 #include "math/Size2.hpp"
+#include "utils/HandleTable.hpp"
 
 namespace ouzel
 {
@@ -34,6 +37,17 @@ namespace ouzel
             friend Shader;
             friend Texture;
         public:
+            static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+            // timings of a presented frame, in seconds
+            struct FrameTiming final
+            {
+                float recordTime = 0.0F; // from the start of the update that recorded the frame to the submit
+                float queueTime = 0.0F; // from the submit to the start of rendering
+                float renderTime = 0.0F; // from the start of rendering to the present
+                float latency = 0.0F; // from the start of the update that recorded the frame to the present
+            };
+
             struct Event
             {
                 enum class Type
@@ -71,6 +85,27 @@ namespace ouzel
                 commandQueueCondition.notify_all();
             }
 
+            // blocks while the maximum number of frames is in flight, except in single-threaded builds where
+            // the device is processed on the calling thread
+            void submitFrame(CommandBuffer&& commandBuffer);
+
+            // 1 frame has the lowest latency, more frames let the update and render threads work in parallel
+            void setMaxFramesInFlight(uint32_t newMaxFramesInFlight);
+            inline uint32_t getMaxFramesInFlight() const { return maxFramesInFlight; }
+            // frames submitted to the device that have not been presented yet
+            inline uint32_t getFramesInFlight() const { return framesInFlight; }
+
+            CommandBuffer acquireCommandBuffer()
+            {
+                std::unique_lock<std::mutex> lock(commandBufferPoolMutex);
+
+                if (commandBufferPool.empty()) return CommandBuffer();
+
+                CommandBuffer commandBuffer = std::move(commandBufferPool.back());
+                commandBufferPool.pop_back();
+                return commandBuffer;
+            }
+
             inline uint32_t getDrawCallCount() const { return drawCallCount; }
 
             inline uint16_t getAPIMajorVersion() const { return apiMajorVersion; }
@@ -80,6 +115,9 @@ namespace ouzel
             inline bool isMultisamplingSupported() const { return multisamplingSupported; }
             inline bool isAnisotropicFilteringSupported() const { return anisotropicFilteringSupported; }
             inline bool isRenderTargetsSupported() const { return renderTargetsSupported; }
+            inline bool isInstancingSupported() const { return instancingSupported; }
+            // A8 textures are sampled as white with the stored alpha, otherwise the textures expand them to RGBA8
+            inline bool isAlphaTexturesSupported() const { return alphaTexturesSupported; }
 
             const Matrix4& getProjectionTransform(bool renderTarget) const
             {
@@ -89,25 +127,25 @@ namespace ouzel
             inline float getFPS() const { return currentFPS; }
             inline float getAccumulatedFPS() const { return accumulatedFPS; }
 
+            // latency of the last presented frame from the start of its update to the present, in seconds
+            inline float getLatency() const { return currentLatency; }
+            // average latency of the frames presented in the last second
+            inline float getAccumulatedLatency() const { return accumulatedLatency; }
+            FrameTiming getFrameTiming() const;
+
             void executeOnRenderThread(const std::function<void()>& func);
 
-            uintptr_t getResourceId()
+            uintptr_t getResourceId(ResourceType type)
             {
-                auto i = deletedResourceIds.begin();
-
-                if (i == deletedResourceIds.end())
-                    return ++lastResourceId; // zero is reserved for null resource
-                else
-                {
-                    uintptr_t resourceId = *i;
-                    deletedResourceIds.erase(i);
-                    return resourceId;
-                }
+                // resources can be created from the asset loader threads
+                std::unique_lock<std::mutex> lock(resourceIdMutex);
+                return resourceIds[static_cast<uint32_t>(type)].allocate();
             }
 
-            void deleteResourceId(uintptr_t resourceId)
+            void deleteResourceId(ResourceType type, uintptr_t resourceId)
             {
-                deletedResourceIds.insert(resourceId);
+                std::unique_lock<std::mutex> lock(resourceIdMutex);
+                resourceIds[static_cast<uint32_t>(type)].release(resourceId);
             }
 
         protected:
@@ -123,7 +161,37 @@ namespace ouzel
                               bool newDepth,
                               bool newDebugRenderer);
 
+            // recycles the popped command buffer when it goes out of scope, so that its frame is finished
+            // even if processing the commands throws
+            class CommandBufferRecycler final
+            {
+            public:
+                CommandBufferRecycler(RenderDevice& initDevice, CommandBuffer& initCommandBuffer):
+                    device(initDevice), commandBuffer(initCommandBuffer)
+                {
+                }
+
+                ~CommandBufferRecycler()
+                {
+                    device.recycleCommandBuffer(std::move(commandBuffer));
+                }
+
+                CommandBufferRecycler(const CommandBufferRecycler&) = delete;
+                CommandBufferRecycler& operator=(const CommandBufferRecycler&) = delete;
+
+                CommandBufferRecycler(CommandBufferRecycler&&) = delete;
+                CommandBufferRecycler& operator=(CommandBufferRecycler&&) = delete;
+
+            private:
+                RenderDevice& device;
+                CommandBuffer& commandBuffer;
+            };
+
             void executeAll();
+            // returns false if the queue is empty and wait is not set
+            bool popCommandBuffer(CommandBuffer& commandBuffer, bool wait);
+            // finishes the frame if the command buffer was submitted as a frame
+            void recycleCommandBuffer(CommandBuffer&& commandBuffer);
             virtual void setSize(const Size2& newSize);
 
             virtual void generateScreenshot(const std::string& filename);
@@ -148,6 +216,8 @@ namespace ouzel
             bool multisamplingSupported = true;
             bool anisotropicFilteringSupported = true;
             bool renderTargetsSupported = true;
+            bool instancingSupported = true;
+            bool alphaTexturesSupported = false;
 
             Matrix4 projectionTransform;
             Matrix4 renderTargetProjectionTransform;
@@ -158,12 +228,21 @@ namespace ouzel
             bool clearColorBuffer = true;
             bool clearDepthBuffer = false;
 
-            uint32_t drawCallCount = 0;
+            std::atomic<uint32_t> drawCallCount;
+            uint32_t currentDrawCallCount = 0;
 
             std::queue<CommandBuffer> commandQueue;
             std::mutex commandQueueMutex;
             std::condition_variable commandQueueCondition;
 
+            std::vector<CommandBuffer> commandBufferPool;
+            std::mutex commandBufferPoolMutex;
+
+            std::atomic<uint32_t> maxFramesInFlight;
+            std::atomic<uint32_t> framesInFlight;
+            std::mutex frameMutex;
+            std::condition_variable frameCondition;
+
             std::atomic<float> currentFPS;
             std::chrono::steady_clock::time_point previousFrameTime;
 
@@ -171,11 +250,18 @@ namespace ouzel
             float currentAccumulatedFPS = 0.0F;
             std::atomic<float> accumulatedFPS;
 
+            std::atomic<float> currentLatency;
+            float latencySum = 0.0F;
+            uint32_t latencyCount = 0;
+            std::atomic<float> accumulatedLatency;
+            FrameTiming frameTiming;
+            mutable std::mutex frameTimingMutex;
+
             std::queue<std::function<void()>> executeQueue;
             std::mutex executeMutex;
 
-            uintptr_t lastResourceId = 0;
-            std::set<uintptr_t> deletedResourceIds;
+            HandlePool resourceIds[RESOURCE_TYPE_COUNT];
+            std::mutex resourceIdMutex;
         };
     } // namespace graphics
 } // namespace ouzel
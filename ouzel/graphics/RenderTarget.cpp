@@ -10,7 +10,7 @@ namespace ouzel
     {
         RenderTarget::RenderTarget(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::RENDER_TARGET))
         {
         }
 
@@ -18,9 +18,9 @@ namespace ouzel
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::RENDER_TARGET, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::RENDER_TARGET, resource);
             }
         }
 
@@ -1,5 +1,8 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <stdexcept>
 #include "core/Setup.h"
 #include "Renderer.hpp"
@@ -37,7 +40,7 @@
 
 static const float GAMMA = 2.2F;
 uint8_t GAMMA_ENCODE[256];
-float GAMMA_DECODE[256];
+uint8_t GAMMA_DECODE[256];
 
 namespace ouzel
 {
@@ -76,13 +79,12 @@ namespace ouzel
                            uint32_t newMaxAnisotropy,
                            bool newVerticalSync,
                            bool newDepth,
-                           bool newDebugRenderer):
-            refillQueue(true)
+                           bool newDebugRenderer)
         {
             for (uint32_t i = 0; i < 256; ++i)
             {
                 GAMMA_ENCODE[i] = static_cast<uint8_t>(roundf(powf(i / 255.0F, 1.0F / GAMMA) * 255.0F));
-                GAMMA_DECODE[i] = roundf(powf(i / 255.0F, GAMMA) * 255.0F);
+                GAMMA_DECODE[i] = static_cast<uint8_t>(roundf(powf(i / 255.0F, GAMMA) * 255.0F));
             }
 
             switch (driver)
@@ -151,7 +153,6 @@ namespace ouzel
             {
                 std::unique_lock<std::mutex> lock(frameMutex);
                 newFrame = true;
-                refillQueue = true;
                 lock.unlock();
                 frameCondition.notify_all();
             }
@@ -161,44 +162,44 @@ namespace ouzel
         {
             clearColorBuffer = clear;
 
-            addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(0,
-                                                                                     clearColorBuffer,
-                                                                                     clearDepthBuffer,
-                                                                                     clearColor,
-                                                                                     clearDepth)));
+            addCommand(SetRenderTargetParametersCommand(0,
+                                                        clearColorBuffer,
+                                                        clearDepthBuffer,
+                                                        clearColor,
+                                                        clearDepth));
         }
 
         void Renderer::setClearDepthBuffer(bool clear)
         {
             clearDepthBuffer = clear;
 
-            addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(0,
-                                                                                     clearColorBuffer,
-                                                                                     clearDepthBuffer,
-                                                                                     clearColor,
-                                                                                     clearDepth)));
+            addCommand(SetRenderTargetParametersCommand(0,
+                                                        clearColorBuffer,
+                                                        clearDepthBuffer,
+                                                        clearColor,
+                                                        clearDepth));
         }
 
         void Renderer::setClearColor(Color color)
         {
             clearColor = color;
 
-            addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(0,
-                                                                                     clearColorBuffer,
-                                                                                     clearDepthBuffer,
-                                                                                     clearColor,
-                                                                                     clearDepth)));
+            addCommand(SetRenderTargetParametersCommand(0,
+                                                        clearColorBuffer,
+                                                        clearDepthBuffer,
+                                                        clearColor,
+                                                        clearDepth));
         }
 
         void Renderer::setClearDepth(float newClearDepth)
         {
             clearDepth = newClearDepth;
 
-            addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(0,
-                                                                                     clearColorBuffer,
-                                                                                     clearDepthBuffer,
-                                                                                     clearColor,
-                                                                                     clearDepth)));
+            addCommand(SetRenderTargetParametersCommand(0,
+                                                        clearColorBuffer,
+                                                        clearDepthBuffer,
+                                                        clearColor,
+                                                        clearDepth));
         }
 
         void Renderer::setSize(const Size2& newSize)
@@ -208,6 +209,18 @@ namespace ouzel
             device->executeOnRenderThread(std::bind(&RenderDevice::setSize, device.get(), size));
         }
 
+        ThreadPool& Renderer::getThreadPool()
+        {
+            // textures can be created from the asset loader threads
+            std::unique_lock<std::mutex> lock(threadPoolMutex);
+
+            // created on demand, so that applications that don't generate mip maps don't start the threads
+            if (!threadPool)
+                threadPool.reset(new ThreadPool("Mip map"));
+
+            return *threadPool;
+        }
+
         void Renderer::saveScreenshot(const std::string& filename)
         {
             device->executeOnRenderThread(std::bind(&RenderDevice::generateScreenshot, device.get(), filename));
@@ -215,43 +228,70 @@ namespace ouzel
 
         void Renderer::setRenderTarget(uintptr_t renderTarget)
         {
-            addCommand(std::unique_ptr<Command>(new SetRenderTargetCommand(renderTarget)));
+            ++stateCommandCount;
+
+            if ((currentStateMask & RENDER_TARGET) && currentState.renderTarget == renderTarget)
+                return;
+
+            commandBuffer.push(SetRenderTargetCommand(renderTarget));
+            ++writtenStateCommandCount;
+
+            // starting a new render pass resets the rest of the state on some devices (e.g. Metal)
+            currentState.renderTarget = renderTarget;
+            currentStateMask = RENDER_TARGET;
         }
 
         void Renderer::clearRenderTarget(uintptr_t renderTarget)
         {
-            addCommand(std::unique_ptr<Command>(new ClearRenderTargetCommand(renderTarget)));
+            commandBuffer.push(ClearRenderTargetCommand(renderTarget));
+
+            // clearing binds the render target and overrides the viewport, scissor test and depth write
+            currentStateMask = 0;
         }
 
         void Renderer::setCullMode(CullMode cullMode)
         {
-            addCommand(std::unique_ptr<Command>(new SetCullModeCommad(cullMode)));
+            ++stateCommandCount;
+            state.cullMode = cullMode;
+            stateMask |= CULL_MODE;
         }
 
         void Renderer::setFillMode(FillMode fillMode)
         {
-            addCommand(std::unique_ptr<Command>(new SetFillModeCommad(fillMode)));
+            ++stateCommandCount;
+            state.fillMode = fillMode;
+            stateMask |= FILL_MODE;
         }
 
         void Renderer::setScissorTest(bool enabled, const Rect& rectangle)
         {
-            addCommand(std::unique_ptr<Command>(new SetScissorTestCommand(enabled, rectangle)));
+            ++stateCommandCount;
+            state.scissorTest = enabled;
+            state.scissorRectangle = rectangle;
+            stateMask |= SCISSOR_TEST;
         }
 
         void Renderer::setViewport(const Rect& viewport)
         {
-            addCommand(std::unique_ptr<Command>(new SetViewportCommand(viewport)));
+            ++stateCommandCount;
+            state.viewport = viewport;
+            stateMask |= VIEWPORT;
         }
 
         void Renderer::setDepthStencilState(uintptr_t depthStencilState)
         {
-            addCommand(std::unique_ptr<Command>(new SetDepthStencilStateCommand(depthStencilState)));
+            ++stateCommandCount;
+            state.depthStencilState = depthStencilState;
+            stateMask |= DEPTH_STENCIL_STATE;
         }
 
         void Renderer::setPipelineState(uintptr_t blendState,
                                         uintptr_t shader)
         {
-            addCommand(std::unique_ptr<Command>(new SetPipelineStateCommand(blendState, shader)));
+            ++stateCommandCount;
+            state.blendState = blendState;
+            state.shader = shader;
+            stateMask |= PIPELINE_STATE;
         }
 
         void Renderer::draw(uintptr_t indexBuffer,
@@ -264,52 +304,262 @@ namespace ouzel
             if (!indexBuffer || !vertexBuffer)
                 throw std::runtime_error("Invalid mesh buffer passed to render queue");
 
-            addCommand(std::unique_ptr<Command>(new DrawCommand(indexBuffer,
-                                                                indexCount,
-                                                                indexSize,
-                                                                vertexBuffer,
-                                                                drawMode,
-                                                                startIndex)));
+            addCommand(DrawCommand(indexBuffer,
+                                   indexCount,
+                                   indexSize,
+                                   vertexBuffer,
+                                   drawMode,
+                                   startIndex));
+        }
+
+        void Renderer::drawInstanced(uintptr_t indexBuffer,
+                                     uint32_t indexCount,
+                                     uint32_t indexSize,
+                                     uintptr_t vertexBuffer,
+                                     DrawMode drawMode,
+                                     uint32_t startIndex,
+                                     uintptr_t instanceBuffer,
+                                     uint32_t instanceCount)
+        {
+            if (!indexBuffer || !vertexBuffer || !instanceBuffer)
+                throw std::runtime_error("Invalid mesh buffer passed to render queue");
+
+            if (!device->isInstancingSupported())
+                throw std::runtime_error("Instancing is not supported");
+
+            addCommand(DrawCommand(indexBuffer,
+                                   indexCount,
+                                   indexSize,
+                                   vertexBuffer,
+                                   drawMode,
+                                   startIndex,
+                                   instanceBuffer,
+                                   instanceCount));
         }
 
         void Renderer::pushDebugMarker(const std::string& name)
         {
-            addCommand(std::unique_ptr<Command>(new PushDebugMarkerCommand(name)));
+            addCommand(PushDebugMarkerCommand(name));
         }
 
         void Renderer::popDebugMarker()
         {
-            addCommand(std::unique_ptr<Command>(new PopDebugMarkerCommand()));
+            addCommand(PopDebugMarkerCommand());
+        }
+
+        void Renderer::setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
+                                          const std::vector<std::vector<float>>& vertexShaderConstants)
+        {
+            fragmentShaderData.clear();
+            for (const std::vector<float>& fragmentShaderConstant : fragmentShaderConstants)
+                fragmentShaderData.insert(fragmentShaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
+
+            vertexShaderData.clear();
+            for (const std::vector<float>& vertexShaderConstant : vertexShaderConstants)
+                vertexShaderData.insert(vertexShaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+
+            setShaderConstants(fragmentShaderData.data(), static_cast<uint32_t>(sizeof(float) * fragmentShaderData.size()),
+                               vertexShaderData.data(), static_cast<uint32_t>(sizeof(float) * vertexShaderData.size()));
+        }
+
+        void Renderer::setShaderConstants(const void* fragmentShaderConstants,
+                                          uint32_t fragmentShaderConstantSize,
+                                          const void* vertexShaderConstants,
+                                          uint32_t vertexShaderConstantSize)
+        {
+            // the previous blocks are reused if the data didn't change
+            ConstantBlock fragmentShaderConstantBlock = ((stateMask & SHADER_CONSTANTS) &&
+                                                         isConstantDataEqual(state.fragmentShaderConstants, fragmentShaderConstants, fragmentShaderConstantSize)) ?
+                state.fragmentShaderConstants : addShaderConstants(fragmentShaderConstants, fragmentShaderConstantSize);
+
+            ConstantBlock vertexShaderConstantBlock = ((stateMask & SHADER_CONSTANTS) &&
+                                                       isConstantDataEqual(state.vertexShaderConstants, vertexShaderConstants, vertexShaderConstantSize)) ?
+                state.vertexShaderConstants : addShaderConstants(vertexShaderConstants, vertexShaderConstantSize);
+
+            setShaderConstants(fragmentShaderConstantBlock, vertexShaderConstantBlock);
         }
 
-        void Renderer::setShaderConstants(std::vector<std::vector<float>> fragmentShaderConstants,
-                                          std::vector<std::vector<float>> vertexShaderConstants)
+        void Renderer::setShaderConstants(ConstantBlock fragmentShaderConstants,
+                                          ConstantBlock vertexShaderConstants)
         {
-            addCommand(std::unique_ptr<Command>(new SetShaderConstantsCommand(fragmentShaderConstants,
-                                                                              vertexShaderConstants)));
+            ++stateCommandCount;
+            state.fragmentShaderConstants = fragmentShaderConstants;
+            state.vertexShaderConstants = vertexShaderConstants;
+            stateMask |= SHADER_CONSTANTS;
         }
 
         void Renderer::setTextures(const std::vector<uintptr_t>& textures)
         {
-            uintptr_t newTextures[Texture::LAYERS];
+            setTextures(textures.data(), static_cast<uint32_t>(textures.size()));
+        }
+
+        void Renderer::setTextures(const uintptr_t* textures, uint32_t count)
+        {
+            ++stateCommandCount;
 
             for (uint32_t i = 0; i < Texture::LAYERS; ++i)
-                newTextures[i] = (i < textures.size()) ? textures[i] : 0;
+                state.textures[i] = (i < count) ? textures[i] : 0;
 
-            addCommand(std::unique_ptr<Command>(new SetTexturesCommand(newTextures)));
+            stateMask |= TEXTURES;
+        }
+
+        void Renderer::beginFrame()
+        {
+            // updates that don't present stamp it again, so it belongs to the update that records the frame
+            commandBuffer.beginTime = std::chrono::steady_clock::now();
         }
 
         void Renderer::present()
         {
-            refillQueue = false;
-            addCommand(std::unique_ptr<Command>(new PresentCommand()));
-            device->submitCommandBuffer(std::move(commandBuffer));
-            commandBuffer = CommandBuffer();
+            addCommand(PresentCommand());
+            if (captureWriter) captureWriter->write(commandBuffer);
+            // blocks while the maximum number of frames is in flight
+            device->submitFrame(std::move(commandBuffer));
+            commandBuffer = device->acquireCommandBuffer();
+
+            // the state is written again in the next command buffer, but the constants belong to the submitted one
+            currentStateMask = 0;
+            stateMask &= ~SHADER_CONSTANTS;
+
+            // state can be written more often than it was set if it got invalidated
+            removedCommandCount = (stateCommandCount > writtenStateCommandCount) ? stateCommandCount - writtenStateCommandCount : 0;
+            stateCommandCount = 0;
+            writtenStateCommandCount = 0;
         }
 
-        void Renderer::addCommand(std::unique_ptr<Command>&& command)
+        void Renderer::prepareCommand(Command::Type type)
         {
-            commandBuffer.commands.push(std::forward<std::unique_ptr<Command>>(command));
+            switch (type)
+            {
+                case Command::Type::DRAW:
+                case Command::Type::BLIT:
+                case Command::Type::COMPUTE:
+                    flushState();
+                    break;
+                case Command::Type::PRESENT:
+                case Command::Type::PUSH_DEBUG_MARKER:
+                case Command::Type::POP_DEBUG_MARKER:
+                case Command::Type::SET_RENDER_TARGET_PARAMETERS:
+                case Command::Type::SET_BUFFER_DATA:
+                    break;
+                case Command::Type::SET_TEXTURE_DATA:
+                case Command::Type::SET_TEXTURE_REGION_DATA:
+                case Command::Type::SET_TEXTURE_PARAMETERS:
+                    // the devices bind the samplers together with the textures
+                    currentStateMask &= ~TEXTURES;
+                    break;
+                default:
+                    // resource ids are reused after deletion and initialization recreates the device objects
+                    currentStateMask = 0;
+                    break;
+            }
+        }
+
+        void Renderer::flushState()
+        {
+            uint32_t changedMask = stateMask & ~currentStateMask;
+
+            if ((stateMask & CULL_MODE) && ((changedMask & CULL_MODE) || state.cullMode != currentState.cullMode))
+            {
+                commandBuffer.push(SetCullModeCommad(state.cullMode));
+                ++writtenStateCommandCount;
+                currentState.cullMode = state.cullMode;
+            }
+
+            if ((stateMask & FILL_MODE) && ((changedMask & FILL_MODE) || state.fillMode != currentState.fillMode))
+            {
+                commandBuffer.push(SetFillModeCommad(state.fillMode));
+                ++writtenStateCommandCount;
+                currentState.fillMode = state.fillMode;
+            }
+
+            if ((stateMask & SCISSOR_TEST) && ((changedMask & SCISSOR_TEST) ||
+                                               state.scissorTest != currentState.scissorTest ||
+                                               (state.scissorTest && state.scissorRectangle != currentState.scissorRectangle)))
+            {
+                commandBuffer.push(SetScissorTestCommand(state.scissorTest, state.scissorRectangle));
+                ++writtenStateCommandCount;
+                currentState.scissorTest = state.scissorTest;
+                currentState.scissorRectangle = state.scissorRectangle;
+            }
+
+            if ((stateMask & VIEWPORT) && ((changedMask & VIEWPORT) || state.viewport != currentState.viewport))
+            {
+                commandBuffer.push(SetViewportCommand(state.viewport));
+                ++writtenStateCommandCount;
+                currentState.viewport = state.viewport;
+            }
+
+            if ((stateMask & DEPTH_STENCIL_STATE) && ((changedMask & DEPTH_STENCIL_STATE) ||
+                                                      state.depthStencilState != currentState.depthStencilState))
+            {
+                commandBuffer.push(SetDepthStencilStateCommand(state.depthStencilState));
+                ++writtenStateCommandCount;
+                currentState.depthStencilState = state.depthStencilState;
+            }
+
+            if ((stateMask & PIPELINE_STATE) && ((changedMask & PIPELINE_STATE) ||
+                                                 state.blendState != currentState.blendState ||
+                                                 state.shader != currentState.shader))
+            {
+                commandBuffer.push(SetPipelineStateCommand(state.blendState, state.shader));
+                ++writtenStateCommandCount;
+
+                // the shader constants have to be set for every shader
+                if (state.shader != currentState.shader) changedMask |= SHADER_CONSTANTS;
+
+                currentState.blendState = state.blendState;
+                currentState.shader = state.shader;
+            }
+
+            if ((stateMask & SHADER_CONSTANTS) && ((changedMask & SHADER_CONSTANTS) ||
+                                                   !isConstantDataEqual(state.fragmentShaderConstants, currentState.fragmentShaderConstants) ||
+                                                   !isConstantDataEqual(state.vertexShaderConstants, currentState.vertexShaderConstants)))
+            {
+                commandBuffer.push(SetShaderConstantsCommand(state.fragmentShaderConstants, state.vertexShaderConstants));
+                ++writtenStateCommandCount;
+                currentState.fragmentShaderConstants = state.fragmentShaderConstants;
+                currentState.vertexShaderConstants = state.vertexShaderConstants;
+            }
+
+            if ((stateMask & TEXTURES) && ((changedMask & TEXTURES) ||
+                                           !std::equal(std::begin(state.textures), std::end(state.textures), std::begin(currentState.textures))))
+            {
+                commandBuffer.push(SetTexturesCommand(state.textures));
+                ++writtenStateCommandCount;
+                std::copy(std::begin(state.textures), std::end(state.textures), std::begin(currentState.textures));
+            }
+
+            currentStateMask |= stateMask;
+        }
+
+        bool Renderer::isConstantDataEqual(ConstantBlock block, const void* data, uint32_t size) const
+        {
+            if (block.size != size) return false;
+            if (size == 0) return true;
+
+            return std::memcmp(commandBuffer.getConstantData().data() + block.offset, data, size) == 0;
+        }
+
+        bool Renderer::isConstantDataEqual(ConstantBlock block, ConstantBlock otherBlock) const
+        {
+            if (block.offset == otherBlock.offset && block.size == otherBlock.size) return true;
+
+            return isConstantDataEqual(block, commandBuffer.getConstantData().data() + otherBlock.offset, otherBlock.size);
+        }
+
+        void Renderer::startCapture(const std::string& filename)
+        {
+            captureWriter.reset(new CommandTraceWriter(filename));
+        }
+
+        void Renderer::stopCapture()
+        {
+            if (captureWriter)
+            {
+                engine->log(Log::Level::INFO) << "Captured " << captureWriter->getCommandBufferCount() << " command buffers";
+                captureWriter.reset();
+            }
         }
 
         void Renderer::waitForNextFrame()
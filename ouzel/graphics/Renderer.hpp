@@ -11,6 +11,7 @@
 #include <queue>
 #include <set>
 #include <atomic>
+#include "graphics/CommandTrace.hpp"
 #include "graphics/Commands.hpp"
 #include "graphics/Driver.hpp"
 #include "graphics/RenderDevice.hpp"
@@ -18,6 +19,7 @@
 #include "math/Matrix4.hpp"
 #include "math/Size2.hpp"
 #include "math/Color.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace ouzel
 {
@@ -78,16 +80,58 @@ namespace ouzel
                       uintptr_t vertexBuffer,
                       DrawMode drawMode,
                       uint32_t startIndex);
+            // the current shader must have an instanced vertex layout
+            void drawInstanced(uintptr_t indexBuffer,
+                               uint32_t indexCount,
+                               uint32_t indexSize,
+                               uintptr_t vertexBuffer,
+                               DrawMode drawMode,
+                               uint32_t startIndex,
+                               uintptr_t instanceBuffer,
+                               uint32_t instanceCount);
             void pushDebugMarker(const std::string& name);
             void popDebugMarker();
-            void setShaderConstants(std::vector<std::vector<float>> fragmentShaderConstants,
-                                    std::vector<std::vector<float>> vertexShaderConstants);
+            void setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
+                                    const std::vector<std::vector<float>>& vertexShaderConstants);
+            // the constants must be laid out in the order of the shader's constant info without padding
+            void setShaderConstants(const void* fragmentShaderConstants,
+                                    uint32_t fragmentShaderConstantSize,
+                                    const void* vertexShaderConstants,
+                                    uint32_t vertexShaderConstantSize);
+            // blocks added during the frame can be shared by several draws
+            inline ConstantBlock addShaderConstants(const void* data, uint32_t size)
+            {
+                return commandBuffer.pushConstants(data, size);
+            }
+            void setShaderConstants(ConstantBlock fragmentShaderConstants,
+                                    ConstantBlock vertexShaderConstants);
             void setTextures(const std::vector<uintptr_t>& textures);
+            void setTextures(const uintptr_t* textures, uint32_t count);
+            // stamps the start of the frame, its record time and latency are measured from here
+            void beginFrame();
             void present();
-            void addCommand(std::unique_ptr<Command>&& command);
+
+            // writes all submitted command buffers to a trace file that can be replayed with CommandTracePlayer
+            void startCapture(const std::string& filename);
+            void stopCapture();
+            inline bool isCapturing() const { return captureWriter != nullptr; }
+
+            template<class T>
+            void addCommand(T&& command)
+            {
+                prepareCommand(command.type);
+                commandBuffer.push(std::forward<T>(command));
+            }
+
+            // number of state commands that were dropped in the last presented frame, because they didn't change the state
+            inline uint32_t getRemovedCommandCount() const { return removedCommandCount; }
 
             void waitForNextFrame();
-            inline bool getRefillQueue() const { return refillQueue; }
+            // true if a frame can be presented without waiting for the render device
+            inline bool getRefillQueue() const { return device->getFramesInFlight() < device->getMaxFramesInFlight(); }
+
+            // used to split the generation of large mip levels across cores
+            ThreadPool& getThreadPool();
 
             Vector2 convertScreenToNormalizedLocation(const Vector2& position)
             {
@@ -102,9 +146,43 @@ namespace ouzel
             }
 
         private:
+            enum StateFlags
+            {
+                RENDER_TARGET = 0x01,
+                CULL_MODE = 0x02,
+                FILL_MODE = 0x04,
+                SCISSOR_TEST = 0x08,
+                VIEWPORT = 0x10,
+                DEPTH_STENCIL_STATE = 0x20,
+                PIPELINE_STATE = 0x40,
+                SHADER_CONSTANTS = 0x80,
+                TEXTURES = 0x100
+            };
+
+            struct State final
+            {
+                uintptr_t renderTarget = 0;
+                CullMode cullMode = CullMode::NONE;
+                FillMode fillMode = FillMode::SOLID;
+                bool scissorTest = false;
+                Rect scissorRectangle;
+                Rect viewport;
+                uintptr_t depthStencilState = 0;
+                uintptr_t blendState = 0;
+                uintptr_t shader = 0;
+                ConstantBlock fragmentShaderConstants;
+                ConstantBlock vertexShaderConstants;
+                uintptr_t textures[Texture::LAYERS] = {};
+            };
+
             void handleEvent(const RenderDevice::Event& event);
             void setSize(const Size2& newSize);
 
+            void prepareCommand(Command::Type type);
+            void flushState();
+            bool isConstantDataEqual(ConstantBlock block, const void* data, uint32_t size) const;
+            bool isConstantDataEqual(ConstantBlock block, ConstantBlock otherBlock) const;
+
             std::unique_ptr<RenderDevice> device;
 
             Size2 size;
@@ -113,11 +191,25 @@ namespace ouzel
             bool clearColorBuffer = true;
             bool clearDepthBuffer = false;
             CommandBuffer commandBuffer;
+            std::vector<float> fragmentShaderData;
+            std::vector<float> vertexShaderData;
+
+            // state commands are written to the command buffer before the next draw and only if they change the state
+            State state; // state set by the last calls
+            uint32_t stateMask = 0; // state that has been set
+            State currentState; // state in the command buffer
+            uint32_t currentStateMask = 0; // state that is known to be current on the device
+            uint32_t stateCommandCount = 0;
+            uint32_t writtenStateCommandCount = 0;
+            uint32_t removedCommandCount = 0;
+            std::unique_ptr<CommandTraceWriter> captureWriter;
 
             bool newFrame = false;
             std::mutex frameMutex;
             std::condition_variable frameCondition;
-            std::atomic_bool refillQueue;
+
+            std::unique_ptr<ThreadPool> threadPool;
+            std::mutex threadPoolMutex;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -0,0 +1,27 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_RESOURCETYPE_HPP
+#define OUZEL_GRAPHICS_RESOURCETYPE_HPP
+
+#include <cstdint>
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // every type has its own resource handles
+        enum class ResourceType
+        {
+            BLEND_STATE,
+            BUFFER,
+            DEPTH_STENCIL_STATE,
+            RENDER_TARGET,
+            SHADER,
+            TEXTURE
+        };
+
+        static constexpr uint32_t RESOURCE_TYPE_COUNT = static_cast<uint32_t>(ResourceType::TEXTURE) + 1;
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_RESOURCETYPE_HPP
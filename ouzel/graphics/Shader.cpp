@@ -10,7 +10,7 @@ namespace ouzel
     {
         Shader::Shader(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::SHADER))
         {
         }
 
@@ -24,29 +24,52 @@ namespace ouzel
                        uint32_t initVertexShaderDataAlignment,
                        const std::string& fragmentShaderFunction,
                        const std::string& vertexShaderFunction):
+            Shader(initRenderer,
+                   initFragmentShader,
+                   initVertexShader,
+                   VertexLayout(initVertexAttributes),
+                   initFragmentShaderConstantInfo,
+                   initVertexShaderConstantInfo,
+                   initFragmentShaderDataAlignment,
+                   initVertexShaderDataAlignment,
+                   fragmentShaderFunction,
+                   vertexShaderFunction)
+        {
+        }
+
+        Shader::Shader(Renderer& initRenderer,
+                       const std::vector<uint8_t>& initFragmentShader,
+                       const std::vector<uint8_t>& initVertexShader,
+                       const VertexLayout& initVertexLayout,
+                       const std::vector<ConstantInfo>& initFragmentShaderConstantInfo,
+                       const std::vector<ConstantInfo>& initVertexShaderConstantInfo,
+                       uint32_t initFragmentShaderDataAlignment,
+                       uint32_t initVertexShaderDataAlignment,
+                       const std::string& fragmentShaderFunction,
+                       const std::string& vertexShaderFunction):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
-            vertexAttributes(initVertexAttributes)
+            resource(renderer.getDevice()->getResourceId(ResourceType::SHADER)),
+            vertexLayout(initVertexLayout)
         {
-            renderer.addCommand(std::unique_ptr<Command>(new InitShaderCommand(resource,
-                                                                               initFragmentShader,
-                                                                               initVertexShader,
-                                                                               initVertexAttributes,
-                                                                               initFragmentShaderConstantInfo,
-                                                                               initVertexShaderConstantInfo,
-                                                                               initFragmentShaderDataAlignment,
-                                                                               initVertexShaderDataAlignment,
-                                                                               fragmentShaderFunction,
-                                                                               vertexShaderFunction)));
+            renderer.addCommand(InitShaderCommand(resource,
+                                                  initFragmentShader,
+                                                  initVertexShader,
+                                                  initVertexLayout,
+                                                  initFragmentShaderConstantInfo,
+                                                  initVertexShaderConstantInfo,
+                                                  initFragmentShaderDataAlignment,
+                                                  initVertexShaderDataAlignment,
+                                                  fragmentShaderFunction,
+                                                  vertexShaderFunction));
         }
 
         Shader::~Shader()
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::SHADER, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::SHADER, resource);
             }
         }
 
@@ -60,23 +83,49 @@ namespace ouzel
                           const std::string& fragmentShaderFunction,
                           const std::string& vertexShaderFunction)
         {
-            vertexAttributes = newVertexAttributes;
+            init(newFragmentShader,
+                 newVertexShader,
+                 VertexLayout(newVertexAttributes),
+                 newFragmentShaderConstantInfo,
+                 newVertexShaderConstantInfo,
+                 newFragmentShaderDataAlignment,
+                 newVertexShaderDataAlignment,
+                 fragmentShaderFunction,
+                 vertexShaderFunction);
+        }
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitShaderCommand(resource,
-                                                                               newFragmentShader,
-                                                                               newVertexShader,
-                                                                               newVertexAttributes,
-                                                                               newFragmentShaderConstantInfo,
-                                                                               newVertexShaderConstantInfo,
-                                                                               newFragmentShaderDataAlignment,
-                                                                               newVertexShaderDataAlignment,
-                                                                               fragmentShaderFunction,
-                                                                               vertexShaderFunction)));
+        void Shader::init(const std::vector<uint8_t>& newFragmentShader,
+                          const std::vector<uint8_t>& newVertexShader,
+                          const VertexLayout& newVertexLayout,
+                          const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
+                          const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
+                          uint32_t newFragmentShaderDataAlignment,
+                          uint32_t newVertexShaderDataAlignment,
+                          const std::string& fragmentShaderFunction,
+                          const std::string& vertexShaderFunction)
+        {
+            vertexLayout = newVertexLayout;
+
+            renderer.addCommand(InitShaderCommand(resource,
+                                                  newFragmentShader,
+                                                  newVertexShader,
+                                                  newVertexLayout,
+                                                  newFragmentShaderConstantInfo,
+                                                  newVertexShaderConstantInfo,
+                                                  newFragmentShaderDataAlignment,
+                                                  newVertexShaderDataAlignment,
+                                                  fragmentShaderFunction,
+                                                  vertexShaderFunction));
         }
 
-        const std::set<Vertex::Attribute::Usage>& Shader::getVertexAttributes() const
+        std::set<Vertex::Attribute::Usage> Shader::getVertexAttributes() const
         {
-            return vertexAttributes;
+            std::set<Vertex::Attribute::Usage> result;
+
+            for (const VertexLayout::Element& element : vertexLayout.getElements())
+                result.insert(element.usage);
+
+            return result;
         }
     } // namespace graphics
 } // namespace ouzel
@@ -9,6 +9,7 @@
 #include <vector>
 #include "graphics/DataType.hpp"
 #include "graphics/Vertex.hpp"
+#include "graphics/VertexLayout.hpp"
 
 namespace ouzel
 {
@@ -41,6 +42,16 @@ namespace ouzel
                    uint32_t initVertexShaderDataAlignment = 0,
                    const std::string& fragmentShaderFunction = "",
                    const std::string& vertexShaderFunction = "");
+            Shader(Renderer& initRenderer,
+                   const std::vector<uint8_t>& initFragmentShader,
+                   const std::vector<uint8_t>& initVertexShader,
+                   const VertexLayout& initVertexLayout,
+                   const std::vector<ConstantInfo>& initFragmentShaderConstantInfo,
+                   const std::vector<ConstantInfo>& initVertexShaderConstantInfo,
+                   uint32_t initFragmentShaderDataAlignment = 0,
+                   uint32_t initVertexShaderDataAlignment = 0,
+                   const std::string& fragmentShaderFunction = "",
+                   const std::string& vertexShaderFunction = "");
             ~Shader();
 
             Shader(const Shader&) = delete;
@@ -58,16 +69,27 @@ namespace ouzel
                       uint32_t newVertexShaderDataAlignment = 0,
                       const std::string& fragmentShaderFunction = "",
                       const std::string& vertexShaderFunction = "");
+            void init(const std::vector<uint8_t>& newFragmentShader,
+                      const std::vector<uint8_t>& newVertexShader,
+                      const VertexLayout& newVertexLayout,
+                      const std::vector<ConstantInfo>& newFragmentShaderConstantInfo,
+                      const std::vector<ConstantInfo>& newVertexShaderConstantInfo,
+                      uint32_t newFragmentShaderDataAlignment = 0,
+                      uint32_t newVertexShaderDataAlignment = 0,
+                      const std::string& fragmentShaderFunction = "",
+                      const std::string& vertexShaderFunction = "");
 
             inline uintptr_t getResource() const { return resource; }
 
-            const std::set<Vertex::Attribute::Usage>& getVertexAttributes() const;
+            inline const VertexLayout& getVertexLayout() const { return vertexLayout; }
+            // usages of the vertex layout's attributes
+            std::set<Vertex::Attribute::Usage> getVertexAttributes() const;
 
         private:
             Renderer& renderer;
             uintptr_t resource = 0;
 
-            std::set<Vertex::Attribute::Usage> vertexAttributes;
+            VertexLayout vertexLayout;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -1,210 +1,196 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <stdexcept>
+#include "core/Setup.h"
+#if OUZEL_SUPPORTS_NEON
+#include <arm_neon.h>
+#elif OUZEL_SUPPORTS_SSE
+#include <xmmintrin.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#endif
 #include "Texture.hpp"
 #include "Renderer.hpp"
 #include "RenderDevice.hpp"
+#include "utils/Utils.hpp"
 
 extern uint8_t GAMMA_ENCODE[256];
-extern float GAMMA_DECODE[256];
+extern uint8_t GAMMA_DECODE[256];
 
 namespace ouzel
 {
     namespace graphics
     {
-        static void imageA8Downsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
+        static inline bool isSimdAvailable()
         {
-            const uint32_t dstWidth = width >> 1;
-            const uint32_t dstHeight = height >> 1;
+#if OUZEL_SUPPORTS_NEON_CHECK
+            return anrdoidNEONChecker.isNEONAvailable();
+#else
+            return true;
+#endif
+        }
 
-            if (dstWidth > 0 && dstHeight > 0)
+        // averages every channel of the 2x2 blocks of the rows src0 and src1, returns the number of the written pixels
+        template<uint32_t pixelSize>
+        static uint32_t imageBoxDownsampleRowSimd(uint32_t dstWidth, const uint8_t* src0, const uint8_t* src1, uint8_t* dst, uint16_t bias)
+        {
+            uint32_t x = 0;
+
+#if OUZEL_SUPPORTS_NEON
+            if (isSimdAvailable())
             {
-                uint32_t y;
-                uint32_t ystep;
+                uint16x8_t biasVector = vdupq_n_u16(bias);
 
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep)
+                // 16 source pixels of each row give 8 destination pixels
+                for (; x + 8 <= dstWidth; x += 8, src0 += 16 * pixelSize, src1 += 16 * pixelSize, dst += 8 * pixelSize)
                 {
-                    const uint8_t* pixel = src;
-                    for (uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
+                    switch (pixelSize)
                     {
-                        float a = 0.0F;
-                        a += pixel[0];
-                        a += pixel[1];
-                        a += pixel[pitch + 0];
-                        a += pixel[pitch + 1];
-                        a /= 4.0F;
-                        dst[0] = static_cast<uint8_t>(a);
+                        case 1:
+                        {
+                            uint16x8_t sum = vpadalq_u8(vpaddlq_u8(vld1q_u8(src0)), vld1q_u8(src1));
+                            vst1_u8(dst, vshrn_n_u16(vaddq_u16(sum, biasVector), 2));
+                            break;
+                        }
+                        case 2:
+                        {
+                            uint8x16x2_t row0 = vld2q_u8(src0);
+                            uint8x16x2_t row1 = vld2q_u8(src1);
+                            uint8x8x2_t result;
+                            for (int c = 0; c < 2; ++c)
+                            {
+                                uint16x8_t sum = vpadalq_u8(vpaddlq_u8(row0.val[c]), row1.val[c]);
+                                result.val[c] = vshrn_n_u16(vaddq_u16(sum, biasVector), 2);
+                            }
+                            vst2_u8(dst, result);
+                            break;
+                        }
+                        case 4:
+                        {
+                            uint8x16x4_t row0 = vld4q_u8(src0);
+                            uint8x16x4_t row1 = vld4q_u8(src1);
+                            uint8x8x4_t result;
+                            for (int c = 0; c < 4; ++c)
+                            {
+                                uint16x8_t sum = vpadalq_u8(vpaddlq_u8(row0.val[c]), row1.val[c]);
+                                result.val[c] = vshrn_n_u16(vaddq_u16(sum, biasVector), 2);
+                            }
+                            vst4_u8(dst, result);
+                            break;
+                        }
                     }
                 }
             }
-            else if (dstHeight > 0)
+#elif OUZEL_SUPPORTS_SSE && defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i ones = _mm_set1_epi16(1);
+            const __m128i biasVector = _mm_set1_epi16(static_cast<short>(bias));
+
+            // 16 bytes of each row give 8 bytes of the destination
+            const uint32_t step = 8 / pixelSize;
+            for (; x + step <= dstWidth; x += step, src0 += 16, src1 += 16, dst += 8)
             {
-                uint32_t y;
-                uint32_t ystep;
+                __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0));
+                __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1));
 
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep, dst += 1)
-                {
-                    const uint8_t* pixel = src;
+                // vertical sums of the first and the second 8 bytes
+                __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+                __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
 
-                    float a = 0.0F;
-                    a += pixel[0];
-                    a += pixel[pitch + 0];
-                    a /= 2.0F;
-                    dst[0] = static_cast<uint8_t>(a);
-                }
-            }
-            else if (dstWidth > 0)
-            {
-                const uint8_t* pixel = src;
-                for (uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
+                __m128i sum;
+                if (pixelSize == 4)
+                    sum = _mm_unpacklo_epi64(_mm_add_epi16(low, _mm_srli_si128(low, 8)),
+                                             _mm_add_epi16(high, _mm_srli_si128(high, 8)));
+                else
                 {
-                    float a = 0.0F;
-                    a += pixel[0];
-                    a += pixel[1];
-                    a /= 2.0F;
-                    dst[0] = static_cast<uint8_t>(a);
+                    if (pixelSize == 2)
+                    {
+                        // group the same channels of the neighbouring pixels before adding them together
+                        low = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+                        high = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+                    }
+
+                    sum = _mm_packs_epi32(_mm_madd_epi16(low, ones), _mm_madd_epi16(high, ones));
                 }
+
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, biasVector), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(sum, sum));
             }
+#else
+            (void)dstWidth;
+            (void)src0;
+            (void)src1;
+            (void)dst;
+            (void)bias;
+#endif
+
+            return x;
         }
 
-        static void imageR8Downsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
+        // averages all channels without gamma correction, used for alpha, linear and premultiplied data
+        template<uint32_t pixelSize, bool round>
+        static void imageBoxDownsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
         {
             const uint32_t dstWidth = width >> 1;
             const uint32_t dstHeight = height >> 1;
+            const uint32_t bias = round ? 2 : 0;
 
             if (dstWidth > 0 && dstHeight > 0)
             {
-                uint32_t y;
-                uint32_t ystep;
-
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep)
+                for (uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += dstWidth * pixelSize)
                 {
-                    const uint8_t* pixel = src;
-                    for (uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                    {
-                        float r = 0.0F;
-                        r += GAMMA_DECODE[pixel[0]];
-                        r += GAMMA_DECODE[pixel[1]];
-                        r += GAMMA_DECODE[pixel[pitch + 0]];
-                        r += GAMMA_DECODE[pixel[pitch + 1]];
-                        r /= 4.0F;
-                        dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                    }
+                    uint32_t x = imageBoxDownsampleRowSimd<pixelSize>(dstWidth, src, src + pitch, dst, bias);
+
+                    const uint8_t* pixel = src + x * 2 * pixelSize;
+                    for (; x < dstWidth; ++x, pixel += 2 * pixelSize)
+                        for (uint32_t c = 0; c < pixelSize; ++c)
+                            dst[x * pixelSize + c] = static_cast<uint8_t>((pixel[c] + pixel[pixelSize + c] +
+                                                                           pixel[pitch + c] + pixel[pitch + pixelSize + c] +
+                                                                           bias) >> 2);
                 }
             }
             else if (dstHeight > 0)
             {
-                uint32_t y;
-                uint32_t ystep;
-
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep, dst += 1)
-                {
-                    const uint8_t* pixel = src;
-
-                    float r = 0.0F;
-                    r += GAMMA_DECODE[pixel[0]];
-                    r += GAMMA_DECODE[pixel[pitch + 0]];
-                    r /= 2.0F;
-                    dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                }
+                for (uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += pixelSize)
+                    for (uint32_t c = 0; c < pixelSize; ++c)
+                        dst[c] = static_cast<uint8_t>((src[c] + src[pitch + c] + (bias >> 1)) >> 1);
             }
             else if (dstWidth > 0)
             {
                 const uint8_t* pixel = src;
-                for (uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                {
-                    float r = 0.0F;
-                    r += GAMMA_DECODE[pixel[0]];
-                    r += GAMMA_DECODE[pixel[1]];
-                    r /= 2.0F;
-                    dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                }
+                for (uint32_t x = 0; x < dstWidth; ++x, pixel += 2 * pixelSize, dst += pixelSize)
+                    for (uint32_t c = 0; c < pixelSize; ++c)
+                        dst[c] = static_cast<uint8_t>((pixel[c] + pixel[pixelSize + c] + (bias >> 1)) >> 1);
             }
         }
 
-        static void imageRG8Downsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
+        // gamma correct average of all channels, the decoded rows are averaged by the box filter
+        template<uint32_t pixelSize>
+        static void imageGammaDownsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
         {
-            const uint32_t dstWidth = width >> 1;
-            const uint32_t dstHeight = height >> 1;
-
-            if (dstWidth > 0 && dstHeight > 0)
-            {
-                uint32_t y;
-                uint32_t ystep;
-
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep)
-                {
-                    const uint8_t* pixel = src;
-                    for (uint32_t x = 0; x < dstWidth; ++x, pixel += 4, dst += 2)
-                    {
-                        float r = 0.0F;
-                        float g = 0.0F;
-
-                        r += GAMMA_DECODE[pixel[0]];
-                        g += GAMMA_DECODE[pixel[1]];
-
-                        r += GAMMA_DECODE[pixel[2]];
-                        g += GAMMA_DECODE[pixel[3]];
-
-                        r += GAMMA_DECODE[pixel[pitch + 0]];
-                        g += GAMMA_DECODE[pixel[pitch + 1]];
-
-                        r += GAMMA_DECODE[pixel[pitch + 2]];
-                        g += GAMMA_DECODE[pixel[pitch + 3]];
-
-                        r /= 4.0F;
-                        g /= 4.0F;
-
-                        r = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                        g = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                        dst[0] = static_cast<uint8_t>(r);
-                        dst[1] = static_cast<uint8_t>(g);
-                    }
-                }
-            }
-            else if (dstHeight > 0)
-            {
-                uint32_t y;
-                uint32_t ystep;
-                for (y = 0, ystep = pitch * 2; y < dstHeight; ++y, src += ystep, dst += 2)
-                {
-                    const uint8_t* pixel = src;
-                    float r = 0.0F;
-                    float g = 0.0F;
-
-                    r += GAMMA_DECODE[pixel[0]];
-                    g += GAMMA_DECODE[pixel[1]];
+            if (width < 2 && height < 2) return;
 
-                    r += GAMMA_DECODE[pixel[pitch + 0]];
-                    g += GAMMA_DECODE[pixel[pitch + 1]];
+            const uint32_t srcRows = (height > 1) ? 2 : 1;
+            const uint32_t dstHeight = (height > 1) ? height >> 1 : 1;
+            const uint32_t rowSize = ((width > 1) ? width & ~1U : 1) * pixelSize;
+            const uint32_t dstRowSize = ((width > 1) ? width >> 1 : 1) * pixelSize;
 
-                    r /= 2.0F;
-                    g /= 2.0F;
+            std::vector<uint8_t> decoded(rowSize * srcRows);
 
-                    dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                    dst[1] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                }
-            }
-            else if (dstWidth > 0)
+            for (uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += dstRowSize)
             {
-                const uint8_t* pixel = src;
-                for (uint32_t x = 0; x < dstWidth; ++x, pixel += 4, dst += 2)
-                {
-                    float r = 0.0F;
-                    float g = 0.0F;
-
-                    r += GAMMA_DECODE[pixel[0]];
-                    g += GAMMA_DECODE[pixel[1]];
+                for (uint32_t row = 0; row < srcRows; ++row)
+                    for (uint32_t i = 0; i < rowSize; ++i)
+                        decoded[row * rowSize + i] = GAMMA_DECODE[src[row * pitch + i]];
 
-                    r += GAMMA_DECODE[pixel[2]];
-                    g += GAMMA_DECODE[pixel[3]];
+                imageBoxDownsample2x2<pixelSize, true>(width, srcRows, rowSize, decoded.data(), dst);
 
-                    r /= 2.0F;
-                    g /= 2.0F;
-
-                    dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                    dst[1] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                }
+                for (uint32_t i = 0; i < dstRowSize; ++i)
+                    dst[i] = GAMMA_ENCODE[dst[i]];
             }
         }
 
@@ -222,18 +208,18 @@ namespace ouzel
                     const uint8_t* pixel = src;
                     for (uint32_t x = 0; x < dstWidth; ++x, pixel += 8, dst += 4)
                     {
-                        float pixels = 0.0F;
-                        float r = 0.0F;
-                        float g = 0.0F;
-                        float b = 0.0F;
-                        float a = 0.0F;
+                        uint32_t pixels = 0;
+                        uint32_t r = 0;
+                        uint32_t g = 0;
+                        uint32_t b = 0;
+                        uint32_t a = 0;
 
                         if (pixel[3] > 0)
                         {
                             r += GAMMA_DECODE[pixel[0]];
                             g += GAMMA_DECODE[pixel[1]];
                             b += GAMMA_DECODE[pixel[2]];
-                            pixels += 1.0F;
+                            ++pixels;
                         }
                         a += pixel[3];
 
@@ -242,7 +228,7 @@ namespace ouzel
                             r += GAMMA_DECODE[pixel[4]];
                             g += GAMMA_DECODE[pixel[5]];
                             b += GAMMA_DECODE[pixel[6]];
-                            pixels += 1.0F;
+                            ++pixels;
                         }
                         a += pixel[7];
 
@@ -251,7 +237,7 @@ namespace ouzel
                             r += GAMMA_DECODE[pixel[pitch + 0]];
                             g += GAMMA_DECODE[pixel[pitch + 1]];
                             b += GAMMA_DECODE[pixel[pitch + 2]];
-                            pixels += 1.0F;
+                            ++pixels;
                         }
                         a += pixel[pitch + 3];
 
@@ -260,20 +246,16 @@ namespace ouzel
                             r += GAMMA_DECODE[pixel[pitch + 4]];
                             g += GAMMA_DECODE[pixel[pitch + 5]];
                             b += GAMMA_DECODE[pixel[pitch + 6]];
-                            pixels += 1.0F;
+                            ++pixels;
                         }
                         a += pixel[pitch + 7];
 
-                        if (pixels > 0.0F)
+                        if (pixels > 0)
                         {
-                            r /= pixels;
-                            g /= pixels;
-                            b /= pixels;
-                            a *= 0.25F;
-                            dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                            dst[1] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                            dst[2] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(b))];
-                            dst[3] = static_cast<uint8_t>(a);
+                            dst[0] = GAMMA_ENCODE[(r + pixels / 2) / pixels];
+                            dst[1] = GAMMA_ENCODE[(g + pixels / 2) / pixels];
+                            dst[2] = GAMMA_ENCODE[(b + pixels / 2) / pixels];
+                            dst[3] = static_cast<uint8_t>(a >> 2);
                         }
                         else
                         {
@@ -294,18 +276,18 @@ namespace ouzel
                 {
                     const uint8_t* pixel = src;
 
-                    float pixels = 0.0F;
-                    float r = 0.0F;
-                    float g = 0.0F;
-                    float b = 0.0F;
-                    float a = 0.0F;
+                    uint32_t pixels = 0;
+                    uint32_t r = 0;
+                    uint32_t g = 0;
+                    uint32_t b = 0;
+                    uint32_t a = 0;
 
                     if (pixel[3] > 0)
                     {
                         r += GAMMA_DECODE[pixel[0]];
                         g += GAMMA_DECODE[pixel[1]];
                         b += GAMMA_DECODE[pixel[2]];
-                        pixels += 1.0F;
+                        ++pixels;
                     }
                     a = pixel[3];
 
@@ -314,20 +296,16 @@ namespace ouzel
                         r += GAMMA_DECODE[pixel[pitch + 0]];
                         g += GAMMA_DECODE[pixel[pitch + 1]];
                         b += GAMMA_DECODE[pixel[pitch + 2]];
-                        pixels += 1.0F;
+                        ++pixels;
                     }
                     a += pixel[pitch + 3];
 
-                    if (pixels > 0.0F)
+                    if (pixels > 0)
                     {
-                        r /= pixels;
-                        g /= pixels;
-                        b /= pixels;
-                        a *= 0.5F;
-                        dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                        dst[1] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                        dst[2] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(b))];
-                        dst[3] = static_cast<uint8_t>(a);
+                        dst[0] = GAMMA_ENCODE[(r + pixels / 2) / pixels];
+                        dst[1] = GAMMA_ENCODE[(g + pixels / 2) / pixels];
+                        dst[2] = GAMMA_ENCODE[(b + pixels / 2) / pixels];
+                        dst[3] = static_cast<uint8_t>(a >> 1);
                     }
                     else
                     {
@@ -343,18 +321,18 @@ namespace ouzel
                 const uint8_t* pixel = src;
                 for (uint32_t x = 0; x < dstWidth; ++x, pixel += 8, dst += 4)
                 {
-                    float pixels = 0.0F;
-                    float r = 0.0F;
-                    float g = 0.0F;
-                    float b = 0.0F;
-                    float a = 0.0F;
+                    uint32_t pixels = 0;
+                    uint32_t r = 0;
+                    uint32_t g = 0;
+                    uint32_t b = 0;
+                    uint32_t a = 0;
 
                     if (pixel[3] > 0)
                     {
                         r += GAMMA_DECODE[pixel[0]];
                         g += GAMMA_DECODE[pixel[1]];
                         b += GAMMA_DECODE[pixel[2]];
-                        pixels += 1.0F;
+                        ++pixels;
                     }
                     a += pixel[3];
 
@@ -363,20 +341,16 @@ namespace ouzel
                         r += GAMMA_DECODE[pixel[4]];
                         g += GAMMA_DECODE[pixel[5]];
                         b += GAMMA_DECODE[pixel[6]];
-                        pixels += 1.0F;
+                        ++pixels;
                     }
                     a += pixel[7];
 
-                    if (pixels > 0.0F)
+                    if (pixels > 0)
                     {
-                        r /= pixels;
-                        g /= pixels;
-                        b /= pixels;
-                        a *= 0.5F;
-                        dst[0] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(r))];
-                        dst[1] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(g))];
-                        dst[2] = GAMMA_ENCODE[static_cast<uint8_t>(roundf(b))];
-                        dst[3] = static_cast<uint8_t>(a);
+                        dst[0] = GAMMA_ENCODE[(r + pixels / 2) / pixels];
+                        dst[1] = GAMMA_ENCODE[(g + pixels / 2) / pixels];
+                        dst[2] = GAMMA_ENCODE[(b + pixels / 2) / pixels];
+                        dst[3] = static_cast<uint8_t>(a >> 1);
                     }
                     else
                     {
@@ -389,9 +363,73 @@ namespace ouzel
             }
         }
 
-        static std::vector<Texture::Level> calculateSizes(const Size2& size,
+        typedef void (*DownsampleFunction)(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst);
+
+        static DownsampleFunction getDownsampleFunction(PixelFormat pixelFormat, bool linear)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::RGBA8_UNORM:
+                    return linear ? imageBoxDownsample2x2<4, true> : imageRGBA8Downsample2x2;
+                case PixelFormat::RG8_UNORM:
+                    return linear ? imageBoxDownsample2x2<2, true> : imageGammaDownsample2x2<2>;
+                case PixelFormat::R8_UNORM:
+                    return linear ? imageBoxDownsample2x2<1, true> : imageGammaDownsample2x2<1>;
+                case PixelFormat::A8_UNORM:
+                    return imageBoxDownsample2x2<1, false>;
+                default:
+                    throw std::runtime_error("Invalid pixel format");
+            }
+        }
+
+        // levels smaller than this are not worth handing to other threads
+        static const uint32_t MIN_BAND_SIZE = 64 * 1024;
+
+        static void downsample(Renderer& renderer, DownsampleFunction function,
+                               uint32_t width, uint32_t height, uint32_t pitch, uint32_t dstPitch,
+                               const uint8_t* src, uint8_t* dst)
+        {
+            const uint32_t dstHeight = height >> 1;
+            uint32_t bands = std::min(dstHeight, dstPitch * dstHeight / MIN_BAND_SIZE);
+
+            if (bands > 1)
+                bands = std::min(bands, renderer.getThreadPool().getThreadCount() + 1);
+
+            if (bands <= 1)
+            {
+                function(width, height, pitch, src, dst);
+                return;
+            }
+
+            // every band writes its own destination rows, the first one is processed by the calling thread
+            std::mutex bandMutex;
+            std::condition_variable bandCondition;
+            uint32_t remainingBands = bands - 1;
+
+            for (uint32_t band = 1; band < bands; ++band)
+            {
+                const uint32_t firstRow = dstHeight * band / bands;
+                const uint32_t lastRow = dstHeight * (band + 1) / bands;
+
+                renderer.getThreadPool().run([&, firstRow, lastRow]() {
+                    function(width, (lastRow - firstRow) * 2, pitch, src + firstRow * 2 * pitch, dst + firstRow * dstPitch);
+
+                    std::unique_lock<std::mutex> lock(bandMutex);
+                    if (--remainingBands == 0) bandCondition.notify_all();
+                });
+            }
+
+            function(width, (dstHeight / bands) * 2, pitch, src, dst);
+
+            std::unique_lock<std::mutex> lock(bandMutex);
+            while (remainingBands > 0) bandCondition.wait(lock);
+        }
+
+        static std::vector<Texture::Level> calculateSizes(Renderer& renderer,
+                                                          const Size2& size,
                                                           const std::vector<uint8_t>& data,
                                                           uint32_t mipmaps,
+                                                          uint32_t flags,
                                                           PixelFormat pixelFormat)
         {
             std::vector<Texture::Level> levels;
@@ -399,9 +437,8 @@ namespace ouzel
             uint32_t newWidth = static_cast<uint32_t>(size.width);
             uint32_t newHeight = static_cast<uint32_t>(size.height);
 
-            uint32_t pixelSize = getPixelSize(pixelFormat);
-            uint32_t pitch = newWidth * pixelSize;
-            uint32_t bufferSize = pitch * newHeight;
+            uint32_t pitch = static_cast<uint32_t>(getRowPitch(pixelFormat, newWidth));
+            size_t bufferSize = getLevelSize(pixelFormat, newWidth, newHeight);
             if (data.empty())
                 levels.push_back({size, pitch, std::vector<uint8_t>(bufferSize)});
             else
@@ -410,7 +447,6 @@ namespace ouzel
             uint32_t previousWidth = newWidth;
             uint32_t previousHeight = newHeight;
             uint32_t previousPitch = pitch;
-            std::vector<uint8_t> previousData = data;
 
             while ((newWidth > 1 || newHeight > 1) &&
                    (mipmaps == 0 || levels.size() < mipmaps))
@@ -422,8 +458,8 @@ namespace ouzel
                 if (newHeight < 1) newHeight = 1;
 
                 Size2 mipMapSize = Size2(static_cast<float>(newWidth), static_cast<float>(newHeight));
-                pitch = newWidth * pixelSize;
-                bufferSize = pitch * newHeight;
+                pitch = static_cast<uint32_t>(getRowPitch(pixelFormat, newWidth));
+                bufferSize = getLevelSize(pixelFormat, newWidth, newHeight);
 
                 if (data.empty())
                     levels.push_back({mipMapSize, pitch, std::vector<uint8_t>(bufferSize)});
@@ -431,48 +467,66 @@ namespace ouzel
                 {
                     std::vector<uint8_t> newData(bufferSize);
 
-                    switch (pixelFormat)
-                    {
-                        case PixelFormat::RGBA8_UNORM:
-                            imageRGBA8Downsample2x2(previousWidth, previousHeight, previousPitch,
-                                                    previousData.data(), newData.data());
-                            break;
+                    // each level is generated from the previous one
+                    downsample(renderer, getDownsampleFunction(pixelFormat, (flags & Texture::LINEAR_MIPMAPS) != 0),
+                               previousWidth, previousHeight, previousPitch, pitch,
+                               levels.back().data.data(), newData.data());
 
-                        case PixelFormat::RG8_UNORM:
-                            imageRG8Downsample2x2(previousWidth, previousHeight, previousPitch,
-                                                  previousData.data(), newData.data());
-                            break;
+                    levels.push_back({mipMapSize, pitch, std::move(newData)});
+                }
 
-                        case PixelFormat::R8_UNORM:
-                            imageR8Downsample2x2(previousWidth, previousHeight, previousPitch,
-                                                 previousData.data(), newData.data());
-                            break;
+                previousWidth = newWidth;
+                previousHeight = newHeight;
+                previousPitch = pitch;
+            }
 
-                        case PixelFormat::A8_UNORM:
-                            imageA8Downsample2x2(previousWidth, previousHeight, previousPitch,
-                                                 previousData.data(), newData.data());
-                            break;
+            return levels;
+        }
 
-                        default:
-                            throw std::runtime_error("Invalid pixel format");
-                    }
+        // A8 textures are sampled as white with the stored alpha, the devices that can't do it get them as RGBA8
+        static bool isAlphaExpanded(Renderer& renderer, PixelFormat pixelFormat)
+        {
+            return pixelFormat == PixelFormat::A8_UNORM && !renderer.getDevice()->isAlphaTexturesSupported();
+        }
+
+        static std::vector<uint8_t> expandAlpha(const uint8_t* data, uint32_t width, uint32_t height, uint32_t pitch)
+        {
+            std::vector<uint8_t> result(static_cast<size_t>(width) * height * 4, 255);
 
-                    levels.push_back({mipMapSize, pitch, newData});
+            for (uint32_t y = 0; y < height; ++y)
+                for (uint32_t x = 0; x < width; ++x)
+                    result[(static_cast<size_t>(y) * width + x) * 4 + 3] = data[static_cast<size_t>(y) * pitch + x];
 
-                    previousData = std::move(newData);
+            return result;
+        }
+
+        // returns the pixel format of the levels that are sent to the device
+        static PixelFormat prepareLevels(Renderer& renderer, std::vector<Texture::Level>& levels, PixelFormat pixelFormat)
+        {
+            if (!isAlphaExpanded(renderer, pixelFormat)) return pixelFormat;
+
+            for (Texture::Level& level : levels)
+            {
+                uint32_t width = static_cast<uint32_t>(level.size.width);
+                uint32_t height = static_cast<uint32_t>(level.size.height);
+
+                if (!level.data.empty())
+                {
+                    if (level.data.size() < static_cast<size_t>(level.pitch) * (height - 1) + width)
+                        throw std::runtime_error("Invalid level size");
+
+                    level.data = expandAlpha(level.data.data(), width, height, level.pitch);
                 }
 
-                previousWidth = newWidth;
-                previousHeight = newHeight;
-                previousPitch = pitch;
+                level.pitch = width * 4;
             }
 
-            return levels;
+            return PixelFormat::RGBA8_UNORM;
         }
 
         Texture::Texture(Renderer& initRenderer):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId())
+            resource(renderer.getDevice()->getResourceId(ResourceType::TEXTURE))
         {
         }
 
@@ -483,7 +537,7 @@ namespace ouzel
                          uint32_t initSampleCount,
                          PixelFormat initPixelFormat):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::TEXTURE)),
             size(initSize),
             flags(initFlags),
             mipmaps(initMipmaps),
@@ -497,13 +551,15 @@ namespace ouzel
                 (!isPOT(static_cast<uint32_t>(size.width)) || isPOT(static_cast<uint32_t>(size.height))))
                 mipmaps = 1;
 
-            std::vector<Level> levels = calculateSizes(size, std::vector<uint8_t>(), mipmaps, pixelFormat);
+            std::vector<Level> levels = calculateSizes(renderer, size, std::vector<uint8_t>(), mipmaps, flags, pixelFormat);
+
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         Texture::Texture(Renderer& initRenderer,
@@ -513,7 +569,7 @@ namespace ouzel
                          uint32_t initMipmaps,
                          PixelFormat initPixelFormat):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::TEXTURE)),
             size(initSize),
             flags(initFlags),
             mipmaps(initMipmaps),
@@ -527,13 +583,15 @@ namespace ouzel
                 (!isPOT(static_cast<uint32_t>(size.width)) || isPOT(static_cast<uint32_t>(size.height))))
                 mipmaps = 1;
 
-            std::vector<Level> levels = calculateSizes(size, initData, mipmaps, pixelFormat);
+            std::vector<Level> levels = calculateSizes(renderer, size, initData, mipmaps, flags, pixelFormat);
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
+
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         Texture::Texture(Renderer& initRenderer,
@@ -542,7 +600,7 @@ namespace ouzel
                          uint32_t initFlags,
                          PixelFormat initPixelFormat):
             renderer(initRenderer),
-            resource(renderer.getDevice()->getResourceId()),
+            resource(renderer.getDevice()->getResourceId(ResourceType::TEXTURE)),
             size(initSize),
             flags(initFlags),
             mipmaps(static_cast<uint32_t>(initLevels.size())),
@@ -561,20 +619,22 @@ namespace ouzel
                 levels.resize(1);
             }
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
+
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         Texture::~Texture()
         {
             if (resource)
             {
-                renderer.addCommand(std::unique_ptr<Command>(new DeleteResourceCommand(resource)));
+                renderer.addCommand(DeleteResourceCommand(ResourceType::TEXTURE, resource));
                 RenderDevice* renderDevice = renderer.getDevice();
-                renderDevice->deleteResourceId(resource);
+                renderDevice->deleteResourceId(ResourceType::TEXTURE, resource);
             }
         }
 
@@ -597,13 +657,15 @@ namespace ouzel
                 (!isPOT(static_cast<uint32_t>(size.width)) || isPOT(static_cast<uint32_t>(size.height))))
                 mipmaps = 1;
 
-            std::vector<Level> levels = calculateSizes(size, std::vector<uint8_t>(), mipmaps, pixelFormat);
+            std::vector<Level> levels = calculateSizes(renderer, size, std::vector<uint8_t>(), mipmaps, flags, pixelFormat);
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
+
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         void Texture::init(const std::vector<uint8_t>& newData,
@@ -625,13 +687,15 @@ namespace ouzel
                 (!isPOT(static_cast<uint32_t>(size.width)) || isPOT(static_cast<uint32_t>(size.height))))
                 mipmaps = 1;
 
-            std::vector<Level> levels = calculateSizes(size, newData, mipmaps, pixelFormat);
+            std::vector<Level> levels = calculateSizes(renderer, size, newData, mipmaps, flags, pixelFormat);
+
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         void Texture::init(const std::vector<Level>& newLevels,
@@ -657,11 +721,13 @@ namespace ouzel
                 levels.resize(1);
             }
 
-            renderer.addCommand(std::unique_ptr<Command>(new InitTextureCommand(resource,
-                                                                                levels,
-                                                                                flags,
-                                                                                sampleCount,
-                                                                                pixelFormat)));
+            PixelFormat devicePixelFormat = prepareLevels(renderer, levels, pixelFormat);
+
+            renderer.addCommand(InitTextureCommand(resource,
+                                                   levels,
+                                                   flags,
+                                                   sampleCount,
+                                                   devicePixelFormat));
         }
 
         void Texture::setData(const std::vector<uint8_t>& newData)
@@ -669,98 +735,129 @@ namespace ouzel
             if (!(flags & Texture::DYNAMIC) || flags & Texture::RENDER_TARGET)
                 throw std::runtime_error("Texture is not dynamic");
 
-            std::vector<Level> levels = calculateSizes(size, newData, mipmaps, pixelFormat);
+            std::vector<Level> levels = calculateSizes(renderer, size, newData, mipmaps, flags, pixelFormat);
+            prepareLevels(renderer, levels, pixelFormat);
+
+            renderer.addCommand(SetTextureDataCommand(resource,
+                                                      levels));
+        }
+
+        void Texture::setRegionData(const std::vector<uint8_t>& newData, uint32_t level,
+                                    uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (isCompressed(pixelFormat))
+                throw std::runtime_error("Regions of compressed textures can't be updated");
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetTextureDataCommand(resource,
-                                                                                   levels)));
+            if (level >= 32 || (mipmaps != 0 && level >= mipmaps))
+                throw std::runtime_error("Invalid mip map level");
+
+            uint32_t levelWidth = std::max(static_cast<uint32_t>(size.width) >> level, 1U);
+            uint32_t levelHeight = std::max(static_cast<uint32_t>(size.height) >> level, 1U);
+
+            if (width > levelWidth || x > levelWidth - width ||
+                height > levelHeight || y > levelHeight - height)
+                throw std::runtime_error("Invalid texture region");
+
+            if (newData.size() != getLevelSize(pixelFormat, width, height))
+                throw std::runtime_error("Invalid texture data size");
+
+            if (isAlphaExpanded(renderer, pixelFormat))
+                renderer.addCommand(SetTextureRegionDataCommand(resource, level, x, y, width, height,
+                                                                expandAlpha(newData.data(), width, height, width)));
+            else
+                renderer.addCommand(SetTextureRegionDataCommand(resource, level, x, y, width, height,
+                                                                newData));
         }
 
         void Texture::setFilter(Filter newFilter)
         {
             filter = newFilter;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetTextureParametersCommand(resource,
-                                                                                         filter,
-                                                                                         addressX,
-                                                                                         addressY,
-                                                                                         maxAnisotropy)));
+            renderer.addCommand(SetTextureParametersCommand(resource,
+                                                            filter,
+                                                            addressX,
+                                                            addressY,
+                                                            maxAnisotropy));
         }
 
         void Texture::setAddressX(Address newAddressX)
         {
             addressX = newAddressX;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetTextureParametersCommand(resource,
-                                                                                         filter,
-                                                                                         addressX,
-                                                                                         addressY,
-                                                                                         maxAnisotropy)));
+            renderer.addCommand(SetTextureParametersCommand(resource,
+                                                            filter,
+                                                            addressX,
+                                                            addressY,
+                                                            maxAnisotropy));
         }
 
         void Texture::setAddressY(Address newAddressY)
         {
             addressY = newAddressY;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetTextureParametersCommand(resource,
-                                                                                         filter,
-                                                                                         addressX,
-                                                                                         addressY,
-                                                                                         maxAnisotropy)));
+            renderer.addCommand(SetTextureParametersCommand(resource,
+                                                            filter,
+                                                            addressX,
+                                                            addressY,
+                                                            maxAnisotropy));
         }
 
         void Texture::setMaxAnisotropy(uint32_t newMaxAnisotropy)
         {
             maxAnisotropy = newMaxAnisotropy;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetTextureParametersCommand(resource,
-                                                                                         filter,
-                                                                                         addressX,
-                                                                                         addressY,
-                                                                                         maxAnisotropy)));
+            renderer.addCommand(SetTextureParametersCommand(resource,
+                                                            filter,
+                                                            addressX,
+                                                            addressY,
+                                                            maxAnisotropy));
         }
 
         void Texture::setClearColorBuffer(bool clear)
         {
             clearColorBuffer = clear;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(resource,
-                                                                                              clearColorBuffer,
-                                                                                              clearDepthBuffer,
-                                                                                              clearColor,
-                                                                                              clearDepth)));
+            renderer.addCommand(SetRenderTargetParametersCommand(resource,
+                                                                 clearColorBuffer,
+                                                                 clearDepthBuffer,
+                                                                 clearColor,
+                                                                 clearDepth));
         }
 
         void Texture::setClearDepthBuffer(bool clear)
         {
             clearDepthBuffer = clear;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(resource,
-                                                                                              clearColorBuffer,
-                                                                                              clearDepthBuffer,
-                                                                                              clearColor,
-                                                                                              clearDepth)));
+            renderer.addCommand(SetRenderTargetParametersCommand(resource,
+                                                                 clearColorBuffer,
+                                                                 clearDepthBuffer,
+                                                                 clearColor,
+                                                                 clearDepth));
         }
 
         void Texture::setClearColor(Color color)
         {
             clearColor = color;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(resource,
-                                                                                              clearColorBuffer,
-                                                                                              clearDepthBuffer,
-                                                                                              clearColor,
-                                                                                              clearDepth)));
+            renderer.addCommand(SetRenderTargetParametersCommand(resource,
+                                                                 clearColorBuffer,
+                                                                 clearDepthBuffer,
+                                                                 clearColor,
+                                                                 clearDepth));
         }
 
         void Texture::setClearDepth(float depth)
         {
             clearDepth = depth;
 
-            renderer.addCommand(std::unique_ptr<Command>(new SetRenderTargetParametersCommand(resource,
-                                                                                              clearColorBuffer,
-                                                                                              clearDepthBuffer,
-                                                                                              clearColor,
-                                                                                              clearDepth)));
+            renderer.addCommand(SetRenderTargetParametersCommand(resource,
+                                                                 clearColorBuffer,
+                                                                 clearDepthBuffer,
+                                                                 clearColor,
+                                                                 clearDepth));
         }
 
     } // namespace graphics
@@ -33,6 +33,7 @@ namespace ouzel
                 DEPTH_BUFFER = 0x04,
                 BINDABLE_COLOR_BUFFER = 0x08,
                 BINDABLE_DEPTH_BUFFER = 0x10,
+                LINEAR_MIPMAPS = 0x20, // the data is linear or has premultiplied alpha, so mip maps are averaged without gamma correction
             };
 
             enum class Filter
@@ -106,6 +107,9 @@ namespace ouzel
             inline const Size2& getSize() const { return size; }
 
             void setData(const std::vector<uint8_t>& newData);
+            // replaces a part of a mip level without regenerating the other levels, the rows of the data are tightly packed
+            void setRegionData(const std::vector<uint8_t>& newData, uint32_t level,
+                               uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 
             inline uint32_t getFlags() const { return flags; }
             inline uint32_t getMipmaps() const { return mipmaps; }
@@ -3,8 +3,11 @@
 #ifndef OUZEL_GRAPHICS_VERTEX_HPP
 #define OUZEL_GRAPHICS_VERTEX_HPP
 
+#include <cstdint>
 #include <vector>
 #include "graphics/DataType.hpp"
+#include "math/MathUtils.hpp"
+#include "math/Matrix4.hpp"
 #include "math/Vector2.hpp"
 #include "math/Vector3.hpp"
 #include "math/Color.hpp"
@@ -32,7 +35,8 @@ namespace ouzel
                     POINT_SIZE,
                     TANGENT,
                     TEXTURE_COORDINATES0,
-                    TEXTURE_COORDINATES1
+                    TEXTURE_COORDINATES1,
+                    TRANSFORM
                 };
 
                 Attribute(Usage initUsage, DataType initDataType):
@@ -55,6 +59,110 @@ namespace ouzel
             Vector2 texCoords[2];
             Vector3 normal;
         };
+
+        inline uint16_t normalizeTexCoord(float texCoord)
+        {
+            return static_cast<uint16_t>(clamp(texCoord, 0.0F, 1.0F) * 65535.0F + 0.5F);
+        }
+
+        inline int8_t normalizeNormal(float normal)
+        {
+            return static_cast<int8_t>(clamp(normal, -1.0F, 1.0F) * 127.0F + (normal < 0.0F ? -0.5F : 0.5F));
+        }
+
+        // vertex of VertexLayout::SPRITE
+        class SpriteVertex final
+        {
+        public:
+            SpriteVertex() {}
+            SpriteVertex(const Vector3& initPosition, Color initColor, const Vector2& initTexCoord):
+                position(initPosition), color(initColor), texCoord(initTexCoord)
+            {
+            }
+            explicit SpriteVertex(const Vertex& vertex):
+                position(vertex.position), color(vertex.color), texCoord(vertex.texCoords[0])
+            {
+            }
+
+            Vector3 position;
+            Color color;
+            Vector2 texCoord;
+        };
+
+        // vertex of VertexLayout::PARTICLE
+        class ParticleVertex final
+        {
+        public:
+            ParticleVertex() {}
+            ParticleVertex(const Vector2& initPosition, Color initColor, const Vector2& initTexCoord):
+                position(initPosition), color(initColor)
+            {
+                texCoord[0] = normalizeTexCoord(initTexCoord.x);
+                texCoord[1] = normalizeTexCoord(initTexCoord.y);
+            }
+
+            Vector2 position;
+            Color color;
+            uint16_t texCoord[2] = {0, 0};
+        };
+
+        // vertex of VertexLayout::TEXT
+        class TextVertex final
+        {
+        public:
+            TextVertex() {}
+            TextVertex(const Vector2& initPosition, Color initColor, const Vector2& initTexCoord):
+                position(initPosition), color(initColor)
+            {
+                texCoord[0] = normalizeTexCoord(initTexCoord.x);
+                texCoord[1] = normalizeTexCoord(initTexCoord.y);
+            }
+
+            Vector2 position;
+            Color color;
+            uint16_t texCoord[2] = {0, 0};
+        };
+
+        // vertex of VertexLayout::STATIC_MESH
+        class StaticMeshVertex final
+        {
+        public:
+            StaticMeshVertex() {}
+            StaticMeshVertex(const Vector3& initPosition, Color initColor, const Vector2& initTexCoord, const Vector3& initNormal):
+                position(initPosition), color(initColor), texCoord(initTexCoord)
+            {
+                normal[0] = normalizeNormal(initNormal.x);
+                normal[1] = normalizeNormal(initNormal.y);
+                normal[2] = normalizeNormal(initNormal.z);
+            }
+            explicit StaticMeshVertex(const Vertex& vertex):
+                StaticMeshVertex(vertex.position, vertex.color, vertex.texCoords[0], vertex.normal)
+            {
+            }
+
+            Vector3 position;
+            Color color;
+            Vector2 texCoord;
+            int8_t normal[4] = {0, 0, 0, 0};
+        };
+
+        // per-instance data of VertexLayout::INSTANCED_MESH
+        class InstanceData final
+        {
+        public:
+            InstanceData() {}
+            InstanceData(const Matrix4& initModelViewProj, const Vector4& initColor):
+                modelViewProj(initModelViewProj)
+            {
+                color[0] = initColor.x;
+                color[1] = initColor.y;
+                color[2] = initColor.z;
+                color[3] = initColor.w;
+            }
+
+            Matrix4 modelViewProj;
+            float color[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+        };
     } // namespace graphics
 } // namespace ouzel
 
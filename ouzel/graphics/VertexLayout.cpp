@@ -0,0 +1,115 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "VertexLayout.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        static_assert(sizeof(Vertex) == 44, "Invalid size of Vertex");
+        static_assert(sizeof(SpriteVertex) == 24, "Invalid size of SpriteVertex");
+        static_assert(sizeof(ParticleVertex) == 16, "Invalid size of ParticleVertex");
+        static_assert(sizeof(TextVertex) == 16, "Invalid size of TextVertex");
+        static_assert(sizeof(StaticMeshVertex) == 28, "Invalid size of StaticMeshVertex");
+        static_assert(sizeof(InstanceData) == 80, "Invalid size of InstanceData");
+
+        const VertexLayout VertexLayout::DEFAULT({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES1, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::NORMAL, DataType::FLOAT_VECTOR3)
+        });
+
+        // batched sprites are transformed to world space, so the depth is kept
+        const VertexLayout VertexLayout::SPRITE({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::FLOAT_VECTOR2)
+        });
+
+        const VertexLayout VertexLayout::PARTICLE({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::UNSIGNED_SHORT_VECTOR2_NORM)
+        });
+
+        const VertexLayout VertexLayout::TEXT({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::UNSIGNED_SHORT_VECTOR2_NORM)
+        });
+
+        const VertexLayout VertexLayout::STATIC_MESH({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::NORMAL, DataType::BYTE_VECTOR4_NORM)
+        });
+
+        const VertexLayout VertexLayout::INSTANCED_MESH({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::NORMAL, DataType::BYTE_VECTOR4_NORM)
+        }, {
+            Vertex::Attribute(Vertex::Attribute::Usage::TRANSFORM, DataType::FLOAT_MATRIX4),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::FLOAT_VECTOR4)
+        });
+
+        VertexLayout::VertexLayout(const std::vector<Vertex::Attribute>& attributes)
+        {
+            for (const Vertex::Attribute& attribute : attributes)
+            {
+                elements.push_back(Element(attribute.usage, attribute.dataType, stride));
+                stride += getDataTypeSize(attribute.dataType);
+            }
+        }
+
+        VertexLayout::VertexLayout(const std::vector<Vertex::Attribute>& attributes,
+                                   const std::vector<Vertex::Attribute>& instanceAttributes):
+            VertexLayout(attributes)
+        {
+            for (const Vertex::Attribute& attribute : instanceAttributes)
+            {
+                instanceElements.push_back(Element(attribute.usage, attribute.dataType, instanceStride));
+                instanceStride += getDataTypeSize(attribute.dataType);
+            }
+        }
+
+        VertexLayout::VertexLayout(const std::set<Vertex::Attribute::Usage>& usages):
+            stride(static_cast<uint32_t>(sizeof(Vertex)))
+        {
+            uint32_t offset = 0;
+
+            for (const Vertex::Attribute& attribute : Vertex::ATTRIBUTES)
+            {
+                if (usages.find(attribute.usage) != usages.end())
+                    elements.push_back(Element(attribute.usage, attribute.dataType, offset));
+
+                offset += getDataTypeSize(attribute.dataType);
+            }
+        }
+
+        bool VertexLayout::hasUsage(Vertex::Attribute::Usage usage) const
+        {
+            for (const Element& element : elements)
+                if (element.usage == usage) return true;
+
+            return false;
+        }
+
+        bool VertexLayout::isCompatible(const VertexLayout& bufferLayout) const
+        {
+            if (stride != bufferLayout.stride) return false;
+
+            // the buffer can contain attributes that the shader doesn't read
+            for (const Element& element : elements)
+                if (std::find(bufferLayout.elements.begin(), bufferLayout.elements.end(), element) == bufferLayout.elements.end())
+                    return false;
+
+            return true;
+        }
+    } // namespace graphics
+} // namespace ouzel
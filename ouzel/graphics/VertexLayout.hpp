@@ -0,0 +1,94 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
+#define OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
+
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "graphics/DataType.hpp"
+#include "graphics/Vertex.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // describes the attributes of a vertex and where they are stored in a vertex buffer
+        class VertexLayout final
+        {
+        public:
+            class Element final
+            {
+            public:
+                Element(Vertex::Attribute::Usage initUsage, DataType initDataType, uint32_t initOffset):
+                    usage(initUsage), dataType(initDataType), offset(initOffset) {}
+
+                inline bool operator==(const Element& other) const
+                {
+                    return usage == other.usage && dataType == other.dataType && offset == other.offset;
+                }
+
+                Vertex::Attribute::Usage usage = Vertex::Attribute::Usage::NONE;
+                DataType dataType = DataType::NONE;
+                uint32_t offset = 0;
+            };
+
+            static const VertexLayout DEFAULT; // Vertex
+            static const VertexLayout SPRITE; // SpriteVertex
+            static const VertexLayout PARTICLE; // ParticleVertex
+            static const VertexLayout TEXT; // TextVertex
+            static const VertexLayout STATIC_MESH; // StaticMeshVertex
+            static const VertexLayout INSTANCED_MESH; // StaticMeshVertex and InstanceData
+
+            VertexLayout() {}
+            // the attributes are tightly packed in the given order
+            explicit VertexLayout(const std::vector<Vertex::Attribute>& attributes);
+            // the instance attributes are read from a separate buffer once per instance
+            VertexLayout(const std::vector<Vertex::Attribute>& attributes,
+                         const std::vector<Vertex::Attribute>& instanceAttributes);
+            // the given attributes of Vertex
+            explicit VertexLayout(const std::set<Vertex::Attribute::Usage>& usages);
+            // the elements at the given offsets, e.g. of a deserialized layout
+            VertexLayout(const std::vector<Element>& initElements,
+                         uint32_t initStride,
+                         const std::vector<Element>& initInstanceElements,
+                         uint32_t initInstanceStride):
+                elements(initElements),
+                stride(initStride),
+                instanceElements(initInstanceElements),
+                instanceStride(initInstanceStride)
+            {
+            }
+
+            inline const std::vector<Element>& getElements() const { return elements; }
+            inline uint32_t getStride() const { return stride; }
+
+            inline const std::vector<Element>& getInstanceElements() const { return instanceElements; }
+            inline uint32_t getInstanceStride() const { return instanceStride; }
+            inline bool isInstanced() const { return !instanceElements.empty(); }
+
+            bool hasUsage(Vertex::Attribute::Usage usage) const;
+            // whether a shader with this layout can read the vertices of a buffer with the given layout
+            bool isCompatible(const VertexLayout& bufferLayout) const;
+
+            inline bool operator==(const VertexLayout& other) const
+            {
+                return stride == other.stride && elements == other.elements &&
+                    instanceStride == other.instanceStride && instanceElements == other.instanceElements;
+            }
+
+            inline bool operator!=(const VertexLayout& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            std::vector<Element> elements;
+            uint32_t stride = 0;
+            std::vector<Element> instanceElements;
+            uint32_t instanceStride = 0;
+        };
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
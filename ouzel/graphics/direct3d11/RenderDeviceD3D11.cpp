@@ -39,12 +39,16 @@ namespace ouzel
         {
             running = false;
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
 
             if (renderThread.joinable()) renderThread.join();
 
-            resources.clear();
+            textures.clear();
+            shaders.clear();
+            buffers.clear();
+            depthStencilStates.clear();
+            blendStates.clear();
 
             if (defaultDepthStencilState)
                 defaultDepthStencilState->Release();
@@ -330,8 +334,6 @@ namespace ouzel
             RenderDevice::process();
             executeAll();
 
-            std::vector<float> shaderData;
-
             uint32_t fillModeIndex = 0;
             uint32_t scissorEnableIndex = 0;
             uint32_t cullModeIndex = 0;
@@ -341,44 +343,49 @@ namespace ouzel
 
             for (;;)
             {
-                std::unique_lock<std::mutex> lock(commandQueueMutex);
-                while (commandQueue.empty()) commandQueueCondition.wait(lock);
-                commandBuffer = std::move(commandQueue.front());
-                commandQueue.pop();
-                lock.unlock();
+                popCommandBuffer(commandBuffer, true);
+                CommandBufferRecycler recycler(*this, commandBuffer);
 
-                std::unique_ptr<Command> command;
+                bool presented = false;
 
-                while (!commandBuffer.commands.empty())
+                for (const Command* command : commandBuffer)
                 {
-                    command = std::move(commandBuffer.commands.front());
-                    commandBuffer.commands.pop();
-
                     switch (command->type)
                     {
                         case Command::Type::PRESENT:
                         {
+                            drawCallCount = currentDrawCallCount;
+                            currentDrawCallCount = 0;
+
                             swapChain->Present(swapInterval, 0);
                             break;
                         }
 
                         case Command::Type::DELETE_RESOURCE:
                         {
-                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
-                            resources[deleteResourceCommand->resource - 1].reset();
+                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
+                            switch (deleteResourceCommand->resourceType)
+                            {
+                                case ResourceType::BLEND_STATE: blendStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::BUFFER: buffers.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::DEPTH_STENCIL_STATE: depthStencilStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::SHADER: shaders.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::TEXTURE: textures.erase(deleteResourceCommand->resource); break;
+                                default: break; // render targets are not created on the device
+                            }
                             break;
                         }
 
                         case Command::Type::SET_RENDER_TARGET:
                         {
-                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                             ID3D11RenderTargetView* newRenderTargetView = nullptr;
                             ID3D11DepthStencilView* newDepthStencilView = nullptr;
 
                             if (setRenderTargetCommand->renderTarget)
                             {
-                                TextureResourceD3D11* renderTargetD3D11 = static_cast<TextureResourceD3D11*>(resources[setRenderTargetCommand->renderTarget - 1].get());
+                                TextureResourceD3D11* renderTargetD3D11 = textures.get(setRenderTargetCommand->renderTarget);
 
                                 if (!renderTargetD3D11->getRenderTargetView()) break;
 
@@ -398,11 +405,11 @@ namespace ouzel
 
                         case Command::Type::SET_RENDER_TARGET_PARAMETERS:
                         {
-                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command.get());
+                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command);
 
                             if (setRenderTargetParametersCommand->renderTarget)
                             {
-                                TextureResourceD3D11* renderTargetD3D11 = static_cast<TextureResourceD3D11*>(resources[setRenderTargetParametersCommand->renderTarget - 1].get());
+                                TextureResourceD3D11* renderTargetD3D11 = textures.get(setRenderTargetParametersCommand->renderTarget);
                                 renderTargetD3D11->setClearColorBuffer(setRenderTargetParametersCommand->clearColorBuffer);
                                 renderTargetD3D11->setClearDepthBuffer(setRenderTargetParametersCommand->clearDepthBuffer);
                                 renderTargetD3D11->setClearColor(setRenderTargetParametersCommand->clearColor);
@@ -421,7 +428,7 @@ namespace ouzel
 
                         case Command::Type::CLEAR_RENDER_TARGET:
                         {
-                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                             ID3D11RenderTargetView* newRenderTargetView = nullptr;
                             ID3D11DepthStencilView* newDepthStencilView = nullptr;
@@ -434,7 +441,7 @@ namespace ouzel
 
                             if (clearCommand->renderTarget)
                             {
-                                TextureResourceD3D11* renderTargetD3D11 = static_cast<TextureResourceD3D11*>(resources[clearCommand->renderTarget - 1].get());
+                                TextureResourceD3D11* renderTargetD3D11 = textures.get(clearCommand->renderTarget);
 
                                 if (!renderTargetD3D11->getRenderTargetView()) break;
 
@@ -480,10 +487,10 @@ namespace ouzel
 
                         case Command::Type::BLIT:
                         {
-                            const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command.get());
+                            const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command);
 
-                            TextureResourceD3D11* sourceTextureD3D11 = static_cast<TextureResourceD3D11*>(resources[blitCommand->sourceTexture - 1].get());
-                            TextureResourceD3D11* destinationTextureD3D11 = static_cast<TextureResourceD3D11*>(resources[blitCommand->destinationTexture - 1].get());
+                            TextureResourceD3D11* sourceTextureD3D11 = textures.get(blitCommand->sourceTexture);
+                            TextureResourceD3D11* destinationTextureD3D11 = textures.get(blitCommand->destinationTexture);
 
                             D3D11_BOX box;
                             box.left = blitCommand->sourceX;
@@ -506,7 +513,7 @@ namespace ouzel
 
                         case Command::Type::SET_CULL_MODE:
                         {
-                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command.get());
+                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command);
 
                             switch (setCullModeCommad->cullMode)
                             {
@@ -524,7 +531,7 @@ namespace ouzel
 
                         case Command::Type::SET_FILL_MODE:
                         {
-                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command.get());
+                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command);
 
                             switch (setFillModeCommad->fillMode)
                             {
@@ -541,7 +548,7 @@ namespace ouzel
 
                         case Command::Type::SET_SCISSOR_TEST:
                         {
-                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                             if (setScissorTestCommand->enabled)
                             {
@@ -563,7 +570,7 @@ namespace ouzel
 
                         case Command::Type::SET_VIEWPORT:
                         {
-                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                             D3D11_VIEWPORT viewport;
                             viewport.MinDepth = 0.0F;
@@ -579,25 +586,23 @@ namespace ouzel
 
                         case Command::Type::INIT_DEPTH_STENCIL_STATE:
                         {
-                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                             std::unique_ptr<DepthStencilStateResourceD3D11> depthStencilStateResourceD3D11(new DepthStencilStateResourceD3D11(*this,
                                                                                                                                             initDepthStencilStateCommand->depthTest,
                                                                                                                                             initDepthStencilStateCommand->depthWrite,
                                                                                                                                             initDepthStencilStateCommand->compareFunction));
 
-                            if (initDepthStencilStateCommand->depthStencilState > resources.size())
-                                resources.resize(initDepthStencilStateCommand->depthStencilState);
-                            resources[initDepthStencilStateCommand->depthStencilState - 1] = std::move(depthStencilStateResourceD3D11);
+                            depthStencilStates.insert(initDepthStencilStateCommand->depthStencilState, std::move(depthStencilStateResourceD3D11));
                             break;
                         }
 
                         case Command::Type::SET_DEPTH_STENCIL_STATE:
                         {
-                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                             if (setDepthStencilStateCommand->depthStencilState)
                             {
-                                DepthStencilStateResourceD3D11* depthStencilStateD3D11 = static_cast<DepthStencilStateResourceD3D11*>(resources[setDepthStencilStateCommand->depthStencilState - 1].get());
+                                DepthStencilStateResourceD3D11* depthStencilStateD3D11 = depthStencilStates.get(setDepthStencilStateCommand->depthStencilState);
                                 context->OMSetDepthStencilState(depthStencilStateD3D11->getDepthStencilState(), 0);
                             }
                             else
@@ -608,10 +613,10 @@ namespace ouzel
 
                         case Command::Type::SET_PIPELINE_STATE:
                         {
-                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
-                            BlendStateResourceD3D11* blendStateD3D11 = static_cast<BlendStateResourceD3D11*>(resources[setPipelineStateCommand->blendState - 1].get());
-                            ShaderResourceD3D11* shaderD3D11 = static_cast<ShaderResourceD3D11*>(resources[setPipelineStateCommand->shader - 1].get());
+                            BlendStateResourceD3D11* blendStateD3D11 = blendStates.get(setPipelineStateCommand->blendState);
+                            ShaderResourceD3D11* shaderD3D11 = shaders.get(setPipelineStateCommand->shader);
                             currentShader = shaderD3D11;
 
                             if (blendStateD3D11)
@@ -641,21 +646,45 @@ namespace ouzel
 
                         case Command::Type::DRAW:
                         {
-                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command.get());
+                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command);
+                            ++currentDrawCallCount;
 
                             // draw mesh buffer
-                            BufferResourceD3D11* indexBufferD3D11 = static_cast<BufferResourceD3D11*>(resources[drawCommand->indexBuffer - 1].get());
-                            BufferResourceD3D11* vertexBufferD3D11 = static_cast<BufferResourceD3D11*>(resources[drawCommand->vertexBuffer - 1].get());
+                            BufferResourceD3D11* indexBufferD3D11 = buffers.get(drawCommand->indexBuffer);
+                            BufferResourceD3D11* vertexBufferD3D11 = buffers.get(drawCommand->vertexBuffer);
 
                             assert(indexBufferD3D11);
                             assert(indexBufferD3D11->getBuffer());
                             assert(vertexBufferD3D11);
                             assert(vertexBufferD3D11->getBuffer());
 
-                            ID3D11Buffer* buffers[] = {vertexBufferD3D11->getBuffer()};
-                            UINT strides[] = {sizeof(Vertex)};
-                            UINT offsets[] = {0};
-                            context->IASetVertexBuffers(0, 1, buffers, strides, offsets);
+                            if (!currentShader)
+                                throw std::runtime_error("No shader set");
+
+                            const VertexLayout& vertexLayout = currentShader->getVertexLayout();
+
+                            if (vertexLayout.isInstanced() != (drawCommand->instanceBuffer != 0))
+                                throw std::runtime_error("Shader vertex layout does not match the draw");
+
+                            if (drawCommand->instanceBuffer)
+                            {
+                                BufferResourceD3D11* instanceBufferD3D11 = buffers.get(drawCommand->instanceBuffer);
+
+                                assert(instanceBufferD3D11);
+                                assert(instanceBufferD3D11->getBuffer());
+
+                                ID3D11Buffer* buffers[] = {vertexBufferD3D11->getBuffer(), instanceBufferD3D11->getBuffer()};
+                                UINT strides[] = {vertexLayout.getStride(), vertexLayout.getInstanceStride()};
+                                UINT offsets[] = {0, 0};
+                                context->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+                            }
+                            else
+                            {
+                                ID3D11Buffer* buffers[] = {vertexBufferD3D11->getBuffer()};
+                                UINT strides[] = {vertexLayout.getStride()};
+                                UINT offsets[] = {0};
+                                context->IASetVertexBuffers(0, 1, buffers, strides, offsets);
+                            }
 
                             DXGI_FORMAT indexFormat;
 
@@ -688,7 +717,10 @@ namespace ouzel
                             assert(indexBufferD3D11->getSize());
                             assert(vertexBufferD3D11->getSize());
 
-                            context->DrawIndexed(drawCommand->indexCount, drawCommand->startIndex, 0);
+                            if (drawCommand->instanceBuffer)
+                                context->DrawIndexedInstanced(drawCommand->indexCount, drawCommand->instanceCount, drawCommand->startIndex, 0, 0);
+                            else
+                                context->DrawIndexed(drawCommand->indexCount, drawCommand->startIndex, 0);
 
                             break;
                         }
@@ -707,7 +739,7 @@ namespace ouzel
 
                         case Command::Type::INIT_BLEND_STATE:
                         {
-                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                             std::unique_ptr<BlendStateResourceD3D11> blendStateResourceD3D11(new BlendStateResourceD3D11(*this,
                                                                                                                         initBlendStateCommand->enableBlending,
@@ -719,15 +751,13 @@ namespace ouzel
                                                                                                                         initBlendStateCommand->alphaOperation,
                                                                                                                         initBlendStateCommand->colorMask));
 
-                            if (initBlendStateCommand->blendState > resources.size())
-                                resources.resize(initBlendStateCommand->blendState);
-                            resources[initBlendStateCommand->blendState - 1] = std::move(blendStateResourceD3D11);
+                            blendStates.insert(initBlendStateCommand->blendState, std::move(blendStateResourceD3D11));
                             break;
                         }
 
                         case Command::Type::INIT_BUFFER:
                         {
-                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                             std::unique_ptr<BufferResourceD3D11> bufferResourceD3D11(new BufferResourceD3D11(*this,
                                                                                                             initBufferCommand->usage,
@@ -735,29 +765,27 @@ namespace ouzel
                                                                                                             initBufferCommand->data,
                                                                                                             initBufferCommand->size));
 
-                            if (initBufferCommand->buffer > resources.size())
-                                resources.resize(initBufferCommand->buffer);
-                            resources[initBufferCommand->buffer - 1] = std::move(bufferResourceD3D11);
+                            buffers.insert(initBufferCommand->buffer, std::move(bufferResourceD3D11));
                             break;
                         }
 
                         case Command::Type::SET_BUFFER_DATA:
                         {
-                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
-                            BufferResourceD3D11* bufferResourceD3D11 = static_cast<BufferResourceD3D11*>(resources[setBufferDataCommand->buffer - 1].get());
+                            BufferResourceD3D11* bufferResourceD3D11 = buffers.get(setBufferDataCommand->buffer);
                             bufferResourceD3D11->setData(setBufferDataCommand->data);
                             break;
                         }
 
                         case Command::Type::INIT_SHADER:
                         {
-                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                             std::unique_ptr<ShaderResourceD3D11> shaderResourceD3D11(new ShaderResourceD3D11(*this,
                                                                                                             initShaderCommand->fragmentShader,
                                                                                                             initShaderCommand->vertexShader,
-                                                                                                            initShaderCommand->vertexAttributes,
+                                                                                                            initShaderCommand->vertexLayout,
                                                                                                             initShaderCommand->fragmentShaderConstantInfo,
                                                                                                             initShaderCommand->vertexShaderConstantInfo,
                                                                                                             initShaderCommand->fragmentShaderDataAlignment,
@@ -765,67 +793,43 @@ namespace ouzel
                                                                                                             initShaderCommand->fragmentShaderFunction,
                                                                                                             initShaderCommand->vertexShaderFunction));
 
-                            if (initShaderCommand->shader > resources.size())
-                                resources.resize(initShaderCommand->shader);
-                            resources[initShaderCommand->shader - 1] = std::move(shaderResourceD3D11);
+                            shaders.insert(initShaderCommand->shader, std::move(shaderResourceD3D11));
                             break;
                         }
 
                         case Command::Type::SET_SHADER_CONSTANTS:
                         {
-                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                             if (!currentShader)
                                 throw std::runtime_error("No shader set");
 
+                            const std::vector<uint8_t>& constantData = commandBuffer.getConstantData();
+
                             // pixel shader constants
-                            const std::vector<ShaderResourceD3D11::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                            const ConstantBlock& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                            if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
+                            if (fragmentShaderConstants.size > currentShader->getFragmentShaderConstantSize())
                                 throw std::runtime_error("Invalid pixel shader constant size");
 
-                            shaderData.clear();
-
-                            for (size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
-                            {
-                                const ShaderResourceD3D11::Location& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                                const std::vector<float>& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
-
-                                if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                    throw std::runtime_error("Invalid pixel shader constant size");
-
-                                shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
-                            }
-
-                            uploadBuffer(currentShader->getFragmentShaderConstantBuffer(),
-                                            shaderData.data(),
-                                            static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                            if (fragmentShaderConstants.size)
+                                uploadBuffer(currentShader->getFragmentShaderConstantBuffer(),
+                                             constantData.data() + fragmentShaderConstants.offset,
+                                             fragmentShaderConstants.size);
 
                             ID3D11Buffer* fragmentShaderConstantBuffers[1] = {currentShader->getFragmentShaderConstantBuffer()};
                             context->PSSetConstantBuffers(0, 1, fragmentShaderConstantBuffers);
 
                             // vertex shader constants
-                            const std::vector<ShaderResourceD3D11::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                            const ConstantBlock& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                            if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                            if (vertexShaderConstants.size > currentShader->getVertexShaderConstantSize())
                                 throw std::runtime_error("Invalid vertex shader constant size");
 
-                            shaderData.clear();
-
-                            for (size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
-                            {
-                                const ShaderResourceD3D11::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                                const std::vector<float>& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
-
-                                if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                    throw std::runtime_error("Invalid pixel shader constant size");
-
-                                shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
-                            }
-
-                            uploadBuffer(currentShader->getVertexShaderConstantBuffer(),
-                                            shaderData.data(),
-                                            static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                            if (vertexShaderConstants.size)
+                                uploadBuffer(currentShader->getVertexShaderConstantBuffer(),
+                                             constantData.data() + vertexShaderConstants.offset,
+                                             vertexShaderConstants.size);
 
                             ID3D11Buffer* vertexShaderConstantBuffers[1] = {currentShader->getVertexShaderConstantBuffer()};
                             context->VSSetConstantBuffers(0, 1, vertexShaderConstantBuffers);
@@ -835,7 +839,7 @@ namespace ouzel
 
                         case Command::Type::INIT_TEXTURE:
                         {
-                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                             std::unique_ptr<TextureResourceD3D11> textureResourceD3D11(new TextureResourceD3D11(*this,
                                                                                                                 initTextureCommand->levels,
@@ -843,27 +847,40 @@ namespace ouzel
                                                                                                                 initTextureCommand->sampleCount,
                                                                                                                 initTextureCommand->pixelFormat));
 
-                            if (initTextureCommand->texture > resources.size())
-                                resources.resize(initTextureCommand->texture);
-                            resources[initTextureCommand->texture - 1] = std::move(textureResourceD3D11);
+                            textures.insert(initTextureCommand->texture, std::move(textureResourceD3D11));
                             break;
                         }
 
                         case Command::Type::SET_TEXTURE_DATA:
                         {
-                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
-                            TextureResourceD3D11* textureResourceD3D11 = static_cast<TextureResourceD3D11*>(resources[setTextureDataCommand->texture - 1].get());
+                            TextureResourceD3D11* textureResourceD3D11 = textures.get(setTextureDataCommand->texture);
                             textureResourceD3D11->setData(setTextureDataCommand->levels);
 
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            const SetTextureRegionDataCommand* setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command);
+
+                            TextureResourceD3D11* textureResourceD3D11 = textures.get(setTextureRegionDataCommand->texture);
+                            textureResourceD3D11->setRegionData(setTextureRegionDataCommand->level,
+                                                                setTextureRegionDataCommand->x,
+                                                                setTextureRegionDataCommand->y,
+                                                                setTextureRegionDataCommand->width,
+                                                                setTextureRegionDataCommand->height,
+                                                                setTextureRegionDataCommand->data);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
-                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
-                            TextureResourceD3D11* textureResourceD3D11 = static_cast<TextureResourceD3D11*>(resources[setTextureParametersCommand->texture - 1].get());
+                            TextureResourceD3D11* textureResourceD3D11 = textures.get(setTextureParametersCommand->texture);
                             textureResourceD3D11->setFilter(setTextureParametersCommand->filter);
                             textureResourceD3D11->setAddressX(setTextureParametersCommand->addressX);
                             textureResourceD3D11->setAddressY(setTextureParametersCommand->addressY);
@@ -874,7 +891,7 @@ namespace ouzel
 
                         case Command::Type::SET_TEXTURES:
                         {
-                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                             ID3D11ShaderResourceView* resourceViews[Texture::LAYERS];
                             ID3D11SamplerState* samplers[Texture::LAYERS];
@@ -883,7 +900,7 @@ namespace ouzel
                             {
                                 if (setTexturesCommand->textures[layer])
                                 {
-                                    TextureResourceD3D11* textureD3D11 = static_cast<TextureResourceD3D11*>(resources[setTexturesCommand->textures[layer] - 1].get());
+                                    TextureResourceD3D11* textureD3D11 = textures.get(setTexturesCommand->textures[layer]);
                                     resourceViews[layer] = textureD3D11->getResourceView();
                                     samplers[layer] = textureD3D11->getSamplerState();
                                 }
@@ -904,8 +921,14 @@ namespace ouzel
                             throw std::runtime_error("Invalid command");
                     }
 
-                    if (command->type == Command::Type::PRESENT) return;
+                    if (command->type == Command::Type::PRESENT)
+                    {
+                        presented = true;
+                        break;
+                    }
                 }
+
+                if (presented) return;
             }
         }
 
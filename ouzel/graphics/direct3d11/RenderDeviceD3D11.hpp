@@ -21,6 +21,11 @@ namespace ouzel
 {
     namespace graphics
     {
+        class BlendStateResourceD3D11;
+        class BufferResourceD3D11;
+        class DepthStencilStateResourceD3D11;
+        class ShaderResourceD3D11;
+
         class Direct3D11ErrorCategory: public std::error_category
         {
         public:
@@ -113,7 +118,11 @@ namespace ouzel
             std::atomic_bool running;
             std::thread renderThread;
 
-            std::vector<std::unique_ptr<RenderResourceD3D11>> resources;
+            HandleTable<BlendStateResourceD3D11> blendStates;
+            HandleTable<BufferResourceD3D11> buffers;
+            HandleTable<DepthStencilStateResourceD3D11> depthStencilStates;
+            HandleTable<ShaderResourceD3D11> shaders;
+            HandleTable<TextureResourceD3D11> textures;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -83,7 +83,7 @@ namespace ouzel
         ShaderResourceD3D11::ShaderResourceD3D11(RenderDeviceD3D11& renderDeviceD3D11,
                                                  const std::vector<uint8_t>& fragmentShaderData,
                                                  const std::vector<uint8_t>& vertexShaderData,
-                                                 const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                                                 const VertexLayout& newVertexLayout,
                                                  const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                                                  const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                                                  uint32_t,
@@ -91,7 +91,7 @@ namespace ouzel
                                                  const std::string&,
                                                  const std::string&):
             RenderResourceD3D11(renderDeviceD3D11),
-            vertexAttributes(newVertexAttributes),
+            vertexLayout(newVertexLayout),
             fragmentShaderConstantInfo(newFragmentShaderConstantInfo),
             vertexShaderConstantInfo(newVertexShaderConstantInfo)
         {
@@ -106,68 +106,93 @@ namespace ouzel
 
             std::vector<D3D11_INPUT_ELEMENT_DESC> vertexInputElements;
 
-            UINT offset = 0;
-
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            for (const VertexLayout::Element& element : vertexLayout.getElements())
             {
-                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
+                DXGI_FORMAT vertexFormat = getVertexFormat(element.dataType);
+
+                if (vertexFormat == DXGI_FORMAT_UNKNOWN)
+                    throw std::runtime_error("Invalid vertex format");
+
+                const char* semantic;
+                UINT index = 0;
+
+                switch (element.usage)
                 {
-                    DXGI_FORMAT vertexFormat = getVertexFormat(vertexAttribute.dataType);
-
-                    if (vertexFormat == DXGI_FORMAT_UNKNOWN)
-                        throw std::runtime_error("Invalid vertex format");
-
-                    const char* semantic;
-                    UINT index = 0;
-
-                    switch (vertexAttribute.usage)
-                    {
-                        case Vertex::Attribute::Usage::BINORMAL:
-                            semantic = "BINORMAL";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_INDICES:
-                            semantic = "BLENDINDICES";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_WEIGHT:
-                            semantic = "BLENDWEIGHT";
-                            break;
-                        case Vertex::Attribute::Usage::COLOR:
-                            semantic = "COLOR";
-                            break;
-                        case Vertex::Attribute::Usage::NORMAL:
-                            semantic = "NORMAL";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION:
-                            semantic = "POSITION";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION_TRANSFORMED:
-                            semantic = "POSITIONT";
-                            break;
-                        case Vertex::Attribute::Usage::POINT_SIZE:
-                            semantic = "PSIZE";
-                            break;
-                        case Vertex::Attribute::Usage::TANGENT:
-                            semantic = "TANGENT";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES0:
-                            semantic = "TEXCOORD";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES1:
-                            semantic = "TEXCOORD";
-                            index = 1;
-                            break;
-                        default:
-                            throw std::runtime_error("Invalid vertex attribute usage");
-                    }
-
-                    vertexInputElements.push_back({
-                        semantic, index,
-                        vertexFormat,
-                        0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0
-                    });
+                    case Vertex::Attribute::Usage::BINORMAL:
+                        semantic = "BINORMAL";
+                        break;
+                    case Vertex::Attribute::Usage::BLEND_INDICES:
+                        semantic = "BLENDINDICES";
+                        break;
+                    case Vertex::Attribute::Usage::BLEND_WEIGHT:
+                        semantic = "BLENDWEIGHT";
+                        break;
+                    case Vertex::Attribute::Usage::COLOR:
+                        semantic = "COLOR";
+                        break;
+                    case Vertex::Attribute::Usage::NORMAL:
+                        semantic = "NORMAL";
+                        break;
+                    case Vertex::Attribute::Usage::POSITION:
+                        semantic = "POSITION";
+                        break;
+                    case Vertex::Attribute::Usage::POSITION_TRANSFORMED:
+                        semantic = "POSITIONT";
+                        break;
+                    case Vertex::Attribute::Usage::POINT_SIZE:
+                        semantic = "PSIZE";
+                        break;
+                    case Vertex::Attribute::Usage::TANGENT:
+                        semantic = "TANGENT";
+                        break;
+                    case Vertex::Attribute::Usage::TEXTURE_COORDINATES0:
+                        semantic = "TEXCOORD";
+                        break;
+                    case Vertex::Attribute::Usage::TEXTURE_COORDINATES1:
+                        semantic = "TEXCOORD";
+                        index = 1;
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid vertex attribute usage");
                 }
 
-                offset += getDataTypeSize(vertexAttribute.dataType);
+                vertexInputElements.push_back({
+                    semantic, index,
+                    vertexFormat,
+                    0, element.offset, D3D11_INPUT_PER_VERTEX_DATA, 0
+                });
+            }
+
+            // instance attributes are read from the second input slot
+            for (const VertexLayout::Element& element : vertexLayout.getInstanceElements())
+            {
+                switch (element.usage)
+                {
+                    case Vertex::Attribute::Usage::COLOR:
+                        if (element.dataType != DataType::FLOAT_VECTOR4)
+                            throw std::runtime_error("Invalid instance color format");
+
+                        vertexInputElements.push_back({
+                            "INSTANCECOLOR", 0,
+                            DXGI_FORMAT_R32G32B32A32_FLOAT,
+                            1, element.offset, D3D11_INPUT_PER_INSTANCE_DATA, 1
+                        });
+                        break;
+                    case Vertex::Attribute::Usage::TRANSFORM:
+                        if (element.dataType != DataType::FLOAT_MATRIX4)
+                            throw std::runtime_error("Invalid instance transform format");
+
+                        // one element per matrix column
+                        for (UINT column = 0; column < 4; ++column)
+                            vertexInputElements.push_back({
+                                "INSTANCETRANSFORM", column,
+                                DXGI_FORMAT_R32G32B32A32_FLOAT,
+                                1, element.offset + column * 4 * sizeof(float), D3D11_INPUT_PER_INSTANCE_DATA, 1
+                            });
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid instance attribute usage");
+                }
             }
 
             if (inputLayout) inputLayout->Release();
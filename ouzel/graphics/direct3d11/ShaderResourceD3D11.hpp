@@ -24,7 +24,7 @@ namespace ouzel
             ShaderResourceD3D11(RenderDeviceD3D11& renderDeviceD3D11,
                                 const std::vector<uint8_t>& fragmentShaderData,
                                 const std::vector<uint8_t>& vertexShaderData,
-                                const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                                const VertexLayout& newVertexLayout,
                                 const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                                 const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                                 uint32_t,
@@ -39,11 +39,14 @@ namespace ouzel
                 uint32_t size;
             };
 
-            inline const std::set<Vertex::Attribute::Usage>& getVertexAttributes() const { return vertexAttributes; }
+            inline const VertexLayout& getVertexLayout() const { return vertexLayout; }
 
             const std::vector<Location>& getFragmentShaderConstantLocations() const { return fragmentShaderConstantLocations; }
             const std::vector<Location>& getVertexShaderConstantLocations() const { return vertexShaderConstantLocations; }
 
+            uint32_t getFragmentShaderConstantSize() const { return fragmentShaderConstantSize; }
+            uint32_t getVertexShaderConstantSize() const { return vertexShaderConstantSize; }
+
             ID3D11PixelShader* getFragmentShader() const { return fragmentShader; }
             ID3D11VertexShader* getVertexShader() const { return vertexShader; }
 
@@ -52,7 +55,7 @@ namespace ouzel
             ID3D11InputLayout* getInputLayout() const { return inputLayout; }
 
         private:
-            std::set<Vertex::Attribute::Usage> vertexAttributes;
+            VertexLayout vertexLayout;
 
             std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo;
             std::vector<Shader::ConstantInfo> vertexShaderConstantInfo;
@@ -2,6 +2,8 @@
 
 #include "core/Setup.h"
 
+#include <algorithm>
+
 #if OUZEL_COMPILE_DIRECT3D11
 
 #include "TextureResourceD3D11.hpp"
@@ -44,6 +46,9 @@ namespace ouzel
                 case PixelFormat::RGBA32_UINT: return DXGI_FORMAT_R32G32B32A32_UINT;
                 case PixelFormat::RGBA32_SINT: return DXGI_FORMAT_R32G32B32A32_SINT;
                 case PixelFormat::RGBA32_FLOAT: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+                case PixelFormat::BC1_UNORM: return DXGI_FORMAT_BC1_UNORM;
+                case PixelFormat::BC3_UNORM: return DXGI_FORMAT_BC3_UNORM;
+                case PixelFormat::BC7_UNORM: return DXGI_FORMAT_BC7_UNORM;
                 default: return DXGI_FORMAT_UNKNOWN;
             }
         }
@@ -110,69 +115,61 @@ namespace ouzel
 
             if (!texture)
                 createTexture(levels);
-            else if (!(flags & Texture::RENDER_TARGET))
+            else
             {
-                if (flags & Texture::DYNAMIC)
-                {
-                    for (size_t level = 0; level < levels.size(); ++level)
-                    {
-                        if (!levels[level].data.empty())
-                        {
-                            D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-                            mappedSubresource.pData = nullptr;
-                            mappedSubresource.RowPitch = 0;
-                            mappedSubresource.DepthPitch = 0;
-
-                            HRESULT hr;
-                            if (FAILED(hr = renderDeviceD3D11.getContext()->Map(texture, static_cast<UINT>(level),
-                                                                                (level == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE,
-                                                                                0, &mappedSubresource)))
-                                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to map Direct3D 11 texture");
-
-                            uint8_t* destination = static_cast<uint8_t*>(mappedSubresource.pData);
-
-                            if (mappedSubresource.RowPitch == levels[level].pitch)
-                            {
-                                std::copy(levels[level].data.begin(),
-                                          levels[level].data.end(),
-                                          destination);
-                            }
-                            else
-                            {
-                                auto source = levels[level].data.begin();
-                                UINT rowSize = static_cast<UINT>(levels[level].size.width) * getPixelSize(pixelFormat);
-                                UINT rows = static_cast<UINT>(levels[level].size.height);
-
-                                for (UINT row = 0; row < rows; ++row)
-                                {
-                                    std::copy(source,
-                                              source + rowSize,
-                                              destination);
-
-                                    source += levels[level].pitch;
-                                    destination += mappedSubresource.RowPitch;
-                                }
-                            }
-
-                            renderDeviceD3D11.getContext()->Unmap(texture, static_cast<UINT>(level));
-                        }
-                    }
-                }
-                else
+                for (size_t level = 0; level < levels.size(); ++level)
                 {
-                    for (size_t level = 0; level < levels.size(); ++level)
+                    if (!levels[level].data.empty())
                     {
-                        if (!levels[level].data.empty())
-                        {
-                            renderDeviceD3D11.getContext()->UpdateSubresource(texture, static_cast<UINT>(level),
-                                                                              nullptr, levels[level].data.data(),
-                                                                              static_cast<UINT>(levels[level].pitch), 0);
-                        }
+                        renderDeviceD3D11.getContext()->UpdateSubresource(texture, static_cast<UINT>(level),
+                                                                          nullptr, levels[level].data.data(),
+                                                                          static_cast<UINT>(levels[level].pitch), 0);
                     }
                 }
             }
         }
 
+        void TextureResourceD3D11::setRegionData(uint32_t level, uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                                                 const std::vector<uint8_t>& data)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (isCompressed(pixelFormat))
+                throw std::runtime_error("Regions of compressed textures can't be updated");
+
+            if (level >= mipmaps)
+                throw std::runtime_error("Invalid mip map level");
+
+            UINT levelWidth = std::max(width >> level, 1U);
+            UINT levelHeight = std::max(height >> level, 1U);
+
+            if (regionWidth > levelWidth || x > levelWidth - regionWidth ||
+                regionHeight > levelHeight || y > levelHeight - regionHeight)
+                throw std::runtime_error("Invalid texture region");
+
+            size_t rowSize = getRowPitch(pixelFormat, regionWidth);
+
+            if (data.size() != rowSize * regionHeight)
+                throw std::runtime_error("Invalid texture data size");
+
+            if (!texture)
+                throw std::runtime_error("Texture not initialized");
+
+            D3D11_BOX box;
+            box.left = x;
+            box.top = y;
+            box.front = 0;
+            box.right = x + regionWidth;
+            box.bottom = y + regionHeight;
+            box.back = 1;
+
+            RenderDeviceD3D11& renderDeviceD3D11 = static_cast<RenderDeviceD3D11&>(renderDevice);
+            renderDeviceD3D11.getContext()->UpdateSubresource(texture, static_cast<UINT>(level),
+                                                              &box, data.data(),
+                                                              static_cast<UINT>(rowSize), 0);
+        }
+
         void TextureResourceD3D11::setFilter(Texture::Filter filter)
         {
             samplerDescriptor.filter = (filter == Texture::Filter::DEFAULT) ? renderDevice.getTextureFilter() : filter;
@@ -273,8 +270,8 @@ namespace ouzel
                 textureDescriptor.Format = d3d11PixelFormat;
                 textureDescriptor.SampleDesc.Count = sampleCount;
                 textureDescriptor.SampleDesc.Quality = 0;
-                if (flags & Texture::RENDER_TARGET) textureDescriptor.Usage = D3D11_USAGE_DEFAULT;
-                else if (flags & Texture::DYNAMIC) textureDescriptor.Usage = D3D11_USAGE_DYNAMIC;
+                // dynamic textures are updated with UpdateSubresource, so that parts of them and their mip maps can be replaced
+                if (flags & (Texture::RENDER_TARGET | Texture::DYNAMIC)) textureDescriptor.Usage = D3D11_USAGE_DEFAULT;
                 else textureDescriptor.Usage = D3D11_USAGE_IMMUTABLE;
 
                 if (flags & Texture::RENDER_TARGET)
@@ -285,7 +282,7 @@ namespace ouzel
                 else
                     textureDescriptor.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
-                textureDescriptor.CPUAccessFlags = (flags & Texture::DYNAMIC && !(flags & Texture::RENDER_TARGET)) ? D3D11_CPU_ACCESS_WRITE : 0;
+                textureDescriptor.CPUAccessFlags = 0;
                 textureDescriptor.MiscFlags = 0;
 
                 RenderDeviceD3D11& renderDeviceD3D11 = static_cast<RenderDeviceD3D11&>(renderDevice);
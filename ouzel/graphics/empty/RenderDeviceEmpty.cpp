@@ -1,18 +1,445 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <stdexcept>
 #include "RenderDeviceEmpty.hpp"
+#include "core/Engine.hpp"
+#include "utils/Log.hpp"
+#include "utils/Utils.hpp"
 
 namespace ouzel
 {
     namespace graphics
     {
+        constexpr uint32_t RenderDeviceEmpty::COMMAND_TYPE_COUNT;
+
         RenderDeviceEmpty::RenderDeviceEmpty(const std::function<void(const Event&)>& initCallback):
             RenderDevice(Driver::EMPTY, initCallback)
+#if OUZEL_MULTITHREADED
+            , running(false)
+#endif
+        {
+        }
+
+        RenderDeviceEmpty::~RenderDeviceEmpty()
+        {
+#if OUZEL_MULTITHREADED
+            running = false;
+            CommandBuffer commandBuffer;
+            commandBuffer.push(PresentCommand());
+            submitCommandBuffer(std::move(commandBuffer));
+
+            if (renderThread.joinable()) renderThread.join();
+#endif
+        }
+
+        void RenderDeviceEmpty::init(Window* newWindow,
+                                     const Size2& newSize,
+                                     uint32_t newSampleCount,
+                                     Texture::Filter newTextureFilter,
+                                     uint32_t newMaxAnisotropy,
+                                     bool newVerticalSync,
+                                     bool newDepth,
+                                     bool newDebugRenderer)
+        {
+            RenderDevice::init(newWindow,
+                               newSize,
+                               newSampleCount,
+                               newTextureFilter,
+                               newMaxAnisotropy,
+                               newVerticalSync,
+                               newDepth,
+                               newDebugRenderer);
+
+#if OUZEL_MULTITHREADED
+            running = true;
+            renderThread = std::thread(&RenderDeviceEmpty::main, this);
+#endif
+        }
+
+        RenderDeviceEmpty::Statistics RenderDeviceEmpty::getStatistics() const
         {
+            std::unique_lock<std::mutex> lock(statisticsMutex);
+            return statistics;
+        }
+
+        void RenderDeviceEmpty::initResource(uintptr_t resource, ResourceType type)
+        {
+            if (!resource)
+                throw std::runtime_error("Invalid resource");
+
+            std::vector<uint32_t>& generations = resources[static_cast<uint32_t>(type)];
+            uint32_t index = HandlePool::getIndex(resource);
+
+            if (index >= generations.size())
+                generations.resize(index + 1, 0);
+
+            // initializing a live handle again replaces the resource, like the backends do
+            generations[index] = HandlePool::getGeneration(resource);
+        }
+
+        void RenderDeviceEmpty::checkResource(uintptr_t resource, ResourceType type, bool optional) const
+        {
+            if (!resource)
+            {
+                if (optional) return;
+                throw std::runtime_error("Null resource");
+            }
+
+            const std::vector<uint32_t>& generations = resources[static_cast<uint32_t>(type)];
+            uint32_t index = HandlePool::getIndex(resource);
+
+            if (index >= generations.size() || !generations[index])
+                throw std::runtime_error("Resource " + std::to_string(resource) + " not initialized");
+
+            if (generations[index] != HandlePool::getGeneration(resource))
+                throw std::runtime_error("Resource " + std::to_string(resource) + " is stale");
         }
 
         void RenderDeviceEmpty::process()
         {
+            RenderDevice::process();
+            executeAll();
+
+            CommandBuffer commandBuffer;
+
+            for (;;)
+            {
+#if OUZEL_MULTITHREADED
+                popCommandBuffer(commandBuffer, true);
+#else
+                // the device is processed on the main thread, so it can't wait for the next command buffer
+                if (!popCommandBuffer(commandBuffer, false)) return;
+#endif
+
+                CommandBufferRecycler recycler(*this, commandBuffer);
+
+                ++currentStatistics.commandBufferCount;
+                currentStatistics.constantUploadSize += commandBuffer.getConstantData().size();
+
+                bool presented = false;
+
+                for (const Command* command : commandBuffer)
+                {
+                    // an invalid command is skipped, so that the rest of the frame is still validated and presented
+                    try
+                    {
+                        processCommand(command, commandBuffer);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        engine->log(Log::Level::ERR) << "Invalid command: " << e.what();
+                    }
+
+                    if (command->type == Command::Type::PRESENT)
+                    {
+                        presented = true;
+                        break;
+                    }
+                }
+
+                if (presented) return;
+            }
+        }
+
+        void RenderDeviceEmpty::processCommand(const Command* command, const CommandBuffer& commandBuffer)
+        {
+            if (command->type >= COMMAND_TYPE_COUNT)
+                throw std::runtime_error("Invalid command");
+
+            ++currentStatistics.commandCounts[command->type];
+
+            switch (command->type)
+            {
+                case Command::Type::PRESENT:
+                {
+                    drawCallCount = currentDrawCallCount;
+                    currentDrawCallCount = 0;
+
+                    std::unique_lock<std::mutex> lock(statisticsMutex);
+                    statistics = currentStatistics;
+                    lock.unlock();
+
+                    currentStatistics = Statistics();
+                    break;
+                }
+
+                case Command::Type::DELETE_RESOURCE:
+                {
+                    const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
+                    checkResource(deleteResourceCommand->resource, deleteResourceCommand->resourceType, false);
+                    resources[static_cast<uint32_t>(deleteResourceCommand->resourceType)][HandlePool::getIndex(deleteResourceCommand->resource)] = 0;
+                    break;
+                }
+
+                case Command::Type::INIT_RENDER_TARGET:
+                {
+                    const InitRenderTargetCommand* initRenderTargetCommand = static_cast<const InitRenderTargetCommand*>(command);
+                    initResource(initRenderTargetCommand->renderTarget, ResourceType::RENDER_TARGET);
+                    break;
+                }
+
+                case Command::Type::SET_RENDER_TARGET_PARAMETERS:
+                {
+                    const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command);
+                    checkResource(setRenderTargetParametersCommand->renderTarget, ResourceType::TEXTURE, true);
+                    break;
+                }
+
+                case Command::Type::SET_RENDER_TARGET:
+                {
+                    const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
+                    checkResource(setRenderTargetCommand->renderTarget, ResourceType::TEXTURE, true);
+                    setState(state.renderTarget, setRenderTargetCommand->renderTarget);
+                    break;
+                }
+
+                case Command::Type::CLEAR_RENDER_TARGET:
+                {
+                    const ClearRenderTargetCommand* clearRenderTargetCommand = static_cast<const ClearRenderTargetCommand*>(command);
+                    checkResource(clearRenderTargetCommand->renderTarget, ResourceType::TEXTURE, true);
+                    break;
+                }
+
+                case Command::Type::BLIT:
+                {
+                    const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command);
+                    checkResource(blitCommand->sourceTexture, ResourceType::TEXTURE, false);
+                    checkResource(blitCommand->destinationTexture, ResourceType::TEXTURE, false);
+                    break;
+                }
+
+                case Command::Type::COMPUTE:
+                {
+                    const ComputeCommand* computeCommand = static_cast<const ComputeCommand*>(command);
+                    checkResource(computeCommand->shader, ResourceType::SHADER, false);
+                    break;
+                }
+
+                case Command::Type::SET_CULL_MODE:
+                {
+                    const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command);
+                    setState(state.cullMode, setCullModeCommad->cullMode);
+                    break;
+                }
+
+                case Command::Type::SET_FILL_MODE:
+                {
+                    const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command);
+                    setState(state.fillMode, setFillModeCommad->fillMode);
+                    break;
+                }
+
+                case Command::Type::SET_SCISSOR_TEST:
+                {
+                    const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
+
+                    if (state.scissorTest == setScissorTestCommand->enabled &&
+                        (!state.scissorTest || state.scissorRectangle == setScissorTestCommand->rectangle))
+                        ++currentStatistics.redundantStateChangeCount;
+                    else
+                    {
+                        state.scissorTest = setScissorTestCommand->enabled;
+                        state.scissorRectangle = setScissorTestCommand->rectangle;
+                        ++currentStatistics.stateChangeCount;
+                    }
+                    break;
+                }
+
+                case Command::Type::SET_VIEWPORT:
+                {
+                    const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command);
+                    setState(state.viewport, setViewportCommand->viewport);
+                    break;
+                }
+
+                case Command::Type::INIT_DEPTH_STENCIL_STATE:
+                {
+                    const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
+                    initResource(initDepthStencilStateCommand->depthStencilState, ResourceType::DEPTH_STENCIL_STATE);
+                    break;
+                }
+
+                case Command::Type::SET_DEPTH_STENCIL_STATE:
+                {
+                    const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
+                    checkResource(setDepthStencilStateCommand->depthStencilState, ResourceType::DEPTH_STENCIL_STATE, true);
+                    setState(state.depthStencilState, setDepthStencilStateCommand->depthStencilState);
+                    break;
+                }
+
+                case Command::Type::SET_PIPELINE_STATE:
+                {
+                    const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
+                    checkResource(setPipelineStateCommand->blendState, ResourceType::BLEND_STATE, true);
+                    checkResource(setPipelineStateCommand->shader, ResourceType::SHADER, true);
+
+                    if (state.blendState == setPipelineStateCommand->blendState &&
+                        state.shader == setPipelineStateCommand->shader)
+                        ++currentStatistics.redundantStateChangeCount;
+                    else
+                    {
+                        state.blendState = setPipelineStateCommand->blendState;
+                        state.shader = setPipelineStateCommand->shader;
+                        ++currentStatistics.stateChangeCount;
+                    }
+                    break;
+                }
+
+                case Command::Type::DRAW:
+                {
+                    const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command);
+                    ++currentDrawCallCount;
+
+                    checkResource(drawCommand->indexBuffer, ResourceType::BUFFER, false);
+                    checkResource(drawCommand->vertexBuffer, ResourceType::BUFFER, false);
+                    checkResource(drawCommand->instanceBuffer, ResourceType::BUFFER, true);
+
+                    if (!state.shader)
+                        throw std::runtime_error("No shader set");
+
+                    if (drawCommand->indexSize != 2 && drawCommand->indexSize != 4)
+                        throw std::runtime_error("Invalid index size");
+
+                    ++currentStatistics.drawCallCount;
+                    currentStatistics.vertexCount += static_cast<uint64_t>(drawCommand->indexCount) *
+                        (drawCommand->instanceBuffer ? drawCommand->instanceCount : 1);
+                    break;
+                }
+
+                case Command::Type::PUSH_DEBUG_MARKER:
+                case Command::Type::POP_DEBUG_MARKER:
+                    break;
+
+                case Command::Type::INIT_BLEND_STATE:
+                {
+                    const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
+                    initResource(initBlendStateCommand->blendState, ResourceType::BLEND_STATE);
+                    break;
+                }
+
+                case Command::Type::INIT_BUFFER:
+                {
+                    const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command);
+                    initResource(initBufferCommand->buffer, ResourceType::BUFFER);
+                    currentStatistics.bufferUploadSize += initBufferCommand->data.size();
+                    break;
+                }
+
+                case Command::Type::SET_BUFFER_DATA:
+                {
+                    const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
+                    checkResource(setBufferDataCommand->buffer, ResourceType::BUFFER, false);
+                    currentStatistics.bufferUploadSize += setBufferDataCommand->data.size();
+                    break;
+                }
+
+                case Command::Type::INIT_SHADER:
+                {
+                    const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command);
+                    initResource(initShaderCommand->shader, ResourceType::SHADER);
+                    break;
+                }
+
+                case Command::Type::SET_SHADER_CONSTANTS:
+                {
+                    const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
+
+                    if (!state.shader)
+                        throw std::runtime_error("No shader set");
+
+                    const std::vector<uint8_t>& constantData = commandBuffer.getConstantData();
+                    const ConstantBlock& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
+                    const ConstantBlock& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
+
+                    if (fragmentShaderConstants.size && fragmentShaderConstants.offset + fragmentShaderConstants.size > constantData.size())
+                        throw std::runtime_error("Invalid pixel shader constant block");
+
+                    if (vertexShaderConstants.size && vertexShaderConstants.offset + vertexShaderConstants.size > constantData.size())
+                        throw std::runtime_error("Invalid vertex shader constant block");
+                    break;
+                }
+
+                case Command::Type::INIT_TEXTURE:
+                {
+                    const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command);
+                    initResource(initTextureCommand->texture, ResourceType::TEXTURE);
+
+                    for (const Texture::Level& level : initTextureCommand->levels)
+                        currentStatistics.textureUploadSize += level.data.size();
+                    break;
+                }
+
+                case Command::Type::SET_TEXTURE_DATA:
+                {
+                    const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
+                    checkResource(setTextureDataCommand->texture, ResourceType::TEXTURE, false);
+
+                    for (const Texture::Level& level : setTextureDataCommand->levels)
+                        currentStatistics.textureUploadSize += level.data.size();
+                    break;
+                }
+
+                case Command::Type::SET_TEXTURE_REGION_DATA:
+                {
+                    const SetTextureRegionDataCommand* setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command);
+                    checkResource(setTextureRegionDataCommand->texture, ResourceType::TEXTURE, false);
+
+                    currentStatistics.textureUploadSize += setTextureRegionDataCommand->data.size();
+                    break;
+                }
+
+                case Command::Type::SET_TEXTURE_PARAMETERS:
+                {
+                    const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
+                    checkResource(setTextureParametersCommand->texture, ResourceType::TEXTURE, false);
+                    break;
+                }
+
+                case Command::Type::SET_TEXTURES:
+                {
+                    const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
+                    bool changed = false;
+
+                    for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
+                    {
+                        checkResource(setTexturesCommand->textures[layer], ResourceType::TEXTURE, true);
+
+                        if (state.textures[layer] != setTexturesCommand->textures[layer])
+                        {
+                            state.textures[layer] = setTexturesCommand->textures[layer];
+                            changed = true;
+                        }
+                    }
+
+                    if (changed)
+                        ++currentStatistics.stateChangeCount;
+                    else
+                        ++currentStatistics.redundantStateChangeCount;
+                    break;
+                }
+
+                default:
+                    throw std::runtime_error("Invalid command");
+            }
+        }
+
+#if OUZEL_MULTITHREADED
+        void RenderDeviceEmpty::main()
+        {
+            setCurrentThreadName("Render");
+
+            while (running)
+            {
+                try
+                {
+                    process();
+                }
+                catch (const std::exception& e)
+                {
+                    engine->log(Log::Level::ERR) << e.what();
+                }
+            }
         }
+#endif
     } // namespace graphics
 } // namespace ouzel
@@ -3,19 +3,105 @@
 #ifndef OUZEL_GRAPHICS_RENDERDEVICEEMPTY_HPP
 #define OUZEL_GRAPHICS_RENDERDEVICEEMPTY_HPP
 
+#include "core/Setup.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#if OUZEL_MULTITHREADED
+#  include <thread>
+#endif
+#include <vector>
 #include "graphics/RenderDevice.hpp"
 
 namespace ouzel
 {
     namespace graphics
     {
+        // headless device that consumes the command buffers like a real device, validates the
+        // resource handles and collects statistics, but doesn't render anything
         class RenderDeviceEmpty final: public RenderDevice
         {
             friend Renderer;
+        public:
+            static constexpr uint32_t COMMAND_TYPE_COUNT = Command::Type::SET_TEXTURES + 1;
+
+            struct Statistics final
+            {
+                uint32_t commandCounts[COMMAND_TYPE_COUNT] = {};
+                uint32_t commandBufferCount = 0;
+                uint32_t drawCallCount = 0;
+                uint64_t vertexCount = 0; // indices processed by the draw calls, multiplied by the instance count
+                uint64_t bufferUploadSize = 0;
+                uint64_t textureUploadSize = 0;
+                uint64_t constantUploadSize = 0;
+                uint32_t stateChangeCount = 0; // state commands that changed the current state
+                uint32_t redundantStateChangeCount = 0; // state commands that set the current state again
+            };
+
+            ~RenderDeviceEmpty();
+
+            // statistics of the last presented frame
+            Statistics getStatistics() const;
+
         protected:
             RenderDeviceEmpty(const std::function<void(const Event&)>& initCallback);
 
+            void init(Window* newWindow,
+                      const Size2& newSize,
+                      uint32_t newSampleCount,
+                      Texture::Filter newTextureFilter,
+                      uint32_t newMaxAnisotropy,
+                      bool newVerticalSync,
+                      bool newDepth,
+                      bool newDebugRenderer) override;
+
             void process() override;
+
+        private:
+            void initResource(uintptr_t resource, ResourceType type);
+            void checkResource(uintptr_t resource, ResourceType type, bool optional) const;
+            void processCommand(const Command* command, const CommandBuffer& commandBuffer);
+
+            template<class T>
+            void setState(T& current, const T& value)
+            {
+                if (current == value)
+                    ++currentStatistics.redundantStateChangeCount;
+                else
+                {
+                    current = value;
+                    ++currentStatistics.stateChangeCount;
+                }
+            }
+
+#if OUZEL_MULTITHREADED
+            void main();
+
+            std::atomic_bool running;
+            std::thread renderThread;
+#endif
+
+            std::vector<uint32_t> resources[RESOURCE_TYPE_COUNT]; // generations of the initialized resources, zero if not initialized
+
+            struct State final
+            {
+                uintptr_t renderTarget = 0;
+                CullMode cullMode = CullMode::NONE;
+                FillMode fillMode = FillMode::SOLID;
+                bool scissorTest = false;
+                Rect scissorRectangle;
+                Rect viewport;
+                uintptr_t depthStencilState = 0;
+                uintptr_t blendState = 0;
+                uintptr_t shader = 0;
+                uintptr_t textures[Texture::LAYERS] = {};
+            };
+
+            State state;
+
+            Statistics currentStatistics;
+            Statistics statistics;
+            mutable std::mutex statisticsMutex;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -55,6 +55,8 @@ namespace ouzel
     namespace graphics
     {
         class BlendStateResourceMetal;
+        class BufferResourceMetal;
+        class DepthStencilStateResourceMetal;
         class ShaderResourceMetal;
 
         class RenderDeviceMetal: public RenderDevice
@@ -144,7 +146,11 @@ namespace ouzel
 
             std::map<PipelineStateDesc, MTLRenderPipelineStatePtr> pipelineStates;
 
-            std::vector<std::unique_ptr<RenderResourceMetal>> resources;
+            HandleTable<BlendStateResourceMetal> blendStates;
+            HandleTable<BufferResourceMetal> buffers;
+            HandleTable<DepthStencilStateResourceMetal> depthStencilStates;
+            HandleTable<ShaderResourceMetal> shaders;
+            HandleTable<TextureResourceMetal> textures;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -45,7 +45,11 @@ namespace ouzel
 
         RenderDeviceMetal::~RenderDeviceMetal()
         {
-            resources.clear();
+            textures.clear();
+            shaders.clear();
+            buffers.clear();
+            depthStencilStates.clear();
+            blendStates.clear();
 
             for (const ShaderConstantBuffer& shaderConstantBuffer : shaderConstantBuffers)
                 for (MTLBufferPtr buffer : shaderConstantBuffer.buffers)
@@ -262,7 +266,6 @@ namespace ouzel
             id<MTLRenderCommandEncoder> currentRenderCommandEncoder = nil;
             PipelineStateDesc currentPipelineStateDesc;
             MTLTexturePtr currentRenderTarget = nil;
-            std::vector<float> shaderData;
 
             if (++shaderConstantBufferIndex >= BUFFER_COUNT) shaderConstantBufferIndex = 0;
             ShaderConstantBuffer& shaderConstantBuffer = shaderConstantBuffers[shaderConstantBufferIndex];
@@ -274,23 +277,20 @@ namespace ouzel
 
             for (;;)
             {
-                std::unique_lock<std::mutex> lock(commandQueueMutex);
-                while (commandQueue.empty()) commandQueueCondition.wait(lock);
-                commandBuffer = std::move(commandQueue.front());
-                commandQueue.pop();
-                lock.unlock();
+                popCommandBuffer(commandBuffer, true);
+                CommandBufferRecycler recycler(*this, commandBuffer);
 
-                std::unique_ptr<Command> command;
+                bool presented = false;
 
-                while (!commandBuffer.commands.empty())
+                for (const Command* command : commandBuffer)
                 {
-                    command = std::move(commandBuffer.commands.front());
-                    commandBuffer.commands.pop();
-
                     switch (command->type)
                     {
                         case Command::Type::PRESENT:
                         {
+                            drawCallCount = currentDrawCallCount;
+                            currentDrawCallCount = 0;
+
                             if (currentRenderCommandEncoder)
                                 [currentRenderCommandEncoder endEncoding];
 
@@ -304,20 +304,28 @@ namespace ouzel
 
                         case Command::Type::DELETE_RESOURCE:
                         {
-                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
-                            resources[deleteResourceCommand->resource - 1].reset();
+                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
+                            switch (deleteResourceCommand->resourceType)
+                            {
+                                case ResourceType::BLEND_STATE: blendStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::BUFFER: buffers.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::DEPTH_STENCIL_STATE: depthStencilStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::SHADER: shaders.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::TEXTURE: textures.erase(deleteResourceCommand->resource); break;
+                                default: break; // render targets are not created on the device
+                            }
                             break;
                         }
 
                         case Command::Type::SET_RENDER_TARGET:
                         {
-                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                             MTLRenderPassDescriptorPtr newRenderPassDescriptor;
 
                             if (setRenderTargetCommand->renderTarget)
                             {
-                                TextureResourceMetal* renderTargetMetal = static_cast<TextureResourceMetal*>(resources[setRenderTargetCommand->renderTarget - 1].get());
+                                TextureResourceMetal* renderTargetMetal = textures.get(setRenderTargetCommand->renderTarget);
 
                                 currentRenderTarget = renderTargetMetal->getTexture();
                                 newRenderPassDescriptor = renderTargetMetal->getRenderPassDescriptor();
@@ -357,11 +365,11 @@ namespace ouzel
 
                         case Command::Type::SET_RENDER_TARGET_PARAMETERS:
                         {
-                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command.get());
+                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command);
 
                             if (setRenderTargetParametersCommand->renderTarget)
                             {
-                                TextureResourceMetal* renderTargetMetal = static_cast<TextureResourceMetal*>(resources[setRenderTargetParametersCommand->renderTarget - 1].get());
+                                TextureResourceMetal* renderTargetMetal = textures.get(setRenderTargetParametersCommand->renderTarget);
                                 renderTargetMetal->setClearColorBuffer(setRenderTargetParametersCommand->clearColorBuffer);
                                 renderTargetMetal->setClearDepthBuffer(setRenderTargetParametersCommand->clearDepthBuffer);
                                 renderTargetMetal->setClearColor(setRenderTargetParametersCommand->clearColor);
@@ -380,7 +388,7 @@ namespace ouzel
 
                         case Command::Type::CLEAR_RENDER_TARGET:
                         {
-                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                             MTLRenderPassDescriptorPtr newRenderPassDescriptor;
                             MTLLoadAction newColorBufferLoadAction = MTLLoadActionLoad;
@@ -392,7 +400,7 @@ namespace ouzel
                             // render target
                             if (clearCommand->renderTarget)
                             {
-                                TextureResourceMetal* renderTargetMetal = static_cast<TextureResourceMetal*>(resources[clearCommand->renderTarget - 1].get());
+                                TextureResourceMetal* renderTargetMetal = textures.get(clearCommand->renderTarget);
 
                                 newRenderPassDescriptor = renderTargetMetal->getRenderPassDescriptor();
                                 if (!newRenderPassDescriptor) break;
@@ -450,14 +458,14 @@ namespace ouzel
 
                         case Command::Type::BLIT:
                         {
-                            //const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command.get());
+                            //const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command);
                             //MTLBlitCommandEncoder
                             break;
                         }
 
                         case Command::Type::SET_CULL_MODE:
                         {
-                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command.get());
+                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -479,7 +487,7 @@ namespace ouzel
 
                         case Command::Type::SET_FILL_MODE:
                         {
-                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command.get());
+                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -500,7 +508,7 @@ namespace ouzel
 
                         case Command::Type::SET_SCISSOR_TEST:
                         {
-                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -532,7 +540,7 @@ namespace ouzel
 
                         case Command::Type::SET_VIEWPORT:
                         {
-                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -552,29 +560,27 @@ namespace ouzel
 
                         case Command::Type::INIT_DEPTH_STENCIL_STATE:
                         {
-                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                             std::unique_ptr<DepthStencilStateResourceMetal> depthStencilStateResourceMetal(new DepthStencilStateResourceMetal(*this,
                                                                                                                                               initDepthStencilStateCommand->depthTest,
                                                                                                                                               initDepthStencilStateCommand->depthWrite,
                                                                                                                                               initDepthStencilStateCommand->compareFunction));
 
-                            if (initDepthStencilStateCommand->depthStencilState > resources.size())
-                                resources.resize(initDepthStencilStateCommand->depthStencilState);
-                            resources[initDepthStencilStateCommand->depthStencilState - 1] = std::move(depthStencilStateResourceMetal);
+                            depthStencilStates.insert(initDepthStencilStateCommand->depthStencilState, std::move(depthStencilStateResourceMetal));
 
                             break;
                         }
 
                         case Command::Type::SET_DEPTH_STENCIL_STATE:
                         {
-                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
 
                             if (setDepthStencilStateCommand->depthStencilState)
                             {
-                                DepthStencilStateResourceMetal* depthStencilStateMetal = static_cast<DepthStencilStateResourceMetal*>(resources[setDepthStencilStateCommand->depthStencilState - 1].get());
+                                DepthStencilStateResourceMetal* depthStencilStateMetal = depthStencilStates.get(setDepthStencilStateCommand->depthStencilState);
                                 [currentRenderCommandEncoder setDepthStencilState:depthStencilStateMetal->getDepthStencilState()];
                             }
                             else
@@ -585,13 +591,13 @@ namespace ouzel
 
                         case Command::Type::SET_PIPELINE_STATE:
                         {
-                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
 
-                            BlendStateResourceMetal* blendStateMetal = static_cast<BlendStateResourceMetal*>(resources[setPipelineStateCommand->blendState - 1].get());
-                            ShaderResourceMetal* shaderMetal = static_cast<ShaderResourceMetal*>(resources[setPipelineStateCommand->shader - 1].get());
+                            BlendStateResourceMetal* blendStateMetal = blendStates.get(setPipelineStateCommand->blendState);
+                            ShaderResourceMetal* shaderMetal = shaders.get(setPipelineStateCommand->shader);
                             currentShader = shaderMetal;
 
                             currentPipelineStateDesc.blendState = blendStateMetal;
@@ -605,14 +611,15 @@ namespace ouzel
 
                         case Command::Type::DRAW:
                         {
-                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command.get());
+                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command);
+                            ++currentDrawCallCount;
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
 
                             // mesh buffer
-                            BufferResourceMetal* indexBufferMetal = static_cast<BufferResourceMetal*>(resources[drawCommand->indexBuffer - 1].get());
-                            BufferResourceMetal* vertexBufferMetal = static_cast<BufferResourceMetal*>(resources[drawCommand->vertexBuffer - 1].get());
+                            BufferResourceMetal* indexBufferMetal = buffers.get(drawCommand->indexBuffer);
+                            BufferResourceMetal* vertexBufferMetal = buffers.get(drawCommand->vertexBuffer);
 
                             assert(indexBufferMetal);
                             assert(indexBufferMetal->getBuffer());
@@ -621,6 +628,16 @@ namespace ouzel
 
                             [currentRenderCommandEncoder setVertexBuffer:vertexBufferMetal->getBuffer() offset:0 atIndex:0];
 
+                            if (drawCommand->instanceBuffer)
+                            {
+                                BufferResourceMetal* instanceBufferMetal = buffers.get(drawCommand->instanceBuffer);
+
+                                assert(instanceBufferMetal);
+                                assert(instanceBufferMetal->getBuffer());
+
+                                [currentRenderCommandEncoder setVertexBuffer:instanceBufferMetal->getBuffer() offset:0 atIndex:2];
+                            }
+
                             // draw
                             MTLPrimitiveType primitiveType;
 
@@ -647,18 +664,26 @@ namespace ouzel
                                 default: throw std::runtime_error("Invalid index size");
                             }
 
-                            [currentRenderCommandEncoder drawIndexedPrimitives:primitiveType
-                                                                    indexCount:drawCommand->indexCount
-                                                                     indexType:indexType
-                                                                   indexBuffer:indexBufferMetal->getBuffer()
-                                                             indexBufferOffset:drawCommand->startIndex * drawCommand->indexSize];
+                            if (drawCommand->instanceBuffer)
+                                [currentRenderCommandEncoder drawIndexedPrimitives:primitiveType
+                                                                        indexCount:drawCommand->indexCount
+                                                                         indexType:indexType
+                                                                       indexBuffer:indexBufferMetal->getBuffer()
+                                                                 indexBufferOffset:drawCommand->startIndex * drawCommand->indexSize
+                                                                     instanceCount:drawCommand->instanceCount];
+                            else
+                                [currentRenderCommandEncoder drawIndexedPrimitives:primitiveType
+                                                                        indexCount:drawCommand->indexCount
+                                                                         indexType:indexType
+                                                                       indexBuffer:indexBufferMetal->getBuffer()
+                                                                 indexBufferOffset:drawCommand->startIndex * drawCommand->indexSize];
 
                             break;
                         }
 
                         case Command::Type::PUSH_DEBUG_MARKER:
                         {
-                            const PushDebugMarkerCommand* pushDebugMarkerCommand = static_cast<const PushDebugMarkerCommand*>(command.get());
+                            const PushDebugMarkerCommand* pushDebugMarkerCommand = static_cast<const PushDebugMarkerCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -680,7 +705,7 @@ namespace ouzel
 
                         case Command::Type::INIT_BLEND_STATE:
                         {
-                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                             std::unique_ptr<BlendStateResourceMetal> blendStateResourceMetal(new BlendStateResourceMetal(*this,
                                                                                                                          initBlendStateCommand->enableBlending,
@@ -692,15 +717,13 @@ namespace ouzel
                                                                                                                          initBlendStateCommand->alphaOperation,
                                                                                                                          initBlendStateCommand->colorMask));
 
-                            if (initBlendStateCommand->blendState > resources.size())
-                                resources.resize(initBlendStateCommand->blendState);
-                            resources[initBlendStateCommand->blendState - 1] = std::move(blendStateResourceMetal);
+                            blendStates.insert(initBlendStateCommand->blendState, std::move(blendStateResourceMetal));
                             break;
                         }
 
                         case Command::Type::INIT_BUFFER:
                         {
-                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                             std::unique_ptr<BufferResourceMetal> bufferResourceMetal(new BufferResourceMetal(*this,
                                                                                                              initBufferCommand->usage,
@@ -708,29 +731,27 @@ namespace ouzel
                                                                                                              initBufferCommand->data,
                                                                                                              initBufferCommand->size));
 
-                            if (initBufferCommand->buffer > resources.size())
-                                resources.resize(initBufferCommand->buffer);
-                            resources[initBufferCommand->buffer - 1] = std::move(bufferResourceMetal);
+                            buffers.insert(initBufferCommand->buffer, std::move(bufferResourceMetal));
                             break;
                         }
 
                         case Command::Type::SET_BUFFER_DATA:
                         {
-                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
-                            BufferResourceMetal* bufferResourceMetal = static_cast<BufferResourceMetal*>(resources[setBufferDataCommand->buffer - 1].get());
+                            BufferResourceMetal* bufferResourceMetal = buffers.get(setBufferDataCommand->buffer);
                             bufferResourceMetal->setData(setBufferDataCommand->data);
                             break;
                         }
 
                         case Command::Type::INIT_SHADER:
                         {
-                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                             std::unique_ptr<ShaderResourceMetal> shaderResourceMetal(new ShaderResourceMetal(*this,
                                                                                                              initShaderCommand->fragmentShader,
                                                                                                              initShaderCommand->vertexShader,
-                                                                                                             initShaderCommand->vertexAttributes,
+                                                                                                             initShaderCommand->vertexLayout,
                                                                                                              initShaderCommand->fragmentShaderConstantInfo,
                                                                                                              initShaderCommand->vertexShaderConstantInfo,
                                                                                                              initShaderCommand->fragmentShaderDataAlignment,
@@ -738,15 +759,13 @@ namespace ouzel
                                                                                                              initShaderCommand->fragmentShaderFunction,
                                                                                                              initShaderCommand->vertexShaderFunction));
 
-                            if (initShaderCommand->shader > resources.size())
-                                resources.resize(initShaderCommand->shader);
-                            resources[initShaderCommand->shader - 1] = std::move(shaderResourceMetal);
+                            shaders.insert(initShaderCommand->shader, std::move(shaderResourceMetal));
                             break;
                         }
 
                         case Command::Type::SET_SHADER_CONSTANTS:
                         {
-                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -754,29 +773,18 @@ namespace ouzel
                             if (!currentShader)
                                 throw std::runtime_error("No shader set");
 
+                            const std::vector<uint8_t>& constantData = commandBuffer.getConstantData();
+
                             // pixel shader constants
-                            const std::vector<ShaderResourceMetal::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
+                            const ConstantBlock& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
 
-                            if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
+                            if (fragmentShaderConstants.size > currentShader->getFragmentShaderConstantBufferSize())
                                 throw std::runtime_error("Invalid pixel shader constant size");
 
-                            shaderData.clear();
-
-                            for (size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
-                            {
-                                const ShaderResourceMetal::Location& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                                const std::vector<float>& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
-
-                                if (sizeof(float) * fragmentShaderConstant.size() != fragmentShaderConstantLocation.size)
-                                    throw std::runtime_error("Invalid pixel shader constant size");
-
-                                shaderData.insert(shaderData.end(), fragmentShaderConstant.begin(), fragmentShaderConstant.end());
-                            }
-
                             shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getFragmentShaderAlignment() - 1) /
                                                            currentShader->getFragmentShaderAlignment()) * currentShader->getFragmentShaderAlignment(); // round up to nearest aligned pointer
 
-                            if (shaderConstantBuffer.offset + getVectorSize(shaderData) > BUFFER_SIZE)
+                            if (shaderConstantBuffer.offset + fragmentShaderConstants.size > BUFFER_SIZE)
                             {
                                 ++shaderConstantBuffer.index;
                                 shaderConstantBuffer.offset = 0;
@@ -795,39 +803,26 @@ namespace ouzel
 
                             MTLBufferPtr currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index];
 
-                            std::copy(reinterpret_cast<const char*>(shaderData.data()),
-                                      reinterpret_cast<const char*>(shaderData.data()) + static_cast<uint32_t>(sizeof(float) * shaderData.size()),
-                                      static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset);
+                            std::copy(constantData.data() + fragmentShaderConstants.offset,
+                                      constantData.data() + fragmentShaderConstants.offset + fragmentShaderConstants.size,
+                                      static_cast<uint8_t*>([currentBuffer contents]) + shaderConstantBuffer.offset);
 
                             [currentRenderCommandEncoder setFragmentBuffer:currentBuffer
                                                                     offset:shaderConstantBuffer.offset
                                                                    atIndex:1];
 
-                            shaderConstantBuffer.offset += static_cast<uint32_t>(getVectorSize(shaderData));
+                            shaderConstantBuffer.offset += fragmentShaderConstants.size;
 
                             // vertex shader constants
-                            const std::vector<ShaderResourceMetal::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                            const ConstantBlock& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                            if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                            if (vertexShaderConstants.size > currentShader->getVertexShaderConstantBufferSize())
                                 throw std::runtime_error("Invalid vertex shader constant size");
 
-                            shaderData.clear();
-
-                            for (size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
-                            {
-                                const ShaderResourceMetal::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                                const std::vector<float>& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
-
-                                if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
-                                    throw std::runtime_error("Invalid vertex shader constant size");
-
-                                shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
-                            }
-
                             shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + currentShader->getVertexShaderAlignment() - 1) /
                                                            currentShader->getVertexShaderAlignment()) * currentShader->getVertexShaderAlignment(); // round up to nearest aligned pointer
 
-                            if (shaderConstantBuffer.offset + getVectorSize(shaderData) > BUFFER_SIZE)
+                            if (shaderConstantBuffer.offset + vertexShaderConstants.size > BUFFER_SIZE)
                             {
                                 ++shaderConstantBuffer.index;
                                 shaderConstantBuffer.offset = 0;
@@ -846,22 +841,22 @@ namespace ouzel
 
                             currentBuffer = shaderConstantBuffer.buffers[shaderConstantBuffer.index];
 
-                            std::copy(reinterpret_cast<const char*>(shaderData.data()),
-                                      reinterpret_cast<const char*>(shaderData.data()) + static_cast<uint32_t>(sizeof(float) * shaderData.size()),
-                                      static_cast<char*>([currentBuffer contents]) + shaderConstantBuffer.offset);
+                            std::copy(constantData.data() + vertexShaderConstants.offset,
+                                      constantData.data() + vertexShaderConstants.offset + vertexShaderConstants.size,
+                                      static_cast<uint8_t*>([currentBuffer contents]) + shaderConstantBuffer.offset);
 
                             [currentRenderCommandEncoder setVertexBuffer:currentBuffer
                                                                   offset:shaderConstantBuffer.offset
                                                                  atIndex:1];
 
-                            shaderConstantBuffer.offset += static_cast<uint32_t>(getVectorSize(shaderData));
+                            shaderConstantBuffer.offset += vertexShaderConstants.size;
 
                             break;
                         }
 
                         case Command::Type::INIT_TEXTURE:
                         {
-                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                             std::unique_ptr<TextureResourceMetal> textureResourceMetal(new TextureResourceMetal(*this,
                                                                                                                 initTextureCommand->levels,
@@ -869,27 +864,40 @@ namespace ouzel
                                                                                                                 initTextureCommand->sampleCount,
                                                                                                                 initTextureCommand->pixelFormat));
 
-                            if (initTextureCommand->texture > resources.size())
-                                resources.resize(initTextureCommand->texture);
-                            resources[initTextureCommand->texture - 1] = std::move(textureResourceMetal);
+                            textures.insert(initTextureCommand->texture, std::move(textureResourceMetal));
                             break;
                         }
 
                         case Command::Type::SET_TEXTURE_DATA:
                         {
-                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
-                            TextureResourceMetal* textureResourceMetal = static_cast<TextureResourceMetal*>(resources[setTextureDataCommand->texture - 1].get());
+                            TextureResourceMetal* textureResourceMetal = textures.get(setTextureDataCommand->texture);
                             textureResourceMetal->setData(setTextureDataCommand->levels);
 
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            const SetTextureRegionDataCommand* setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command);
+
+                            TextureResourceMetal* textureResourceMetal = textures.get(setTextureRegionDataCommand->texture);
+                            textureResourceMetal->setRegionData(setTextureRegionDataCommand->level,
+                                                                setTextureRegionDataCommand->x,
+                                                                setTextureRegionDataCommand->y,
+                                                                setTextureRegionDataCommand->width,
+                                                                setTextureRegionDataCommand->height,
+                                                                setTextureRegionDataCommand->data);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
-                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
-                            TextureResourceMetal* textureResourceMetal = static_cast<TextureResourceMetal*>(resources[setTextureParametersCommand->texture - 1].get());
+                            TextureResourceMetal* textureResourceMetal = textures.get(setTextureParametersCommand->texture);
                             textureResourceMetal->setFilter(setTextureParametersCommand->filter);
                             textureResourceMetal->setAddressX(setTextureParametersCommand->addressX);
                             textureResourceMetal->setAddressY(setTextureParametersCommand->addressY);
@@ -900,7 +908,7 @@ namespace ouzel
 
                         case Command::Type::SET_TEXTURES:
                         {
-                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                             if (!currentRenderCommandEncoder)
                                 throw std::runtime_error("Metal render command encoder not initialized");
@@ -909,7 +917,7 @@ namespace ouzel
                             {
                                 if (setTexturesCommand->textures[layer])
                                 {
-                                    TextureResourceMetal* textureMetal = static_cast<TextureResourceMetal*>(resources[setTexturesCommand->textures[layer] - 1].get());
+                                    TextureResourceMetal* textureMetal = textures.get(setTexturesCommand->textures[layer]);
                                     [currentRenderCommandEncoder setFragmentTexture:textureMetal->getTexture() atIndex:layer];
                                     [currentRenderCommandEncoder setFragmentSamplerState:textureMetal->getSamplerState() atIndex:layer];
                                 }
@@ -926,8 +934,14 @@ namespace ouzel
                         default: throw std::runtime_error("Invalid command");
                     }
 
-                    if (command->type == Command::Type::PRESENT) return;
+                    if (command->type == Command::Type::PRESENT)
+                    {
+                        presented = true;
+                        break;
+                    }
                 }
+
+                if (presented) return;
             }
         }
 
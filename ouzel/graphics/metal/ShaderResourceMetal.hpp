@@ -32,7 +32,7 @@ namespace ouzel
             ShaderResourceMetal(RenderDeviceMetal& renderDeviceMetal,
                                 const std::vector<uint8_t>& fragmentShaderData,
                                 const std::vector<uint8_t>& vertexShaderData,
-                                const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                                const VertexLayout& newVertexLayout,
                                 const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                                 const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                                 uint32_t newFragmentShaderDataAlignment,
@@ -47,7 +47,7 @@ namespace ouzel
                 uint32_t size;
             };
 
-            inline const std::set<Vertex::Attribute::Usage>& getVertexAttributes() const { return vertexAttributes; }
+            inline const VertexLayout& getVertexLayout() const { return vertexLayout; }
 
             inline uint32_t getFragmentShaderAlignment() const { return fragmentShaderAlignment; }
             inline uint32_t getVertexShaderAlignment() const { return vertexShaderAlignment; }
@@ -64,7 +64,7 @@ namespace ouzel
             inline uint32_t getVertexShaderConstantBufferSize() const { return vertexShaderConstantSize; }
 
         private:
-            std::set<Vertex::Attribute::Usage> vertexAttributes;
+            VertexLayout vertexLayout;
 
             std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo;
             uint32_t fragmentShaderAlignment = 0;
@@ -85,7 +85,7 @@ namespace ouzel
         ShaderResourceMetal::ShaderResourceMetal(RenderDeviceMetal& renderDeviceMetal,
                                                  const std::vector<uint8_t>& fragmentShaderData,
                                                  const std::vector<uint8_t>& vertexShaderData,
-                                                 const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                                                 const VertexLayout& newVertexLayout,
                                                  const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                                                  const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                                                  uint32_t newFragmentShaderDataAlignment,
@@ -93,7 +93,7 @@ namespace ouzel
                                                  const std::string& fragmentShaderFunction,
                                                  const std::string& vertexShaderFunction):
             RenderResourceMetal(renderDeviceMetal),
-            vertexAttributes(newVertexAttributes),
+            vertexLayout(newVertexLayout),
             fragmentShaderConstantInfo(newFragmentShaderConstantInfo),
             vertexShaderConstantInfo(newVertexShaderConstantInfo)
         {
@@ -118,32 +118,52 @@ namespace ouzel
             }
 
             uint32_t index = 0;
-            NSUInteger offset = 0;
 
             vertexDescriptor = [MTLVertexDescriptor new];
 
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            for (const VertexLayout::Element& element : vertexLayout.getElements())
             {
-                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
+                MTLVertexFormat vertexFormat = getVertexFormat(element.dataType);
+
+                if (vertexFormat == MTLVertexFormatInvalid)
+                    throw std::runtime_error("Invalid vertex format");
+
+                vertexDescriptor.attributes[index].format = vertexFormat;
+                vertexDescriptor.attributes[index].offset = element.offset;
+                vertexDescriptor.attributes[index].bufferIndex = 0;
+                ++index;
+            }
+
+            vertexDescriptor.layouts[0].stride = vertexLayout.getStride();
+            vertexDescriptor.layouts[0].stepRate = 1;
+            vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
+
+            // buffer 1 holds the vertex shader constants, so the instance data is read from buffer 2
+            if (vertexLayout.isInstanced())
+            {
+                for (const VertexLayout::Element& element : vertexLayout.getInstanceElements())
                 {
-                    MTLVertexFormat vertexFormat = getVertexFormat(vertexAttribute.dataType);
+                    // matrices are split into one float4 attribute per column
+                    uint32_t columnCount = (element.dataType == DataType::FLOAT_MATRIX4) ? 4 : 1;
+                    MTLVertexFormat vertexFormat = (columnCount > 1) ? MTLVertexFormatFloat4 : getVertexFormat(element.dataType);
 
                     if (vertexFormat == MTLVertexFormatInvalid)
                         throw std::runtime_error("Invalid vertex format");
 
-                    vertexDescriptor.attributes[index].format = vertexFormat;
-                    vertexDescriptor.attributes[index].offset = offset;
-                    vertexDescriptor.attributes[index].bufferIndex = 0;
-                    ++index;
+                    for (uint32_t column = 0; column < columnCount; ++column)
+                    {
+                        vertexDescriptor.attributes[index].format = vertexFormat;
+                        vertexDescriptor.attributes[index].offset = element.offset + column * 4 * sizeof(float);
+                        vertexDescriptor.attributes[index].bufferIndex = 2;
+                        ++index;
+                    }
                 }
 
-                offset += getDataTypeSize(vertexAttribute.dataType);
+                vertexDescriptor.layouts[2].stride = vertexLayout.getInstanceStride();
+                vertexDescriptor.layouts[2].stepRate = 1;
+                vertexDescriptor.layouts[2].stepFunction = MTLVertexStepFunctionPerInstance;
             }
 
-            vertexDescriptor.layouts[0].stride = offset;
-            vertexDescriptor.layouts[0].stepRate = 1;
-            vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
-
             NSError* err;
 
             dispatch_data_t fragmentShaderDispatchData = dispatch_data_create(fragmentShaderData.data(), fragmentShaderData.size(), nullptr, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
@@ -58,6 +58,8 @@ namespace ouzel
             ~TextureResourceMetal();
 
             void setData(const std::vector<Texture::Level>& levels);
+            void setRegionData(uint32_t level, uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                               const std::vector<uint8_t>& data);
             void setFilter(Texture::Filter filter);
             void setAddressX(Texture::Address addressX);
             void setAddressY(Texture::Address addressY);
@@ -4,6 +4,7 @@
 
 #if OUZEL_COMPILE_METAL
 
+#include <algorithm>
 #include <stdexcept>
 #include "TextureResourceMetal.hpp"
 #include "RenderDeviceMetal.hpp"
@@ -46,6 +47,17 @@ namespace ouzel
                 case PixelFormat::RGBA32_UINT: return MTLPixelFormatRGBA32Uint;
                 case PixelFormat::RGBA32_SINT: return MTLPixelFormatRGBA32Sint;
                 case PixelFormat::RGBA32_FLOAT: return MTLPixelFormatRGBA32Float;
+#if OUZEL_PLATFORM_MACOS
+                case PixelFormat::BC1_UNORM: return MTLPixelFormatBC1_RGBA;
+                case PixelFormat::BC3_UNORM: return MTLPixelFormatBC3_RGBA;
+                case PixelFormat::BC7_UNORM: return MTLPixelFormatBC7_RGBAUnorm;
+#else
+                case PixelFormat::ETC2_RGB8_UNORM: return MTLPixelFormatETC2_RGB8;
+                case PixelFormat::ETC2_RGBA8_UNORM: return MTLPixelFormatEAC_RGBA8;
+                case PixelFormat::ASTC_4X4_UNORM: return MTLPixelFormatASTC_4x4_LDR;
+                case PixelFormat::ASTC_6X6_UNORM: return MTLPixelFormatASTC_6x6_LDR;
+                case PixelFormat::ASTC_8X8_UNORM: return MTLPixelFormatASTC_8x8_LDR;
+#endif
                 default: return MTLPixelFormatInvalid;
             }
         }
@@ -143,6 +155,38 @@ namespace ouzel
             }
         }
 
+        void TextureResourceMetal::setRegionData(uint32_t level, uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                                                 const std::vector<uint8_t>& data)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (isCompressed(pixelFormat))
+                throw std::runtime_error("Regions of compressed textures can't be updated");
+
+            if (level >= mipmaps)
+                throw std::runtime_error("Invalid mip map level");
+
+            NSUInteger levelWidth = std::max(width >> level, static_cast<NSUInteger>(1));
+            NSUInteger levelHeight = std::max(height >> level, static_cast<NSUInteger>(1));
+
+            if (regionWidth > levelWidth || x > levelWidth - regionWidth ||
+                regionHeight > levelHeight || y > levelHeight - regionHeight)
+                throw std::runtime_error("Invalid texture region");
+
+            size_t rowSize = getRowPitch(pixelFormat, regionWidth);
+
+            if (data.size() != rowSize * regionHeight)
+                throw std::runtime_error("Invalid texture data size");
+
+            if (!texture)
+                throw std::runtime_error("Texture not initialized");
+
+            [texture replaceRegion:MTLRegionMake2D(x, y, regionWidth, regionHeight)
+                       mipmapLevel:level withBytes:data.data()
+                       bytesPerRow:static_cast<NSUInteger>(rowSize)];
+        }
+
         void TextureResourceMetal::setFilter(Texture::Filter filter)
         {
             samplerDescriptor.filter = (filter == Texture::Filter::DEFAULT) ? renderDevice.getTextureFilter() : filter;
@@ -38,7 +38,7 @@ namespace ouzel
         {
             displayLink.stop();
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
         }
 
@@ -49,7 +49,7 @@ namespace ouzel
         {
             running = false;
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
 
             if (displayLink)
@@ -133,7 +133,7 @@ namespace ouzel
                     running = false;
 
                     CommandBuffer commandBuffer;
-                    commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+                    commandBuffer.push(PresentCommand());
                     submitCommandBuffer(std::move(commandBuffer));
 
                     if (displayLink)
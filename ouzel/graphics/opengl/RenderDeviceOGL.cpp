@@ -54,6 +54,8 @@ PFNGLDELETETEXTURESPROC glDeleteTexturesProc;
 PFNGLTEXPARAMETERIPROC glTexParameteriProc;
 PFNGLTEXIMAGE2DPROC glTexImage2DProc;
 PFNGLTEXSUBIMAGE2DPROC glTexSubImage2DProc;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DProc;
+PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC glCompressedTexSubImage2DProc;
 PFNGLVIEWPORTPROC glViewportProc;
 PFNGLCLEARPROC glClearProc;
 PFNGLCLEARCOLORPROC glClearColorProc;
@@ -63,7 +65,9 @@ PFNGLDEPTHFUNCPROC glDepthFuncProc;
 PFNGLCULLFACEPROC glCullFaceProc;
 PFNGLSCISSORPROC glScissorProc;
 PFNGLDRAWELEMENTSPROC glDrawElementsProc;
+PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc;
 PFNGLREADPIXELSPROC glReadPixelsProc;
+PFNGLPIXELSTOREIPROC glPixelStoreiProc;
 
 PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparateProc;
 PFNGLBLENDEQUATIONSEPARATEPROC glBlendEquationSeparateProc;
@@ -143,6 +147,10 @@ PFNGLDELETEBUFFERSPROC glDeleteBuffersProc;
 PFNGLGENBUFFERSPROC glGenBuffersProc;
 PFNGLBUFFERDATAPROC glBufferDataProc;
 PFNGLBUFFERSUBDATAPROC glBufferSubDataProc;
+PFNGLBINDBUFFERRANGEPROC glBindBufferRangeProc;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndexProc;
+PFNGLGETACTIVEUNIFORMBLOCKIVPROC glGetActiveUniformBlockivProc;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBindingProc;
 
 PFNGLGENVERTEXARRAYSPROC glGenVertexArraysProc;
 PFNGLBINDVERTEXARRAYPROC glBindVertexArrayProc;
@@ -150,6 +158,7 @@ PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArraysProc;
 PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc;
 PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc;
 PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc;
+PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc;
 
 PFNGLGETSTRINGIPROC glGetStringiProc;
 PFNGLPUSHGROUPMARKEREXTPROC glPushGroupMarkerEXTProc;
@@ -374,8 +383,13 @@ namespace ouzel
         RenderDeviceOGL::~RenderDeviceOGL()
         {
             if (vertexArrayId) glDeleteVertexArraysProc(1, &vertexArrayId);
+            if (uniformBufferId) glDeleteBuffersProc(1, &uniformBufferId);
 
-            resources.clear();
+            textures.clear();
+            shaders.clear();
+            buffers.clear();
+            depthStencilStates.clear();
+            blendStates.clear();
         }
 
         void RenderDeviceOGL::init(Window* newWindow,
@@ -448,6 +462,8 @@ namespace ouzel
             glTexParameteriProc = getCoreProcAddress<PFNGLTEXPARAMETERIPROC>("glTexParameteri");
             glTexImage2DProc = getCoreProcAddress<PFNGLTEXIMAGE2DPROC>("glTexImage2D");
             glTexSubImage2DProc = getCoreProcAddress<PFNGLTEXSUBIMAGE2DPROC>("glTexSubImage2D");
+            glCompressedTexImage2DProc = getCoreProcAddress<PFNGLCOMPRESSEDTEXIMAGE2DPROC>("glCompressedTexImage2D");
+            glCompressedTexSubImage2DProc = getCoreProcAddress<PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC>("glCompressedTexSubImage2D");
             glViewportProc = getCoreProcAddress<PFNGLVIEWPORTPROC>("glViewport");
             glClearProc = getCoreProcAddress<PFNGLCLEARPROC>("glClear");
             glClearColorProc = getCoreProcAddress<PFNGLCLEARCOLORPROC>("glClearColor");
@@ -458,6 +474,7 @@ namespace ouzel
             glScissorProc = getCoreProcAddress<PFNGLSCISSORPROC>("glScissor");
             glDrawElementsProc = getCoreProcAddress<PFNGLDRAWELEMENTSPROC>("glDrawElements");
             glReadPixelsProc = getCoreProcAddress<PFNGLREADPIXELSPROC>("glReadPixels");
+            glPixelStoreiProc = getCoreProcAddress<PFNGLPIXELSTOREIPROC>("glPixelStorei");
 
             glBlendFuncSeparateProc = getCoreProcAddress<PFNGLBLENDFUNCSEPARATEPROC>("glBlendFuncSeparate");
             glBlendEquationSeparateProc = getCoreProcAddress<PFNGLBLENDEQUATIONSEPARATEPROC>("glBlendEquationSeparate");
@@ -578,6 +595,9 @@ namespace ouzel
             textureBaseLevelSupported = false;
             textureMaxLevelSupported = false;
             renderTargetsSupported = false;
+            uniformBufferSupported = false;
+            instancingSupported = false;
+            alphaTexturesSupported = false;
 
             if (apiMajorVersion >= 4)
             {
@@ -599,6 +619,24 @@ namespace ouzel
                 textureBaseLevelSupported = true;
                 textureMaxLevelSupported = true;
                 renderTargetsSupported = true;
+                uniformBufferSupported = true;
+                instancingSupported = true;
+
+#if OUZEL_SUPPORTS_OPENGLES
+                alphaTexturesSupported = true;
+#else
+                // texture swizzle is in the core since OpenGL 3.3
+                if (apiMajorVersion >= 4 || apiMinorVersion >= 3)
+                    alphaTexturesSupported = true;
+#endif
+
+                glDrawElementsInstancedProc = getExtProcAddress<PFNGLDRAWELEMENTSINSTANCEDPROC>("glDrawElementsInstanced");
+                glVertexAttribDivisorProc = getExtProcAddress<PFNGLVERTEXATTRIBDIVISORPROC>("glVertexAttribDivisor");
+
+                glBindBufferRangeProc = getExtProcAddress<PFNGLBINDBUFFERRANGEPROC>("glBindBufferRange");
+                glGetUniformBlockIndexProc = getExtProcAddress<PFNGLGETUNIFORMBLOCKINDEXPROC>("glGetUniformBlockIndex");
+                glGetActiveUniformBlockivProc = getExtProcAddress<PFNGLGETACTIVEUNIFORMBLOCKIVPROC>("glGetActiveUniformBlockiv");
+                glUniformBlockBindingProc = getExtProcAddress<PFNGLUNIFORMBLOCKBINDINGPROC>("glUniformBlockBinding");
 
                 glUniform1uivProc = getExtProcAddress<PFNGLUNIFORM1UIVPROC>("glUniform1uiv");
                 glUniform2uivProc = getExtProcAddress<PFNGLUNIFORM2UIVPROC>("glUniform2uiv");
@@ -669,6 +707,9 @@ namespace ouzel
                 }
                 else if (extension == "GL_EXT_texture_filter_anisotropic")
                     anisotropicFilteringSupported = true;
+                else if (extension == "GL_ARB_texture_swizzle" ||
+                         extension == "GL_EXT_texture_swizzle")
+                    alphaTexturesSupported = apiMajorVersion >= 3; // one channel textures need OpenGL 3
                 else if (extension == "GL_EXT_map_buffer_range")
                 {
 #if OUZEL_SUPPORTS_OPENGLES
@@ -753,6 +794,12 @@ namespace ouzel
             if ((error = glGetErrorProc()) != GL_NO_ERROR)
                 throw std::system_error(makeErrorCode(error), "Failed to set depth function");
 
+            // rows of the texture data are tightly packed
+            glPixelStoreiProc(GL_UNPACK_ALIGNMENT, 1);
+
+            if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                throw std::system_error(makeErrorCode(error), "Failed to set unpack alignment");
+
 #if !OUZEL_SUPPORTS_OPENGLES
             if (sampleCount > 1)
             {
@@ -781,6 +828,22 @@ namespace ouzel
                 if ((error = glGetErrorProc()) != GL_NO_ERROR)
                     throw std::system_error(makeErrorCode(error), "Failed to bind vertex array");
             }
+
+            if (uniformBufferSupported)
+            {
+                GLint uniformBufferOffsetAlignment;
+                glGetIntegervProc(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to get uniform buffer offset alignment");
+
+                uniformBufferAlignment = static_cast<uint32_t>(uniformBufferOffsetAlignment);
+
+                glGenBuffersProc(1, &uniformBufferId);
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to create uniform buffer");
+            }
         }
 
         void RenderDeviceOGL::setClearColorBuffer(bool clear)
@@ -882,6 +945,97 @@ namespace ouzel
             }
         }
 
+        static void setUniforms(const std::vector<ShaderResourceOGL::Location>& locations, const uint8_t* data, uint32_t size)
+        {
+            for (const ShaderResourceOGL::Location& location : locations)
+            {
+                if (location.offset + getDataTypeSize(location.dataType) > size) break;
+                setUniform(location.location, location.dataType, data + location.offset);
+            }
+        }
+
+        // used when the device can't bind the frame's constant data by ranges (its uniform buffer offset alignment is larger
+        // than CommandBuffer::CONSTANT_ALIGNMENT), the uniform buffer then holds only the blocks of the current draw
+        void RenderDeviceOGL::uploadConstantBlocks(const ShaderResourceOGL& shader,
+                                                   const std::vector<uint8_t>& constantData,
+                                                   const ConstantBlock& fragmentShaderConstants,
+                                                   const ConstantBlock& vertexShaderConstants)
+        {
+            GLsizeiptr vertexShaderConstantOffset = 0;
+            if (shader.hasFragmentShaderConstantBlock())
+                vertexShaderConstantOffset = static_cast<GLsizeiptr>((fragmentShaderConstants.size + uniformBufferAlignment - 1) /
+                                                                     uniformBufferAlignment * uniformBufferAlignment);
+
+            GLsizeiptr size = vertexShaderConstantOffset;
+            if (shader.hasVertexShaderConstantBlock())
+                size += static_cast<GLsizeiptr>(vertexShaderConstants.size);
+
+            bindBuffer(GL_UNIFORM_BUFFER, uniformBufferId);
+            glBufferDataProc(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+            if (shader.hasFragmentShaderConstantBlock())
+            {
+                glBufferSubDataProc(GL_UNIFORM_BUFFER, 0,
+                                    static_cast<GLsizeiptr>(fragmentShaderConstants.size),
+                                    constantData.data() + fragmentShaderConstants.offset);
+                glBindBufferRangeProc(GL_UNIFORM_BUFFER,
+                                      ShaderResourceOGL::FRAGMENT_SHADER_CONSTANT_BINDING,
+                                      uniformBufferId,
+                                      0,
+                                      static_cast<GLsizeiptr>(fragmentShaderConstants.size));
+            }
+
+            if (shader.hasVertexShaderConstantBlock())
+            {
+                glBufferSubDataProc(GL_UNIFORM_BUFFER, vertexShaderConstantOffset,
+                                    static_cast<GLsizeiptr>(vertexShaderConstants.size),
+                                    constantData.data() + vertexShaderConstants.offset);
+                glBindBufferRangeProc(GL_UNIFORM_BUFFER,
+                                      ShaderResourceOGL::VERTEX_SHADER_CONSTANT_BINDING,
+                                      uniformBufferId,
+                                      vertexShaderConstantOffset,
+                                      static_cast<GLsizeiptr>(vertexShaderConstants.size));
+            }
+
+            GLenum error;
+            if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                throw std::system_error(makeErrorCode(error), "Failed to upload uniform buffer");
+        }
+
+        GLuint RenderDeviceOGL::setVertexAttribute(GLuint index, const VertexLayout::Element& element, uint32_t stride, bool instance)
+        {
+            GLuint locationCount = ShaderResourceOGL::getLocationCount(element.dataType);
+            GLint size = getArraySize(element.dataType) / static_cast<GLint>(locationCount);
+            uint32_t columnSize = getDataTypeSize(element.dataType) / locationCount;
+
+            for (GLuint location = 0; location < locationCount; ++location, ++index)
+            {
+                if (index >= stateCache.vertexAttributeCount)
+                    glEnableVertexAttribArrayProc(index);
+
+                glVertexAttribPointerProc(index,
+                                          size,
+                                          getVertexFormat(element.dataType),
+                                          isNormalized(element.dataType),
+                                          static_cast<GLsizei>(stride),
+                                          static_cast<const GLchar*>(nullptr) + element.offset + location * columnSize);
+
+                // the divisor is part of the attribute state, so it has to be reset for per-vertex attributes too
+                uint32_t bit = 1U << index;
+                if (((stateCache.instanceAttributeMask & bit) != 0) != instance)
+                {
+                    glVertexAttribDivisorProc(index, instance ? 1 : 0);
+
+                    if (instance)
+                        stateCache.instanceAttributeMask |= bit;
+                    else
+                        stateCache.instanceAttributeMask &= ~bit;
+                }
+            }
+
+            return locationCount;
+        }
+
         void RenderDeviceOGL::process()
         {
             RenderDevice::process();
@@ -893,43 +1047,65 @@ namespace ouzel
 
             for (;;)
             {
-                std::unique_lock<std::mutex> lock(commandQueueMutex);
-                while (commandQueue.empty()) commandQueueCondition.wait(lock);
-                commandBuffer = std::move(commandQueue.front());
-                commandQueue.pop();
-                lock.unlock();
+                popCommandBuffer(commandBuffer, true);
+                CommandBufferRecycler recycler(*this, commandBuffer);
 
-                std::unique_ptr<Command> command;
+                const std::vector<uint8_t>& constantData = commandBuffer.getConstantData();
 
-                while (!commandBuffer.commands.empty())
+                // the constants of the whole frame are uploaded at once, draws bind ranges of the uniform buffer
+                if (uniformBufferId && !constantData.empty() &&
+                    uniformBufferAlignment <= CommandBuffer::CONSTANT_ALIGNMENT)
                 {
-                    command = std::move(commandBuffer.commands.front());
-                    commandBuffer.commands.pop();
+                    bindBuffer(GL_UNIFORM_BUFFER, uniformBufferId);
+                    glBufferDataProc(GL_UNIFORM_BUFFER,
+                                     static_cast<GLsizeiptr>(constantData.size()),
+                                     constantData.data(),
+                                     GL_STREAM_DRAW);
+
+                    GLenum error;
+                    if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                        throw std::system_error(makeErrorCode(error), "Failed to upload uniform buffer");
+                }
 
+                bool presented = false;
+
+                for (const Command* command : commandBuffer)
+                {
                     switch (command->type)
                     {
                         case Command::Type::PRESENT:
                         {
+                            drawCallCount = currentDrawCallCount;
+                            currentDrawCallCount = 0;
+
                             present();
                             break;
                         }
 
                         case Command::Type::DELETE_RESOURCE:
                         {
-                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command.get());
-                            resources[deleteResourceCommand->resource - 1].reset();
+                            const DeleteResourceCommand* deleteResourceCommand = static_cast<const DeleteResourceCommand*>(command);
+                            switch (deleteResourceCommand->resourceType)
+                            {
+                                case ResourceType::BLEND_STATE: blendStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::BUFFER: buffers.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::DEPTH_STENCIL_STATE: depthStencilStates.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::SHADER: shaders.erase(deleteResourceCommand->resource); break;
+                                case ResourceType::TEXTURE: textures.erase(deleteResourceCommand->resource); break;
+                                default: break; // render targets are not created on the device
+                            }
                             break;
                         }
 
                         case Command::Type::SET_RENDER_TARGET:
                         {
-                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command.get());
+                            const SetRenderTargetCommand* setRenderTargetCommand = static_cast<const SetRenderTargetCommand*>(command);
 
                             GLuint newFrameBufferId = 0;
 
                             if (setRenderTargetCommand->renderTarget)
                             {
-                                TextureResourceOGL* renderTargetOGL = static_cast<TextureResourceOGL*>(resources[setRenderTargetCommand->renderTarget - 1].get());
+                                TextureResourceOGL* renderTargetOGL = textures.get(setRenderTargetCommand->renderTarget);
 
                                 if (!renderTargetOGL->getFrameBufferId()) break;
                                 newFrameBufferId = renderTargetOGL->getFrameBufferId();
@@ -946,11 +1122,11 @@ namespace ouzel
 
                         case Command::Type::SET_RENDER_TARGET_PARAMETERS:
                         {
-                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command.get());
+                            const SetRenderTargetParametersCommand* setRenderTargetParametersCommand = static_cast<const SetRenderTargetParametersCommand*>(command);
 
                             if (setRenderTargetParametersCommand->renderTarget)
                             {
-                                TextureResourceOGL* renderTargetOGL = static_cast<TextureResourceOGL*>(resources[setRenderTargetParametersCommand->renderTarget - 1].get());
+                                TextureResourceOGL* renderTargetOGL = textures.get(setRenderTargetParametersCommand->renderTarget);
                                 renderTargetOGL->setClearColorBuffer(setRenderTargetParametersCommand->clearColorBuffer);
                                 renderTargetOGL->setClearDepthBuffer(setRenderTargetParametersCommand->clearDepthBuffer);
                                 renderTargetOGL->setClearColor(setRenderTargetParametersCommand->clearColor);
@@ -969,7 +1145,7 @@ namespace ouzel
 
                         case Command::Type::CLEAR_RENDER_TARGET:
                         {
-                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command.get());
+                            const ClearRenderTargetCommand* clearCommand = static_cast<const ClearRenderTargetCommand*>(command);
 
                             GLuint newFrameBufferId = 0;
                             GLbitfield newClearMask = 0;
@@ -980,7 +1156,7 @@ namespace ouzel
 
                             if (clearCommand->renderTarget)
                             {
-                                TextureResourceOGL* renderTargetOGL = static_cast<TextureResourceOGL*>(resources[clearCommand->renderTarget - 1].get());
+                                TextureResourceOGL* renderTargetOGL = textures.get(clearCommand->renderTarget);
 
                                 if (!renderTargetOGL->getFrameBufferId()) break;
 
@@ -1035,10 +1211,10 @@ namespace ouzel
                         case Command::Type::BLIT:
                         {
 #if !OUZEL_SUPPORTS_OPENGLES
-                            const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command.get());
+                            const BlitCommand* blitCommand = static_cast<const BlitCommand*>(command);
 
-                            TextureResourceOGL* sourceTextureOGL = static_cast<TextureResourceOGL*>(resources[blitCommand->sourceTexture - 1].get());
-                            TextureResourceOGL* destinationTextureOGL = static_cast<TextureResourceOGL*>(resources[blitCommand->destinationTexture - 1].get());
+                            TextureResourceOGL* sourceTextureOGL = textures.get(blitCommand->sourceTexture);
+                            TextureResourceOGL* destinationTextureOGL = textures.get(blitCommand->destinationTexture);
 
                             if (glCopyImageSubDataProc)
                                 glCopyImageSubDataProc(sourceTextureOGL->getTextureId(),
@@ -1063,7 +1239,7 @@ namespace ouzel
 
                         case Command::Type::SET_CULL_MODE:
                         {
-                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command.get());
+                            const SetCullModeCommad* setCullModeCommad = static_cast<const SetCullModeCommad*>(command);
 
                             GLenum cullFace = GL_NONE;
 
@@ -1082,7 +1258,7 @@ namespace ouzel
 
                         case Command::Type::SET_FILL_MODE:
                         {
-                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command.get());
+                            const SetFillModeCommad* setFillModeCommad = static_cast<const SetFillModeCommad*>(command);
 
 #if OUZEL_SUPPORTS_OPENGLES
                             if (setFillModeCommad->fillMode != FillMode::SOLID)
@@ -1104,7 +1280,7 @@ namespace ouzel
 
                         case Command::Type::SET_SCISSOR_TEST:
                         {
-                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command.get());
+                            const SetScissorTestCommand* setScissorTestCommand = static_cast<const SetScissorTestCommand*>(command);
 
                             setScissorTest(setScissorTestCommand->enabled,
                                            static_cast<GLint>(setScissorTestCommand->rectangle.position.x),
@@ -1117,7 +1293,7 @@ namespace ouzel
 
                         case Command::Type::SET_VIEWPORT:
                         {
-                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command.get());
+                            const SetViewportCommand* setViewportCommand = static_cast<const SetViewportCommand*>(command);
 
                             setViewport(static_cast<GLint>(setViewportCommand->viewport.position.x),
                                         static_cast<GLint>(setViewportCommand->viewport.position.y),
@@ -1129,25 +1305,23 @@ namespace ouzel
 
                         case Command::Type::INIT_DEPTH_STENCIL_STATE:
                         {
-                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command.get());
+                            const InitDepthStencilStateCommand* initDepthStencilStateCommand = static_cast<const InitDepthStencilStateCommand*>(command);
                             std::unique_ptr<DepthStencilStateResourceOGL> depthStencilStateResourceOGL(new DepthStencilStateResourceOGL(*this,
                                                                                                                                         initDepthStencilStateCommand->depthTest,
                                                                                                                                         initDepthStencilStateCommand->depthWrite,
                                                                                                                                         initDepthStencilStateCommand->compareFunction));
 
-                            if (initDepthStencilStateCommand->depthStencilState > resources.size())
-                                resources.resize(initDepthStencilStateCommand->depthStencilState);
-                            resources[initDepthStencilStateCommand->depthStencilState - 1] = std::move(depthStencilStateResourceOGL);
+                            depthStencilStates.insert(initDepthStencilStateCommand->depthStencilState, std::move(depthStencilStateResourceOGL));
                             break;
                         }
 
                         case Command::Type::SET_DEPTH_STENCIL_STATE:
                         {
-                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command.get());
+                            const SetDepthStencilStateCommand* setDepthStencilStateCommand = static_cast<const SetDepthStencilStateCommand*>(command);
 
                             if (setDepthStencilStateCommand->depthStencilState)
                             {
-                                DepthStencilStateResourceOGL* depthStencilStateResourceOGL = static_cast<DepthStencilStateResourceOGL*>(resources[setDepthStencilStateCommand->depthStencilState - 1].get());
+                                DepthStencilStateResourceOGL* depthStencilStateResourceOGL = depthStencilStates.get(setDepthStencilStateCommand->depthStencilState);
 
                                 enableDepthTest(depthStencilStateResourceOGL->getDepthTest());
                                 setDepthMask(depthStencilStateResourceOGL->getDepthMask());
@@ -1165,10 +1339,10 @@ namespace ouzel
 
                         case Command::Type::SET_PIPELINE_STATE:
                         {
-                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command.get());
+                            const SetPipelineStateCommand* setPipelineStateCommand = static_cast<const SetPipelineStateCommand*>(command);
 
-                            BlendStateResourceOGL* blendStateOGL = static_cast<BlendStateResourceOGL*>(resources[setPipelineStateCommand->blendState - 1].get());
-                            ShaderResourceOGL* shaderOGL = static_cast<ShaderResourceOGL*>(resources[setPipelineStateCommand->shader - 1].get());
+                            BlendStateResourceOGL* blendStateOGL = blendStates.get(setPipelineStateCommand->blendState);
+                            ShaderResourceOGL* shaderOGL = shaders.get(setPipelineStateCommand->shader);
                             currentShader = shaderOGL;
 
                             if (blendStateOGL)
@@ -1205,11 +1379,12 @@ namespace ouzel
 
                         case Command::Type::DRAW:
                         {
-                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command.get());
+                            const DrawCommand* drawCommand = static_cast<const DrawCommand*>(command);
+                            ++currentDrawCallCount;
 
                             // mesh buffer
-                            BufferResourceOGL* indexBufferOGL = static_cast<BufferResourceOGL*>(resources[drawCommand->indexBuffer - 1].get());
-                            BufferResourceOGL* vertexBufferOGL = static_cast<BufferResourceOGL*>(resources[drawCommand->vertexBuffer - 1].get());
+                            BufferResourceOGL* indexBufferOGL = buffers.get(drawCommand->indexBuffer);
+                            BufferResourceOGL* vertexBufferOGL = buffers.get(drawCommand->vertexBuffer);
 
                             assert(indexBufferOGL);
                             assert(indexBufferOGL->getBufferId());
@@ -1232,23 +1407,44 @@ namespace ouzel
                             bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferOGL->getBufferId());
                             bindBuffer(GL_ARRAY_BUFFER, vertexBufferOGL->getBufferId());
 
-                            GLuint vertexOffset = 0;
+                            if (!currentShader)
+                                throw std::runtime_error("No shader set");
+
+                            // the attribute locations are bound in the order of the shader's vertex layout
+                            const VertexLayout& vertexLayout = currentShader->getVertexLayout();
+
+                            if (vertexLayout.isInstanced() != (drawCommand->instanceBuffer != 0))
+                                throw std::runtime_error("Shader vertex layout does not match the draw");
+
+                            GLuint vertexAttributeCount = 0;
 
-                            for (GLuint index = 0; index < Vertex::ATTRIBUTES.size(); ++index)
+                            for (const VertexLayout::Element& vertexElement : vertexLayout.getElements())
+                                vertexAttributeCount += setVertexAttribute(vertexAttributeCount,
+                                                                           vertexElement,
+                                                                           vertexLayout.getStride(),
+                                                                           false);
+
+                            if (drawCommand->instanceBuffer)
                             {
-                                const Vertex::Attribute& vertexAttribute = Vertex::ATTRIBUTES[index];
+                                BufferResourceOGL* instanceBufferOGL = buffers.get(drawCommand->instanceBuffer);
+
+                                assert(instanceBufferOGL);
+                                assert(instanceBufferOGL->getBufferId());
 
-                                glEnableVertexAttribArrayProc(index);
-                                glVertexAttribPointerProc(index,
-                                                          getArraySize(vertexAttribute.dataType),
-                                                          getVertexFormat(vertexAttribute.dataType),
-                                                          isNormalized(vertexAttribute.dataType),
-                                                          static_cast<GLsizei>(sizeof(Vertex)),
-                                                          static_cast<const GLchar*>(nullptr) + vertexOffset);
+                                bindBuffer(GL_ARRAY_BUFFER, instanceBufferOGL->getBufferId());
 
-                                vertexOffset += getDataTypeSize(vertexAttribute.dataType);
+                                for (const VertexLayout::Element& instanceElement : vertexLayout.getInstanceElements())
+                                    vertexAttributeCount += setVertexAttribute(vertexAttributeCount,
+                                                                               instanceElement,
+                                                                               vertexLayout.getInstanceStride(),
+                                                                               true);
                             }
 
+                            for (GLuint index = vertexAttributeCount; index < stateCache.vertexAttributeCount; ++index)
+                                glDisableVertexAttribArrayProc(index);
+
+                            stateCache.vertexAttributeCount = vertexAttributeCount;
+
                             GLenum error;
 
                             if ((error = glGetErrorProc()) != GL_NO_ERROR)
@@ -1267,10 +1463,17 @@ namespace ouzel
                                 default: throw std::runtime_error("Invalid index size");
                             }
 
-                            glDrawElementsProc(mode,
-                                               static_cast<GLsizei>(drawCommand->indexCount),
-                                               indexType,
-                                               static_cast<const char*>(nullptr) + (drawCommand->startIndex * drawCommand->indexSize));
+                            if (drawCommand->instanceBuffer)
+                                glDrawElementsInstancedProc(mode,
+                                                            static_cast<GLsizei>(drawCommand->indexCount),
+                                                            indexType,
+                                                            static_cast<const char*>(nullptr) + (drawCommand->startIndex * drawCommand->indexSize),
+                                                            static_cast<GLsizei>(drawCommand->instanceCount));
+                            else
+                                glDrawElementsProc(mode,
+                                                   static_cast<GLsizei>(drawCommand->indexCount),
+                                                   indexType,
+                                                   static_cast<const char*>(nullptr) + (drawCommand->startIndex * drawCommand->indexSize));
 
                             if ((error = glGetErrorProc()) != GL_NO_ERROR)
                                 throw std::system_error(makeErrorCode(error), "Failed to draw elements");
@@ -1280,7 +1483,7 @@ namespace ouzel
 
                         case Command::Type::PUSH_DEBUG_MARKER:
                         {
-                            const PushDebugMarkerCommand* pushDebugMarkerCommand = static_cast<const PushDebugMarkerCommand*>(command.get());
+                            const PushDebugMarkerCommand* pushDebugMarkerCommand = static_cast<const PushDebugMarkerCommand*>(command);
                             if (glPushGroupMarkerEXTProc) glPushGroupMarkerEXTProc(0, pushDebugMarkerCommand->name.c_str());
                             break;
                         }
@@ -1293,7 +1496,7 @@ namespace ouzel
 
                         case Command::Type::INIT_BLEND_STATE:
                         {
-                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command.get());
+                            const InitBlendStateCommand* initBlendStateCommand = static_cast<const InitBlendStateCommand*>(command);
 
                             std::unique_ptr<BlendStateResourceOGL> blendStateResourceOGL(new BlendStateResourceOGL(*this,
                                                                                                                    initBlendStateCommand->enableBlending,
@@ -1305,15 +1508,13 @@ namespace ouzel
                                                                                                                    initBlendStateCommand->alphaOperation,
                                                                                                                    initBlendStateCommand->colorMask));
 
-                            if (initBlendStateCommand->blendState > resources.size())
-                                resources.resize(initBlendStateCommand->blendState);
-                            resources[initBlendStateCommand->blendState - 1] = std::move(blendStateResourceOGL);
+                            blendStates.insert(initBlendStateCommand->blendState, std::move(blendStateResourceOGL));
                             break;
                         }
 
                         case Command::Type::INIT_BUFFER:
                         {
-                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command.get());
+                            const InitBufferCommand* initBufferCommand = static_cast<const InitBufferCommand*>(command);
 
                             std::unique_ptr<BufferResourceOGL> bufferResourceOGL(new BufferResourceOGL(*this,
                                                                                                        initBufferCommand->usage,
@@ -1321,29 +1522,27 @@ namespace ouzel
                                                                                                        initBufferCommand->data,
                                                                                                        initBufferCommand->size));
 
-                            if (initBufferCommand->buffer > resources.size())
-                                resources.resize(initBufferCommand->buffer);
-                            resources[initBufferCommand->buffer - 1] = std::move(bufferResourceOGL);
+                            buffers.insert(initBufferCommand->buffer, std::move(bufferResourceOGL));
                             break;
                         }
 
                         case Command::Type::SET_BUFFER_DATA:
                         {
-                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                            const SetBufferDataCommand* setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command);
 
-                            BufferResourceOGL* bufferResourceOGL = static_cast<BufferResourceOGL*>(resources[setBufferDataCommand->buffer - 1].get());
+                            BufferResourceOGL* bufferResourceOGL = buffers.get(setBufferDataCommand->buffer);
                             bufferResourceOGL->setData(setBufferDataCommand->data);
                             break;
                         }
 
                         case Command::Type::INIT_SHADER:
                         {
-                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command.get());
+                            const InitShaderCommand* initShaderCommand = static_cast<const InitShaderCommand*>(command);
 
                             std::unique_ptr<ShaderResourceOGL> shaderResourceOGL(new ShaderResourceOGL(*this,
                                                                                                        initShaderCommand->fragmentShader,
                                                                                                        initShaderCommand->vertexShader,
-                                                                                                       initShaderCommand->vertexAttributes,
+                                                                                                       initShaderCommand->vertexLayout,
                                                                                                        initShaderCommand->fragmentShaderConstantInfo,
                                                                                                        initShaderCommand->vertexShaderConstantInfo,
                                                                                                        initShaderCommand->fragmentShaderDataAlignment,
@@ -1351,57 +1550,80 @@ namespace ouzel
                                                                                                        initShaderCommand->fragmentShaderFunction,
                                                                                                        initShaderCommand->vertexShaderFunction));
 
-                            if (initShaderCommand->shader > resources.size())
-                                resources.resize(initShaderCommand->shader);
-                            resources[initShaderCommand->shader - 1] = std::move(shaderResourceOGL);
+                            shaders.insert(initShaderCommand->shader, std::move(shaderResourceOGL));
                             break;
                         }
 
                         case Command::Type::SET_SHADER_CONSTANTS:
                         {
-                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command.get());
+                            const SetShaderConstantsCommand* setShaderConstantsCommand = static_cast<const SetShaderConstantsCommand*>(command);
 
                             if (!currentShader)
                                 throw std::runtime_error("No shader set");
 
-                            // pixel shader constants
-                            const std::vector<ShaderResourceOGL::Location>& fragmentShaderConstantLocations = currentShader->getFragmentShaderConstantLocations();
-
-                            if (setShaderConstantsCommand->fragmentShaderConstants.size() > fragmentShaderConstantLocations.size())
-                                throw std::runtime_error("Invalid pixel shader constant size");
+                            const ConstantBlock& fragmentShaderConstants = setShaderConstantsCommand->fragmentShaderConstants;
+                            const ConstantBlock& vertexShaderConstants = setShaderConstantsCommand->vertexShaderConstants;
 
-                            for (size_t i = 0; i < setShaderConstantsCommand->fragmentShaderConstants.size(); ++i)
+                            // pixel shader constants
+                            if (currentShader->hasFragmentShaderConstantBlock())
+                            {
+                                // the bound range must cover the whole uniform block
+                                if (fragmentShaderConstants.size != currentShader->getFragmentShaderConstantSize())
+                                    throw std::runtime_error("Invalid pixel shader constant size");
+                            }
+                            else
                             {
-                                const ShaderResourceOGL::Location& fragmentShaderConstantLocation = fragmentShaderConstantLocations[i];
-                                const std::vector<float>& fragmentShaderConstant = setShaderConstantsCommand->fragmentShaderConstants[i];
+                                if (fragmentShaderConstants.size > currentShader->getFragmentShaderConstantSize())
+                                    throw std::runtime_error("Invalid pixel shader constant size");
 
-                                setUniform(fragmentShaderConstantLocation.location,
-                                           fragmentShaderConstantLocation.dataType,
-                                           fragmentShaderConstant.data());
+                                setUniforms(currentShader->getFragmentShaderConstantLocations(),
+                                            constantData.data() + fragmentShaderConstants.offset,
+                                            fragmentShaderConstants.size);
                             }
 
                             // vertex shader constants
-                            const std::vector<ShaderResourceOGL::Location>& vertexShaderConstantLocations = currentShader->getVertexShaderConstantLocations();
+                            if (currentShader->hasVertexShaderConstantBlock())
+                            {
+                                if (vertexShaderConstants.size != currentShader->getVertexShaderConstantSize())
+                                    throw std::runtime_error("Invalid vertex shader constant size");
+                            }
+                            else
+                            {
+                                if (vertexShaderConstants.size > currentShader->getVertexShaderConstantSize())
+                                    throw std::runtime_error("Invalid vertex shader constant size");
 
-                            if (setShaderConstantsCommand->vertexShaderConstants.size() > vertexShaderConstantLocations.size())
-                                throw std::runtime_error("Invalid vertex shader constant size");
+                                setUniforms(currentShader->getVertexShaderConstantLocations(),
+                                            constantData.data() + vertexShaderConstants.offset,
+                                            vertexShaderConstants.size);
+                            }
 
-                            for (size_t i = 0; i < setShaderConstantsCommand->vertexShaderConstants.size(); ++i)
+                            if (uniformBufferAlignment <= CommandBuffer::CONSTANT_ALIGNMENT)
                             {
-                                const ShaderResourceOGL::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                                const std::vector<float>& vertexShaderConstant = setShaderConstantsCommand->vertexShaderConstants[i];
-
-                                setUniform(vertexShaderConstantLocation.location,
-                                           vertexShaderConstantLocation.dataType,
-                                           vertexShaderConstant.data());
+                                if (currentShader->hasFragmentShaderConstantBlock())
+                                    glBindBufferRangeProc(GL_UNIFORM_BUFFER,
+                                                          ShaderResourceOGL::FRAGMENT_SHADER_CONSTANT_BINDING,
+                                                          uniformBufferId,
+                                                          static_cast<GLintptr>(fragmentShaderConstants.offset),
+                                                          static_cast<GLsizeiptr>(fragmentShaderConstants.size));
+
+                                if (currentShader->hasVertexShaderConstantBlock())
+                                    glBindBufferRangeProc(GL_UNIFORM_BUFFER,
+                                                          ShaderResourceOGL::VERTEX_SHADER_CONSTANT_BINDING,
+                                                          uniformBufferId,
+                                                          static_cast<GLintptr>(vertexShaderConstants.offset),
+                                                          static_cast<GLsizeiptr>(vertexShaderConstants.size));
                             }
+                            else if (currentShader->hasFragmentShaderConstantBlock() ||
+                                     currentShader->hasVertexShaderConstantBlock())
+                                uploadConstantBlocks(*currentShader, constantData,
+                                                     fragmentShaderConstants, vertexShaderConstants);
 
                             break;
                         }
 
                         case Command::Type::INIT_TEXTURE:
                         {
-                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command.get());
+                            const InitTextureCommand* initTextureCommand = static_cast<const InitTextureCommand*>(command);
 
                             std::unique_ptr<TextureResourceOGL> textureResourceOGL(new TextureResourceOGL(*this,
                                                                                                           initTextureCommand->levels,
@@ -1409,27 +1631,40 @@ namespace ouzel
                                                                                                           initTextureCommand->sampleCount,
                                                                                                           initTextureCommand->pixelFormat));
 
-                            if (initTextureCommand->texture > resources.size())
-                                resources.resize(initTextureCommand->texture);
-                            resources[initTextureCommand->texture - 1] = std::move(textureResourceOGL);
+                            textures.insert(initTextureCommand->texture, std::move(textureResourceOGL));
                             break;
                         }
 
                         case Command::Type::SET_TEXTURE_DATA:
                         {
-                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command.get());
+                            const SetTextureDataCommand* setTextureDataCommand = static_cast<const SetTextureDataCommand*>(command);
 
-                            TextureResourceOGL* textureResourceOGL = static_cast<TextureResourceOGL*>(resources[setTextureDataCommand->texture - 1].get());
+                            TextureResourceOGL* textureResourceOGL = textures.get(setTextureDataCommand->texture);
                             textureResourceOGL->setData(setTextureDataCommand->levels);
 
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            const SetTextureRegionDataCommand* setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command);
+
+                            TextureResourceOGL* textureResourceOGL = textures.get(setTextureRegionDataCommand->texture);
+                            textureResourceOGL->setRegionData(setTextureRegionDataCommand->level,
+                                                              setTextureRegionDataCommand->x,
+                                                              setTextureRegionDataCommand->y,
+                                                              setTextureRegionDataCommand->width,
+                                                              setTextureRegionDataCommand->height,
+                                                              setTextureRegionDataCommand->data);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
-                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
+                            const SetTextureParametersCommand* setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command);
 
-                            TextureResourceOGL* textureResourceOGL = static_cast<TextureResourceOGL*>(resources[setTextureParametersCommand->texture - 1].get());
+                            TextureResourceOGL* textureResourceOGL = textures.get(setTextureParametersCommand->texture);
                             textureResourceOGL->setFilter(setTextureParametersCommand->filter);
                             textureResourceOGL->setAddressX(setTextureParametersCommand->addressX);
                             textureResourceOGL->setAddressY(setTextureParametersCommand->addressY);
@@ -1439,13 +1674,13 @@ namespace ouzel
 
                         case Command::Type::SET_TEXTURES:
                         {
-                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command.get());
+                            const SetTexturesCommand* setTexturesCommand = static_cast<const SetTexturesCommand*>(command);
 
                             for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                             {
                                 if (setTexturesCommand->textures[layer])
                                 {
-                                    TextureResourceOGL* textureOGL = static_cast<TextureResourceOGL*>(resources[setTexturesCommand->textures[layer] - 1].get());
+                                    TextureResourceOGL* textureOGL = textures.get(setTexturesCommand->textures[layer]);
                                     bindTexture(textureOGL->getTextureId(), layer);
                                 }
                                 else
@@ -1459,8 +1694,14 @@ namespace ouzel
                             throw std::runtime_error("Invalid command");
                     }
 
-                    if (command->type == Command::Type::PRESENT) return;
+                    if (command->type == Command::Type::PRESENT)
+                    {
+                        presented = true;
+                        break;
+                    }
                 }
+
+                if (presented) return;
             }
         }
 
@@ -38,6 +38,8 @@ extern PFNGLDELETETEXTURESPROC glDeleteTexturesProc;
 extern PFNGLTEXPARAMETERIPROC glTexParameteriProc;
 extern PFNGLTEXIMAGE2DPROC glTexImage2DProc;
 extern PFNGLTEXSUBIMAGE2DPROC glTexSubImage2DProc;
+extern PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DProc;
+extern PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC glCompressedTexSubImage2DProc;
 extern PFNGLVIEWPORTPROC glViewportProc;
 extern PFNGLCLEARPROC glClearProc;
 extern PFNGLCLEARCOLORPROC glClearColorProc;
@@ -47,7 +49,9 @@ extern PFNGLDEPTHFUNCPROC glDepthFuncProc;
 extern PFNGLCULLFACEPROC glCullFaceProc;
 extern PFNGLSCISSORPROC glScissorProc;
 extern PFNGLDRAWELEMENTSPROC glDrawElementsProc;
+extern PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc;
 extern PFNGLREADPIXELSPROC glReadPixelsProc;
+extern PFNGLPIXELSTOREIPROC glPixelStoreiProc;
 
 extern PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparateProc;
 extern PFNGLBLENDEQUATIONSEPARATEPROC glBlendEquationSeparateProc;
@@ -127,6 +131,10 @@ extern PFNGLDELETEBUFFERSPROC glDeleteBuffersProc;
 extern PFNGLGENBUFFERSPROC glGenBuffersProc;
 extern PFNGLBUFFERDATAPROC glBufferDataProc;
 extern PFNGLBUFFERSUBDATAPROC glBufferSubDataProc;
+extern PFNGLBINDBUFFERRANGEPROC glBindBufferRangeProc;
+extern PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndexProc;
+extern PFNGLGETACTIVEUNIFORMBLOCKIVPROC glGetActiveUniformBlockivProc;
+extern PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBindingProc;
 
 extern PFNGLGENVERTEXARRAYSPROC glGenVertexArraysProc;
 extern PFNGLBINDVERTEXARRAYPROC glBindVertexArrayProc;
@@ -134,6 +142,7 @@ extern PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArraysProc;
 extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc;
 extern PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc;
 extern PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc;
+extern PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc;
 
 extern PFNGLGETSTRINGIPROC glGetStringiProc;
 extern PFNGLPUSHGROUPMARKEREXTPROC glPushGroupMarkerEXTProc;
@@ -146,6 +155,11 @@ namespace ouzel
 {
     namespace graphics
     {
+        class BlendStateResourceOGL;
+        class BufferResourceOGL;
+        class DepthStencilStateResourceOGL;
+        class TextureResourceOGL;
+
         class OpenGLErrorCategory: public std::error_category
         {
         public:
@@ -184,6 +198,7 @@ namespace ouzel
 
             bool isTextureBaseLevelSupported() const { return textureBaseLevelSupported; }
             bool isTextureMaxLevelSupported() const { return textureMaxLevelSupported; }
+            bool isUniformBufferSupported() const { return uniformBufferSupported; }
 
             inline void bindTexture(GLuint textureId, uint32_t layer)
             {
@@ -568,15 +583,25 @@ namespace ouzel
             virtual void present();
             void generateScreenshot(const std::string& filename) override;
 
+            // returns the number of attribute locations used by the element
+            GLuint setVertexAttribute(GLuint index, const VertexLayout::Element& element, uint32_t stride, bool instance);
+            void uploadConstantBlocks(const ShaderResourceOGL& shader,
+                                      const std::vector<uint8_t>& constantData,
+                                      const ConstantBlock& fragmentShaderConstants,
+                                      const ConstantBlock& vertexShaderConstants);
+
             GLuint frameBufferId = 0;
             GLsizei frameBufferWidth = 0;
             GLsizei frameBufferHeight = 0;
             GLuint vertexArrayId = 0;
+            GLuint uniformBufferId = 0;
+            uint32_t uniformBufferAlignment = 0;
 
             GLbitfield clearMask = 0;
             std::array<GLfloat, 4> frameBufferClearColor;
             bool textureBaseLevelSupported = true;
             bool textureMaxLevelSupported = true;
+            bool uniformBufferSupported = false;
 
             class StateCache
             {
@@ -594,6 +619,8 @@ namespace ouzel
                 GLuint frameBufferId = 0;
 
                 std::map<GLuint, GLuint> bufferId;
+                GLuint vertexAttributeCount = 0; // number of enabled vertex attribute arrays
+                uint32_t instanceAttributeMask = 0; // vertex attribute arrays with a divisor of one
 
                 bool blendEnabled = false;
                 GLenum blendModeRGB = 0;
@@ -634,7 +661,11 @@ namespace ouzel
 
             StateCache stateCache;
 
-            std::vector<std::unique_ptr<RenderResourceOGL>> resources;
+            HandleTable<BlendStateResourceOGL> blendStates;
+            HandleTable<BufferResourceOGL> buffers;
+            HandleTable<DepthStencilStateResourceOGL> depthStencilStates;
+            HandleTable<ShaderResourceOGL> shaders;
+            HandleTable<TextureResourceOGL> textures;
         };
     } // namespace graphics
 } // namespace ouzel
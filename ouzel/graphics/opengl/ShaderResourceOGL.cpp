@@ -11,10 +11,42 @@ namespace ouzel
 {
     namespace graphics
     {
+        constexpr GLuint ShaderResourceOGL::FRAGMENT_SHADER_CONSTANT_BINDING;
+        constexpr GLuint ShaderResourceOGL::VERTEX_SHADER_CONSTANT_BINDING;
+
+        static const GLchar* getAttributeName(Vertex::Attribute::Usage usage)
+        {
+            switch (usage)
+            {
+                case Vertex::Attribute::Usage::BINORMAL: return "binormal0";
+                case Vertex::Attribute::Usage::BLEND_INDICES: return "blendIndices0";
+                case Vertex::Attribute::Usage::BLEND_WEIGHT: return "blendWeight0";
+                case Vertex::Attribute::Usage::COLOR: return "color0";
+                case Vertex::Attribute::Usage::NORMAL: return "normal0";
+                case Vertex::Attribute::Usage::POSITION: return "position0";
+                case Vertex::Attribute::Usage::POSITION_TRANSFORMED: return "positionT0";
+                case Vertex::Attribute::Usage::POINT_SIZE: return "pointSize0";
+                case Vertex::Attribute::Usage::TANGENT: return "tangent0";
+                case Vertex::Attribute::Usage::TEXTURE_COORDINATES0: return "texCoord0";
+                case Vertex::Attribute::Usage::TEXTURE_COORDINATES1: return "texCoord1";
+                default: throw std::runtime_error("Invalid vertex attribute usage");
+            }
+        }
+
+        static const GLchar* getInstanceAttributeName(Vertex::Attribute::Usage usage)
+        {
+            switch (usage)
+            {
+                case Vertex::Attribute::Usage::COLOR: return "instanceColor0";
+                case Vertex::Attribute::Usage::TRANSFORM: return "instanceTransform0";
+                default: throw std::runtime_error("Invalid instance attribute usage");
+            }
+        }
+
         ShaderResourceOGL::ShaderResourceOGL(RenderDeviceOGL& renderDeviceOGL,
                                              const std::vector<uint8_t>& newFragmentShader,
                                              const std::vector<uint8_t>& newVertexShader,
-                                             const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                                             const VertexLayout& newVertexLayout,
                                              const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                                              const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                                              uint32_t,
@@ -24,7 +56,7 @@ namespace ouzel
             RenderResourceOGL(renderDeviceOGL),
             fragmentShaderData(newFragmentShader),
             vertexShaderData(newVertexShader),
-            vertexAttributes(newVertexAttributes),
+            vertexLayout(newVertexLayout),
             fragmentShaderConstantInfo(newFragmentShaderConstantInfo),
             vertexShaderConstantInfo(newVertexShaderConstantInfo)
         {
@@ -118,54 +150,17 @@ namespace ouzel
 
             GLuint index = 0;
 
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            for (const VertexLayout::Element& element : vertexLayout.getElements())
             {
-                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
-                {
-                    const GLchar* name;
-
-                    switch (vertexAttribute.usage)
-                    {
-                        case Vertex::Attribute::Usage::BINORMAL:
-                            name = "binormal0";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_INDICES:
-                            name = "blendIndices0";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_WEIGHT:
-                            name = "blendWeight0";
-                            break;
-                        case Vertex::Attribute::Usage::COLOR:
-                            name = "color0";
-                            break;
-                        case Vertex::Attribute::Usage::NORMAL:
-                            name = "normal0";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION:
-                            name = "position0";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION_TRANSFORMED:
-                            name = "positionT0";
-                            break;
-                        case Vertex::Attribute::Usage::POINT_SIZE:
-                            name = "pointSize0";
-                            break;
-                        case Vertex::Attribute::Usage::TANGENT:
-                            name = "tangent0";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES0:
-                            name = "texCoord0";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES1:
-                            name = "texCoord1";
-                            break;
-                        default:
-                            throw std::runtime_error("Invalid vertex attribute usage");
-                    }
+                glBindAttribLocationProc(programId, index, getAttributeName(element.usage));
+                index += getLocationCount(element.dataType);
+            }
 
-                    glBindAttribLocationProc(programId, index, name);
-                    ++index;
-                }
+            // the instance attributes follow the vertex attributes
+            for (const VertexLayout::Element& element : vertexLayout.getInstanceElements())
+            {
+                glBindAttribLocationProc(programId, index, getInstanceAttributeName(element.usage));
+                index += getLocationCount(element.dataType);
             }
 
             glLinkProgramProc(programId);
@@ -199,6 +194,34 @@ namespace ouzel
             if ((error = glGetErrorProc()) != GL_NO_ERROR)
                 throw std::system_error(makeErrorCode(error), "Failed to get uniform location");
 
+            fragmentShaderConstantBlock = false;
+            vertexShaderConstantBlock = false;
+
+            GLuint fragmentShaderConstantBlockIndex = GL_INVALID_INDEX;
+            GLuint vertexShaderConstantBlockIndex = GL_INVALID_INDEX;
+
+            if (renderDevice.isUniformBufferSupported())
+            {
+                fragmentShaderConstantBlockIndex = glGetUniformBlockIndexProc(programId, "FragmentConstants");
+                if (fragmentShaderConstantBlockIndex != GL_INVALID_INDEX)
+                {
+                    glUniformBlockBindingProc(programId, fragmentShaderConstantBlockIndex, FRAGMENT_SHADER_CONSTANT_BINDING);
+                    fragmentShaderConstantBlock = true;
+                }
+
+                vertexShaderConstantBlockIndex = glGetUniformBlockIndexProc(programId, "VertexConstants");
+                if (vertexShaderConstantBlockIndex != GL_INVALID_INDEX)
+                {
+                    glUniformBlockBindingProc(programId, vertexShaderConstantBlockIndex, VERTEX_SHADER_CONSTANT_BINDING);
+                    vertexShaderConstantBlock = true;
+                }
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to bind uniform block");
+            }
+
+            fragmentShaderConstantSize = 0;
+
             if (!fragmentShaderConstantInfo.empty())
             {
                 fragmentShaderConstantLocations.clear();
@@ -206,18 +229,26 @@ namespace ouzel
 
                 for (const Shader::ConstantInfo& info : fragmentShaderConstantInfo)
                 {
-                    GLint location = glGetUniformLocationProc(programId, info.name.c_str());
+                    GLint location = -1;
 
-                    if ((error = glGetErrorProc()) != GL_NO_ERROR)
-                        throw std::system_error(makeErrorCode(error), "Failed to get OpenGL uniform location");
+                    if (!fragmentShaderConstantBlock)
+                    {
+                        location = glGetUniformLocationProc(programId, info.name.c_str());
+
+                        if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                            throw std::system_error(makeErrorCode(error), "Failed to get OpenGL uniform location");
 
-                    if (location == -1)
-                        throw std::runtime_error("Failed to get OpenGL uniform location");
+                        if (location == -1)
+                            throw std::runtime_error("Failed to get OpenGL uniform location");
+                    }
 
-                    fragmentShaderConstantLocations.push_back({location, info.dataType});
+                    fragmentShaderConstantLocations.push_back({location, info.dataType, fragmentShaderConstantSize});
+                    fragmentShaderConstantSize += info.size;
                 }
             }
 
+            vertexShaderConstantSize = 0;
+
             if (!vertexShaderConstantInfo.empty())
             {
                 vertexShaderConstantLocations.clear();
@@ -225,17 +256,49 @@ namespace ouzel
 
                 for (const Shader::ConstantInfo& info : vertexShaderConstantInfo)
                 {
-                    GLint location = glGetUniformLocationProc(programId, info.name.c_str());
+                    GLint location = -1;
 
-                    if ((error = glGetErrorProc()) != GL_NO_ERROR)
-                        throw std::system_error(makeErrorCode(error), "Failed to get OpenGL uniform location");
+                    if (!vertexShaderConstantBlock)
+                    {
+                        location = glGetUniformLocationProc(programId, info.name.c_str());
 
-                    if (location == -1)
-                        throw std::runtime_error("Failed to get OpenGL uniform location");
+                        if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                            throw std::system_error(makeErrorCode(error), "Failed to get OpenGL uniform location");
 
-                    vertexShaderConstantLocations.push_back({location, info.dataType});
+                        if (location == -1)
+                            throw std::runtime_error("Failed to get OpenGL uniform location");
+                    }
+
+                    vertexShaderConstantLocations.push_back({location, info.dataType, vertexShaderConstantSize});
+                    vertexShaderConstantSize += info.size;
                 }
             }
+
+            // the std140 layout of the uniform blocks must match the tightly packed constant info,
+            // otherwise the bound ranges of the uniform buffer would be smaller than the blocks
+            if (fragmentShaderConstantBlock)
+            {
+                GLint blockSize;
+                glGetActiveUniformBlockivProc(programId, fragmentShaderConstantBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to get uniform block size");
+
+                if (static_cast<uint32_t>(blockSize) != fragmentShaderConstantSize)
+                    throw std::runtime_error("Pixel shader uniform block size doesn't match the shader constants");
+            }
+
+            if (vertexShaderConstantBlock)
+            {
+                GLint blockSize;
+                glGetActiveUniformBlockivProc(programId, vertexShaderConstantBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to get uniform block size");
+
+                if (static_cast<uint32_t>(blockSize) != vertexShaderConstantSize)
+                    throw std::runtime_error("Vertex shader uniform block size doesn't match the shader constants");
+            }
         }
     } // namespace graphics
 } // namespace ouzel
@@ -32,7 +32,7 @@ namespace ouzel
             ShaderResourceOGL(RenderDeviceOGL& renderDeviceOGL,
                               const std::vector<uint8_t>& newFragmentShader,
                               const std::vector<uint8_t>& newVertexShader,
-                              const std::set<Vertex::Attribute::Usage>& newVertexAttributes,
+                              const VertexLayout& newVertexLayout,
                               const std::vector<Shader::ConstantInfo>& newFragmentShaderConstantInfo,
                               const std::vector<Shader::ConstantInfo>& newVertexShaderConstantInfo,
                               uint32_t newFragmentShaderDataAlignment,
@@ -43,17 +43,40 @@ namespace ouzel
 
             void reload() override;
 
+            // uniform buffer binding points of the FragmentConstants and VertexConstants uniform blocks
+            static constexpr GLuint FRAGMENT_SHADER_CONSTANT_BINDING = 0;
+            static constexpr GLuint VERTEX_SHADER_CONSTANT_BINDING = 1;
+
             struct Location final
             {
                 GLint location;
                 DataType dataType;
+                uint32_t offset;
             };
 
-            inline const std::set<Vertex::Attribute::Usage>& getVertexAttributes() const { return vertexAttributes; }
+            // matrix attributes take one location per column
+            static inline GLuint getLocationCount(DataType dataType)
+            {
+                switch (dataType)
+                {
+                    case DataType::FLOAT_MATRIX3: return 3;
+                    case DataType::FLOAT_MATRIX4: return 4;
+                    default: return 1;
+                }
+            }
+
+            inline const VertexLayout& getVertexLayout() const { return vertexLayout; }
 
             inline const std::vector<Location>& getFragmentShaderConstantLocations() const { return fragmentShaderConstantLocations; }
             inline const std::vector<Location>& getVertexShaderConstantLocations() const { return vertexShaderConstantLocations; }
 
+            inline uint32_t getFragmentShaderConstantSize() const { return fragmentShaderConstantSize; }
+            inline uint32_t getVertexShaderConstantSize() const { return vertexShaderConstantSize; }
+
+            // constants in uniform blocks are read from the uniform buffer instead of being set one by one
+            inline bool hasFragmentShaderConstantBlock() const { return fragmentShaderConstantBlock; }
+            inline bool hasVertexShaderConstantBlock() const { return vertexShaderConstantBlock; }
+
             inline GLuint getProgramId() const { return programId; }
 
         private:
@@ -64,7 +87,7 @@ namespace ouzel
             std::vector<uint8_t> fragmentShaderData;
             std::vector<uint8_t> vertexShaderData;
 
-            std::set<Vertex::Attribute::Usage> vertexAttributes;
+            VertexLayout vertexLayout;
 
             std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo;
             std::vector<Shader::ConstantInfo> vertexShaderConstantInfo;
@@ -74,7 +97,11 @@ namespace ouzel
             GLuint programId = 0;
 
             std::vector<Location> fragmentShaderConstantLocations;
+            uint32_t fragmentShaderConstantSize = 0;
+            bool fragmentShaderConstantBlock = false;
             std::vector<Location> vertexShaderConstantLocations;
+            uint32_t vertexShaderConstantSize = 0;
+            bool vertexShaderConstantBlock = false;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -56,7 +56,19 @@ namespace ouzel
 
                 for (size_t level = 0; level < levels.size(); ++level)
                 {
-                    if (!levels[level].data.empty())
+                    if (isCompressed(pixelFormat))
+                    {
+                        size_t levelSize = getLevelSize(pixelFormat,
+                                                        static_cast<uint32_t>(levels[level].size.width),
+                                                        static_cast<uint32_t>(levels[level].size.height));
+
+                        glCompressedTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), oglInternalPixelFormat,
+                                                   static_cast<GLsizei>(levels[level].size.width),
+                                                   static_cast<GLsizei>(levels[level].size.height), 0,
+                                                   static_cast<GLsizei>(levelSize),
+                                                   levels[level].data.empty() ? nullptr : levels[level].data.data());
+                    }
+                    else if (!levels[level].data.empty())
                     {
                         glTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(oglInternalPixelFormat),
                                          static_cast<GLsizei>(levels[level].size.width),
@@ -106,7 +118,7 @@ namespace ouzel
             {
                 switch (pixelFormat)
                 {
-                    case PixelFormat::A8_UNORM: return GL_ALPHA8_OES;
+                    case PixelFormat::A8_UNORM: return GL_R8; // swizzled to white with alpha
                     case PixelFormat::R8_UNORM: return GL_R8;
                     case PixelFormat::R8_SNORM: return GL_R8_SNORM;
                     case PixelFormat::R8_UINT: return GL_R8UI;
@@ -137,6 +149,13 @@ namespace ouzel
                     case PixelFormat::RGBA32_UINT: return GL_RGBA32UI;
                     case PixelFormat::RGBA32_SINT: return GL_RGBA32I;
                     case PixelFormat::RGBA32_FLOAT: return GL_RGBA32F;
+                    case PixelFormat::BC1_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                    case PixelFormat::BC3_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                    case PixelFormat::ETC2_RGB8_UNORM: return GL_COMPRESSED_RGB8_ETC2;
+                    case PixelFormat::ETC2_RGBA8_UNORM: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                    case PixelFormat::ASTC_4X4_UNORM: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                    case PixelFormat::ASTC_6X6_UNORM: return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+                    case PixelFormat::ASTC_8X8_UNORM: return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
                     default: return GL_NONE;
                 }
             }
@@ -144,8 +163,12 @@ namespace ouzel
             {
                 switch (pixelFormat)
                 {
-                    case PixelFormat::A8_UNORM: return GL_ALPHA;
                     case PixelFormat::RGBA8_UNORM: return GL_RGBA;
+                    case PixelFormat::BC1_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                    case PixelFormat::BC3_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                    case PixelFormat::ASTC_4X4_UNORM: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                    case PixelFormat::ASTC_6X6_UNORM: return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+                    case PixelFormat::ASTC_8X8_UNORM: return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
                     default: return GL_NONE;
                 }
             }
@@ -154,7 +177,7 @@ namespace ouzel
 
             switch (pixelFormat)
             {
-                case PixelFormat::A8_UNORM: return GL_ALPHA8_EXT;
+                case PixelFormat::A8_UNORM: return GL_R8; // swizzled to white with alpha
 
                 case PixelFormat::R8_UNORM: return GL_R8;
                 case PixelFormat::R8_SNORM: return GL_R8_SNORM;
@@ -186,6 +209,14 @@ namespace ouzel
                 case PixelFormat::RGBA32_UINT: return GL_RGBA32UI;
                 case PixelFormat::RGBA32_SINT: return GL_RGBA32I;
                 case PixelFormat::RGBA32_FLOAT: return GL_RGBA32F;
+                case PixelFormat::BC1_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case PixelFormat::BC3_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case PixelFormat::BC7_UNORM: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                case PixelFormat::ETC2_RGB8_UNORM: return GL_COMPRESSED_RGB8_ETC2;
+                case PixelFormat::ETC2_RGBA8_UNORM: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                case PixelFormat::ASTC_4X4_UNORM: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                case PixelFormat::ASTC_6X6_UNORM: return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+                case PixelFormat::ASTC_8X8_UNORM: return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
                 default: return GL_NONE;
             }
 #endif
@@ -196,7 +227,6 @@ namespace ouzel
             switch (pixelFormat)
             {
                 case PixelFormat::A8_UNORM:
-                    return GL_ALPHA;
                 case PixelFormat::R8_UNORM:
                 case PixelFormat::R8_SNORM:
                 case PixelFormat::R16_UNORM:
@@ -306,7 +336,19 @@ namespace ouzel
 
                 for (size_t level = 0; level < levels.size(); ++level)
                 {
-                    if (!levels[level].data.empty())
+                    if (isCompressed(pixelFormat))
+                    {
+                        size_t levelSize = getLevelSize(pixelFormat,
+                                                        static_cast<uint32_t>(levels[level].size.width),
+                                                        static_cast<uint32_t>(levels[level].size.height));
+
+                        glCompressedTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), oglInternalPixelFormat,
+                                                   static_cast<GLsizei>(levels[level].size.width),
+                                                   static_cast<GLsizei>(levels[level].size.height), 0,
+                                                   static_cast<GLsizei>(levelSize),
+                                                   levels[level].data.empty() ? nullptr : levels[level].data.data());
+                    }
+                    else if (!levels[level].data.empty())
                     {
                         glTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(oglInternalPixelFormat),
                                          static_cast<GLsizei>(levels[level].size.width),
@@ -349,11 +391,19 @@ namespace ouzel
                 {
                     if (!levels[level].data.empty())
                     {
-                        glTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
-                                            static_cast<GLsizei>(levels[level].size.width),
-                                            static_cast<GLsizei>(levels[level].size.height),
-                                            oglPixelFormat, oglPixelType,
-                                            levels[level].data.data());
+                        if (isCompressed(pixelFormat))
+                            glCompressedTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                                                          static_cast<GLsizei>(levels[level].size.width),
+                                                          static_cast<GLsizei>(levels[level].size.height),
+                                                          oglInternalPixelFormat,
+                                                          static_cast<GLsizei>(levels[level].data.size()),
+                                                          levels[level].data.data());
+                        else
+                            glTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                                                static_cast<GLsizei>(levels[level].size.width),
+                                                static_cast<GLsizei>(levels[level].size.height),
+                                                oglPixelFormat, oglPixelType,
+                                                levels[level].data.data());
                     }
                 }
 
@@ -364,6 +414,57 @@ namespace ouzel
             }
         }
 
+        void TextureResourceOGL::setRegionData(uint32_t level, uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                                               const std::vector<uint8_t>& data)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (isCompressed(pixelFormat))
+                throw std::runtime_error("Regions of compressed textures can't be updated");
+
+            if (level >= levels.size())
+                throw std::runtime_error("Invalid mip map level");
+
+            Texture::Level& textureLevel = levels[level];
+            uint32_t levelWidth = static_cast<uint32_t>(textureLevel.size.width);
+            uint32_t levelHeight = static_cast<uint32_t>(textureLevel.size.height);
+
+            if (regionWidth > levelWidth || x > levelWidth - regionWidth ||
+                regionHeight > levelHeight || y > levelHeight - regionHeight)
+                throw std::runtime_error("Invalid texture region");
+
+            size_t rowSize = getRowPitch(pixelFormat, regionWidth);
+
+            if (data.size() != rowSize * regionHeight)
+                throw std::runtime_error("Invalid texture data size");
+
+            if (!textureId)
+                throw std::runtime_error("Texture not initialized");
+
+            // the copy of the level is uploaded again when the context is recreated
+            if (textureLevel.data.empty())
+                textureLevel.data.resize(static_cast<size_t>(textureLevel.pitch) * levelHeight);
+
+            size_t offset = getRowPitch(pixelFormat, x);
+            for (uint32_t row = 0; row < regionHeight; ++row)
+                std::copy(data.begin() + static_cast<std::ptrdiff_t>(row * rowSize),
+                          data.begin() + static_cast<std::ptrdiff_t>((row + 1) * rowSize),
+                          textureLevel.data.begin() + static_cast<std::ptrdiff_t>((y + row) * textureLevel.pitch + offset));
+
+            renderDevice.bindTexture(textureId, 0);
+
+            glTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level),
+                                static_cast<GLint>(x), static_cast<GLint>(y),
+                                static_cast<GLsizei>(regionWidth), static_cast<GLsizei>(regionHeight),
+                                oglPixelFormat, oglPixelType, data.data());
+
+            GLenum error;
+
+            if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                throw std::system_error(makeErrorCode(error), "Failed to upload texture data");
+        }
+
         void TextureResourceOGL::setFilter(Texture::Filter newFilter)
         {
             filter = newFilter;
@@ -570,15 +671,30 @@ namespace ouzel
             if (oglInternalPixelFormat == GL_NONE)
                 throw std::runtime_error("Invalid pixel format");
 
-            oglPixelFormat = getOGLPixelFormat(pixelFormat);
+            // compressed data is uploaded in the internal format
+            if (!isCompressed(pixelFormat))
+            {
+                oglPixelFormat = getOGLPixelFormat(pixelFormat);
 
-            if (oglPixelFormat == GL_NONE)
-                throw std::runtime_error("Invalid pixel format");
+                if (oglPixelFormat == GL_NONE)
+                    throw std::runtime_error("Invalid pixel format");
 
-            oglPixelType = getOGLPixelType(pixelFormat);
+                oglPixelType = getOGLPixelType(pixelFormat);
 
-            if (oglPixelType == GL_NONE)
-                throw std::runtime_error("Invalid pixel format");
+                if (oglPixelType == GL_NONE)
+                    throw std::runtime_error("Invalid pixel format");
+            }
+
+            if (pixelFormat == PixelFormat::A8_UNORM)
+            {
+                glTexParameteriProc(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+                glTexParameteriProc(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+                glTexParameteriProc(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+                glTexParameteriProc(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to set texture swizzle");
+            }
 
             if ((flags & Texture::RENDER_TARGET) && renderDevice.isRenderTargetsSupported())
             {
@@ -41,6 +41,8 @@ namespace ouzel
             void reload() override;
 
             void setData(const std::vector<Texture::Level>& newLevels);
+            void setRegionData(uint32_t level, uint32_t x, uint32_t y, uint32_t regionWidth, uint32_t regionHeight,
+                               const std::vector<uint8_t>& data);
             void setFilter(Texture::Filter newFilter);
             void setAddressX(Texture::Address newAddressX);
             void setAddressY(Texture::Address newAddressY);
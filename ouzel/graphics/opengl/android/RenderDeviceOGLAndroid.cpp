@@ -8,6 +8,10 @@
 #include "core/Engine.hpp"
 #include "core/Window.hpp"
 #include "core/android/NativeWindowAndroid.hpp"
+#include "graphics/opengl/BlendStateResourceOGL.hpp"
+#include "graphics/opengl/BufferResourceOGL.hpp"
+#include "graphics/opengl/DepthStencilStateResourceOGL.hpp"
+#include "graphics/opengl/TextureResourceOGL.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
 
@@ -57,7 +61,7 @@ namespace ouzel
         {
             running = false;
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
 
             if (renderThread.joinable()) renderThread.join();
@@ -193,7 +197,7 @@ namespace ouzel
         {
             running = false;
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
 
             if (renderThread.joinable()) renderThread.join();
@@ -287,10 +291,14 @@ namespace ouzel
                 throw std::system_error(makeErrorCode(error), "Failed to set depth function");
 
             if (glGenVertexArraysProc) glGenVertexArraysProc(1, &vertexArrayId);
+            if (uniformBufferSupported) glGenBuffersProc(1, &uniformBufferId);
 
-            for (const std::unique_ptr<RenderResourceOGL>& resource : resources)
-                if (resource)
-                    static_cast<RenderResourceOGL*>(resource.get())->reload();
+            auto reload = [](RenderResourceOGL& resource) { resource.reload(); };
+            blendStates.forEach(reload);
+            buffers.forEach(reload);
+            depthStencilStates.forEach(reload);
+            shaders.forEach(reload);
+            textures.forEach(reload);
 
             if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT))
                 throw std::runtime_error("Failed to unset EGL context");
@@ -303,7 +311,7 @@ namespace ouzel
         {
             running = false;
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
             
             if (renderThread.joinable()) renderThread.join();
@@ -37,7 +37,7 @@ namespace ouzel
         {
             displayLink.stop();
             CommandBuffer commandBuffer;
-            commandBuffer.commands.push(std::unique_ptr<Command>(new PresentCommand()));
+            commandBuffer.push(PresentCommand());
             submitCommandBuffer(std::move(commandBuffer));
 
             if (msaaColorRenderBufferId) glDeleteRenderbuffersProc(1, &msaaColorRenderBufferId);
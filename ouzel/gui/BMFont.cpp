@@ -358,7 +358,7 @@ namespace ouzel
                              float fontSize,
                              const Vector2& anchor,
                              std::vector<uint16_t>& indices,
-                             std::vector<graphics::Vertex>& vertices,
+                             std::vector<graphics::TextVertex>& vertices,
                              std::shared_ptr<graphics::Texture>& texture)
     {
         Vector2 position;
@@ -403,14 +403,14 @@ namespace ouzel
                 textCoords[2] = Vector2(leftTop.x, leftTop.y);
                 textCoords[3] = Vector2(rightBottom.x, leftTop.y);
 
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.xOffset, -position.y - f.yOffset - f.height, 0.0F),
-                                                    color, textCoords[0], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.xOffset + f.width, -position.y - f.yOffset - f.height, 0.0F),
-                                                    color, textCoords[1], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.xOffset, -position.y - f.yOffset, 0.0F),
-                                                    color, textCoords[2], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.xOffset + f.width, -position.y - f.yOffset, 0.0F),
-                                                    color, textCoords[3], Vector3(0.0F, 0.0F, -1.0F)));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.xOffset, -position.y - f.yOffset - f.height),
+                                                        color, textCoords[0]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.xOffset + f.width, -position.y - f.yOffset - f.height),
+                                                        color, textCoords[1]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.xOffset, -position.y - f.yOffset),
+                                                        color, textCoords[2]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.xOffset + f.width, -position.y - f.yOffset),
+                                                        color, textCoords[3]));
 
                 if ((i + 1) != utf32Text.end())
                     position.x += static_cast<float>(getKerningPair(*i, *(i + 1)));
@@ -32,7 +32,7 @@ namespace ouzel
                                  float fontSize,
                                  const Vector2& anchor,
                                  std::vector<uint16_t>& indices,
-                                 std::vector<graphics::Vertex>& vertices,
+                                 std::vector<graphics::TextVertex>& vertices,
                                  std::shared_ptr<graphics::Texture>& texture) = 0;
     };
 }
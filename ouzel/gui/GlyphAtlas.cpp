@@ -0,0 +1,295 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "GlyphAtlas.hpp"
+#include "core/Engine.hpp"
+
+namespace ouzel
+{
+    GlyphAtlas::GlyphAtlas(bool initMipmaps):
+        mipmaps(initMipmaps),
+        pixels(INITIAL_SIZE * INITIAL_SIZE)
+    {
+    }
+
+    GlyphAtlas::Glyph* GlyphAtlas::getGlyph(uint32_t character)
+    {
+        auto i = glyphs.find(character);
+
+        if (i == glyphs.end())
+            return nullptr;
+
+        i->second.lastUse = currentUse;
+
+        return &i->second;
+    }
+
+    GlyphAtlas::Glyph* GlyphAtlas::addGlyph(uint32_t character, const Glyph& newGlyph, const uint8_t* bitmap)
+    {
+        Glyph glyph = newGlyph;
+        glyph.lastUse = currentUse;
+
+        if (glyph.width && glyph.height)
+        {
+            bool evicted = false;
+
+            while (!pack(glyph.width + SPACING, glyph.height + SPACING, glyph.x, glyph.y))
+            {
+                if (width < MAX_SIZE || height < MAX_SIZE)
+                    grow();
+                else if (!evicted)
+                {
+                    evict();
+                    evicted = true;
+                }
+                else // glyphs of the current text don't fit into the maximum size
+                {
+                    rejectedGlyphs.insert(character);
+                    return nullptr;
+                }
+            }
+
+            for (uint32_t row = 0; row < glyph.height; ++row)
+                std::copy(bitmap + row * glyph.width,
+                          bitmap + (row + 1) * glyph.width,
+                          pixels.begin() + (glyph.y + row) * width + glyph.x);
+
+            if (textureDirty)
+            {
+                dirtyLeft = std::min(dirtyLeft, glyph.x);
+                dirtyTop = std::min(dirtyTop, glyph.y);
+                dirtyRight = std::max(dirtyRight, glyph.x + glyph.width);
+                dirtyBottom = std::max(dirtyBottom, glyph.y + glyph.height);
+            }
+            else
+            {
+                dirtyLeft = glyph.x;
+                dirtyTop = glyph.y;
+                dirtyRight = glyph.x + glyph.width;
+                dirtyBottom = glyph.y + glyph.height;
+                textureDirty = true;
+            }
+        }
+
+        Glyph& result = glyphs[character];
+        result = glyph;
+
+        return &result;
+    }
+
+    std::shared_ptr<graphics::Texture> GlyphAtlas::getTexture()
+    {
+        if (!texture || textureStale)
+        {
+            std::vector<graphics::Texture::Level> levels;
+            levels.push_back({Size2(static_cast<float>(width), static_cast<float>(height)), width, pixels});
+
+            if (mipmaps)
+            {
+                mipMaps.clear();
+
+                for (uint32_t level = 1; (width >> (level - 1)) > 1 || (height >> (level - 1)) > 1; ++level)
+                {
+                    uint32_t levelWidth = std::max(width >> level, 1U);
+                    uint32_t levelHeight = std::max(height >> level, 1U);
+                    mipMaps.push_back(std::vector<uint8_t>(levelWidth * levelHeight));
+
+                    uint32_t left = 0;
+                    uint32_t top = 0;
+                    uint32_t right = std::max(width >> (level - 1), 1U);
+                    uint32_t bottom = std::max(height >> (level - 1), 1U);
+                    downsample(level, left, top, right, bottom);
+
+                    levels.push_back({Size2(static_cast<float>(levelWidth), static_cast<float>(levelHeight)), levelWidth, mipMaps.back()});
+                }
+            }
+
+            texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
+            texture->init(levels, Size2(static_cast<float>(width), static_cast<float>(height)),
+                          graphics::Texture::DYNAMIC, graphics::PixelFormat::A8_UNORM);
+        }
+        else if (textureDirty)
+        {
+            // only the rectangle of the new glyphs is uploaded, the mip maps are updated under it
+            uint32_t left = dirtyLeft;
+            uint32_t top = dirtyTop;
+            uint32_t right = dirtyRight;
+            uint32_t bottom = dirtyBottom;
+
+            for (uint32_t level = 0; level < mipMaps.size() + 1; ++level)
+            {
+                if (level > 0) downsample(level, left, top, right, bottom);
+
+                const std::vector<uint8_t>& levelPixels = (level == 0) ? pixels : mipMaps[level - 1];
+                uint32_t levelWidth = std::max(width >> level, 1U);
+
+                std::vector<uint8_t> regionData((right - left) * (bottom - top));
+
+                for (uint32_t row = top; row < bottom; ++row)
+                    std::copy(levelPixels.begin() + row * levelWidth + left,
+                              levelPixels.begin() + row * levelWidth + right,
+                              regionData.begin() + (row - top) * (right - left));
+
+                texture->setRegionData(regionData, level, left, top, right - left, bottom - top);
+            }
+        }
+
+        textureDirty = false;
+        textureStale = false;
+
+        return texture;
+    }
+
+    bool GlyphAtlas::pack(uint32_t glyphWidth, uint32_t glyphHeight, uint32_t& x, uint32_t& y)
+    {
+        // the lowest row that has enough space
+        Row* bestRow = nullptr;
+
+        for (Row& row : rows)
+        {
+            if (row.height >= glyphHeight && row.x + glyphWidth <= width &&
+                (!bestRow || row.height < bestRow->height))
+                bestRow = &row;
+        }
+
+        // don't waste more than a half of a row on short glyphs
+        if (!bestRow || bestRow->height > glyphHeight + glyphHeight / 2)
+        {
+            uint32_t top = rows.empty() ? 0 : rows.back().y + rows.back().height;
+
+            if (glyphWidth <= width && top + glyphHeight <= height)
+            {
+                Row row;
+                row.y = top;
+                row.height = glyphHeight;
+                row.x = 0;
+                rows.push_back(row);
+                bestRow = &rows.back();
+            }
+        }
+
+        if (!bestRow) return false;
+
+        x = bestRow->x;
+        y = bestRow->y;
+        bestRow->x += glyphWidth;
+
+        return true;
+    }
+
+    void GlyphAtlas::grow()
+    {
+        uint32_t newWidth = width;
+        uint32_t newHeight = height;
+
+        if (width <= height)
+            newWidth *= 2;
+        else
+            newHeight *= 2;
+
+        std::vector<uint8_t> newPixels(newWidth * newHeight);
+
+        // glyphs keep their positions
+        for (uint32_t row = 0; row < height; ++row)
+            std::copy(pixels.begin() + row * width,
+                      pixels.begin() + (row + 1) * width,
+                      newPixels.begin() + row * newWidth);
+
+        width = newWidth;
+        height = newHeight;
+        pixels.swap(newPixels);
+
+        textureStale = true;
+    }
+
+    void GlyphAtlas::evict()
+    {
+        // repack the glyphs starting from the most recently used ones and keep at most a half of the atlas filled, so that
+        // the next glyphs don't cause another eviction right away
+        std::vector<std::pair<uint32_t, Glyph>> oldGlyphs(glyphs.begin(), glyphs.end());
+
+        std::sort(oldGlyphs.begin(), oldGlyphs.end(), [](const std::pair<uint32_t, Glyph>& a,
+                                                         const std::pair<uint32_t, Glyph>& b) {
+            return (a.second.lastUse == b.second.lastUse) ?
+                a.second.height > b.second.height :
+                a.second.lastUse > b.second.lastUse;
+        });
+
+        uint32_t oldWidth = width;
+        std::vector<uint8_t> oldPixels(width * height);
+        oldPixels.swap(pixels);
+
+        rows.clear();
+        glyphs.clear();
+        rejectedGlyphs.clear(); // the evicted glyphs leave room for them
+
+        uint32_t area = 0;
+
+        for (std::pair<uint32_t, Glyph>& oldGlyph : oldGlyphs)
+        {
+            Glyph& glyph = oldGlyph.second;
+
+            if (glyph.width && glyph.height)
+            {
+                area += (glyph.width + SPACING) * (glyph.height + SPACING);
+
+                if (glyph.lastUse != currentUse && area > width * height / 2)
+                    continue;
+
+                uint32_t x;
+                uint32_t y;
+
+                bool packed;
+                // glyphs of the current text are dropped only if they don't fit into the maximum size
+                while (!(packed = pack(glyph.width + SPACING, glyph.height + SPACING, x, y)) &&
+                       glyph.lastUse == currentUse &&
+                       (width < MAX_SIZE || height < MAX_SIZE))
+                    grow();
+
+                if (!packed) continue;
+
+                for (uint32_t row = 0; row < glyph.height; ++row)
+                    std::copy(oldPixels.begin() + (glyph.y + row) * oldWidth + glyph.x,
+                              oldPixels.begin() + (glyph.y + row) * oldWidth + glyph.x + glyph.width,
+                              pixels.begin() + (y + row) * width + x);
+
+                glyph.x = x;
+                glyph.y = y;
+            }
+
+            glyphs[oldGlyph.first] = glyph;
+        }
+
+        textureStale = true;
+    }
+
+    void GlyphAtlas::downsample(uint32_t level, uint32_t& left, uint32_t& top, uint32_t& right, uint32_t& bottom)
+    {
+        const std::vector<uint8_t>& source = (level == 1) ? pixels : mipMaps[level - 2];
+        std::vector<uint8_t>& destination = mipMaps[level - 1];
+
+        uint32_t sourceWidth = std::max(width >> (level - 1), 1U);
+        uint32_t sourceHeight = std::max(height >> (level - 1), 1U);
+        uint32_t destinationWidth = std::max(width >> level, 1U);
+
+        left /= 2;
+        top /= 2;
+        right = (right + 1) / 2;
+        bottom = (bottom + 1) / 2;
+
+        // the same box filter that the textures use for alpha, edges of odd sized levels are repeated
+        for (uint32_t y = top; y < bottom; ++y)
+        {
+            const uint8_t* row0 = source.data() + std::min(y * 2, sourceHeight - 1) * sourceWidth;
+            const uint8_t* row1 = source.data() + std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth;
+
+            for (uint32_t x = left; x < right; ++x)
+            {
+                uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+                uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+                destination[y * destinationWidth + x] = static_cast<uint8_t>((row0[x0] + row0[x1] + row1[x0] + row1[x1]) >> 2);
+            }
+        }
+    }
+}
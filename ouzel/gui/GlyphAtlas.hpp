@@ -0,0 +1,102 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GUI_GLYPHATLAS_HPP
+#define OUZEL_GUI_GLYPHATLAS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "math/Vector2.hpp"
+#include "graphics/Texture.hpp"
+
+namespace ouzel
+{
+    // glyph bitmaps of one font size, packed in rows into a texture that is shared by all the texts
+    class GlyphAtlas final
+    {
+    public:
+        struct Glyph final
+        {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            Vector2 offset;
+            float advance = 0.0F;
+            uint32_t lastUse = 0;
+        };
+
+        static const uint32_t INITIAL_SIZE = 256;
+        static const uint32_t MAX_SIZE = 2048;
+        static const uint32_t SPACING = 2;
+
+        explicit GlyphAtlas(bool initMipmaps);
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        GlyphAtlas(GlyphAtlas&&) = delete;
+        GlyphAtlas& operator=(GlyphAtlas&&) = delete;
+
+        // starts a new use, glyphs that are not used for the longest time are evicted first
+        void beginUse() { ++currentUse; }
+
+        Glyph* getGlyph(uint32_t character);
+        // bitmap is width * height coverage values, glyph positions can change until the texture is requested,
+        // returns nullptr if the glyph doesn't fit into an atlas of the maximum size
+        Glyph* addGlyph(uint32_t character, const Glyph& newGlyph, const uint8_t* bitmap);
+
+        // characters that the font doesn't have or that didn't fit, so that they are not rasterized again for every text,
+        // the ones that didn't fit are retried after the next eviction
+        inline bool isGlyphMissing(uint32_t character) const
+        {
+            return missingGlyphs.find(character) != missingGlyphs.end() ||
+                rejectedGlyphs.find(character) != rejectedGlyphs.end();
+        }
+        inline void addMissingGlyph(uint32_t character) { missingGlyphs.insert(character); }
+
+        std::shared_ptr<graphics::Texture> getTexture();
+
+        inline uint32_t getWidth() const { return width; }
+        inline uint32_t getHeight() const { return height; }
+        inline size_t getGlyphCount() const { return glyphs.size(); }
+
+    private:
+        struct Row final
+        {
+            uint32_t y;
+            uint32_t height;
+            uint32_t x;
+        };
+
+        bool pack(uint32_t glyphWidth, uint32_t glyphHeight, uint32_t& x, uint32_t& y);
+        void grow();
+        void evict();
+        // updates the rectangle of the level from the previous level and converts the rectangle to the level's coordinates
+        void downsample(uint32_t level, uint32_t& left, uint32_t& top, uint32_t& right, uint32_t& bottom);
+
+        bool mipmaps = true;
+        uint32_t width = INITIAL_SIZE;
+        uint32_t height = INITIAL_SIZE;
+        std::vector<uint8_t> pixels; // single channel coverage
+        std::vector<std::vector<uint8_t>> mipMaps; // downsampled pixels, starting from the second level
+        std::vector<Row> rows;
+        std::unordered_map<uint32_t, Glyph> glyphs;
+        std::unordered_set<uint32_t> missingGlyphs;
+        std::unordered_set<uint32_t> rejectedGlyphs; // didn't fit into an atlas of the maximum size
+        uint32_t currentUse = 0;
+
+        std::shared_ptr<graphics::Texture> texture;
+        bool textureDirty = false; // new glyphs must be uploaded
+        bool textureStale = true; // glyphs moved, textures given out must not change
+        // the part of the atlas that the new glyphs were copied to
+        uint32_t dirtyLeft = 0;
+        uint32_t dirtyTop = 0;
+        uint32_t dirtyRight = 0;
+        uint32_t dirtyBottom = 0;
+    };
+}
+
+#endif // OUZEL_GUI_GLYPHATLAS_HPP
@@ -33,49 +33,28 @@ namespace ouzel
                              float fontSize,
                              const Vector2& anchor,
                              std::vector<uint16_t>& indices,
-                             std::vector<graphics::Vertex>& vertices,
+                             std::vector<graphics::TextVertex>& vertices,
                              std::shared_ptr<graphics::Texture>& texture)
     {
         if (!loaded)
             throw std::runtime_error("Font not loaded");
 
-        static const uint32_t SPACING = 2;
-
-        struct CharDescriptor final
-        {
-            uint16_t x = 0;
-            uint16_t y = 0;
-            uint16_t width = 0;
-            uint16_t height = 0;
-            Vector2 offset;
-            float advance = 0;
-            std::vector<uint8_t> bitmap;
-        };
-
-        std::unordered_map<uint32_t, CharDescriptor> chars;
-
         float s = stbtt_ScaleForPixelHeight(&font, fontSize);
 
         std::vector<uint32_t> utf32Text = utf8ToUtf32(text);
 
-        std::set<uint32_t> glyphs;
-        for (uint32_t i : utf32Text)
-            glyphs.insert(i);
-
-        uint16_t width = 0;
-        uint16_t height = 0;
-
         int ascent;
         int descent;
         int lineGap;
         stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
 
-        for (uint32_t c : glyphs)
+        GlyphAtlas& atlas = getAtlas(fontSize);
+        atlas.beginUse();
+
+        // rasterize only the glyphs that are not in the atlas yet
+        for (uint32_t c : utf32Text)
         {
-            int w;
-            int h;
-            int xoff;
-            int yoff;
+            if (atlas.getGlyph(c) || atlas.isGlyphMissing(c)) continue;
 
             if (int index = stbtt_FindGlyphIndex(&font, static_cast<int>(c)))
             {
@@ -83,63 +62,36 @@ namespace ouzel
                 int leftBearing;
                 stbtt_GetGlyphHMetrics(&font, index, &advance, &leftBearing);
 
-                CharDescriptor charDesc;
+                GlyphAtlas::Glyph glyph;
+                glyph.advance = static_cast<float>(advance * s);
+
+                int w;
+                int h;
+                int xoff;
+                int yoff;
 
                 if (unsigned char* bitmap = stbtt_GetGlyphBitmapSubpixel(&font, s, s, 0.0F, 0.0F, index, &w, &h, &xoff, &yoff))
                 {
-                    charDesc.width = static_cast<uint16_t>(w);
-                    charDesc.height = static_cast<uint16_t>(h);
-                    charDesc.offset.x = static_cast<float>(leftBearing * s);
-                    charDesc.offset.y = static_cast<float>(yoff + (ascent - descent) * s);
-                    charDesc.bitmap = std::vector<uint8_t>(bitmap, bitmap + h * w);
-                    charDesc.x = width;
+                    glyph.width = static_cast<uint32_t>(w);
+                    glyph.height = static_cast<uint32_t>(h);
+                    glyph.offset.x = static_cast<float>(leftBearing * s);
+                    glyph.offset.y = static_cast<float>(yoff + (ascent - descent) * s);
 
-                    width += static_cast<uint16_t>(w);
-                    height = height > static_cast<uint16_t>(h) ? height : static_cast<uint16_t>(h);
+                    atlas.addGlyph(c, glyph, bitmap);
 
                     stbtt_FreeBitmap(bitmap, nullptr);
                 }
-
-                charDesc.advance = static_cast<float>(advance * s);
-
-                if (!chars.empty())
-                    width += SPACING;
-
-                chars[c] = charDesc;
+                else
+                    atlas.addGlyph(c, glyph, nullptr);
             }
+            else
+                atlas.addMissingGlyph(c);
         }
 
-        std::vector<uint8_t> textureData(width * height * 4);
-
-        for (uint16_t posX = 0; posX < width; ++posX)
-        {
-            for (uint16_t posY = 0; posY < height; ++posY)
-            {
-                textureData[(posY * width + posX) * 4 + 0] = 255;
-                textureData[(posY * width + posX) * 4 + 1] = 255;
-                textureData[(posY * width + posX) * 4 + 2] = 255;
-                textureData[(posY * width + posX) * 4 + 3] = 0;
-            }
-        }
+        texture = atlas.getTexture();
 
-        for (auto& c : chars)
-        {
-            CharDescriptor& charDesc = c.second;
-
-            for (uint16_t posX = 0; posX < charDesc.width; ++posX)
-            {
-                for (uint16_t posY = 0; posY < charDesc.height; ++posY)
-                {
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 0] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 1] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 2] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 3] = charDesc.bitmap[posY * charDesc.width + posX];
-                }
-            }
-        }
-
-        texture = std::make_shared<graphics::Texture>(*engine->getRenderer());
-        texture->init(textureData, Size2(width, height), 0, mipmaps ? 0 : 1);
+        float width = static_cast<float>(atlas.getWidth());
+        float height = static_cast<float>(atlas.getHeight());
 
         Vector2 position;
 
@@ -155,11 +107,9 @@ namespace ouzel
 
         for (auto i = utf32Text.begin(); i != utf32Text.end(); ++i)
         {
-            auto iter = chars.find(*i);
-
-            if (iter != chars.end())
+            if (const GlyphAtlas::Glyph* glyph = atlas.getGlyph(*i))
             {
-                const CharDescriptor& f = iter->second;
+                const GlyphAtlas::Glyph& f = *glyph;
 
                 uint16_t startIndex = static_cast<uint16_t>(vertices.size());
                 indices.push_back(startIndex + 0);
@@ -170,25 +120,25 @@ namespace ouzel
                 indices.push_back(startIndex + 3);
                 indices.push_back(startIndex + 2);
 
-                Vector2 leftTop(f.x / static_cast<float>(width),
-                                f.y / static_cast<float>(height));
+                Vector2 leftTop(f.x / width,
+                                f.y / height);
 
-                Vector2 rightBottom((f.x + f.width) / static_cast<float>(width),
-                                    (f.y + f.height) / static_cast<float>(height));
+                Vector2 rightBottom((f.x + f.width) / width,
+                                    (f.y + f.height) / height);
 
                 textCoords[0] = Vector2(leftTop.x, rightBottom.y);
                 textCoords[1] = Vector2(rightBottom.x, rightBottom.y);
                 textCoords[2] = Vector2(leftTop.x, leftTop.y);
                 textCoords[3] = Vector2(rightBottom.x, leftTop.y);
 
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.offset.x, -position.y - f.offset.y - f.height, 0.0F),
-                                                    color, textCoords[0], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.offset.x + f.width, -position.y - f.offset.y - f.height, 0.0F),
-                                                    color, textCoords[1], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.offset.x, -position.y - f.offset.y, 0.0F),
-                                                    color, textCoords[2], Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(position.x + f.offset.x + f.width, -position.y - f.offset.y, 0.0F),
-                                                    color, textCoords[3], Vector3(0.0F, 0.0F, -1.0F)));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.offset.x, -position.y - f.offset.y - f.height),
+                                                        color, textCoords[0]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.offset.x + f.width, -position.y - f.offset.y - f.height),
+                                                        color, textCoords[1]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.offset.x, -position.y - f.offset.y),
+                                                        color, textCoords[2]));
+                vertices.push_back(graphics::TextVertex(Vector2(position.x + f.offset.x + f.width, -position.y - f.offset.y),
+                                                        color, textCoords[3]));
 
                 if ((i + 1) != utf32Text.end())
                 {
@@ -220,4 +170,33 @@ namespace ouzel
         for (size_t c = 0; c < vertices.size(); ++c)
             vertices[c].position.y += textHeight * (1.0F - anchor.y);
     }
+
+    GlyphAtlas& TTFont::getAtlas(float fontSize)
+    {
+        ++currentUse;
+
+        auto i = atlases.find(fontSize);
+
+        if (i == atlases.end())
+        {
+            // drop the least recently used font size
+            if (atlases.size() >= MAX_ATLASES)
+            {
+                auto leastUsed = atlases.begin();
+
+                for (auto atlasIterator = atlases.begin(); atlasIterator != atlases.end(); ++atlasIterator)
+                    if (atlasIterator->second.lastUse < leastUsed->second.lastUse)
+                        leastUsed = atlasIterator;
+
+                atlases.erase(leastUsed);
+            }
+
+            i = atlases.insert(std::make_pair(fontSize, AtlasEntry())).first;
+            i->second.atlas.reset(new GlyphAtlas(mipmaps));
+        }
+
+        i->second.lastUse = currentUse;
+
+        return *i->second.atlas;
+    }
 }
@@ -3,8 +3,11 @@
 #ifndef OUZEL_GUI_TTFONT_HPP
 #define OUZEL_GUI_TTFONT_HPP
 
+#include <map>
+#include <memory>
 #include "stb_truetype.h"
 #include "gui/Font.hpp"
+#include "gui/GlyphAtlas.hpp"
 
 namespace ouzel
 {
@@ -19,18 +22,31 @@ namespace ouzel
                          float fontSize,
                          const Vector2& anchor,
                          std::vector<uint16_t>& indices,
-                         std::vector<graphics::Vertex>& vertices,
+                         std::vector<graphics::TextVertex>& vertices,
                          std::shared_ptr<graphics::Texture>& texture) override;
 
         float getStringWidth(const std::string& text);
 
     private:
         int16_t getKerningPair(uint32_t, uint32_t);
+        GlyphAtlas& getAtlas(float fontSize);
+
+        // number of font sizes whose glyphs are kept
+        static const size_t MAX_ATLASES = 4;
+
+        struct AtlasEntry final
+        {
+            std::unique_ptr<GlyphAtlas> atlas;
+            uint32_t lastUse = 0;
+        };
 
         stbtt_fontinfo font;
         std::vector<unsigned char> data;
         bool loaded = false;
         bool mipmaps = true;
+
+        std::map<float, AtlasEntry> atlases;
+        uint32_t currentUse = 0;
     };
 }
 
@@ -18,8 +18,10 @@
 #include "assets/Loader.hpp"
 #include "assets/LoaderBMF.hpp"
 #include "assets/LoaderCollada.hpp"
+#include "assets/LoaderDDS.hpp"
 #include "assets/LoaderGLTF.hpp"
 #include "assets/LoaderImage.hpp"
+#include "assets/LoaderKTX.hpp"
 #include "assets/LoaderMTL.hpp"
 #include "assets/LoaderOBJ.hpp"
 #include "assets/LoaderParticleSystem.hpp"
@@ -52,8 +54,11 @@
 #include "events/EventHandler.hpp"
 #include "files/Archive.hpp"
 #include "files/File.hpp"
+#include "files/FileData.hpp"
 #include "files/FileSystem.hpp"
+#include "files/MappedFile.hpp"
 #include "graphics/BlendState.hpp"
+#include "graphics/BlockEncoder.hpp"
 #include "graphics/Buffer.hpp"
 #include "graphics/DataType.hpp"
 #include "graphics/DepthStencilState.hpp"
@@ -69,6 +74,7 @@
 #include "graphics/Shader.hpp"
 #include "graphics/Texture.hpp"
 #include "graphics/Vertex.hpp"
+#include "graphics/VertexLayout.hpp"
 #include "gui/BMFont.hpp"
 #include "gui/Button.hpp"
 #include "gui/CheckBox.hpp"
@@ -127,6 +133,9 @@
 #include "utils/JSON.hpp"
 #include "utils/Log.hpp"
 #include "utils/OBF.hpp"
+#include "utils/SpscQueue.hpp"
+#include "utils/StringView.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/Utils.hpp"
 #include "utils/XML.hpp"
 
@@ -25,7 +25,7 @@ namespace ouzel
                 component->setActor(nullptr);
         }
 
-        void Actor::visit(std::vector<Actor*>& drawQueue,
+        void Actor::visit(DrawQueue& drawQueue,
                           const Matrix4& newParentTransform,
                           bool parentTransformDirty,
                           Camera* camera,
@@ -43,14 +43,7 @@ namespace ouzel
                 Box3 boundingBox = getBoundingBox();
 
                 if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox)))
-                {
-                    auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), this,
-                                                       [](Actor* a, Actor* b) {
-                                                           return a->worldOrder > b->worldOrder;
-                                                       });
-
-                    drawQueue.insert(upperBound, this);
-                }
+                    drawQueue.add(this, worldOrder, (layer && layer->isStateSortingEnabled()) ? getStateKey() : 0);
             }
 
             for (Actor* actor : children)
@@ -68,6 +61,12 @@ namespace ouzel
             {
                 if (!component->isHidden())
                 {
+                    // keep the draw order of the sprites and meshes collected so far
+                    if (layer && component->getClass() != Component::SPRITE)
+                        layer->getSpriteBatch().flush();
+                    if (layer && component->getClass() != Component::MODEL_RENDERER)
+                        layer->getStaticMeshBatch().flush();
+
                     component->draw(transform,
                                     opacity,
                                     camera->getRenderViewProjection(),
@@ -98,6 +97,13 @@ namespace ouzel
             updateLocalTransform();
         }
 
+        void Actor::setOrder(int32_t newOrder)
+        {
+            order = newOrder;
+
+            invalidateBoundingBox();
+        }
+
         void Actor::setRotation(const Quaternion& newRotation)
         {
             rotation = newRotation;
@@ -159,9 +165,18 @@ namespace ouzel
             updateLocalTransform();
         }
 
+        void Actor::setCullDisabled(bool newCullDisabled)
+        {
+            cullDisabled = newCullDisabled;
+
+            invalidateBoundingBox();
+        }
+
         void Actor::setHidden(bool newHidden)
         {
             hidden = newHidden;
+
+            invalidateBoundingBox();
         }
 
         bool Actor::pointOn(const Vector2& worldPosition) const
@@ -206,6 +221,8 @@ namespace ouzel
             localTransformDirty = transformDirty = inverseTransformDirty = true;
             for (Component* component : components)
                 component->updateTransform();
+
+            invalidateBoundingBox();
         }
 
         void Actor::updateTransform(const Matrix4& newParentTransform)
@@ -278,6 +295,83 @@ namespace ouzel
             inverseTransformDirty = false;
         }
 
+        void Actor::invalidateBoundingBox()
+        {
+            if (layer) layer->invalidateActor(this);
+        }
+
+        void Actor::updateSpatialIndex(SpatialIndex& spatialIndex,
+                                       const Matrix4& newParentTransform,
+                                       int32_t parentOrder,
+                                       bool parentHidden)
+        {
+            worldOrder = parentOrder + order;
+            worldHidden = parentHidden || hidden;
+            spatialIndexDirty = false;
+
+            updateTransform(newParentTransform);
+            calculateTransform();
+
+            Box2 worldBox;
+
+            if (!worldHidden)
+            {
+                if (cullDisabled)
+                {
+                    // large enough to be returned by every query, small enough to keep the tree arithmetic finite
+                    worldBox.set(Vector2(-1e30F, -1e30F), Vector2(1e30F, 1e30F));
+                }
+                else
+                {
+                    Box3 boundingBox = getBoundingBox();
+
+                    if (!boundingBox.isEmpty())
+                    {
+                        for (uint32_t i = 0; i < 8; ++i)
+                        {
+                            Vector3 corner((i & 1) ? boundingBox.max.x : boundingBox.min.x,
+                                           (i & 2) ? boundingBox.max.y : boundingBox.min.y,
+                                           (i & 4) ? boundingBox.max.z : boundingBox.min.z);
+                            transform.transformPoint(corner);
+                            worldBox.insertPoint(Vector2(corner));
+                        }
+                    }
+                }
+            }
+
+            if (worldBox.isEmpty())
+            {
+                if (spatialProxy != SpatialIndex::NULL_PROXY)
+                {
+                    spatialIndex.destroyProxy(spatialProxy);
+                    spatialProxy = SpatialIndex::NULL_PROXY;
+                }
+            }
+            else if (spatialProxy == SpatialIndex::NULL_PROXY)
+                spatialProxy = spatialIndex.createProxy(worldBox, this);
+            else
+                spatialIndex.moveProxy(spatialProxy, worldBox);
+
+            for (Actor* actor : children)
+                actor->updateSpatialIndex(spatialIndex, transform, worldOrder, worldHidden);
+
+            updateChildrenTransform = false;
+        }
+
+        void Actor::removeFromSpatialIndex(SpatialIndex& spatialIndex)
+        {
+            if (spatialProxy != SpatialIndex::NULL_PROXY)
+            {
+                spatialIndex.destroyProxy(spatialProxy);
+                spatialProxy = SpatialIndex::NULL_PROXY;
+            }
+
+            spatialIndexDirty = false;
+
+            for (Actor* actor : children)
+                actor->removeFromSpatialIndex(spatialIndex);
+        }
+
         void Actor::removeFromParent()
         {
             if (parent) parent->removeChild(this);
@@ -292,6 +386,8 @@ namespace ouzel
 
             component->setActor(this);
             components.push_back(component);
+
+            invalidateBoundingBox();
         }
 
         bool Actor::removeComponent(Component* component)
@@ -314,6 +410,8 @@ namespace ouzel
             if (ownedIterator != ownedComponents.end())
                 ownedComponents.erase(ownedIterator);
 
+            if (result) invalidateBoundingBox();
+
             return result;
         }
 
@@ -321,10 +419,19 @@ namespace ouzel
         {
             components.clear();
             ownedComponents.clear();
+
+            invalidateBoundingBox();
         }
 
         void Actor::setLayer(Layer* newLayer)
         {
+            // proxies belong to the spatial index of the old layer
+            if (newLayer != layer)
+            {
+                spatialProxy = SpatialIndex::NULL_PROXY;
+                spatialIndexDirty = false;
+            }
+
             ActorContainer::setLayer(newLayer);
 
             for (Component* component : components)
@@ -356,5 +463,19 @@ namespace ouzel
 
             return boundingBox;
         }
+
+        uint32_t Actor::getStateKey() const
+        {
+            for (Component* component : components)
+            {
+                if (!component->isHidden())
+                {
+                    uint32_t stateKey = component->getStateKey();
+                    if (stateKey) return stateKey;
+                }
+            }
+
+            return 0;
+        }
     } // namespace scene
 } // namespace ouzel
@@ -4,6 +4,8 @@
 #define OUZEL_SCENE_ACTOR_HPP
 
 #include "scene/ActorContainer.hpp"
+#include "scene/DrawQueue.hpp"
+#include "scene/SpatialIndex.hpp"
 #include "math/Box3.hpp"
 #include "math/Color.hpp"
 #include "math/Matrix4.hpp"
@@ -23,12 +25,13 @@ namespace ouzel
         class Actor: public ActorContainer
         {
             friend ActorContainer;
+            friend Component;
             friend Layer;
         public:
             Actor();
             virtual ~Actor();
 
-            virtual void visit(std::vector<Actor*>& drawQueue,
+            virtual void visit(DrawQueue& drawQueue,
                                const Matrix4& newParentTransform,
                                bool parentTransformDirty,
                                Camera* camera,
@@ -41,7 +44,7 @@ namespace ouzel
             virtual void setPosition(const Vector3& newPosition);
 
             inline int32_t getOrder() const { return order; }
-            void setOrder(int32_t newOrder) { order = newOrder; }
+            void setOrder(int32_t newOrder);
 
             virtual const Quaternion& getRotation() const { return rotation; }
             virtual void setRotation(const Quaternion& newRotation);
@@ -65,7 +68,7 @@ namespace ouzel
             virtual void setPickable(bool newPickable) { pickable = newPickable; }
 
             virtual bool isCullDisabled() const { return cullDisabled; }
-            virtual void setCullDisabled(bool newCullDisabled) { cullDisabled = newCullDisabled; }
+            virtual void setCullDisabled(bool newCullDisabled);
 
             virtual bool isHidden() const { return hidden; }
             virtual void setHidden(bool newHidden);
@@ -131,6 +134,7 @@ namespace ouzel
             std::vector<Component*> getComponents(uint32_t cls) const;
 
             Box3 getBoundingBox() const;
+            uint32_t getStateKey() const;
 
         protected:
             void setLayer(Layer* newLayer) override;
@@ -143,6 +147,13 @@ namespace ouzel
 
             virtual void calculateInverseTransform() const;
 
+            void invalidateBoundingBox();
+            void updateSpatialIndex(SpatialIndex& spatialIndex,
+                                    const Matrix4& newParentTransform,
+                                    int32_t parentOrder,
+                                    bool parentHidden);
+            void removeFromSpatialIndex(SpatialIndex& spatialIndex);
+
             Matrix4 parentTransform;
             mutable Matrix4 transform;
             mutable Matrix4 inverseTransform;
@@ -168,6 +179,10 @@ namespace ouzel
             int32_t order = 0;
             int32_t worldOrder = 0;
 
+            int32_t spatialProxy = SpatialIndex::NULL_PROXY;
+            int64_t siblingKey = 0; // increasing in the order of the parent's children, used to sort the index queries
+            bool spatialIndexDirty = false;
+
             ActorContainer* parent = nullptr;
 
             std::vector<Component*> components;
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "ActorContainer.hpp"
 #include "Actor.hpp"
+#include "Layer.hpp"
 
 namespace ouzel
 {
@@ -33,7 +34,12 @@ namespace ouzel
             actor->parent = this;
             actor->setLayer(layer);
             if (entered) actor->enter();
+            // the keys only have to increase, so removing a child doesn't renumber its siblings
+            actor->siblingKey = children.empty() ? 0 : children.back()->siblingKey + 1;
             children.push_back(actor);
+
+            // only the new subtree is added to the spatial index
+            if (layer) layer->invalidateActor(actor);
         }
 
         bool ActorContainer::removeChild(Actor* actor)
@@ -44,6 +50,8 @@ namespace ouzel
 
             if (childIterator != children.end())
             {
+                if (layer) layer->removeFromSpatialIndex(actor);
+
                 if (entered) actor->leave();
                 actor->parent = nullptr;
                 actor->setLayer(nullptr);
@@ -70,6 +78,8 @@ namespace ouzel
             {
                 std::rotate(children.begin(), i, i + 1);
 
+                if (children.size() > 1) actor->siblingKey = children[1]->siblingKey - 1;
+
                 return true;
             }
 
@@ -84,6 +94,8 @@ namespace ouzel
             {
                 std::rotate(i, i + 1, children.end());
 
+                if (children.size() > 1) actor->siblingKey = children[children.size() - 2]->siblingKey + 1;
+
                 return true;
             }
 
@@ -92,10 +104,17 @@ namespace ouzel
 
         void ActorContainer::removeAllChildren()
         {
+            if (layer)
+            {
+                for (Actor* actor : children)
+                    layer->removeFromSpatialIndex(actor);
+            }
+
             for (auto& actor : children)
             {
                 if (entered) actor->leave();
                 actor->parent = nullptr;
+                actor->setLayer(nullptr);
             }
 
             children.clear();
@@ -25,6 +25,20 @@ namespace ouzel
         {
         }
 
+        void Component::setBoundingBox(const Box3& newBoundingBox)
+        {
+            boundingBox = newBoundingBox;
+
+            invalidateBoundingBox();
+        }
+
+        void Component::setHidden(bool newHidden)
+        {
+            hidden = newHidden;
+
+            invalidateBoundingBox();
+        }
+
         bool Component::pointOn(const Vector2& position) const
         {
             return boundingBox.containsPoint(Vector3(position));
@@ -111,5 +125,10 @@ namespace ouzel
         void Component::updateTransform()
         {
         }
+
+        void Component::invalidateBoundingBox()
+        {
+            if (actor) actor->invalidateBoundingBox();
+        }
     } // namespace scene
 } // namespace ouzel
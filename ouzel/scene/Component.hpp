@@ -54,13 +54,15 @@ namespace ouzel
                               bool wireframe);
 
             virtual const Box3& getBoundingBox() const { return boundingBox; }
-            virtual void setBoundingBox(const Box3& newBoundingBox) { boundingBox = newBoundingBox; }
+            virtual void setBoundingBox(const Box3& newBoundingBox);
+
+            virtual uint32_t getStateKey() const { return 0; }
 
             virtual bool pointOn(const Vector2& position) const;
             virtual bool shapeOverlaps(const std::vector<Vector2>& edges) const;
 
             bool isHidden() const { return hidden; }
-            void setHidden(bool newHidden) { hidden = newHidden; }
+            void setHidden(bool newHidden);
 
             inline Actor* getActor() const { return actor; }
             void removeFromActor();
@@ -70,6 +72,8 @@ namespace ouzel
             virtual void setLayer(Layer* newLayer);
             virtual void updateTransform();
 
+            void invalidateBoundingBox();
+
             uint32_t cls;
 
             Box3 boundingBox;
@@ -0,0 +1,42 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include "DrawQueue.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        void DrawQueue::sort()
+        {
+            if (entries.size() < 2) return;
+
+            sortBuffer.resize(entries.size());
+
+            // stable LSD radix sort, one byte of the key per pass
+            for (uint32_t shift = 0; shift < 64; shift += 8)
+            {
+                size_t offsets[256] = {0};
+
+                for (const Entry& entry : entries)
+                    ++offsets[(entry.key >> shift) & 0xFF];
+
+                // skip the pass if all the keys have the same digit
+                if (offsets[(entries.front().key >> shift) & 0xFF] == entries.size())
+                    continue;
+
+                size_t offset = 0;
+                for (size_t& digitOffset : offsets)
+                {
+                    size_t count = digitOffset;
+                    digitOffset = offset;
+                    offset += count;
+                }
+
+                for (const Entry& entry : entries)
+                    sortBuffer[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+
+                entries.swap(sortBuffer);
+            }
+        }
+    } // namespace scene
+} // namespace ouzel
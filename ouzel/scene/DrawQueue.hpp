@@ -0,0 +1,60 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_DRAWQUEUE_HPP
+#define OUZEL_SCENE_DRAWQUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ouzel
+{
+    namespace scene
+    {
+        class Actor;
+
+        class DrawQueue final
+        {
+        public:
+            struct Entry final
+            {
+                Actor* actor;
+                uint64_t key;
+            };
+
+            DrawQueue() {}
+
+            DrawQueue(const DrawQueue&) = delete;
+            DrawQueue& operator=(const DrawQueue&) = delete;
+
+            DrawQueue(DrawQueue&&) = delete;
+            DrawQueue& operator=(DrawQueue&&) = delete;
+
+            inline void clear() { entries.clear(); }
+
+            // actors with a higher world order are drawn first, equal orders are
+            // optionally grouped by state key and otherwise keep the visiting order
+            void add(Actor* actor, int32_t worldOrder, uint32_t stateKey = 0)
+            {
+                Entry entry;
+                entry.actor = actor;
+                entry.key = (static_cast<uint64_t>(~(static_cast<uint32_t>(worldOrder) ^ 0x80000000U)) << 32) | stateKey;
+                entries.push_back(entry);
+            }
+
+            void sort();
+
+            inline bool empty() const { return entries.empty(); }
+            inline size_t size() const { return entries.size(); }
+
+            inline std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+            inline std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+        private:
+            std::vector<Entry> entries;
+            std::vector<Entry> sortBuffer;
+        };
+    } // namespace scene
+} // namespace ouzel
+
+#endif // OUZEL_SCENE_DRAWQUEUE_HPP
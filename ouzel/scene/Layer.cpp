@@ -27,12 +27,53 @@ namespace ouzel
 
         void Layer::draw()
         {
+            spriteBatch.reset();
+            staticMeshBatch.reset();
+
+            if (spatialIndexEnabled) updateSpatialIndex();
+
             for (Camera* camera : cameras)
             {
-                std::vector<Actor*> drawQueue;
+                drawQueue.clear();
 
-                for (Actor* actor : children)
-                    actor->visit(drawQueue, Matrix4::identity(), false, camera, 0, false);
+                // the index is two-dimensional, so only orthographic cameras can use it
+                if (spatialIndexEnabled && camera->getProjectionMode() == Camera::ProjectionMode::ORTHOGRAPHIC)
+                {
+                    Box2 viewBox;
+                    const Matrix4& inverseViewProjection = camera->getInverseViewProjection();
+
+                    for (uint32_t i = 0; i < 8; ++i)
+                    {
+                        Vector3 corner((i & 1) ? 1.0F : -1.0F,
+                                       (i & 2) ? 1.0F : -1.0F,
+                                       (i & 4) ? 1.0F : -1.0F);
+                        inverseViewProjection.transformPoint(corner);
+                        viewBox.insertPoint(Vector2(corner));
+                    }
+
+                    queryResult.clear();
+                    spatialIndex.query(viewBox, queryResult);
+
+                    // keep the scene graph order for the actors with the same world order
+                    std::sort(queryResult.begin(), queryResult.end(), [this](Actor* a, Actor* b) {
+                        return precedes(a, b);
+                    });
+
+                    for (Actor* actor : queryResult)
+                    {
+                        Box3 boundingBox = actor->getBoundingBox();
+
+                        if (actor->cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(actor->getTransform(), boundingBox)))
+                            drawQueue.add(actor, actor->worldOrder, stateSortingEnabled ? actor->getStateKey() : 0);
+                    }
+                }
+                else
+                {
+                    for (Actor* actor : children)
+                        actor->visit(drawQueue, Matrix4::identity(), false, camera, 0, false);
+                }
+
+                drawQueue.sort();
 
                 engine->getRenderer()->setRenderTarget(camera->getRenderTarget() ? camera->getRenderTarget()->getResource() : 0);
                 engine->getRenderer()->setViewport(camera->getRenderViewport());
@@ -42,8 +83,11 @@ namespace ouzel
                                                    graphics::FillMode::WIREFRAME :
                                                    graphics::FillMode::SOLID);
 
-                for (Actor* actor : drawQueue)
-                    actor->draw(camera, false);
+                for (const DrawQueue::Entry& entry : drawQueue)
+                    entry.actor->draw(camera, false);
+
+                spriteBatch.flush();
+                staticMeshBatch.flush();
             }
         }
 
@@ -154,11 +198,188 @@ namespace ouzel
             return result;
         }
 
+        void Layer::findActors(const Vector2& position, std::vector<std::pair<Actor*, Vector3>>& actors) const
+        {
+            if (!spatialIndexEnabled)
+            {
+                ActorContainer::findActors(position, actors);
+                return;
+            }
+
+            updateSpatialIndex();
+
+            queryResult.clear();
+            spatialIndex.query(position, queryResult);
+
+            for (Actor* actor : queryResult)
+            {
+                if (actor->isPickable() && actor->pointOn(position))
+                    actors.push_back(std::make_pair(actor, actor->convertWorldToLocal(Vector3(position))));
+            }
+
+            // same order as the scene graph traversal: by world order, children in front of their parents
+            std::sort(actors.begin(), actors.end(), [this](const std::pair<Actor*, Vector3>& a,
+                                                           const std::pair<Actor*, Vector3>& b) {
+                return (a.first->worldOrder == b.first->worldOrder) ?
+                    precedes(b.first, a.first) :
+                    a.first->worldOrder < b.first->worldOrder;
+            });
+        }
+
+        void Layer::findActors(const std::vector<Vector2>& edges, std::vector<Actor*>& actors) const
+        {
+            if (!spatialIndexEnabled)
+            {
+                ActorContainer::findActors(edges, actors);
+                return;
+            }
+
+            updateSpatialIndex();
+
+            Box2 edgesBox;
+            for (const Vector2& edge : edges)
+                edgesBox.insertPoint(edge);
+
+            queryResult.clear();
+            spatialIndex.query(edgesBox, queryResult);
+
+            for (Actor* actor : queryResult)
+            {
+                if (actor->isPickable() && actor->shapeOverlaps(edges))
+                    actors.push_back(actor);
+            }
+
+            std::sort(actors.begin(), actors.end(), [this](Actor* a, Actor* b) {
+                return (a->worldOrder == b->worldOrder) ?
+                    precedes(b, a) :
+                    a->worldOrder < b->worldOrder;
+            });
+        }
+
         void Layer::setOrder(int32_t newOrder)
         {
             order = newOrder;
         }
 
+        void Layer::setBatchingEnabled(bool newBatchingEnabled)
+        {
+            batchingEnabled = newBatchingEnabled;
+        }
+
+        void Layer::setStateSortingEnabled(bool newStateSortingEnabled)
+        {
+            stateSortingEnabled = newStateSortingEnabled;
+        }
+
+        void Layer::setSpatialIndexEnabled(bool newSpatialIndexEnabled)
+        {
+            if (spatialIndexEnabled && !newSpatialIndexEnabled)
+            {
+                for (Actor* actor : children)
+                    actor->removeFromSpatialIndex(spatialIndex);
+
+                spatialIndex.clear();
+                dirtyActors.clear();
+            }
+
+            spatialIndexEnabled = newSpatialIndexEnabled;
+            rebuildSpatialIndex = true;
+        }
+
+        void Layer::invalidateActor(Actor* actor)
+        {
+            if (spatialIndexEnabled && !rebuildSpatialIndex && !actor->spatialIndexDirty)
+            {
+                actor->spatialIndexDirty = true;
+                dirtyActors.push_back(actor);
+            }
+        }
+
+        void Layer::removeFromSpatialIndex(Actor* actor)
+        {
+            if (spatialIndexEnabled)
+            {
+                actor->removeFromSpatialIndex(spatialIndex);
+
+                // the removed actors can be deleted, so they must not stay in the dirty list
+                dirtyActors.erase(std::remove_if(dirtyActors.begin(), dirtyActors.end(), [](Actor* dirtyActor) {
+                    return !dirtyActor->spatialIndexDirty;
+                }), dirtyActors.end());
+            }
+        }
+
+        void Layer::updateSpatialIndex() const
+        {
+            if (rebuildSpatialIndex)
+            {
+                for (Actor* actor : children)
+                    actor->updateSpatialIndex(spatialIndex, Matrix4::identity(), 0, false);
+
+                dirtyActors.clear();
+                rebuildSpatialIndex = false;
+            }
+            else
+            {
+                for (Actor* actor : dirtyActors)
+                {
+                    // already updated together with one of its ancestors
+                    if (!actor->spatialIndexDirty) continue;
+
+                    // the topmost dirty ancestor updates the whole subtree
+                    ActorContainer* parent = actor->parent;
+                    while (parent && parent != this && !static_cast<Actor*>(parent)->spatialIndexDirty)
+                        parent = static_cast<Actor*>(parent)->parent;
+
+                    if (parent != this) continue;
+
+                    if (actor->parent == this)
+                        actor->updateSpatialIndex(spatialIndex, Matrix4::identity(), 0, false);
+                    else
+                    {
+                        Actor* parentActor = static_cast<Actor*>(actor->parent);
+                        actor->updateSpatialIndex(spatialIndex, parentActor->getTransform(),
+                                                  parentActor->worldOrder, parentActor->worldHidden);
+                    }
+                }
+
+                dirtyActors.clear();
+            }
+        }
+
+        bool Layer::precedes(const Actor* first, const Actor* second) const
+        {
+            if (first == second) return false;
+
+            uint32_t firstDepth = 0;
+            for (const ActorContainer* parent = first->parent; parent != this; parent = static_cast<const Actor*>(parent)->parent)
+                ++firstDepth;
+
+            uint32_t secondDepth = 0;
+            for (const ActorContainer* parent = second->parent; parent != this; parent = static_cast<const Actor*>(parent)->parent)
+                ++secondDepth;
+
+            // an ancestor comes before its descendants
+            for (; firstDepth > secondDepth; --firstDepth)
+            {
+                first = static_cast<const Actor*>(first->parent);
+                if (first == second) return false;
+            }
+
+            for (; secondDepth > firstDepth; --secondDepth)
+            {
+                second = static_cast<const Actor*>(second->parent);
+                if (second == first) return true;
+            }
+
+            while (first->parent != second->parent)
+            {
+                first = static_cast<const Actor*>(first->parent);
+                second = static_cast<const Actor*>(second->parent);
+            }
+
+            return first->siblingKey < second->siblingKey;
+        }
+
         void Layer::recalculateProjection()
         {
             for (Camera* camera : cameras)
@@ -6,6 +6,10 @@
 #include <cstdint>
 #include <vector>
 #include "scene/ActorContainer.hpp"
+#include "scene/DrawQueue.hpp"
+#include "scene/SpatialIndex.hpp"
+#include "scene/SpriteBatch.hpp"
+#include "scene/StaticMeshBatch.hpp"
 #include "math/Vector2.hpp"
 
 namespace ouzel
@@ -18,6 +22,8 @@ namespace ouzel
 
         class Layer: public ActorContainer
         {
+            friend ActorContainer;
+            friend Actor;
             friend Scene;
             friend Camera;
             friend Light;
@@ -35,12 +41,27 @@ namespace ouzel
             std::vector<std::pair<Actor*, Vector3>> pickActors(const Vector2& position, bool renderTargets = false) const;
             std::vector<Actor*> pickActors(const std::vector<Vector2>& edges, bool renderTargets = false) const;
 
+            void findActors(const Vector2& position, std::vector<std::pair<Actor*, Vector3>>& actors) const override;
+            void findActors(const std::vector<Vector2>& edges, std::vector<Actor*>& actors) const override;
+
             inline int32_t getOrder() const { return order; }
             void setOrder(int32_t newOrder);
 
             inline Scene* getScene() const { return scene; }
             void removeFromScene();
 
+            inline bool isBatchingEnabled() const { return batchingEnabled; }
+            void setBatchingEnabled(bool newBatchingEnabled);
+            inline SpriteBatch& getSpriteBatch() { return spriteBatch; }
+            inline StaticMeshBatch& getStaticMeshBatch() { return staticMeshBatch; }
+
+            inline bool isStateSortingEnabled() const { return stateSortingEnabled; }
+            void setStateSortingEnabled(bool newStateSortingEnabled);
+
+            inline bool isSpatialIndexEnabled() const { return spatialIndexEnabled; }
+            void setSpatialIndexEnabled(bool newSpatialIndexEnabled);
+            inline const SpatialIndex& getSpatialIndex() const { return spatialIndex; }
+
         protected:
             void addCamera(Camera* camera);
             void removeCamera(Camera* camera);
@@ -49,6 +70,12 @@ namespace ouzel
             void removeLight(Light* light);
 
             virtual void recalculateProjection();
+
+            void invalidateActor(Actor* actor);
+            void removeFromSpatialIndex(Actor* actor);
+            void updateSpatialIndex() const;
+            // scene graph order of two actors of the layer, parents come before their children
+            bool precedes(const Actor* first, const Actor* second) const;
             void enter() override;
 
             Scene* scene = nullptr;
@@ -57,6 +84,19 @@ namespace ouzel
             std::vector<Light*> lights;
 
             int32_t order = 0;
+
+            bool batchingEnabled = true;
+            SpriteBatch spriteBatch;
+            StaticMeshBatch staticMeshBatch;
+
+            bool stateSortingEnabled = false;
+            DrawQueue drawQueue;
+
+            bool spatialIndexEnabled = false;
+            mutable bool rebuildSpatialIndex = true;
+            mutable SpatialIndex spatialIndex;
+            mutable std::vector<Actor*> dirtyActors;
+            mutable std::vector<Actor*> queryResult;
         };
     } // namespace scene
 } // namespace ouzel
@@ -1,8 +1,14 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cassert>
 #include <cstdlib>
 #include <stdexcept>
 #include "core/Setup.h"
+#if OUZEL_SUPPORTS_NEON
+#include <arm_neon.h>
+#elif OUZEL_SUPPORTS_SSE
+#include <xmmintrin.h>
+#endif
 #include "ParticleSystem.hpp"
 #include "core/Engine.hpp"
 #include "SceneManager.hpp"
@@ -18,10 +24,114 @@ namespace ouzel
 {
     namespace scene
     {
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+#if OUZEL_SUPPORTS_NEON
+        typedef float32x4_t Float4;
+        typedef uint32x4_t Mask4;
+
+        static inline Float4 set4(float value) { return vdupq_n_f32(value); }
+        static inline Float4 load4(const float* source) { return vld1q_f32(source); }
+        static inline void store4(float* destination, Float4 value) { vst1q_f32(destination, value); }
+        static inline Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+        static inline Float4 sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+        static inline Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+        static inline Float4 min4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+        static inline Float4 max4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+        static inline Mask4 equal4(Float4 a, Float4 b) { return vceqq_f32(a, b); }
+        static inline Mask4 greater4(Float4 a, Float4 b) { return vcgtq_f32(a, b); }
+        static inline Mask4 or4(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+        static inline Float4 select4(Mask4 mask, Float4 a, Float4 b) { return vbslq_f32(mask, a, b); }
+
+        static inline Float4 rsqrt4(Float4 value)
+        {
+            // estimate refined with two Newton-Raphson steps
+            Float4 result = vrsqrteq_f32(value);
+            result = vmulq_f32(result, vrsqrtsq_f32(vmulq_f32(value, result), result));
+            return vmulq_f32(result, vrsqrtsq_f32(vmulq_f32(value, result), result));
+        }
+#else
+        typedef __m128 Float4;
+        typedef __m128 Mask4;
+
+        static inline Float4 set4(float value) { return _mm_set1_ps(value); }
+        static inline Float4 load4(const float* source) { return _mm_loadu_ps(source); }
+        static inline void store4(float* destination, Float4 value) { _mm_storeu_ps(destination, value); }
+        static inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+        static inline Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+        static inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+        static inline Float4 min4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+        static inline Float4 max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+        static inline Mask4 equal4(Float4 a, Float4 b) { return _mm_cmpeq_ps(a, b); }
+        static inline Mask4 greater4(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+        static inline Mask4 or4(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+        static inline Float4 select4(Mask4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        static inline Float4 rsqrt4(Float4 value) { return _mm_div_ps(_mm_set1_ps(1.0F), _mm_sqrt_ps(value)); }
+#endif
+
+        static inline bool isSimdAvailable()
+        {
+#if OUZEL_SUPPORTS_NEON_CHECK
+            return anrdoidNEONChecker.isNEONAvailable();
+#else
+            return true;
+#endif
+        }
+
+        // sine of an angle in [-pi, pi]
+        static inline Float4 sinReduced4(Float4 x)
+        {
+            // reflect into [-pi/2, pi/2]
+            x = min4(x, sub4(set4(PI), x));
+            x = max4(x, sub4(set4(-PI), x));
+
+            // Taylor series up to x^9, error is below 4e-6
+            Float4 x2 = mul4(x, x);
+            Float4 result = add4(mul4(set4(1.0F / 362880.0F), x2), set4(-1.0F / 5040.0F));
+            result = add4(mul4(result, x2), set4(1.0F / 120.0F));
+            result = add4(mul4(result, x2), set4(-1.0F / 6.0F));
+            result = add4(mul4(result, x2), set4(1.0F));
+            return mul4(result, x);
+        }
+
+        static inline void sinCos4(Float4 x, Float4& sine, Float4& cosine)
+        {
+            // reduce to [-pi, pi], 2 * pi is split in two parts to keep the precision for larger angles
+            Float4 magic = set4(12582912.0F); // 1.5 * 2^23, rounds to the nearest integer
+            Float4 quotient = sub4(add4(mul4(x, set4(1.0F / TAU)), magic), magic);
+            x = sub4(x, mul4(quotient, set4(6.28125F)));
+            x = sub4(x, mul4(quotient, set4(1.9353071795864769e-3F)));
+
+            sine = sinReduced4(x);
+
+            // cos(x) = sin(x + pi / 2)
+            Float4 shifted = add4(x, set4(PI / 2.0F));
+            shifted = select4(greater4(shifted, set4(PI)), sub4(shifted, set4(TAU)), shifted);
+            cosine = sinReduced4(shifted);
+        }
+#endif
+
+        static void addScaled(float* values, const float* deltas, float scale, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+            if (isSimdAvailable())
+            {
+                Float4 scale4 = set4(scale);
+
+                for (; i + 4 <= count; i += 4)
+                    store4(values + i, add4(load4(values + i), mul4(load4(deltas + i), scale4)));
+            }
+#endif
+
+            for (; i < count; ++i)
+                values[i] += deltas[i] * scale;
+        }
+
         ParticleSystem::ParticleSystem():
             Component(CLASS)
         {
-            shader = engine->getCache().getShader(SHADER_TEXTURE);
+            shader = engine->getCache().getShader(SHADER_PARTICLE);
             blendState = engine->getCache().getBlendState(BLEND_ALPHA);
             whitePixelTexture = engine->getCache().getTexture(TEXTURE_WHITE_PIXEL);
 
@@ -58,6 +168,8 @@ namespace ouzel
                     needsMeshUpdate = false;
                 }
 
+                assert(shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()));
+
                 Matrix4 transform;
 
                 if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE ||
@@ -68,20 +180,14 @@ namespace ouzel
 
                 float colorVector[] = {1.0F, 1.0F, 1.0F, opacity};
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(transform.m), std::end(transform.m)};
-
                 engine->getRenderer()->setCullMode(graphics::CullMode::NONE);
                 engine->getRenderer()->setPipelineState(blendState->getResource(), shader->getResource());
-                engine->getRenderer()->setShaderConstants(pixelShaderConstants,
-                                                          vertexShaderConstants);
+                engine->getRenderer()->setShaderConstants(colorVector, sizeof(colorVector),
+                                                          transform.m, sizeof(transform.m));
                 engine->getRenderer()->setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
                 engine->getRenderer()->draw(indexBuffer->getResource(),
                                             particleCount * 6,
-                                            sizeof(uint16_t),
+                                            indexSize,
                                             vertexBuffer->getResource(),
                                             graphics::DrawMode::TRIANGLE_LIST,
                                             0);
@@ -138,106 +244,276 @@ namespace ouzel
 
                 if (active)
                 {
-                    for (uint32_t counter = particleCount; counter > 0; --counter)
+                    updateParticles(UPDATE_STEP);
+                    removeDeadParticles();
+
+                    needsMeshUpdate = true;
+                    needsBoundingBoxUpdate = true;
+                }
+            }
+
+            if (needsBoundingBoxUpdate)
+                updateBoundingBox();
+        }
+
+        void ParticleSystem::updateParticles(float step)
+        {
+            uint32_t i = 0;
+
+            float* life = particles.life.data();
+            float* positionX = particles.positionX.data();
+            float* positionY = particles.positionY.data();
+
+            // y coordinate flip is applied as a multiplier
+            float flip = particleSystemData.yCoordFlipped ? 1.0F : 0.0F;
+
+            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
+            {
+                float* directionX = particles.directionX.data();
+                float* directionY = particles.directionY.data();
+                const float* radialAcceleration = particles.radialAcceleration.data();
+                const float* tangentialAcceleration = particles.tangentialAcceleration.data();
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+                if (isSimdAvailable())
+                {
+                    Float4 zero = set4(0.0F);
+                    Float4 step4 = set4(step);
+                    Float4 positionStep4 = set4(step * flip);
+                    Float4 gravityX = set4(particleSystemData.gravity.x);
+                    Float4 gravityY = set4(particleSystemData.gravity.y);
+
+                    for (; i + 4 <= particleCount; i += 4)
                     {
-                        size_t i = counter - 1;
+                        store4(life + i, sub4(load4(life + i), step4));
 
-                        particles[i].life -= UPDATE_STEP;
+                        Float4 x = load4(positionX + i);
+                        Float4 y = load4(positionY + i);
 
-                        if (particles[i].life >= 0.0F)
-                        {
-                            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
-                            {
-                                Vector2 tmp;
-                                Vector2 radial;
-                                Vector2 tangential;
-
-                                // radial acceleration
-                                if (particles[i].position.x == 0.0F || particles[i].position.y == 0.0F)
-                                {
-                                    radial = particles[i].position;
-                                    radial.normalize();
-                                }
-                                tangential = radial;
-                                radial *= particles[i].radialAcceleration;
-
-                                // tangential acceleration
-                                std::swap(tangential.x, tangential.y);
-                                tangential.x *= - particles[i].tangentialAcceleration;
-                                tangential.y *= particles[i].tangentialAcceleration;
-
-                                // (gravity + radial + tangential) * UPDATE_STEP
-                                tmp.x = radial.x + tangential.x + particleSystemData.gravity.x;
-                                tmp.y = radial.y + tangential.y + particleSystemData.gravity.y;
-                                tmp.x *= UPDATE_STEP;
-                                tmp.y *= UPDATE_STEP;
-
-                                particles[i].direction.x += tmp.x;
-                                particles[i].direction.y += tmp.y;
-                                tmp.x = particles[i].direction.x * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                tmp.y = particles[i].direction.y * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                particles[i].position.x += tmp.x;
-                                particles[i].position.y += tmp.y;
-                            }
-                            else
-                            {
-                                particles[i].angle += particles[i].degreesPerSecond * UPDATE_STEP;
-                                particles[i].radius += particles[i].deltaRadius * UPDATE_STEP;
-                                particles[i].position.x = -cosf(particles[i].angle) * particles[i].radius;
-                                particles[i].position.y = -sinf(particles[i].angle) * particles[i].radius * particleSystemData.yCoordFlipped;
-                            }
-
-                            // color r,g,b,a
-                            particles[i].colorRed += particles[i].deltaColorRed * UPDATE_STEP;
-                            particles[i].colorGreen += particles[i].deltaColorGreen * UPDATE_STEP;
-                            particles[i].colorBlue += particles[i].deltaColorBlue * UPDATE_STEP;
-                            particles[i].colorAlpha += particles[i].deltaColorAlpha * UPDATE_STEP;
-
-                            // size
-                            particles[i].size += (particles[i].deltaSize * UPDATE_STEP);
-                            particles[i].size = std::max(0.0F, particles[i].size);
-
-                            // angle
-                            particles[i].rotation += particles[i].deltaRotation * UPDATE_STEP;
-                        }
-                        else
+                        // radial direction is used only for the particles on the axes
+                        Float4 lengthSquared = add4(mul4(x, x), mul4(y, y));
+                        Float4 inverseLength = select4(greater4(lengthSquared, zero), rsqrt4(lengthSquared), zero);
+                        Mask4 onAxis = or4(equal4(x, zero), equal4(y, zero));
+                        Float4 radialX = select4(onAxis, mul4(x, inverseLength), zero);
+                        Float4 radialY = select4(onAxis, mul4(y, inverseLength), zero);
+
+                        Float4 radial = load4(radialAcceleration + i);
+                        Float4 tangential = load4(tangentialAcceleration + i);
+
+                        Float4 accelerationX = add4(sub4(mul4(radialX, radial), mul4(radialY, tangential)), gravityX);
+                        Float4 accelerationY = add4(add4(mul4(radialY, radial), mul4(radialX, tangential)), gravityY);
+
+                        Float4 dx = add4(load4(directionX + i), mul4(accelerationX, step4));
+                        Float4 dy = add4(load4(directionY + i), mul4(accelerationY, step4));
+                        store4(directionX + i, dx);
+                        store4(directionY + i, dy);
+
+                        store4(positionX + i, add4(x, mul4(dx, positionStep4)));
+                        store4(positionY + i, add4(y, mul4(dy, positionStep4)));
+                    }
+                }
+#endif
+
+                for (; i < particleCount; ++i)
+                {
+                    life[i] -= step;
+
+                    float radialX = 0.0F;
+                    float radialY = 0.0F;
+
+                    if (positionX[i] == 0.0F || positionY[i] == 0.0F)
+                    {
+                        float lengthSquared = positionX[i] * positionX[i] + positionY[i] * positionY[i];
+
+                        if (lengthSquared > 0.0F)
                         {
-                            particles[i] = particles[particleCount - 1];
-                            --particleCount;
+                            float inverseLength = 1.0F / sqrtf(lengthSquared);
+                            radialX = positionX[i] * inverseLength;
+                            radialY = positionY[i] * inverseLength;
                         }
                     }
 
-                    needsMeshUpdate = true;
-                    needsBoundingBoxUpdate = true;
+                    float accelerationX = radialX * radialAcceleration[i] - radialY * tangentialAcceleration[i] + particleSystemData.gravity.x;
+                    float accelerationY = radialY * radialAcceleration[i] + radialX * tangentialAcceleration[i] + particleSystemData.gravity.y;
+
+                    directionX[i] += accelerationX * step;
+                    directionY[i] += accelerationY * step;
+
+                    positionX[i] += directionX[i] * (step * flip);
+                    positionY[i] += directionY[i] * (step * flip);
                 }
             }
+            else
+            {
+                float* angle = particles.angle.data();
+                float* radius = particles.radius.data();
+                const float* degreesPerSecond = particles.degreesPerSecond.data();
+                const float* deltaRadius = particles.deltaRadius.data();
 
-            if (needsBoundingBoxUpdate)
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+                if (isSimdAvailable())
+                {
+                    Float4 step4 = set4(step);
+                    Float4 minusOne = set4(-1.0F);
+                    Float4 minusFlip = set4(-flip);
+
+                    for (; i + 4 <= particleCount; i += 4)
+                    {
+                        store4(life + i, sub4(load4(life + i), step4));
+
+                        Float4 a = add4(load4(angle + i), mul4(load4(degreesPerSecond + i), step4));
+                        Float4 r = add4(load4(radius + i), mul4(load4(deltaRadius + i), step4));
+                        store4(angle + i, a);
+                        store4(radius + i, r);
+
+                        Float4 sine;
+                        Float4 cosine;
+                        sinCos4(a, sine, cosine);
+
+                        store4(positionX + i, mul4(mul4(cosine, r), minusOne));
+                        store4(positionY + i, mul4(mul4(sine, r), minusFlip));
+                    }
+                }
+#endif
+
+                for (; i < particleCount; ++i)
+                {
+                    life[i] -= step;
+
+                    angle[i] += degreesPerSecond[i] * step;
+                    radius[i] += deltaRadius[i] * step;
+                    positionX[i] = -cosf(angle[i]) * radius[i];
+                    positionY[i] = -sinf(angle[i]) * radius[i] * flip;
+                }
+            }
+
+            addScaled(particles.colorRed.data(), particles.deltaColorRed.data(), step, particleCount);
+            addScaled(particles.colorGreen.data(), particles.deltaColorGreen.data(), step, particleCount);
+            addScaled(particles.colorBlue.data(), particles.deltaColorBlue.data(), step, particleCount);
+            addScaled(particles.colorAlpha.data(), particles.deltaColorAlpha.data(), step, particleCount);
+            addScaled(particles.rotation.data(), particles.deltaRotation.data(), step, particleCount);
+
+            float* size = particles.size.data();
+            const float* deltaSize = particles.deltaSize.data();
+            i = 0;
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+            if (isSimdAvailable())
+            {
+                Float4 zero = set4(0.0F);
+                Float4 step4 = set4(step);
+
+                for (; i + 4 <= particleCount; i += 4)
+                    store4(size + i, max4(zero, add4(load4(size + i), mul4(load4(deltaSize + i), step4))));
+            }
+#endif
+
+            for (; i < particleCount; ++i)
+                size[i] = std::max(0.0F, size[i] + deltaSize[i] * step);
+        }
+
+        void ParticleSystem::removeDeadParticles()
+        {
+            // replace each dead particle with the last one, going backwards so that the moved particle is already checked
+            const float* life = particles.life.data();
+
+            for (uint32_t counter = particleCount; counter > 0; --counter)
             {
-                // Update bounding box
-                boundingBox.reset();
+                uint32_t i = counter - 1;
+
+                if (life[i] < 0.0F)
+                {
+                    if (i != particleCount - 1)
+                        particles.move(particleCount - 1, i);
+                    --particleCount;
+                }
+            }
+        }
+
+        void ParticleSystem::updateBoundingBox()
+        {
+            boundingBox.reset();
+
+            if (particleCount)
+            {
+                const float* positionX = particles.positionX.data();
+                const float* positionY = particles.positionY.data();
+                Vector2 min(positionX[0], positionY[0]);
+                Vector2 max = min;
+                uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+                if (isSimdAvailable() && particleCount >= 4)
+                {
+                    Float4 minX = load4(positionX);
+                    Float4 minY = load4(positionY);
+                    Float4 maxX = minX;
+                    Float4 maxY = minY;
+
+                    for (i = 4; i + 4 <= particleCount; i += 4)
+                    {
+                        Float4 x = load4(positionX + i);
+                        Float4 y = load4(positionY + i);
+                        minX = min4(minX, x);
+                        minY = min4(minY, y);
+                        maxX = max4(maxX, x);
+                        maxY = max4(maxY, y);
+                    }
+
+                    float lanes[4][4];
+                    store4(lanes[0], minX);
+                    store4(lanes[1], minY);
+                    store4(lanes[2], maxX);
+                    store4(lanes[3], maxY);
+
+                    for (uint32_t lane = 0; lane < 4; ++lane)
+                    {
+                        min.x = std::min(min.x, lanes[0][lane]);
+                        min.y = std::min(min.y, lanes[1][lane]);
+                        max.x = std::max(max.x, lanes[2][lane]);
+                        max.y = std::max(max.y, lanes[3][lane]);
+                    }
+                }
+#endif
+
+                for (; i < particleCount; ++i)
+                {
+                    min.x = std::min(min.x, positionX[i]);
+                    min.y = std::min(min.y, positionY[i]);
+                    max.x = std::max(max.x, positionX[i]);
+                    max.y = std::max(max.y, positionY[i]);
+                }
 
                 if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE ||
                     particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
                 {
                     if (actor)
                     {
+                        // transform the corners instead of every particle
                         const Matrix4& inverseTransform = actor->getInverseTransform();
 
-                        for (uint32_t i = 0; i < particleCount; ++i)
+                        Vector3 corners[4] = {
+                            Vector3(min.x, min.y, 0.0F),
+                            Vector3(max.x, min.y, 0.0F),
+                            Vector3(min.x, max.y, 0.0F),
+                            Vector3(max.x, max.y, 0.0F)
+                        };
+
+                        for (Vector3& corner : corners)
                         {
-                            Vector3 position = Vector3(particles[i].position);
-                            inverseTransform.transformPoint(position);
-                            boundingBox.insertPoint(position);
+                            inverseTransform.transformPoint(corner);
+                            boundingBox.insertPoint(corner);
                         }
                     }
                 }
                 else if (particleSystemData.positionType == ParticleSystemData::PositionType::GROUPED)
                 {
-                    for (uint32_t i = 0; i < particleCount; ++i)
-                        boundingBox.insertPoint(particles[i].position);
+                    boundingBox.insertPoint(Vector3(min.x, min.y, 0.0F));
+                    boundingBox.insertPoint(Vector3(max.x, max.y, 0.0F));
                 }
             }
+
+            invalidateBoundingBox();
         }
 
         bool ParticleSystem::handleUpdate(const UpdateEvent& event)
@@ -311,33 +587,63 @@ namespace ouzel
 
         void ParticleSystem::createParticleMesh()
         {
-            indices.reserve(particleSystemData.maxParticles * 6);
+            vertices.clear();
             vertices.reserve(particleSystemData.maxParticles * 4);
 
-            for (uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+            for (uint32_t i = 0; i < particleSystemData.maxParticles; ++i)
             {
-                indices.push_back(i * 4 + 0);
-                indices.push_back(i * 4 + 1);
-                indices.push_back(i * 4 + 2);
-                indices.push_back(i * 4 + 1);
-                indices.push_back(i * 4 + 3);
-                indices.push_back(i * 4 + 2);
-
-                vertices.push_back(graphics::Vertex(Vector3(-1.0F, -1.0F, 0.0F), Color::WHITE,
-                                                    Vector2(0.0F, 1.0F), Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(1.0F, -1.0F, 0.0F), Color::WHITE,
-                                                    Vector2(1.0F, 1.0F), Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(-1.0F, 1.0F, 0.0F), Color::WHITE,
-                                                    Vector2(0.0F, 0.0F), Vector3(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3(1.0F, 1.0F, 0.0F), Color::WHITE,
-                                                    Vector2(1.0F, 0.0F), Vector3(0.0F, 0.0F, -1.0F)));
+                vertices.push_back(graphics::ParticleVertex(Vector2(-1.0F, -1.0F), Color::WHITE, Vector2(0.0F, 1.0F)));
+                vertices.push_back(graphics::ParticleVertex(Vector2(1.0F, -1.0F), Color::WHITE, Vector2(1.0F, 1.0F)));
+                vertices.push_back(graphics::ParticleVertex(Vector2(-1.0F, 1.0F), Color::WHITE, Vector2(0.0F, 0.0F)));
+                vertices.push_back(graphics::ParticleVertex(Vector2(1.0F, 1.0F), Color::WHITE, Vector2(1.0F, 0.0F)));
             }
 
             indexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
-            indexBuffer->init(graphics::Buffer::Usage::INDEX, 0, indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
+
+            // 16-bit indices can address up to 16384 quads
+            if (vertices.size() <= 65536)
+            {
+                std::vector<uint16_t> indices;
+                indices.reserve(particleSystemData.maxParticles * 6);
+
+                for (uint32_t i = 0; i < particleSystemData.maxParticles; ++i)
+                {
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 0));
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 1));
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 2));
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 1));
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 3));
+                    indices.push_back(static_cast<uint16_t>(i * 4 + 2));
+                }
+
+                indexSize = sizeof(uint16_t);
+                indexBuffer->init(graphics::Buffer::Usage::INDEX, 0, indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
+            }
+            else
+            {
+                std::vector<uint32_t> indices;
+                indices.reserve(particleSystemData.maxParticles * 6);
+
+                for (uint32_t i = 0; i < particleSystemData.maxParticles; ++i)
+                {
+                    indices.push_back(i * 4 + 0);
+                    indices.push_back(i * 4 + 1);
+                    indices.push_back(i * 4 + 2);
+                    indices.push_back(i * 4 + 1);
+                    indices.push_back(i * 4 + 3);
+                    indices.push_back(i * 4 + 2);
+                }
+
+                indexSize = sizeof(uint32_t);
+                indexBuffer->init(graphics::Buffer::Usage::INDEX, 0, indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
+            }
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::PARTICLE);
+
+            if (!shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
 
             particles.resize(particleSystemData.maxParticles);
         }
@@ -346,49 +652,124 @@ namespace ouzel
         {
             if (actor)
             {
-                for (uint32_t counter = particleCount; counter > 0; --counter)
+                Vector2 offset;
+
+                if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+                    offset = Vector2(actor->getPosition());
+
+                const float* positionX = particles.positionX.data();
+                const float* positionY = particles.positionY.data();
+                const float* size = particles.size.data();
+                const float* rotation = particles.rotation.data();
+                const float* colorRed = particles.colorRed.data();
+                const float* colorGreen = particles.colorGreen.data();
+                const float* colorBlue = particles.colorBlue.data();
+                const float* colorAlpha = particles.colorAlpha.data();
+
+                uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_SSE
+                if (isSimdAvailable())
                 {
-                    size_t i = counter - 1;
+                    Float4 half = set4(0.5F);
+                    Float4 toRadians = set4(-PI / 180.0F);
+                    Float4 colorScale = set4(255.0F);
+                    Float4 offsetX = set4(offset.x);
+                    Float4 offsetY = set4(offset.y);
+
+                    // corner offsets of the rotated quads, the opposite corners are mirrored
+                    float cornerAX[4];
+                    float cornerAY[4];
+                    float cornerBX[4];
+                    float cornerBY[4];
+                    float centerX[4];
+                    float centerY[4];
+                    float color[4][4];
+
+                    for (; i + 4 <= particleCount; i += 4)
+                    {
+                        Float4 sine;
+                        Float4 cosine;
+                        sinCos4(mul4(load4(rotation + i), toRadians), sine, cosine);
+
+                        Float4 halfSize = mul4(load4(size + i), half);
+                        Float4 hc = mul4(halfSize, cosine);
+                        Float4 hs = mul4(halfSize, sine);
+
+                        store4(cornerAX, sub4(hs, hc));
+                        store4(cornerAY, sub4(sub4(set4(0.0F), hs), hc));
+                        store4(cornerBX, add4(hc, hs));
+                        store4(cornerBY, sub4(hs, hc));
+                        store4(centerX, add4(load4(positionX + i), offsetX));
+                        store4(centerY, add4(load4(positionY + i), offsetY));
+
+                        store4(color[0], mul4(load4(colorRed + i), colorScale));
+                        store4(color[1], mul4(load4(colorGreen + i), colorScale));
+                        store4(color[2], mul4(load4(colorBlue + i), colorScale));
+                        store4(color[3], mul4(load4(colorAlpha + i), colorScale));
+
+                        for (uint32_t lane = 0; lane < 4; ++lane)
+                        {
+                            graphics::ParticleVertex* quad = &vertices[(i + lane) * 4];
 
-                    Vector2 position;
+                            Color quadColor(static_cast<uint8_t>(color[0][lane]),
+                                            static_cast<uint8_t>(color[1][lane]),
+                                            static_cast<uint8_t>(color[2][lane]),
+                                            static_cast<uint8_t>(color[3][lane]));
 
-                    if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE)
-                        position = particles[i].position;
-                    else if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
-                        position = Vector2(actor->getPosition()) + particles[i].position;
+                            quad[0].position.x = centerX[lane] + cornerAX[lane];
+                            quad[0].position.y = centerY[lane] + cornerAY[lane];
+                            quad[0].color = quadColor;
 
-                    float size_2 = particles[i].size / 2.0F;
-                    Vector2 v1(-size_2, -size_2);
-                    Vector2 v2(size_2, size_2);
+                            quad[1].position.x = centerX[lane] + cornerBX[lane];
+                            quad[1].position.y = centerY[lane] + cornerBY[lane];
+                            quad[1].color = quadColor;
 
-                    float r = -degToRad(particles[i].rotation);
-                    float cr = cosf(r);
-                    float sr = sinf(r);
+                            quad[2].position.x = centerX[lane] - cornerBX[lane];
+                            quad[2].position.y = centerY[lane] - cornerBY[lane];
+                            quad[2].color = quadColor;
 
-                    Vector2 a(v1.x * cr - v1.y * sr, v1.x * sr + v1.y * cr);
-                    Vector2 b(v2.x * cr - v1.y * sr, v2.x * sr + v1.y * cr);
-                    Vector2 c(v2.x * cr - v2.y * sr, v2.x * sr + v2.y * cr);
-                    Vector2 d(v1.x * cr - v2.y * sr, v1.x * sr + v2.y * cr);
+                            quad[3].position.x = centerX[lane] - cornerAX[lane];
+                            quad[3].position.y = centerY[lane] - cornerAY[lane];
+                            quad[3].color = quadColor;
+                        }
+                    }
+                }
+#endif
+
+                for (; i < particleCount; ++i)
+                {
+                    float r = -degToRad(rotation[i]);
+                    float halfSize = size[i] / 2.0F;
+                    float hc = halfSize * cosf(r);
+                    float hs = halfSize * sinf(r);
 
-                    Color color(static_cast<uint8_t>(particles[i].colorRed * 255),
-                                static_cast<uint8_t>(particles[i].colorGreen * 255),
-                                static_cast<uint8_t>(particles[i].colorBlue * 255),
-                                static_cast<uint8_t>(particles[i].colorAlpha * 255));
+                    Vector2 position(positionX[i] + offset.x, positionY[i] + offset.y);
+                    Vector2 a(hs - hc, -hs - hc);
+                    Vector2 b(hc + hs, hs - hc);
 
-                    vertices[i * 4 + 0].position = a + position;
-                    vertices[i * 4 + 0].color = color;
+                    Color quadColor(static_cast<uint8_t>(colorRed[i] * 255),
+                                    static_cast<uint8_t>(colorGreen[i] * 255),
+                                    static_cast<uint8_t>(colorBlue[i] * 255),
+                                    static_cast<uint8_t>(colorAlpha[i] * 255));
 
-                    vertices[i * 4 + 1].position = b + position;
-                    vertices[i * 4 + 1].color = color;
+                    graphics::ParticleVertex* quad = &vertices[i * 4];
 
-                    vertices[i * 4 + 2].position = d + position;
-                    vertices[i * 4 + 2].color = color;
+                    quad[0].position = position + a;
+                    quad[0].color = quadColor;
 
-                    vertices[i * 4 + 3].position = c + position;
-                    vertices[i * 4 + 3].color = color;
+                    quad[1].position = position + b;
+                    quad[1].color = quadColor;
+
+                    quad[2].position = position - b;
+                    quad[2].color = quadColor;
+
+                    quad[3].position = position - a;
+                    quad[3].color = quadColor;
                 }
 
-                vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+                // only the quads of the live particles are uploaded
+                vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(particleCount * 4 * sizeof(graphics::ParticleVertex)));
             }
         }
 
@@ -410,38 +791,40 @@ namespace ouzel
                 {
                     if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
                     {
-                        particles[i].life = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                        particles.life[i] = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
 
-                        particles[i].position = particleSystemData.sourcePosition + position + Vector2(particleSystemData.sourcePositionVariance.x * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine),
-                                                                                                       particleSystemData.sourcePositionVariance.y * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                        Vector2 particlePosition = particleSystemData.sourcePosition + position + Vector2(particleSystemData.sourcePositionVariance.x * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine),
+                                                                                                          particleSystemData.sourcePositionVariance.y * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                        particles.positionX[i] = particlePosition.x;
+                        particles.positionY[i] = particlePosition.y;
 
-                        particles[i].size = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                        particles.size[i] = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
 
                         float finishSize = fmaxf(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
-                        particles[i].deltaSize = (finishSize - particles[i].size) / particles[i].life;
+                        particles.deltaSize[i] = (finishSize - particles.size[i]) / particles.life[i];
 
-                        particles[i].colorRed = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorGreen = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorBlue = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorAlpha = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                        particles.colorRed[i] = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                        particles.colorGreen[i] = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                        particles.colorBlue[i] = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                        particles.colorAlpha[i] = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
 
                         float finishColorRed = clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                         float finishColorGreen = clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                         float finishColorBlue = clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                         float finishColorAlpha = clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
 
-                        particles[i].deltaColorRed = (finishColorRed - particles[i].colorRed) / particles[i].life;
-                        particles[i].deltaColorGreen = (finishColorGreen - particles[i].colorGreen) / particles[i].life;
-                        particles[i].deltaColorBlue = (finishColorBlue - particles[i].colorBlue) / particles[i].life;
-                        particles[i].deltaColorAlpha = (finishColorAlpha - particles[i].colorAlpha) / particles[i].life;
+                        particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / particles.life[i];
+                        particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / particles.life[i];
+                        particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / particles.life[i];
+                        particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / particles.life[i];
 
-                        particles[i].rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                        particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
 
                         float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].deltaRotation = (finishRotation - particles[i].rotation) / particles[i].life;
+                        particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / particles.life[i];
 
-                        particles[i].radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                        particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                        particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
 
                         if (particleSystemData.rotationIsDir)
                         {
@@ -449,8 +832,9 @@ namespace ouzel
                             Vector2 v(cosf(a), sinf(a));
                             float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
                             Vector2 dir = v * s;
-                            particles[i].direction = dir;
-                            particles[i].rotation = -radToDeg(dir.getAngle());
+                            particles.directionX[i] = dir.x;
+                            particles.directionY[i] = dir.y;
+                            particles.rotation[i] = -radToDeg(dir.getAngle());
                         }
                         else
                         {
@@ -458,22 +842,77 @@ namespace ouzel
                             Vector2 v(cosf(a), sinf(a));
                             float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
                             Vector2 dir = v * s;
-                            particles[i].direction = dir;
+                            particles.directionX[i] = dir.x;
+                            particles.directionY[i] = dir.y;
                         }
                     }
                     else
                     {
-                        particles[i].radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].angle = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
-                        particles[i].degreesPerSecond = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                        particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                        particles.angle[i] = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                        particles.degreesPerSecond[i] = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
 
                         float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].deltaRadius = (endRadius - particles[i].radius) / particles[i].life;
+                        particles.deltaRadius[i] = (endRadius - particles.radius[i]) / particles.life[i];
                     }
                 }
 
                 particleCount += count;
             }
         }
+
+        void ParticleSystem::Particles::resize(size_t newSize)
+        {
+            life.resize(newSize);
+            positionX.resize(newSize);
+            positionY.resize(newSize);
+            colorRed.resize(newSize);
+            colorGreen.resize(newSize);
+            colorBlue.resize(newSize);
+            colorAlpha.resize(newSize);
+            deltaColorRed.resize(newSize);
+            deltaColorGreen.resize(newSize);
+            deltaColorBlue.resize(newSize);
+            deltaColorAlpha.resize(newSize);
+            angle.resize(newSize);
+            size.resize(newSize);
+            deltaSize.resize(newSize);
+            rotation.resize(newSize);
+            deltaRotation.resize(newSize);
+            radialAcceleration.resize(newSize);
+            tangentialAcceleration.resize(newSize);
+            directionX.resize(newSize);
+            directionY.resize(newSize);
+            radius.resize(newSize);
+            degreesPerSecond.resize(newSize);
+            deltaRadius.resize(newSize);
+        }
+
+        void ParticleSystem::Particles::move(uint32_t from, uint32_t to)
+        {
+            life[to] = life[from];
+            positionX[to] = positionX[from];
+            positionY[to] = positionY[from];
+            colorRed[to] = colorRed[from];
+            colorGreen[to] = colorGreen[from];
+            colorBlue[to] = colorBlue[from];
+            colorAlpha[to] = colorAlpha[from];
+            deltaColorRed[to] = deltaColorRed[from];
+            deltaColorGreen[to] = deltaColorGreen[from];
+            deltaColorBlue[to] = deltaColorBlue[from];
+            deltaColorAlpha[to] = deltaColorAlpha[from];
+            angle[to] = angle[from];
+            size[to] = size[from];
+            deltaSize[to] = deltaSize[from];
+            rotation[to] = rotation[from];
+            deltaRotation[to] = deltaRotation[from];
+            radialAcceleration[to] = radialAcceleration[from];
+            tangentialAcceleration[to] = tangentialAcceleration[from];
+            directionX[to] = directionX[from];
+            directionY[to] = directionY[from];
+            radius[to] = radius[from];
+            degreesPerSecond[to] = degreesPerSecond[from];
+            deltaRadius[to] = deltaRadius[from];
+        }
     } // namespace scene
 } // namespace ouzel
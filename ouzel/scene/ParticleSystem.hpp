@@ -56,55 +56,63 @@ namespace ouzel
             void updateParticleMesh();
 
             void emitParticles(uint32_t count);
+            void updateParticles(float step);
+            void removeDeadParticles();
+            void updateBoundingBox();
 
             ParticleSystemData particleSystemData;
 
-            std::shared_ptr<graphics::Shader> shader;
+            std::shared_ptr<graphics::Shader> shader; // must use graphics::VertexLayout::PARTICLE
             std::shared_ptr<graphics::BlendState> blendState;
             std::shared_ptr<graphics::Texture> texture;
             std::shared_ptr<graphics::Texture> whitePixelTexture;
 
-            struct Particle final
+            // particle attributes are stored in separate arrays, so that the update can process several particles at once
+            struct Particles final
             {
-                float life = 0.0F;
+                void resize(size_t newSize);
+                void move(uint32_t from, uint32_t to);
 
-                Vector2 position;
+                std::vector<float> life;
 
-                float colorRed = 0.0F;
-                float colorGreen = 0.0F;
-                float colorBlue = 0.0F;
-                float colorAlpha = 0.0F;
+                std::vector<float> positionX;
+                std::vector<float> positionY;
 
-                float deltaColorRed = 0.0F;
-                float deltaColorGreen = 0.0F;
-                float deltaColorBlue = 0.0F;
-                float deltaColorAlpha = 0.0F;
+                std::vector<float> colorRed;
+                std::vector<float> colorGreen;
+                std::vector<float> colorBlue;
+                std::vector<float> colorAlpha;
 
-                float angle = 0.0F;
-                float speed = 0.0F;
+                std::vector<float> deltaColorRed;
+                std::vector<float> deltaColorGreen;
+                std::vector<float> deltaColorBlue;
+                std::vector<float> deltaColorAlpha;
 
-                float size = 0.0F;
-                float deltaSize = 0.0F;
+                std::vector<float> angle;
 
-                float rotation = 0.0F;
-                float deltaRotation = 0.0F;
+                std::vector<float> size;
+                std::vector<float> deltaSize;
 
-                float radialAcceleration = 0.0F;
-                float tangentialAcceleration = 0.0F;
+                std::vector<float> rotation;
+                std::vector<float> deltaRotation;
 
-                Vector2 direction;
-                float radius = 0.0F;
-                float degreesPerSecond = 0.0F;
-                float deltaRadius = 0.0F;
+                std::vector<float> radialAcceleration;
+                std::vector<float> tangentialAcceleration;
+
+                std::vector<float> directionX;
+                std::vector<float> directionY;
+                std::vector<float> radius;
+                std::vector<float> degreesPerSecond;
+                std::vector<float> deltaRadius;
             };
 
-            std::vector<Particle> particles;
+            Particles particles;
 
             std::shared_ptr<graphics::Buffer> indexBuffer;
             std::shared_ptr<graphics::Buffer> vertexBuffer;
 
-            std::vector<uint16_t> indices;
-            std::vector<graphics::Vertex> vertices;
+            uint32_t indexSize = sizeof(uint16_t);
+            std::vector<graphics::ParticleVertex> vertices;
 
             uint32_t particleCount = 0;
 
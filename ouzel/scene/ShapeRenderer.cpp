@@ -1,6 +1,7 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <cassert>
+#include <stdexcept>
 #include "ShapeRenderer.hpp"
 #include "core/Engine.hpp"
 #include "graphics/Renderer.hpp"
@@ -22,6 +23,15 @@ namespace ouzel
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC);
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::DEFAULT);
+        }
+
+        void ShapeRenderer::setShader(const std::shared_ptr<graphics::Shader>& newShader)
+        {
+            if (!newShader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
+
+            shader = newShader;
         }
 
         void ShapeRenderer::draw(const Matrix4& transformMatrix,
@@ -41,17 +51,17 @@ namespace ouzel
                 dirty = false;
             }
 
+            assert(shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()));
+
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
             float colorVector[] = {1.0F, 1.0F, 1.0F, opacity};
 
+            // all draw commands share the same constants
+            graphics::ConstantBlock fragmentShaderConstants = engine->getRenderer()->addShaderConstants(colorVector, sizeof(colorVector));
+            graphics::ConstantBlock vertexShaderConstants = engine->getRenderer()->addShaderConstants(modelViewProj.m, sizeof(modelViewProj.m));
+
             for (const DrawCommand& drawCommand : drawCommands)
             {
-                std::vector<std::vector<float>> fragmentShaderConstants(1);
-                fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
                 engine->getRenderer()->setCullMode(graphics::CullMode::NONE);
                 engine->getRenderer()->setPipelineState(blendState->getResource(), shader->getResource());
                 engine->getRenderer()->setShaderConstants(fragmentShaderConstants,
@@ -74,6 +84,8 @@ namespace ouzel
             vertices.clear();
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
 
         void ShapeRenderer::line(const Vector2& start, const Vector2& finish, Color color, float thickness)
@@ -137,6 +149,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
 
         void ShapeRenderer::circle(const Vector2& position,
@@ -255,6 +269,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
 
         void ShapeRenderer::rectangle(const Rect& rectangle,
@@ -402,6 +418,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
 
         void ShapeRenderer::polygon(const std::vector<Vector2>& edges,
@@ -464,6 +482,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
 
         static std::vector<uint32_t> pascalsTriangleRow(uint32_t row)
@@ -532,6 +552,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+
+            invalidateBoundingBox();
         }
     } // namespace scene
 } // namespace ouzel
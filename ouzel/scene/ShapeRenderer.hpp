@@ -57,7 +57,8 @@ namespace ouzel
                        float thickness = 0.0F);
 
             inline const std::shared_ptr<graphics::Shader>& getShader() const { return shader; }
-            inline void setShader(const std::shared_ptr<graphics::Shader>& newShader) { shader = newShader; }
+            // the shader must read graphics::Vertex, e.g. use graphics::VertexLayout::DEFAULT
+            void setShader(const std::shared_ptr<graphics::Shader>& newShader);
 
             inline const std::shared_ptr<graphics::BlendState>& getBlendState() const { return blendState; }
             inline void setBlendState(const std::shared_ptr<graphics::BlendState>& newBlendState)  { blendState = newBlendState; }
@@ -27,7 +27,7 @@ namespace ouzel
 
         void SkinnedMeshRenderer::init(const SkinnedMeshData& meshData)
         {
-            boundingBox = meshData.boundingBox;
+            setBoundingBox(meshData.boundingBox);
             material = meshData.material;
         }
 
@@ -0,0 +1,399 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <cassert>
+#include <algorithm>
+#include "SpatialIndex.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        constexpr int32_t SpatialIndex::NULL_PROXY;
+
+        // fraction of the box size by which the stored boxes are enlarged, so that small movements don't cause reinsertion
+        static const float FAT_BOX_MARGIN = 0.1F;
+
+        static inline Box2 combine(const Box2& a, const Box2& b)
+        {
+            Box2 result(a);
+            result.merge(b);
+            return result;
+        }
+
+        static inline float perimeter(const Box2& box)
+        {
+            return 2.0F * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+        }
+
+        static inline bool contains(const Box2& box, const Box2& other)
+        {
+            return box.min.x <= other.min.x && box.min.y <= other.min.y &&
+                other.max.x <= box.max.x && other.max.y <= box.max.y;
+        }
+
+        static inline Box2 fatten(const Box2& box)
+        {
+            Vector2 margin((box.max.x - box.min.x) * FAT_BOX_MARGIN,
+                           (box.max.y - box.min.y) * FAT_BOX_MARGIN);
+
+            return Box2(box.min - margin, box.max + margin);
+        }
+
+        SpatialIndex::SpatialIndex()
+        {
+        }
+
+        int32_t SpatialIndex::createProxy(const Box2& box, Actor* actor)
+        {
+            int32_t proxy = allocateNode();
+
+            nodes[static_cast<size_t>(proxy)].box = fatten(box);
+            nodes[static_cast<size_t>(proxy)].actor = actor;
+            nodes[static_cast<size_t>(proxy)].height = 0;
+
+            insertLeaf(proxy);
+            ++proxyCount;
+
+            return proxy;
+        }
+
+        void SpatialIndex::destroyProxy(int32_t proxy)
+        {
+            assert(proxy >= 0 && static_cast<size_t>(proxy) < nodes.size());
+            assert(nodes[static_cast<size_t>(proxy)].isLeaf());
+
+            removeLeaf(proxy);
+            freeNode(proxy);
+            --proxyCount;
+        }
+
+        bool SpatialIndex::moveProxy(int32_t proxy, const Box2& box)
+        {
+            assert(proxy >= 0 && static_cast<size_t>(proxy) < nodes.size());
+            assert(nodes[static_cast<size_t>(proxy)].isLeaf());
+
+            if (contains(nodes[static_cast<size_t>(proxy)].box, box))
+                return false;
+
+            removeLeaf(proxy);
+            nodes[static_cast<size_t>(proxy)].box = fatten(box);
+            insertLeaf(proxy);
+
+            return true;
+        }
+
+        void SpatialIndex::clear()
+        {
+            nodes.clear();
+            root = NULL_PROXY;
+            freeList = NULL_PROXY;
+            proxyCount = 0;
+        }
+
+        int32_t SpatialIndex::getHeight() const
+        {
+            return (root == NULL_PROXY) ? 0 : nodes[static_cast<size_t>(root)].height;
+        }
+
+        void SpatialIndex::query(const Box2& box, std::vector<Actor*>& result) const
+        {
+            if (root == NULL_PROXY) return;
+
+            stack.clear();
+            stack.push_back(root);
+
+            while (!stack.empty())
+            {
+                const Node& node = nodes[static_cast<size_t>(stack.back())];
+                stack.pop_back();
+
+                if (node.box.intersects(box))
+                {
+                    if (node.isLeaf())
+                        result.push_back(node.actor);
+                    else
+                    {
+                        stack.push_back(node.child1);
+                        stack.push_back(node.child2);
+                    }
+                }
+            }
+        }
+
+        void SpatialIndex::query(const Vector2& point, std::vector<Actor*>& result) const
+        {
+            if (root == NULL_PROXY) return;
+
+            stack.clear();
+            stack.push_back(root);
+
+            while (!stack.empty())
+            {
+                const Node& node = nodes[static_cast<size_t>(stack.back())];
+                stack.pop_back();
+
+                if (node.box.containsPoint(point))
+                {
+                    if (node.isLeaf())
+                        result.push_back(node.actor);
+                    else
+                    {
+                        stack.push_back(node.child1);
+                        stack.push_back(node.child2);
+                    }
+                }
+            }
+        }
+
+        int32_t SpatialIndex::allocateNode()
+        {
+            int32_t node;
+
+            if (freeList != NULL_PROXY)
+            {
+                node = freeList;
+                freeList = nodes[static_cast<size_t>(node)].parent;
+                nodes[static_cast<size_t>(node)] = Node();
+            }
+            else
+            {
+                node = static_cast<int32_t>(nodes.size());
+                nodes.push_back(Node());
+            }
+
+            return node;
+        }
+
+        void SpatialIndex::freeNode(int32_t node)
+        {
+            nodes[static_cast<size_t>(node)].actor = nullptr;
+            nodes[static_cast<size_t>(node)].parent = freeList;
+            nodes[static_cast<size_t>(node)].height = -1;
+            freeList = node;
+        }
+
+        void SpatialIndex::insertLeaf(int32_t leaf)
+        {
+            if (root == NULL_PROXY)
+            {
+                root = leaf;
+                nodes[static_cast<size_t>(root)].parent = NULL_PROXY;
+                return;
+            }
+
+            // find the sibling with the lowest cost by descending the tree
+            Box2 leafBox = nodes[static_cast<size_t>(leaf)].box;
+            int32_t index = root;
+
+            while (!nodes[static_cast<size_t>(index)].isLeaf())
+            {
+                const Node& node = nodes[static_cast<size_t>(index)];
+                const Node& child1 = nodes[static_cast<size_t>(node.child1)];
+                const Node& child2 = nodes[static_cast<size_t>(node.child2)];
+
+                float area = perimeter(node.box);
+                float combinedArea = perimeter(combine(node.box, leafBox));
+
+                // cost of creating a new parent for this node and the new leaf
+                float cost = 2.0F * combinedArea;
+
+                // minimum cost of pushing the leaf further down the tree
+                float inheritanceCost = 2.0F * (combinedArea - area);
+
+                float cost1 = perimeter(combine(leafBox, child1.box)) + inheritanceCost;
+                if (!child1.isLeaf()) cost1 -= perimeter(child1.box);
+
+                float cost2 = perimeter(combine(leafBox, child2.box)) + inheritanceCost;
+                if (!child2.isLeaf()) cost2 -= perimeter(child2.box);
+
+                if (cost < cost1 && cost < cost2) break;
+
+                index = (cost1 < cost2) ? node.child1 : node.child2;
+            }
+
+            int32_t sibling = index;
+            int32_t oldParent = nodes[static_cast<size_t>(sibling)].parent;
+            int32_t newParent = allocateNode();
+
+            nodes[static_cast<size_t>(newParent)].parent = oldParent;
+            nodes[static_cast<size_t>(newParent)].box = combine(leafBox, nodes[static_cast<size_t>(sibling)].box);
+            nodes[static_cast<size_t>(newParent)].height = nodes[static_cast<size_t>(sibling)].height + 1;
+            nodes[static_cast<size_t>(newParent)].child1 = sibling;
+            nodes[static_cast<size_t>(newParent)].child2 = leaf;
+
+            if (oldParent != NULL_PROXY)
+            {
+                if (nodes[static_cast<size_t>(oldParent)].child1 == sibling)
+                    nodes[static_cast<size_t>(oldParent)].child1 = newParent;
+                else
+                    nodes[static_cast<size_t>(oldParent)].child2 = newParent;
+            }
+            else
+                root = newParent;
+
+            nodes[static_cast<size_t>(sibling)].parent = newParent;
+            nodes[static_cast<size_t>(leaf)].parent = newParent;
+
+            refit(nodes[static_cast<size_t>(leaf)].parent);
+        }
+
+        void SpatialIndex::removeLeaf(int32_t leaf)
+        {
+            if (leaf == root)
+            {
+                root = NULL_PROXY;
+                return;
+            }
+
+            int32_t parent = nodes[static_cast<size_t>(leaf)].parent;
+            int32_t grandParent = nodes[static_cast<size_t>(parent)].parent;
+            int32_t sibling = (nodes[static_cast<size_t>(parent)].child1 == leaf) ?
+                nodes[static_cast<size_t>(parent)].child2 :
+                nodes[static_cast<size_t>(parent)].child1;
+
+            // replace the parent with the sibling
+            if (grandParent != NULL_PROXY)
+            {
+                if (nodes[static_cast<size_t>(grandParent)].child1 == parent)
+                    nodes[static_cast<size_t>(grandParent)].child1 = sibling;
+                else
+                    nodes[static_cast<size_t>(grandParent)].child2 = sibling;
+
+                nodes[static_cast<size_t>(sibling)].parent = grandParent;
+                freeNode(parent);
+
+                refit(grandParent);
+            }
+            else
+            {
+                root = sibling;
+                nodes[static_cast<size_t>(sibling)].parent = NULL_PROXY;
+                freeNode(parent);
+            }
+        }
+
+        void SpatialIndex::refit(int32_t index)
+        {
+            while (index != NULL_PROXY)
+            {
+                index = balance(index);
+
+                Node& node = nodes[static_cast<size_t>(index)];
+                const Node& child1 = nodes[static_cast<size_t>(node.child1)];
+                const Node& child2 = nodes[static_cast<size_t>(node.child2)];
+
+                node.height = 1 + std::max(child1.height, child2.height);
+                node.box = combine(child1.box, child2.box);
+
+                index = node.parent;
+            }
+        }
+
+        // performs a left or right rotation if the node is imbalanced, returns the new root of the subtree
+        int32_t SpatialIndex::balance(int32_t indexA)
+        {
+            Node& a = nodes[static_cast<size_t>(indexA)];
+
+            if (a.isLeaf() || a.height < 2)
+                return indexA;
+
+            int32_t indexB = a.child1;
+            int32_t indexC = a.child2;
+            Node& b = nodes[static_cast<size_t>(indexB)];
+            Node& c = nodes[static_cast<size_t>(indexC)];
+
+            int32_t difference = c.height - b.height;
+
+            if (difference > 1) // rotate c up
+            {
+                int32_t indexF = c.child1;
+                int32_t indexG = c.child2;
+                Node& f = nodes[static_cast<size_t>(indexF)];
+                Node& g = nodes[static_cast<size_t>(indexG)];
+
+                c.child1 = indexA;
+                c.parent = a.parent;
+                a.parent = indexC;
+
+                if (c.parent != NULL_PROXY)
+                {
+                    if (nodes[static_cast<size_t>(c.parent)].child1 == indexA)
+                        nodes[static_cast<size_t>(c.parent)].child1 = indexC;
+                    else
+                        nodes[static_cast<size_t>(c.parent)].child2 = indexC;
+                }
+                else
+                    root = indexC;
+
+                if (f.height > g.height)
+                {
+                    c.child2 = indexF;
+                    a.child2 = indexG;
+                    g.parent = indexA;
+                    a.box = combine(b.box, g.box);
+                    c.box = combine(a.box, f.box);
+                    a.height = 1 + std::max(b.height, g.height);
+                    c.height = 1 + std::max(a.height, f.height);
+                }
+                else
+                {
+                    c.child2 = indexG;
+                    a.child2 = indexF;
+                    f.parent = indexA;
+                    a.box = combine(b.box, f.box);
+                    c.box = combine(a.box, g.box);
+                    a.height = 1 + std::max(b.height, f.height);
+                    c.height = 1 + std::max(a.height, g.height);
+                }
+
+                return indexC;
+            }
+            else if (difference < -1) // rotate b up
+            {
+                int32_t indexD = b.child1;
+                int32_t indexE = b.child2;
+                Node& d = nodes[static_cast<size_t>(indexD)];
+                Node& e = nodes[static_cast<size_t>(indexE)];
+
+                b.child1 = indexA;
+                b.parent = a.parent;
+                a.parent = indexB;
+
+                if (b.parent != NULL_PROXY)
+                {
+                    if (nodes[static_cast<size_t>(b.parent)].child1 == indexA)
+                        nodes[static_cast<size_t>(b.parent)].child1 = indexB;
+                    else
+                        nodes[static_cast<size_t>(b.parent)].child2 = indexB;
+                }
+                else
+                    root = indexB;
+
+                if (d.height > e.height)
+                {
+                    b.child2 = indexD;
+                    a.child1 = indexE;
+                    e.parent = indexA;
+                    a.box = combine(c.box, e.box);
+                    b.box = combine(a.box, d.box);
+                    a.height = 1 + std::max(c.height, e.height);
+                    b.height = 1 + std::max(a.height, d.height);
+                }
+                else
+                {
+                    b.child2 = indexE;
+                    a.child1 = indexD;
+                    d.parent = indexA;
+                    a.box = combine(c.box, d.box);
+                    b.box = combine(a.box, e.box);
+                    a.height = 1 + std::max(c.height, d.height);
+                    b.height = 1 + std::max(a.height, e.height);
+                }
+
+                return indexB;
+            }
+
+            return indexA;
+        }
+    } // namespace scene
+} // namespace ouzel
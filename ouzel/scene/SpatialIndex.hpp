@@ -0,0 +1,76 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_SPATIALINDEX_HPP
+#define OUZEL_SCENE_SPATIALINDEX_HPP
+
+#include <cstdint>
+#include <vector>
+#include "math/Box2.hpp"
+#include "math/Vector2.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        class Actor;
+
+        // dynamic AABB tree of the world-space actor bounds
+        class SpatialIndex final
+        {
+        public:
+            static constexpr int32_t NULL_PROXY = -1;
+
+            SpatialIndex();
+
+            SpatialIndex(const SpatialIndex&) = delete;
+            SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+            SpatialIndex(SpatialIndex&&) = delete;
+            SpatialIndex& operator=(SpatialIndex&&) = delete;
+
+            int32_t createProxy(const Box2& box, Actor* actor);
+            void destroyProxy(int32_t proxy);
+            // returns true if the proxy had to be reinserted
+            bool moveProxy(int32_t proxy, const Box2& box);
+            void clear();
+
+            inline Actor* getActor(int32_t proxy) const { return nodes[static_cast<size_t>(proxy)].actor; }
+            inline const Box2& getFatBox(int32_t proxy) const { return nodes[static_cast<size_t>(proxy)].box; }
+            inline uint32_t getProxyCount() const { return proxyCount; }
+            int32_t getHeight() const;
+
+            void query(const Box2& box, std::vector<Actor*>& result) const;
+            void query(const Vector2& point, std::vector<Actor*>& result) const;
+
+        private:
+            struct Node
+            {
+                Box2 box;
+                Actor* actor = nullptr;
+                int32_t parent = NULL_PROXY; // next free node for the nodes in the free list
+                int32_t child1 = NULL_PROXY;
+                int32_t child2 = NULL_PROXY;
+                int32_t height = -1; // 0 for leaves, -1 for free nodes
+
+                inline bool isLeaf() const { return child1 == NULL_PROXY; }
+            };
+
+            int32_t allocateNode();
+            void freeNode(int32_t node);
+
+            void insertLeaf(int32_t leaf);
+            void removeLeaf(int32_t leaf);
+            int32_t balance(int32_t node);
+            void refit(int32_t node);
+
+            std::vector<Node> nodes;
+            int32_t root = NULL_PROXY;
+            int32_t freeList = NULL_PROXY;
+            uint32_t proxyCount = 0;
+
+            mutable std::vector<int32_t> stack;
+        };
+    } // namespace scene
+} // namespace ouzel
+
+#endif // OUZEL_SCENE_SPATIALINDEX_HPP
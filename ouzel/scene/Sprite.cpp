@@ -1,5 +1,7 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cassert>
+#include <stdexcept>
 #include "Sprite.hpp"
 #include "core/Setup.h"
 #include "core/Engine.hpp"
@@ -44,10 +46,14 @@ namespace ouzel
 
         void Sprite::init(const SpriteData& spriteData)
         {
+            // the vertex buffers of all frames use graphics::VertexLayout::SPRITE
+            if (spriteData.shader && !spriteData.shader->getVertexLayout().isCompatible(graphics::VertexLayout::SPRITE))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
+
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::CullMode::NONE;
             material->blendState = spriteData.blendState ? spriteData.blendState : engine->getCache().getBlendState(BLEND_ALPHA);
-            material->shader = spriteData.shader ? spriteData.shader : engine->getCache().getShader(SHADER_TEXTURE);
+            material->shader = spriteData.shader ? spriteData.shader : engine->getCache().getShader(SHADER_SPRITE);
             material->textures[0] = spriteData.texture;
 
             animations = spriteData.animations;
@@ -63,7 +69,7 @@ namespace ouzel
         {
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::CullMode::NONE;
-            material->shader = engine->getCache().getShader(SHADER_TEXTURE);
+            material->shader = engine->getCache().getShader(SHADER_SPRITE);
             material->blendState = engine->getCache().getBlendState(BLEND_ALPHA);
 
             if (const SpriteData* spriteData = engine->getCache().getSpriteData(filename))
@@ -102,7 +108,7 @@ namespace ouzel
         {
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::CullMode::NONE;
-            material->shader = engine->getCache().getShader(SHADER_TEXTURE);
+            material->shader = engine->getCache().getShader(SHADER_SPRITE);
             material->blendState = engine->getCache().getBlendState(BLEND_ALPHA);
             material->textures[0] = newTexture;
             animations.clear();
@@ -224,14 +230,24 @@ namespace ouzel
                 size_t currentFrame = static_cast<size_t>(currentTime / currentAnimation->animation->frameInterval);
                 if (currentFrame >= currentAnimation->animation->frames.size()) currentFrame = currentAnimation->animation->frames.size() - 1;
 
-                Matrix4 modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
-                float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
+                const SpriteData::Frame& frame = currentAnimation->animation->frames[currentFrame];
 
-                std::vector<std::vector<float>> fragmentShaderConstants(1);
-                fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+                // the batched vertices are the same as the ones in the vertex buffer
+                assert(material->shader->getVertexLayout().isCompatible(frame.getVertexBuffer()->getVertexLayout()));
 
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+                if (layer && layer->isBatchingEnabled() && !frame.getVertices().empty())
+                {
+                    layer->getSpriteBatch().draw(*material,
+                                                 transformMatrix * offsetMatrix,
+                                                 opacity,
+                                                 renderViewProjection,
+                                                 frame.getIndices(),
+                                                 frame.getVertices());
+                    return;
+                }
+
+                Matrix4 modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
+                float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
 
                 std::vector<uintptr_t> textures;
                 for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
@@ -240,12 +256,10 @@ namespace ouzel
                 engine->getRenderer()->setCullMode(material->cullMode);
                 engine->getRenderer()->setPipelineState(material->blendState->getResource(),
                                                         material->shader->getResource());
-                engine->getRenderer()->setShaderConstants(fragmentShaderConstants,
-                                                          vertexShaderConstants);
+                engine->getRenderer()->setShaderConstants(colorVector, sizeof(colorVector),
+                                                          modelViewProj.m, sizeof(modelViewProj.m));
                 engine->getRenderer()->setTextures(textures);
 
-                const SpriteData::Frame& frame = currentAnimation->animation->frames[currentFrame];
-
                 engine->getRenderer()->draw(frame.getIndexBuffer()->getResource(),
                                             frame.getIndexCount(),
                                             sizeof(uint16_t),
@@ -255,6 +269,14 @@ namespace ouzel
             }
         }
 
+        void Sprite::setMaterial(const std::shared_ptr<graphics::Material>& newMaterial)
+        {
+            if (newMaterial && !newMaterial->shader->getVertexLayout().isCompatible(graphics::VertexLayout::SPRITE))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
+
+            material = newMaterial;
+        }
+
         void Sprite::setOffset(const Vector2& newOffset)
         {
             offset = newOffset;
@@ -384,6 +406,8 @@ namespace ouzel
             }
             else
                 boundingBox.reset();
+
+            invalidateBoundingBox();
         }
     } // namespace scene
 } // namespace ouzel
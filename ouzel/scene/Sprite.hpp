@@ -40,8 +40,11 @@ namespace ouzel
                       const Matrix4& renderViewProjection,
                       bool wireframe) override;
 
+            uint32_t getStateKey() const override { return material ? material->getStateKey() : 0; }
+
             inline const std::shared_ptr<graphics::Material>& getMaterial() const { return material; }
-            inline void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial) { material = newMaterial; }
+            // the shader of the material must use graphics::VertexLayout::SPRITE
+            void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial);
 
             inline const Vector2& getOffset() const { return offset; }
             void setOffset(const Vector2& newOffset);
@@ -0,0 +1,132 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include "SpriteBatch.hpp"
+#include "core/Engine.hpp"
+#include "graphics/Renderer.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        void SpriteBatch::reset()
+        {
+            indices.clear();
+            vertices.clear();
+            currentMeshBuffers = 0;
+            spriteCount = 0;
+            batchCount = 0;
+        }
+
+        bool SpriteBatch::isCompatible(const graphics::Material& material,
+                                       const Matrix4& renderViewProjection) const
+        {
+            if (material.cullMode != cullMode ||
+                material.blendState->getResource() != blendState ||
+                material.shader->getResource() != shader)
+                return false;
+
+            for (uint32_t layer = 0; layer < graphics::Texture::LAYERS; ++layer)
+            {
+                uintptr_t texture = material.textures[layer] ? material.textures[layer]->getResource() : 0;
+                if (texture != textures[layer]) return false;
+            }
+
+            return material.diffuseColor.normR() == color[0] &&
+                material.diffuseColor.normG() == color[1] &&
+                material.diffuseColor.normB() == color[2] &&
+                material.diffuseColor.normA() * material.opacity == color[3] &&
+                std::equal(std::begin(renderViewProjection.m), std::end(renderViewProjection.m), std::begin(viewProjection.m));
+        }
+
+        void SpriteBatch::draw(const graphics::Material& material,
+                               const Matrix4& transformMatrix,
+                               float opacity,
+                               const Matrix4& renderViewProjection,
+                               const std::vector<uint16_t>& newIndices,
+                               const std::vector<graphics::SpriteVertex>& newVertices)
+        {
+            if (!vertices.empty() &&
+                (!isCompatible(material, renderViewProjection) ||
+                 vertices.size() + newVertices.size() > std::numeric_limits<uint16_t>::max()))
+                flush();
+
+            if (vertices.empty())
+            {
+                cullMode = material.cullMode;
+                blendState = material.blendState->getResource();
+                shader = material.shader->getResource();
+
+                for (uint32_t layer = 0; layer < graphics::Texture::LAYERS; ++layer)
+                    textures[layer] = material.textures[layer] ? material.textures[layer]->getResource() : 0;
+
+                color[0] = material.diffuseColor.normR();
+                color[1] = material.diffuseColor.normG();
+                color[2] = material.diffuseColor.normB();
+                color[3] = material.diffuseColor.normA() * material.opacity;
+                viewProjection = renderViewProjection;
+            }
+
+            uint16_t startVertex = static_cast<uint16_t>(vertices.size());
+
+            for (uint16_t index : newIndices)
+                indices.push_back(startVertex + index);
+
+            for (const graphics::SpriteVertex& vertex : newVertices)
+            {
+                graphics::SpriteVertex transformedVertex = vertex;
+                transformMatrix.transformPoint(transformedVertex.position);
+                transformedVertex.color.a = static_cast<uint8_t>(transformedVertex.color.a * opacity);
+                vertices.push_back(transformedVertex);
+            }
+
+            ++spriteCount;
+        }
+
+        void SpriteBatch::flush()
+        {
+            if (vertices.empty()) return;
+
+            if (currentMeshBuffers == meshBuffers.size())
+            {
+                MeshBuffers newMeshBuffers;
+                newMeshBuffers.indexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
+                newMeshBuffers.indexBuffer->init(graphics::Buffer::Usage::INDEX, graphics::Buffer::DYNAMIC,
+                                                 indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
+
+                newMeshBuffers.vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
+                newMeshBuffers.vertexBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC,
+                                                  vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+                newMeshBuffers.vertexBuffer->setVertexLayout(graphics::VertexLayout::SPRITE);
+
+                meshBuffers.push_back(newMeshBuffers);
+            }
+            else
+            {
+                meshBuffers[currentMeshBuffers].indexBuffer->setData(indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
+                meshBuffers[currentMeshBuffers].vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            }
+
+            const MeshBuffers& currentBuffers = meshBuffers[currentMeshBuffers++];
+
+            engine->getRenderer()->setCullMode(cullMode);
+            engine->getRenderer()->setPipelineState(blendState, shader);
+            engine->getRenderer()->setShaderConstants(color, sizeof(color),
+                                                      viewProjection.m, sizeof(viewProjection.m));
+            engine->getRenderer()->setTextures(textures, graphics::Texture::LAYERS);
+            engine->getRenderer()->draw(currentBuffers.indexBuffer->getResource(),
+                                        static_cast<uint32_t>(indices.size()),
+                                        sizeof(uint16_t),
+                                        currentBuffers.vertexBuffer->getResource(),
+                                        graphics::DrawMode::TRIANGLE_LIST,
+                                        0);
+
+            indices.clear();
+            vertices.clear();
+            ++batchCount;
+        }
+    } // namespace scene
+} // namespace ouzel
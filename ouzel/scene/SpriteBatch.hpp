@@ -0,0 +1,75 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_SPRITEBATCH_HPP
+#define OUZEL_SCENE_SPRITEBATCH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "graphics/Buffer.hpp"
+#include "graphics/Material.hpp"
+#include "graphics/RasterizerState.hpp"
+#include "graphics/Texture.hpp"
+#include "graphics/Vertex.hpp"
+#include "math/Matrix4.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        // Collects consecutive sprites that share the same render state and
+        // draws them with a single draw call using CPU-transformed vertices
+        class SpriteBatch final
+        {
+        public:
+            SpriteBatch() {}
+
+            SpriteBatch(const SpriteBatch&) = delete;
+            SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+            SpriteBatch(SpriteBatch&&) = delete;
+            SpriteBatch& operator=(SpriteBatch&&) = delete;
+
+            void reset();
+
+            void draw(const graphics::Material& material,
+                      const Matrix4& transformMatrix,
+                      float opacity,
+                      const Matrix4& renderViewProjection,
+                      const std::vector<uint16_t>& newIndices,
+                      const std::vector<graphics::SpriteVertex>& newVertices);
+            void flush();
+
+            inline uint32_t getSpriteCount() const { return spriteCount; }
+            inline uint32_t getBatchCount() const { return batchCount; }
+
+        private:
+            bool isCompatible(const graphics::Material& material,
+                              const Matrix4& renderViewProjection) const;
+
+            struct MeshBuffers final
+            {
+                std::shared_ptr<graphics::Buffer> indexBuffer;
+                std::shared_ptr<graphics::Buffer> vertexBuffer;
+            };
+
+            std::vector<MeshBuffers> meshBuffers;
+            size_t currentMeshBuffers = 0;
+
+            graphics::CullMode cullMode = graphics::CullMode::NONE;
+            uintptr_t blendState = 0;
+            uintptr_t shader = 0;
+            uintptr_t textures[graphics::Texture::LAYERS];
+            float color[4];
+            Matrix4 viewProjection;
+
+            std::vector<uint16_t> indices;
+            std::vector<graphics::SpriteVertex> vertices;
+
+            uint32_t spriteCount = 0;
+            uint32_t batchCount = 0;
+        };
+    } // namespace scene
+} // namespace ouzel
+
+#endif // OUZEL_SCENE_SPRITEBATCH_HPP
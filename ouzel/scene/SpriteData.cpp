@@ -15,9 +15,9 @@ namespace ouzel
                                  const Size2& sourceSize,
                                  const Vector2& sourceOffset,
                                  const Vector2& pivot):
-            name(frameName)
+            name(frameName),
+            indices({0, 1, 2, 1, 3, 2})
         {
-            std::vector<uint16_t> indices = {0, 1, 2, 1, 3, 2};
             indexCount = static_cast<uint32_t>(indices.size());
 
             Vector2 textCoords[4];
@@ -51,15 +51,11 @@ namespace ouzel
                 textCoords[3] = Vector2(rightBottom.x, rightBottom.y);
             }
 
-            std::vector<graphics::Vertex> vertices = {
-                graphics::Vertex(Vector3(finalOffset.x, finalOffset.y, 0.0F), Color::WHITE,
-                                 textCoords[0], Vector3(0.0F, 0.0F, -1.0F)),
-                graphics::Vertex(Vector3(finalOffset.x + frameRectangle.size.width, finalOffset.y, 0.0F), Color::WHITE,
-                                 textCoords[1], Vector3(0.0F, 0.0F, -1.0F)),
-                graphics::Vertex(Vector3(finalOffset.x, finalOffset.y + frameRectangle.size.height, 0.0F), Color::WHITE,
-                                 textCoords[2], Vector3(0.0F, 0.0F, -1.0F)),
-                graphics::Vertex(Vector3(finalOffset.x + frameRectangle.size.width, finalOffset.y + frameRectangle.size.height, 0.0F), Color::WHITE,
-                                 textCoords[3], Vector3(0.0F, 0.0F, -1.0F))
+            vertices = {
+                graphics::SpriteVertex(Vector3(finalOffset.x, finalOffset.y, 0.0F), Color::WHITE, textCoords[0]),
+                graphics::SpriteVertex(Vector3(finalOffset.x + frameRectangle.size.width, finalOffset.y, 0.0F), Color::WHITE, textCoords[1]),
+                graphics::SpriteVertex(Vector3(finalOffset.x, finalOffset.y + frameRectangle.size.height, 0.0F), Color::WHITE, textCoords[2]),
+                graphics::SpriteVertex(Vector3(finalOffset.x + frameRectangle.size.width, finalOffset.y + frameRectangle.size.height, 0.0F), Color::WHITE, textCoords[3])
             };
 
             boundingBox.set(finalOffset, finalOffset + Vector2(frameRectangle.size.width, frameRectangle.size.height));
@@ -69,16 +65,19 @@ namespace ouzel
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, 0, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::SPRITE);
         }
 
         SpriteData::Frame::Frame(const std::string& frameName,
-                                 const std::vector<uint16_t>& indices,
-                                 const std::vector<graphics::Vertex>& vertices):
-            name(frameName)
+                                 const std::vector<uint16_t>& initIndices,
+                                 const std::vector<graphics::Vertex>& initVertices):
+            name(frameName),
+            indices(initIndices),
+            vertices(initVertices.begin(), initVertices.end())
         {
             indexCount = static_cast<uint32_t>(indices.size());
 
-            for (const graphics::Vertex& vertex : vertices)
+            for (const graphics::SpriteVertex& vertex : vertices)
                 boundingBox.insertPoint(Vector2(vertex.position));
 
             indexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
@@ -86,20 +85,23 @@ namespace ouzel
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, 0, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::SPRITE);
         }
 
         SpriteData::Frame::Frame(const std::string& frameName,
-                                 const std::vector<uint16_t>& indices,
-                                 const std::vector<graphics::Vertex>& vertices,
+                                 const std::vector<uint16_t>& initIndices,
+                                 const std::vector<graphics::Vertex>& initVertices,
                                  const Rect& frameRectangle,
                                  const Size2& sourceSize,
                                  const Vector2& sourceOffset,
                                  const Vector2& pivot):
-            name(frameName)
+            name(frameName),
+            indices(initIndices),
+            vertices(initVertices.begin(), initVertices.end())
         {
             indexCount = static_cast<uint32_t>(indices.size());
 
-            for (const graphics::Vertex& vertex : vertices)
+            for (const graphics::SpriteVertex& vertex : vertices)
                 boundingBox.insertPoint(Vector2(vertex.position));
 
             // TODO: fix
@@ -111,6 +113,7 @@ namespace ouzel
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, 0, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::SPRITE);
         }
     } // namespace scene
 } // namespace ouzel
@@ -33,12 +33,12 @@ namespace ouzel
                       const Vector2& pivot);
 
                 Frame(const std::string& frameName,
-                      const std::vector<uint16_t>& indices,
-                      const std::vector<graphics::Vertex>& vertices);
+                      const std::vector<uint16_t>& initIndices,
+                      const std::vector<graphics::Vertex>& initVertices);
 
                 Frame(const std::string& frameName,
-                      const std::vector<uint16_t>& indices,
-                      const std::vector<graphics::Vertex>& vertices,
+                      const std::vector<uint16_t>& initIndices,
+                      const std::vector<graphics::Vertex>& initVertices,
                       const Rect& frameRectangle,
                       const Size2& sourceSize,
                       const Vector2& sourceOffset,
@@ -51,12 +51,18 @@ namespace ouzel
                 inline const std::shared_ptr<graphics::Buffer>& getIndexBuffer() const { return indexBuffer; };
                 inline const std::shared_ptr<graphics::Buffer>& getVertexBuffer() const { return vertexBuffer; };
 
+                inline const std::vector<uint16_t>& getIndices() const { return indices; }
+                inline const std::vector<graphics::SpriteVertex>& getVertices() const { return vertices; }
+
             private:
                 std::string name;
                 Box2 boundingBox;
                 uint32_t indexCount = 0;
                 std::shared_ptr<graphics::Buffer> indexBuffer;
                 std::shared_ptr<graphics::Buffer> vertexBuffer;
+
+                std::vector<uint16_t> indices;
+                std::vector<graphics::SpriteVertex> vertices;
             };
 
             struct Animation final
@@ -69,7 +75,7 @@ namespace ouzel
             std::map<std::string, Animation> animations;
             std::shared_ptr<graphics::Texture> texture;
             std::shared_ptr<graphics::BlendState> blendState;
-            std::shared_ptr<graphics::Shader> shader;
+            std::shared_ptr<graphics::Shader> shader; // must use graphics::VertexLayout::SPRITE
         };
     } // namespace scene
 } // namespace ouzel
@@ -0,0 +1,149 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include "StaticMeshBatch.hpp"
+#include "core/Engine.hpp"
+#include "graphics/Renderer.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        void StaticMeshBatch::reset()
+        {
+            std::shared_ptr<graphics::Shader> staticMeshShaderPtr = engine->getCache().getShader(SHADER_STATIC_MESH);
+            std::shared_ptr<graphics::Shader> instancedMeshShaderPtr = engine->getCache().getShader(SHADER_INSTANCED_MESH);
+
+            // the instanced shader exists only for the drivers that have an instanced vertex shader and support instancing
+            staticMeshShader = staticMeshShaderPtr ? staticMeshShaderPtr->getResource() : 0;
+            instancedMeshShader = instancedMeshShaderPtr ? instancedMeshShaderPtr->getResource() : 0;
+
+            instances.clear();
+            currentInstanceBuffer = 0;
+            instanceCount = 0;
+            batchCount = 0;
+        }
+
+        bool StaticMeshBatch::isCompatible(const graphics::Material& material,
+                                           uint32_t newIndexCount,
+                                           uint32_t newIndexSize,
+                                           uintptr_t newIndexBuffer,
+                                           uintptr_t newVertexBuffer) const
+        {
+            if (newIndexCount != indexCount ||
+                newIndexSize != indexSize ||
+                newIndexBuffer != indexBuffer ||
+                newVertexBuffer != vertexBuffer ||
+                material.cullMode != cullMode ||
+                material.blendState->getResource() != blendState)
+                return false;
+
+            for (uint32_t layer = 0; layer < graphics::Texture::LAYERS; ++layer)
+            {
+                uintptr_t texture = material.textures[layer] ? material.textures[layer]->getResource() : 0;
+                if (texture != textures[layer]) return false;
+            }
+
+            return true;
+        }
+
+        bool StaticMeshBatch::draw(const graphics::Material& material,
+                                   float opacity,
+                                   const Matrix4& modelViewProj,
+                                   uint32_t newIndexCount,
+                                   uint32_t newIndexSize,
+                                   uintptr_t newIndexBuffer,
+                                   uintptr_t newVertexBuffer)
+        {
+            if (!instancedMeshShader || material.shader->getResource() != staticMeshShader)
+            {
+                flush();
+                return false;
+            }
+
+            if (!instances.empty() &&
+                !isCompatible(material, newIndexCount, newIndexSize, newIndexBuffer, newVertexBuffer))
+                flush();
+
+            if (instances.empty())
+            {
+                cullMode = material.cullMode;
+                blendState = material.blendState->getResource();
+
+                for (uint32_t layer = 0; layer < graphics::Texture::LAYERS; ++layer)
+                    textures[layer] = material.textures[layer] ? material.textures[layer]->getResource() : 0;
+
+                indexCount = newIndexCount;
+                indexSize = newIndexSize;
+                indexBuffer = newIndexBuffer;
+                vertexBuffer = newVertexBuffer;
+            }
+
+            // the color is applied per instance, because the opacity of every actor can differ
+            instances.push_back(graphics::InstanceData(modelViewProj,
+                                                       Vector4(material.diffuseColor.normR(),
+                                                               material.diffuseColor.normG(),
+                                                               material.diffuseColor.normB(),
+                                                               material.diffuseColor.normA() * opacity * material.opacity)));
+
+            ++instanceCount;
+
+            return true;
+        }
+
+        void StaticMeshBatch::flush()
+        {
+            if (instances.empty()) return;
+
+            engine->getRenderer()->setCullMode(cullMode);
+            engine->getRenderer()->setTextures(textures, graphics::Texture::LAYERS);
+
+            // a single mesh doesn't need an instance buffer
+            if (instances.size() == 1)
+            {
+                const graphics::InstanceData& instance = instances.front();
+
+                engine->getRenderer()->setPipelineState(blendState, staticMeshShader);
+                engine->getRenderer()->setShaderConstants(instance.color, sizeof(instance.color),
+                                                          instance.modelViewProj.m, sizeof(instance.modelViewProj.m));
+                engine->getRenderer()->draw(indexBuffer,
+                                            indexCount,
+                                            indexSize,
+                                            vertexBuffer,
+                                            graphics::DrawMode::TRIANGLE_LIST,
+                                            0);
+            }
+            else
+            {
+                if (currentInstanceBuffer == instanceBuffers.size())
+                {
+                    std::shared_ptr<graphics::Buffer> instanceBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
+                    instanceBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC,
+                                         instances.data(), static_cast<uint32_t>(getVectorSize(instances)));
+
+                    instanceBuffers.push_back(instanceBuffer);
+                }
+                else
+                    instanceBuffers[currentInstanceBuffer]->setData(instances.data(), static_cast<uint32_t>(getVectorSize(instances)));
+
+                const std::shared_ptr<graphics::Buffer>& instanceBuffer = instanceBuffers[currentInstanceBuffer++];
+
+                const float color[] = {1.0F, 1.0F, 1.0F, 1.0F};
+
+                engine->getRenderer()->setPipelineState(blendState, instancedMeshShader);
+                engine->getRenderer()->setShaderConstants(color, sizeof(color), nullptr, 0);
+                engine->getRenderer()->drawInstanced(indexBuffer,
+                                                     indexCount,
+                                                     indexSize,
+                                                     vertexBuffer,
+                                                     graphics::DrawMode::TRIANGLE_LIST,
+                                                     0,
+                                                     instanceBuffer->getResource(),
+                                                     static_cast<uint32_t>(instances.size()));
+            }
+
+            instances.clear();
+            ++batchCount;
+        }
+    } // namespace scene
+} // namespace ouzel
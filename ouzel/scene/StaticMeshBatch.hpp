@@ -0,0 +1,77 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_STATICMESHBATCH_HPP
+#define OUZEL_SCENE_STATICMESHBATCH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "graphics/Buffer.hpp"
+#include "graphics/Material.hpp"
+#include "graphics/RasterizerState.hpp"
+#include "graphics/Texture.hpp"
+#include "graphics/Vertex.hpp"
+#include "math/Matrix4.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        // Collects consecutive static meshes that share the same mesh buffers and
+        // render state and draws them with a single instanced draw call
+        class StaticMeshBatch final
+        {
+        public:
+            StaticMeshBatch() {}
+
+            StaticMeshBatch(const StaticMeshBatch&) = delete;
+            StaticMeshBatch& operator=(const StaticMeshBatch&) = delete;
+
+            StaticMeshBatch(StaticMeshBatch&&) = delete;
+            StaticMeshBatch& operator=(StaticMeshBatch&&) = delete;
+
+            void reset();
+
+            // returns false if the material's shader has no instanced counterpart
+            bool draw(const graphics::Material& material,
+                      float opacity,
+                      const Matrix4& modelViewProj,
+                      uint32_t newIndexCount,
+                      uint32_t newIndexSize,
+                      uintptr_t newIndexBuffer,
+                      uintptr_t newVertexBuffer);
+            void flush();
+
+            inline uint32_t getInstanceCount() const { return instanceCount; }
+            inline uint32_t getBatchCount() const { return batchCount; }
+
+        private:
+            bool isCompatible(const graphics::Material& material,
+                              uint32_t newIndexCount,
+                              uint32_t newIndexSize,
+                              uintptr_t newIndexBuffer,
+                              uintptr_t newVertexBuffer) const;
+
+            uintptr_t staticMeshShader = 0;
+            uintptr_t instancedMeshShader = 0;
+
+            std::vector<std::shared_ptr<graphics::Buffer>> instanceBuffers;
+            size_t currentInstanceBuffer = 0;
+
+            graphics::CullMode cullMode = graphics::CullMode::NONE;
+            uintptr_t blendState = 0;
+            uintptr_t textures[graphics::Texture::LAYERS];
+            uint32_t indexCount = 0;
+            uint32_t indexSize = 0;
+            uintptr_t indexBuffer = 0;
+            uintptr_t vertexBuffer = 0;
+
+            std::vector<graphics::InstanceData> instances;
+
+            uint32_t instanceCount = 0;
+            uint32_t batchCount = 0;
+        };
+    } // namespace scene
+} // namespace ouzel
+
+#endif // OUZEL_SCENE_STATICMESHBATCH_HPP
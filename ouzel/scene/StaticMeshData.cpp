@@ -21,8 +21,11 @@ namespace ouzel
             indexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             indexBuffer->init(graphics::Buffer::Usage::INDEX, 0, indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
 
+            std::vector<graphics::StaticMeshVertex> meshVertices(vertices.begin(), vertices.end());
+
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
-            vertexBuffer->init(graphics::Buffer::Usage::VERTEX, 0, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+            vertexBuffer->init(graphics::Buffer::Usage::VERTEX, 0, meshVertices.data(), static_cast<uint32_t>(getVectorSize(meshVertices)));
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::STATIC_MESH);
         }
     } // namespace scene
 } // namespace ouzel
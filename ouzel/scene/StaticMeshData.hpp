@@ -22,7 +22,7 @@ namespace ouzel
                            const std::shared_ptr<graphics::Material>& initMaterial);
 
             Box3 boundingBox;
-            std::shared_ptr<graphics::Material> material;
+            std::shared_ptr<graphics::Material> material; // the shader must use graphics::VertexLayout::STATIC_MESH
             uint32_t indexCount = 0;
             uint32_t indexSize = 0;
             std::shared_ptr<graphics::Buffer> indexBuffer;
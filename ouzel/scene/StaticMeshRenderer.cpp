@@ -1,7 +1,10 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cassert>
+#include <stdexcept>
 #include "StaticMeshRenderer.hpp"
 #include "core/Engine.hpp"
+#include "Layer.hpp"
 
 namespace ouzel
 {
@@ -26,12 +29,15 @@ namespace ouzel
 
         void StaticMeshRenderer::init(const StaticMeshData& meshData)
         {
-            boundingBox = meshData.boundingBox;
+            setBoundingBox(meshData.boundingBox);
             material = meshData.material;
             indexCount = meshData.indexCount;
             indexSize = meshData.indexSize;
             indexBuffer = meshData.indexBuffer;
             vertexBuffer = meshData.vertexBuffer;
+
+            if (!material->shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
         }
 
         void StaticMeshRenderer::init(const std::string& filename)
@@ -39,6 +45,14 @@ namespace ouzel
             init(*engine->getCache().getStaticMeshData(filename));
         }
 
+        void StaticMeshRenderer::setMaterial(const std::shared_ptr<graphics::Material>& newMaterial)
+        {
+            if (vertexBuffer && !newMaterial->shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
+
+            material = newMaterial;
+        }
+
         void StaticMeshRenderer::draw(const Matrix4& transformMatrix,
                                       float opacity,
                                       const Matrix4& renderViewProjection,
@@ -51,14 +65,21 @@ namespace ouzel
 
             material->cullMode = graphics::CullMode::NONE;
 
+            assert(material->shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()));
+
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
-            float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
 
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+            if (layer && layer->isBatchingEnabled() &&
+                layer->getStaticMeshBatch().draw(*material,
+                                                 opacity,
+                                                 modelViewProj,
+                                                 indexCount,
+                                                 indexSize,
+                                                 indexBuffer->getResource(),
+                                                 vertexBuffer->getResource()))
+                return;
 
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+            float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
 
             std::vector<uintptr_t> textures;
             for (const std::shared_ptr<graphics::Texture>& texture : material->textures)
@@ -67,8 +88,8 @@ namespace ouzel
             engine->getRenderer()->setCullMode(material->cullMode);
             engine->getRenderer()->setPipelineState(material->blendState->getResource(),
                                                     material->shader->getResource());
-            engine->getRenderer()->setShaderConstants(fragmentShaderConstants,
-                                                      vertexShaderConstants);
+            engine->getRenderer()->setShaderConstants(colorVector, sizeof(colorVector),
+                                                      modelViewProj.m, sizeof(modelViewProj.m));
             engine->getRenderer()->setTextures(textures);
             engine->getRenderer()->draw(indexBuffer->getResource(),
                                         indexCount,
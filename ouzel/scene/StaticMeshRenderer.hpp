@@ -27,8 +27,11 @@ namespace ouzel
                       const Matrix4& renderViewProjection,
                       bool wireframe) override;
 
+            uint32_t getStateKey() const override { return material ? material->getStateKey() : 0; }
+
             inline const std::shared_ptr<graphics::Material>& getMaterial() const { return material; }
-            inline void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial) { material = newMaterial; }
+            // the shader of the material must read the vertices of the mesh, e.g. use graphics::VertexLayout::STATIC_MESH
+            void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial);
 
         private:
             std::shared_ptr<graphics::Material> material;
@@ -1,5 +1,7 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cassert>
+#include <stdexcept>
 #include "TextRenderer.hpp"
 #include "core/Engine.hpp"
 #include "graphics/Renderer.hpp"
@@ -22,7 +24,7 @@ namespace ouzel
             textAnchor(initTextAnchor),
             color(initColor)
         {
-            shader = engine->getCache().getShader(SHADER_TEXTURE);
+            shader = engine->getCache().getShader(SHADER_TEXT);
             blendState = engine->getCache().getBlendState(BLEND_ALPHA);
             whitePixelTexture = engine->getCache().getTexture(TEXTURE_WHITE_PIXEL);
 
@@ -31,6 +33,7 @@ namespace ouzel
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer());
             vertexBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC);
+            vertexBuffer->setVertexLayout(graphics::VertexLayout::TEXT);
 
             font = engine->getCache().getFont(fontFile);
 
@@ -76,19 +79,15 @@ namespace ouzel
                 needsMeshUpdate = false;
             }
 
+            assert(shader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()));
+
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
             float colorVector[] = {color.normR(), color.normG(), color.normB(), color.normA() * opacity};
 
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
             engine->getRenderer()->setCullMode(graphics::CullMode::NONE);
             engine->getRenderer()->setPipelineState(blendState->getResource(), shader->getResource());
-            engine->getRenderer()->setShaderConstants(fragmentShaderConstants,
-                                                      vertexShaderConstants);
+            engine->getRenderer()->setShaderConstants(colorVector, sizeof(colorVector),
+                                                      modelViewProj.m, sizeof(modelViewProj.m));
             engine->getRenderer()->setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
             engine->getRenderer()->draw(indexBuffer->getResource(),
                                         static_cast<uint32_t>(indices.size()),
@@ -110,6 +109,14 @@ namespace ouzel
             color = newColor;
         }
 
+        void TextRenderer::setShader(const std::shared_ptr<graphics::Shader>& newShader)
+        {
+            if (!newShader->getVertexLayout().isCompatible(vertexBuffer->getVertexLayout()))
+                throw std::runtime_error("Vertex layout of the buffer doesn't match the shader");
+
+            shader = newShader;
+        }
+
         void TextRenderer::updateText()
         {
             boundingBox.reset();
@@ -119,8 +126,8 @@ namespace ouzel
                 font->getVertices(text, Color::WHITE, fontSize, textAnchor, indices, vertices, texture);
                 needsMeshUpdate = true;
 
-                for (const graphics::Vertex& vertex : vertices)
-                    boundingBox.insertPoint(vertex.position);
+                for (const graphics::TextVertex& vertex : vertices)
+                    boundingBox.insertPoint(Vector3(vertex.position));
             }
             else
             {
@@ -128,6 +135,8 @@ namespace ouzel
                 vertices.clear();
                 texture.reset();
             }
+
+            invalidateBoundingBox();
         }
     } // namespace scene
 } // namespace ouzel
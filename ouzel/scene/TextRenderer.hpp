@@ -47,7 +47,8 @@ namespace ouzel
             void setColor(Color newColor);
 
             inline const std::shared_ptr<graphics::Shader>& getShader() const { return shader; }
-            inline void setShader(const std::shared_ptr<graphics::Shader>& newShader) { shader = newShader; }
+            // the shader must use graphics::VertexLayout::TEXT
+            void setShader(const std::shared_ptr<graphics::Shader>& newShader);
 
             inline const std::shared_ptr<graphics::BlendState>& getBlendState() const { return blendState; }
             inline void setBlendState(const std::shared_ptr<graphics::BlendState>& newBlendState)  { blendState = newBlendState; }
@@ -70,7 +71,7 @@ namespace ouzel
             Vector2 textAnchor;
 
             std::vector<uint16_t> indices;
-            std::vector<graphics::Vertex> vertices;
+            std::vector<graphics::TextVertex> vertices;
 
             Color color = Color::WHITE;
 
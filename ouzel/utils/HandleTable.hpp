@@ -0,0 +1,163 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_HANDLETABLE_HPP
+#define OUZEL_UTILS_HANDLETABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ouzel
+{
+    // allocates handles that consist of a slot index and the generation of the slot,
+    // the generation changes every time a handle is released, so that stale handles can be detected
+    class HandlePool final
+    {
+    public:
+        static constexpr uint32_t INDEX_BITS = 20;
+        static constexpr uint32_t INDEX_MASK = (1U << INDEX_BITS) - 1;
+        static constexpr uint32_t GENERATION_MASK = 0xFFFFFFFFU >> INDEX_BITS;
+
+        static inline uint32_t getIndex(uintptr_t handle) { return static_cast<uint32_t>(handle) & INDEX_MASK; }
+        static inline uint32_t getGeneration(uintptr_t handle) { return (static_cast<uint32_t>(handle) >> INDEX_BITS) & GENERATION_MASK; }
+
+        HandlePool() {}
+
+        HandlePool(const HandlePool&) = delete;
+        HandlePool& operator=(const HandlePool&) = delete;
+
+        HandlePool(HandlePool&&) = delete;
+        HandlePool& operator=(HandlePool&&) = delete;
+
+        uintptr_t allocate()
+        {
+            uint32_t index;
+
+            if (freeIndices.empty())
+            {
+                if (generations.size() > INDEX_MASK)
+                    throw std::runtime_error("Too many handles");
+
+                index = static_cast<uint32_t>(generations.size());
+                generations.push_back(1); // generation zero is not used, so that no handle is zero
+            }
+            else
+            {
+                index = freeIndices.back();
+                freeIndices.pop_back();
+            }
+
+            return (static_cast<uintptr_t>(generations[index]) << INDEX_BITS) | index;
+        }
+
+        // returns false if the handle was already released
+        bool release(uintptr_t handle)
+        {
+            if (!isValid(handle)) return false;
+
+            uint32_t index = getIndex(handle);
+            generations[index] = (generations[index] == GENERATION_MASK) ? 1 : generations[index] + 1;
+            freeIndices.push_back(index);
+
+            return true;
+        }
+
+        bool isValid(uintptr_t handle) const
+        {
+            uint32_t index = getIndex(handle);
+            return handle && index < generations.size() && generations[index] == getGeneration(handle);
+        }
+
+        inline size_t getSize() const { return generations.size() - freeIndices.size(); }
+
+    private:
+        std::vector<uint32_t> generations;
+        std::vector<uint32_t> freeIndices;
+    };
+
+    // objects of one type indexed by the handles of a HandlePool
+    template<class T>
+    class HandleTable final
+    {
+    public:
+        HandleTable() {}
+
+        HandleTable(const HandleTable&) = delete;
+        HandleTable& operator=(const HandleTable&) = delete;
+
+        HandleTable(HandleTable&&) = delete;
+        HandleTable& operator=(HandleTable&&) = delete;
+
+        // replaces the object if the handle is initialized again
+        void insert(uintptr_t handle, std::unique_ptr<T> object)
+        {
+            uint32_t index = HandlePool::getIndex(handle);
+            if (index >= slots.size()) slots.resize(index + 1);
+
+            slots[index].generation = HandlePool::getGeneration(handle);
+            slots[index].object = std::move(object);
+        }
+
+        // returns null for the null handle, throws for the handle of a deleted or uninitialized object
+        T* get(uintptr_t handle) const
+        {
+            if (!handle) return nullptr;
+
+            uint32_t index = HandlePool::getIndex(handle);
+
+            if (index >= slots.size() || !slots[index].object ||
+                slots[index].generation != HandlePool::getGeneration(handle))
+                throw std::runtime_error("Invalid or stale handle");
+
+            return slots[index].object.get();
+        }
+
+        // returns false if the handle was never initialized
+        bool erase(uintptr_t handle)
+        {
+            uint32_t index = HandlePool::getIndex(handle);
+
+            if (!handle || index >= slots.size() ||
+                slots[index].generation != HandlePool::getGeneration(handle))
+                return false;
+
+            slots[index].generation = 0;
+            slots[index].object.reset();
+            return true;
+        }
+
+        // removes the object from the table without destroying it
+        std::unique_ptr<T> take(uintptr_t handle)
+        {
+            get(handle); // validate the handle
+
+            Slot& slot = slots[HandlePool::getIndex(handle)];
+            slot.generation = 0;
+            return std::move(slot.object);
+        }
+
+        void clear()
+        {
+            slots.clear();
+        }
+
+        template<class F>
+        void forEach(F function) const
+        {
+            for (const Slot& slot : slots)
+                if (slot.object) function(*slot.object);
+        }
+
+    private:
+        struct Slot final
+        {
+            uint32_t generation = 0;
+            std::unique_ptr<T> object;
+        };
+
+        std::vector<Slot> slots;
+    };
+}
+
+#endif // OUZEL_UTILS_HANDLETABLE_HPP
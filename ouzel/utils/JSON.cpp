@@ -1,5 +1,7 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cstdlib>
 #include <stdexcept>
 #include "JSON.hpp"
 #include "Utils.hpp"
@@ -8,167 +10,466 @@ namespace ouzel
 {
     namespace json
     {
-        void Value::parseValue(const std::vector<Token>& tokens,
-                               std::vector<Token>::const_iterator& iterator)
+        static inline bool isWhitespace(uint8_t c)
         {
-            if (iterator == tokens.end())
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static inline bool isDigit(uint8_t c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        static inline void skipWhitespaces(const uint8_t*& iterator, const uint8_t* end)
+        {
+            while (iterator != end && isWhitespace(*iterator)) ++iterator;
+        }
+
+        static inline bool skipKeyword(const uint8_t*& iterator, const uint8_t* end,
+                                       const char* keyword, size_t length)
+        {
+            if (static_cast<size_t>(end - iterator) < length ||
+                !std::equal(keyword, keyword + length, iterator))
+                return false;
+
+            iterator += length;
+            return true;
+        }
+
+        static void appendUtf8(std::string& result, uint32_t c)
+        {
+            if (c <= 0x7F)
+                result.push_back(static_cast<char>(c));
+            else if (c <= 0x7FF)
+            {
+                result.push_back(static_cast<char>(0xC0 | ((c >> 6) & 0x1F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else if (c <= 0xFFFF)
+            {
+                result.push_back(static_cast<char>(0xE0 | ((c >> 12) & 0x0F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else
+            {
+                result.push_back(static_cast<char>(0xF0 | ((c >> 18) & 0x07)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+        }
+
+        static uint32_t parseHex(const uint8_t*& iterator, const uint8_t* end)
+        {
+            if (end - iterator < 4)
                 throw std::runtime_error("Unexpected end of data");
 
-            if (iterator->type == Token::Type::LEFT_BRACE)
-                return parseObject(tokens, iterator);
-            else if (iterator->type == Token::Type::LEFT_BRACKET)
-                return parseArray(tokens, iterator);
-            else if (iterator->type == Token::Type::LITERAL_NUMBER)
+            uint32_t c = 0;
+
+            for (uint32_t i = 0; i < 4; ++i, ++iterator)
             {
-                type = Type::NUMBER;
-                doubleValue = std::stod(utf32ToUtf8(iterator->value));
-                ++iterator;
+                uint8_t code = 0;
+
+                if (*iterator >= '0' && *iterator <= '9') code = *iterator - '0';
+                else if (*iterator >= 'a' && *iterator <= 'f') code = *iterator - 'a' + 10;
+                else if (*iterator >= 'A' && *iterator <= 'F') code = *iterator - 'A' + 10;
+                else
+                    throw std::runtime_error("Invalid character code");
+
+                c = (c << 4) | code;
             }
-            else if (iterator->type == Token::Type::OPERATOR_MINUS)
+
+            return c;
+        }
+
+        // the UTF-8 bytes are copied as they are, only the escape sequences are decoded
+        static void parseString(const uint8_t*& iterator, const uint8_t* end, std::string& result)
+        {
+            ++iterator; // skip the quotation mark
+
+            for (;;)
             {
-                if (++iterator == tokens.end())
-                    throw std::runtime_error("Unexpected end of data");
+                const uint8_t* start = iterator;
+                while (iterator != end && *iterator != '"' && *iterator != '\\' && *iterator > 0x1F)
+                    ++iterator;
+
+                result.append(reinterpret_cast<const char*>(start), static_cast<size_t>(iterator - start));
 
-                if (iterator->type != Token::Type::LITERAL_NUMBER)
-                    throw std::runtime_error("Expected a number");
+                if (iterator == end)
+                    throw std::runtime_error("Unterminated string literal");
+
+                if (*iterator == '"')
+                {
+                    ++iterator;
+                    break;
+                }
+                else if (*iterator == '\\')
+                {
+                    if (++iterator == end)
+                        throw std::runtime_error("Unterminated string literal");
+
+                    uint8_t c = *iterator++;
+
+                    if (c == '"') result.push_back('"');
+                    else if (c == '\\') result.push_back('\\');
+                    else if (c == '/') result.push_back('/');
+                    else if (c == 'b') result.push_back('\b');
+                    else if (c == 'f') result.push_back('\f');
+                    else if (c == 'n') result.push_back('\n');
+                    else if (c == 'r') result.push_back('\r');
+                    else if (c == 't') result.push_back('\t');
+                    else if (c == 'u')
+                    {
+                        uint32_t code = parseHex(iterator, end);
 
-                type = Type::NUMBER;
-                doubleValue = -std::stod(utf32ToUtf8(iterator->value));
-                ++iterator;
+                        // surrogate pair
+                        if (code >= 0xD800 && code <= 0xDBFF &&
+                            end - iterator >= 6 && iterator[0] == '\\' && iterator[1] == 'u')
+                        {
+                            const uint8_t* next = iterator + 2;
+                            uint32_t low = parseHex(next, end);
+
+                            if (low >= 0xDC00 && low <= 0xDFFF)
+                            {
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                                iterator = next;
+                            }
+                        }
+
+                        appendUtf8(result, code);
+                    }
+                    else
+                        throw std::runtime_error("Unrecognized escape character");
+                }
+                else
+                    throw std::runtime_error("Unterminated string literal");
             }
-            else if (iterator->type == Token::Type::LITERAL_STRING)
+        }
+
+        static double parseNumber(const uint8_t*& iterator, const uint8_t* end)
+        {
+            const uint8_t* start = iterator;
+
+            bool negative = false;
+            if (*iterator == '-')
             {
-                type = Type::STRING;
-                stringValue = utf32ToUtf8(iterator->value);
-                ++iterator;
+                negative = true;
+                if (++iterator == end)
+                    throw std::runtime_error("Unexpected end of data");
             }
-            else if (iterator->type == Token::Type::KEYWORD_TRUE ||
-                     iterator->type == Token::Type::KEYWORD_FALSE)
+
+            if (!isDigit(*iterator) &&
+                (*iterator != '.' || iterator + 1 == end || !isDigit(*(iterator + 1))))
+                throw std::runtime_error("Expected a number");
+
+            uint64_t integer = 0;
+            uint32_t digits = 0;
+
+            for (; iterator != end && isDigit(*iterator); ++iterator, ++digits)
+                integer = integer * 10 + static_cast<uint64_t>(*iterator - '0');
+
+            // integers that fit into the mantissa don't need strtod
+            if ((iterator == end || (*iterator != '.' && *iterator != 'e' && *iterator != 'E')) &&
+                digits <= 15)
             {
-                type = Type::BOOLEAN;
-                boolValue = (iterator->type == Token::Type::KEYWORD_TRUE);
-                ++iterator;
+                double result = static_cast<double>(integer);
+                return negative ? -result : result;
             }
-            else if (iterator->type == Token::Type::KEYWORD_NULL)
+
+            if (iterator != end && *iterator == '.')
+                for (++iterator; iterator != end && isDigit(*iterator); ++iterator);
+
+            if (iterator != end && (*iterator == 'e' || *iterator == 'E'))
             {
-                type = Type::OBJECT;
-                nullValue = true;
-                ++iterator;
+                if (++iterator != end && (*iterator == '+' || *iterator == '-')) ++iterator;
+
+                if (iterator == end || !isDigit(*iterator))
+                    throw std::runtime_error("Invalid exponent");
+
+                for (; iterator != end && isDigit(*iterator); ++iterator);
+            }
+
+            // the data is not null-terminated
+            char buffer[64];
+            std::string longNumber;
+            const char* number = buffer;
+            size_t length = static_cast<size_t>(iterator - start);
+
+            if (length < sizeof(buffer))
+            {
+                std::copy(start, iterator, buffer);
+                buffer[length] = '\0';
             }
             else
-                throw std::runtime_error("Expected a value");
+            {
+                longNumber.assign(start, iterator);
+                number = longNumber.c_str();
+            }
+
+            return std::strtod(number, nullptr);
         }
 
-        void Value::parseObject(const std::vector<Token>& tokens,
-                                std::vector<Token>::const_iterator& iterator)
+        void Value::parseValue(const uint8_t*& iterator, const uint8_t* end)
         {
-            if (iterator == tokens.end())
+            skipWhitespaces(iterator, end);
+
+            if (iterator == end)
                 throw std::runtime_error("Unexpected end of data");
 
-            if (iterator->type != Token::Type::LEFT_BRACE)
-                throw std::runtime_error("Expected a left brace");
+            switch (*iterator)
+            {
+                case '{':
+                    parseObject(iterator, end);
+                    break;
+                case '[':
+                    parseArray(iterator, end);
+                    break;
+                case '"':
+                    setType(Type::STRING);
+                    parseString(iterator, end, stringValue);
+                    break;
+                case 't':
+                case 'f':
+                    if (skipKeyword(iterator, end, "true", 4))
+                        *this = true;
+                    else if (skipKeyword(iterator, end, "false", 5))
+                        *this = false;
+                    else
+                        throw std::runtime_error("Unknown keyword");
+                    break;
+                case 'n':
+                    if (!skipKeyword(iterator, end, "null", 4))
+                        throw std::runtime_error("Unknown keyword");
+                    *this = nullptr;
+                    break;
+                default:
+                    if (*iterator == '-' || *iterator == '.' || isDigit(*iterator))
+                        *this = parseNumber(iterator, end);
+                    else
+                        throw std::runtime_error("Expected a value");
+            }
+        }
 
+        void Value::parseObject(const uint8_t*& iterator, const uint8_t* end)
+        {
             ++iterator; // skip the left brace
 
-            bool first = true;
+            setType(Type::OBJECT);
+            nullValue = false;
 
-            for (;;)
+            for (bool first = true;; first = false)
             {
-                if (iterator == tokens.end())
+                skipWhitespaces(iterator, end);
+
+                if (iterator == end)
                     throw std::runtime_error("Unexpected end of data");
 
-                if (iterator->type == Token::Type::RIGHT_BRACE)
+                if (*iterator == '}')
                 {
-                    ++iterator;// skip the right brace
+                    ++iterator; // skip the right brace
                     break;
                 }
 
-                if (first)
-                    first = false;
-                else
+                if (!first)
                 {
-                    if (iterator->type != Token::Type::COMMA)
+                    if (*iterator != ',')
                         throw std::runtime_error("Expected a comma");
 
-                    if (++iterator == tokens.end())
+                    skipWhitespaces(++iterator, end);
+
+                    if (iterator == end)
                         throw std::runtime_error("Unexpected end of data");
                 }
 
-                if (iterator->type != Token::Type::LITERAL_STRING)
+                if (*iterator != '"')
                     throw std::runtime_error("Expected a string literal");
 
-                std::string key = utf32ToUtf8(iterator->value);
+                objectValue.push_back(std::make_pair(std::string(), Value()));
+                parseString(iterator, end, objectValue.back().first);
 
-                if (objectValue.find(key) != objectValue.end())
-                    throw std::runtime_error("Duplicate key value " + key);
+                skipWhitespaces(iterator, end);
 
-                if (++iterator == tokens.end())
+                if (iterator == end)
                     throw std::runtime_error("Unexpected end of data");
 
-                if (iterator->type != Token::Type::COLON)
+                if (*iterator != ':')
                     throw std::runtime_error("Expected a colon");
 
-                if (++iterator == tokens.end())
-                    throw std::runtime_error("Unexpected end of data");
-
-                Value value;
-                value.parseValue(tokens, iterator);
-
-                objectValue[key] = value;
+                objectValue.back().second.parseValue(++iterator, end);
             }
 
-            type = Type::OBJECT;
+            std::sort(objectValue.begin(), objectValue.end(),
+                      [](const std::pair<std::string, Value>& a, const std::pair<std::string, Value>& b) {
+                return a.first < b.first;
+            });
+
+            for (size_t i = 1; i < objectValue.size(); ++i)
+                if (objectValue[i - 1].first == objectValue[i].first)
+                    throw std::runtime_error("Duplicate key value " + objectValue[i].first);
         }
 
-        void Value::parseArray(const std::vector<Token>& tokens,
-                               std::vector<Token>::const_iterator& iterator)
+        void Value::parseArray(const uint8_t*& iterator, const uint8_t* end)
         {
-            if (iterator == tokens.end())
-                throw std::runtime_error("Unexpected end of data");
-
-            if (iterator->type != Token::Type::LEFT_BRACKET)
-                throw std::runtime_error("Expected a left bracket");
-
             ++iterator; // skip the left bracket
 
-            bool first = true;
+            setType(Type::ARRAY);
 
-            for (;;)
+            for (bool first = true;; first = false)
             {
-                if (iterator == tokens.end())
+                skipWhitespaces(iterator, end);
+
+                if (iterator == end)
                     throw std::runtime_error("Unexpected end of data");
 
-                if (iterator->type == Token::Type::RIGHT_BRACKET)
+                if (*iterator == ']')
                 {
-                    ++iterator;// skip the right bracket
+                    ++iterator; // skip the right bracket
                     break;
                 }
 
-                if (first)
-                    first = false;
-                else
+                if (!first)
                 {
-                    if (iterator->type != Token::Type::COMMA)
+                    if (*iterator != ',')
                         throw std::runtime_error("Expected a comma");
 
-                    if (++iterator == tokens.end())
-                        throw std::runtime_error("Unexpected end of data");
+                    ++iterator;
                 }
 
-                Value value;
-                value.parseValue(tokens, iterator);
+                arrayValue.push_back(Value());
+                arrayValue.back().parseValue(iterator, end);
+            }
+        }
+
+        const Value& Value::getEmptyValue()
+        {
+            static const Value emptyValue;
+            return emptyValue;
+        }
+
+        const std::string& Value::getEmptyString()
+        {
+            static const std::string emptyString;
+            return emptyString;
+        }
+
+        const Value::Object& Value::getEmptyObject()
+        {
+            static const Object emptyObject;
+            return emptyObject;
+        }
+
+        const Value::Array& Value::getEmptyArray()
+        {
+            static const Array emptyArray;
+            return emptyArray;
+        }
+
+        void Value::setType(Type newType)
+        {
+            if (type == newType) return;
+
+            switch (type)
+            {
+                case Type::STRING: stringValue.~basic_string(); break;
+                case Type::OBJECT: objectValue.~Object(); break;
+                case Type::ARRAY: arrayValue.~Array(); break;
+                default: break;
+            }
 
-                arrayValue.push_back(value);
+            switch (newType)
+            {
+                case Type::STRING: new (&stringValue) std::string(); break;
+                case Type::OBJECT: new (&objectValue) Object(); break;
+                case Type::ARRAY: new (&arrayValue) Array(); break;
+                case Type::BOOLEAN: boolValue = false; break;
+                default: doubleValue = 0.0; break;
+            }
+
+            type = newType;
+        }
+
+        void Value::copy(const Value& other)
+        {
+            switch (other.type)
+            {
+                case Type::STRING: new (&stringValue) std::string(other.stringValue); break;
+                case Type::OBJECT: new (&objectValue) Object(other.objectValue); break;
+                case Type::ARRAY: new (&arrayValue) Array(other.arrayValue); break;
+                case Type::BOOLEAN: boolValue = other.boolValue; break;
+                default: doubleValue = other.doubleValue; break;
+            }
+
+            type = other.type;
+            nullValue = other.nullValue;
+        }
+
+        void Value::move(Value&& other) noexcept
+        {
+            switch (other.type)
+            {
+                case Type::STRING: new (&stringValue) std::string(std::move(other.stringValue)); break;
+                case Type::OBJECT: new (&objectValue) Object(std::move(other.objectValue)); break;
+                case Type::ARRAY: new (&arrayValue) Array(std::move(other.arrayValue)); break;
+                case Type::BOOLEAN: boolValue = other.boolValue; break;
+                default: doubleValue = other.doubleValue; break;
+            }
+
+            type = other.type;
+            nullValue = other.nullValue;
+        }
+
+        void Value::sortMembers(Object& members)
+        {
+            std::stable_sort(members.begin(), members.end(),
+                             [](const std::pair<std::string, Value>& a, const std::pair<std::string, Value>& b) {
+                return a.first < b.first;
+            });
+
+            size_t count = 0;
+
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                if (count > 0 && members[count - 1].first == members[i].first)
+                    members[count - 1].second = std::move(members[i].second);
+                else if (count++ != i)
+                    members[count - 1] = std::move(members[i]);
             }
 
-            type = Type::ARRAY;
+            members.erase(members.begin() + static_cast<ptrdiff_t>(count), members.end());
+        }
+
+        Value::Object::iterator Value::lowerBound(const std::string& member)
+        {
+            return std::lower_bound(objectValue.begin(), objectValue.end(), member,
+                                    [](const std::pair<std::string, Value>& a, const std::string& b) {
+                return a.first < b;
+            });
+        }
+
+        Value::Object::const_iterator Value::findMember(const std::string& member) const
+        {
+            auto i = std::lower_bound(objectValue.begin(), objectValue.end(), member,
+                                      [](const std::pair<std::string, Value>& a, const std::string& b) {
+                return a.first < b;
+            });
+
+            return (i != objectValue.end() && i->first == member) ? i : objectValue.end();
+        }
+
+        Value::Object::iterator Value::findMember(const std::string& member)
+        {
+            auto i = lowerBound(member);
+            return (i != objectValue.end() && i->first == member) ? i : objectValue.end();
         }
 
         static void encodeString(std::vector<uint8_t>& data,
-                                 const std::vector<uint32_t>& str)
+                                 const std::string& str)
         {
-            for (uint32_t c : str)
+            for (char character : str)
             {
+                uint8_t c = static_cast<uint8_t>(character);
+
                 if (c == '"') data.insert(data.end(), {'\\', '"'});
                 else if (c == '\\') data.insert(data.end(), {'\\', '\\'});
                 else if (c == '/') data.insert(data.end(), {'\\', '/'});
@@ -183,11 +484,8 @@ namespace ouzel
                     std::string hexValue = hexToString(c, 4);
                     data.insert(data.end(), hexValue.begin(), hexValue.end());
                 }
-                else
-                {
-                    std::string encoded = utf32ToUtf8(c);
-                    data.insert(data.end(), encoded.begin(), encoded.end());
-                }
+                else // UTF-8 bytes don't need to be escaped
+                    data.push_back(c);
             }
         }
 
@@ -203,7 +501,7 @@ namespace ouzel
                 }
                 case Type::STRING:
                     data.push_back('"');
-                    encodeString(data, utf8ToUtf32(stringValue));
+                    encodeString(data, stringValue);
                     data.push_back('"');
                     break;
                 case Type::OBJECT:
@@ -222,7 +520,7 @@ namespace ouzel
                             else data.push_back(',');
 
                             data.push_back('"');
-                            encodeString(data, utf8ToUtf32(value.first));
+                            encodeString(data, value.first);
                             data.insert(data.end(), {'"', ':'});
                             value.second.encodeValue(data);
                         }
@@ -262,216 +560,32 @@ namespace ouzel
         {
         }
 
-        static inline bool isWhitespace(uint32_t c)
+        Data::Data(const std::vector<uint8_t>& data):
+            Data(data.data(), data.size())
         {
-            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
         }
 
-        static inline bool isControlChar(uint32_t c)
+        Data::Data(const uint8_t* data, size_t size)
         {
-            return c <= 0x1F;
-        }
-
-        static std::vector<Token> tokenize(const std::vector<uint32_t>& str)
-        {
-            std::vector<Token> tokens;
-
-            static const std::map<std::vector<uint32_t>, Token::Type> keywordMap = {
-                {{'t', 'r', 'u', 'e'}, Token::Type::KEYWORD_TRUE},
-                {{'f', 'a', 'l', 's', 'e'}, Token::Type::KEYWORD_FALSE},
-                {{'n', 'u', 'l', 'l'}, Token::Type::KEYWORD_NULL}
-            };
-
-            // tokenize
-            for (auto iterator = str.cbegin(); iterator != str.cend();)
-            {
-                Token token;
-
-                if (*iterator == '{' || *iterator == '}' ||
-                    *iterator == '[' || *iterator == ']' ||
-                    *iterator == ',' || *iterator == ':') // punctuation
-                {
-                    if (*iterator == '{') token.type = Token::Type::LEFT_BRACE;
-                    if (*iterator == '}') token.type = Token::Type::RIGHT_BRACE;
-                    if (*iterator == '[') token.type = Token::Type::LEFT_BRACKET;
-                    if (*iterator == ']') token.type = Token::Type::RIGHT_BRACKET;
-                    if (*iterator == ',') token.type = Token::Type::COMMA;
-                    if (*iterator == ':') token.type = Token::Type::COLON;
-                    token.value.push_back(*iterator);
-
-                    ++iterator;
-                }
-                else if ((*iterator >= '0' && *iterator <= '9') ||  // number
-                         (*iterator == '.' && (iterator + 1) != str.end() &&
-                          *(iterator + 1) >= '0' && *(iterator + 1) <= '9')) // starts with a dot
-                {
-                    token.type = Token::Type::LITERAL_NUMBER;
-
-                    while (iterator != str.end() &&
-                           (*iterator >= '0' && *iterator <= '9'))
-                    {
-                        token.value.push_back(*iterator);
-                        ++iterator;
-                    }
-
-                    if (iterator != str.end() && *iterator == '.')
-                    {
-                        token.value.push_back(*iterator);
-                        ++iterator;
-
-                        while (iterator != str.end() &&
-                               (*iterator >= '0' && *iterator <= '9'))
-                        {
-                            token.value.push_back(*iterator);
-                            ++iterator;
-                        }
-                    }
-
-                    // parse exponent
-                    if (iterator != str.end() &&
-                        (*iterator == 'e' || *iterator == 'E'))
-                    {
-                        token.value.push_back(*iterator);
-
-                        if (++iterator == str.end() || (*iterator != '+' && *iterator != '-'))
-                            throw std::runtime_error("Invalid exponent");
-
-                        token.value.push_back(*iterator);
-
-                        if (++iterator == str.end() || *iterator < '0' || *iterator > '9')
-                            throw std::runtime_error("Invalid exponent");
-
-                        while (iterator != str.end() &&
-                               (*iterator >= '0' && *iterator <= '9'))
-                        {
-                            token.value.push_back(*iterator);
-                            ++iterator;
-                        }
-                    }
-                }
-                else if (*iterator == '"') // string literal
-                {
-                    token.type = Token::Type::LITERAL_STRING;
-
-                    for (;;)
-                    {
-                        if (++iterator == str.end())
-                            throw std::runtime_error("Unterminated string literal");
-
-                        if (*iterator == '"')
-                        {
-                            ++iterator;
-                            break;
-                        }
-                        else if (*iterator == '\\')
-                        {
-                            if (++iterator == str.end())
-                                throw std::runtime_error("Unterminated string literal");
-
-                            if (*iterator == '"') token.value.push_back('"');
-                            else if (*iterator == '\\') token.value.push_back('\\');
-                            else if (*iterator == '/') token.value.push_back('/');
-                            else if (*iterator == 'b') token.value.push_back('\b');
-                            else if (*iterator == 'f') token.value.push_back('\f');
-                            else if (*iterator == 'n') token.value.push_back('\n');
-                            else if (*iterator == 'r') token.value.push_back('\r');
-                            else if (*iterator == 't') token.value.push_back('\t');
-                            else if (*iterator == 'u')
-                            {
-                                if (std::distance<std::vector<uint32_t>::const_iterator>(++iterator, str.end()) < 4)
-                                    throw std::runtime_error("Unexpected end of data");
-
-                                uint32_t c = 0;
-
-                                for (uint32_t i = 0; i < 4; ++i, ++iterator)
-                                {
-                                    uint8_t code = 0;
-
-                                    if (*iterator >= '0' && *iterator <= '9') code = static_cast<uint8_t>(*iterator) - '0';
-                                    else if (*iterator >= 'a' && *iterator <='f') code = static_cast<uint8_t>(*iterator) - 'a' + 10;
-                                    else if (*iterator >= 'A' && *iterator <='F') code = static_cast<uint8_t>(*iterator) - 'A' + 10;
-                                    else
-                                        throw std::runtime_error("Invalid character code");
-
-                                    c = (c << 4) | code;
-                                }
-
-                                token.value.push_back(c);
-                            }
-                            else
-                                throw std::runtime_error("Unrecognized escape character");
-                        }
-                        else if (isControlChar(*iterator))
-                            throw std::runtime_error("Unterminated string literal");
-                        else
-                            token.value.push_back(*iterator);
-                    }
-                }
-                else if ((*iterator >= 'a' && *iterator <= 'z') ||
-                         (*iterator >= 'A' && *iterator <= 'Z') ||
-                         *iterator == '_')
-                {
-                    while (iterator != str.end() &&
-                           ((*iterator >= 'a' && *iterator <= 'z') ||
-                            (*iterator >= 'A' && *iterator <= 'Z') ||
-                            *iterator == '_' ||
-                            (*iterator >= '0' && *iterator <= '9')))
-                    {
-                        token.value.push_back(*iterator);
-                        ++iterator;
-                    }
-
-                    std::map<std::vector<uint32_t>, Token::Type>::const_iterator keywordIterator;
-
-                    if ((keywordIterator = keywordMap.find(token.value)) != keywordMap.end())
-                        token.type = keywordIterator->second;
-                    else
-                        throw std::runtime_error("Unknown keyword " + utf32ToUtf8(token.value));
-                }
-                else if (*iterator == '-')
-                {
-                    token.type = Token::Type::OPERATOR_MINUS;
-                    token.value.push_back(*iterator);
-                    ++iterator;
-                }
-                else if (isWhitespace(*iterator)) // whitespace
-                {
-                    ++iterator;
-                    continue;
-                }
-                else
-                    throw std::runtime_error("Unknown character");
-
-                tokens.push_back(token);
-            }
-
-            return tokens;
-        }
-
-        Data::Data(const std::vector<uint8_t>& data)
-        {
-            std::vector<uint32_t> str;
+            const uint8_t* iterator = data;
+            const uint8_t* end = data + size;
 
             // BOM
-            if (data.size() >= 3 &&
+            if (size >= 3 &&
                 data[0] == 0xEF &&
                 data[1] == 0xBB &&
                 data[2] == 0xBF)
             {
                 bom = true;
-                str = utf8ToUtf32(std::vector<uint8_t>(data.begin() + 3, data.end()));
-            }
-            else
-            {
-                bom = false;
-                str = utf8ToUtf32(data);
+                iterator += 3;
             }
 
-            std::vector<Token> tokens = tokenize(str);
+            parseValue(iterator, end);
 
-            auto iterator = tokens.cbegin();
+            skipWhitespaces(iterator, end);
 
-            parseValue(tokens, iterator);
+            if (iterator != end)
+                throw std::runtime_error("Unexpected data after the value");
         }
 
         std::vector<uint8_t> Data::encode() const
@@ -4,43 +4,25 @@
 #define OUZEL_UTILS_JSON_HPP
 
 #include <cassert>
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ouzel
 {
     namespace json
     {
-        struct Token final
-        {
-            enum class Type
-            {
-                NONE,
-                LITERAL_NUMBER, // float
-                LITERAL_STRING, // string
-                KEYWORD_TRUE, // true
-                KEYWORD_FALSE, // false
-                KEYWORD_NULL, // null
-                LEFT_BRACE, // {
-                RIGHT_BRACE, // }
-                LEFT_BRACKET, // [
-                RIGHT_BRACKET, // ]
-                COMMA, // ,
-                COLON, // :
-                OPERATOR_MINUS // -
-            };
-
-            Type type = Type::NONE;
-            std::vector<uint32_t> value;
-        };
-
+        // tagged union, only the member of the current type is constructed
         class Value
         {
         public:
             using Array = std::vector<Value>;
-            using Object = std::map<std::string, Value>;
+            // members sorted by key, without duplicates
+            using Object = std::vector<std::pair<std::string, Value>>;
 
             enum class Type
             {
@@ -53,72 +35,103 @@ namespace ouzel
             };
 
             Value() {}
-            Value(Type initType): type(initType) {}
+            Value(Type initType) { setType(initType); }
             Value(double value): type(Type::NUMBER), doubleValue(value) {}
-            Value(const std::string& value): type(Type::STRING), stringValue(value) {}
+            Value(const std::string& value): type(Type::STRING) { new (&stringValue) std::string(value); }
             Value(bool value): type(Type::BOOLEAN), boolValue(value) {}
-            Value(std::nullptr_t): type(Type::OBJECT), nullValue(true) {}
-            Value(const Array& value): type(Type::ARRAY), arrayValue(value) {}
-            Value(const Object& value): type(Type::OBJECT), objectValue(value) {}
+            Value(std::nullptr_t): nullValue(true) { setType(Type::OBJECT); }
+            Value(const Array& value): type(Type::ARRAY) { new (&arrayValue) Array(value); }
+            Value(const Object& value): type(Type::OBJECT)
+            {
+                new (&objectValue) Object(value);
+                sortMembers(objectValue);
+            }
+
+            Value(const Value& other) { copy(other); }
+            Value(Value&& other) noexcept { move(std::move(other)); }
+
+            ~Value() { setType(Type::NONE); }
+
+            Value& operator=(const Value& other)
+            {
+                if (&other != this)
+                {
+                    setType(Type::NONE);
+                    copy(other);
+                }
+
+                return *this;
+            }
+
+            Value& operator=(Value&& other) noexcept
+            {
+                if (&other != this)
+                {
+                    setType(Type::NONE);
+                    move(std::move(other));
+                }
+
+                return *this;
+            }
 
             inline Value& operator=(Type newType)
             {
-                type = newType;
+                setType(newType);
                 return *this;
             }
 
             inline Value& operator=(double value)
             {
-                type = Type::NUMBER;
+                setType(Type::NUMBER);
                 doubleValue = value;
                 return *this;
             }
 
             inline Value& operator=(int32_t value)
             {
-                type = Type::NUMBER;
+                setType(Type::NUMBER);
                 doubleValue = static_cast<double>(value);
                 return *this;
             }
 
             inline Value& operator=(uint32_t value)
             {
-                type = Type::NUMBER;
+                setType(Type::NUMBER);
                 doubleValue = static_cast<double>(value);
                 return *this;
             }
 
             inline Value& operator=(int64_t value)
             {
-                type = Type::NUMBER;
+                setType(Type::NUMBER);
                 doubleValue = static_cast<double>(value);
                 return *this;
             }
 
             inline Value& operator=(uint64_t value)
             {
-                type = Type::NUMBER;
+                setType(Type::NUMBER);
                 doubleValue = static_cast<double>(value);
                 return *this;
             }
 
             inline Value& operator=(const std::string& value)
             {
-                type = Type::STRING;
+                setType(Type::STRING);
                 stringValue = value;
                 return *this;
             }
 
             inline Value& operator=(bool value)
             {
-                type = Type::BOOLEAN;
+                setType(Type::BOOLEAN);
                 boolValue = value;
                 return *this;
             }
 
             inline Value& operator=(std::nullptr_t)
             {
-                type = Type::OBJECT;
+                setType(Type::OBJECT);
                 nullValue = true;
                 objectValue.clear();
                 return *this;
@@ -126,15 +139,16 @@ namespace ouzel
 
             inline Value& operator=(const Array& value)
             {
-                type = Type::ARRAY;
+                setType(Type::ARRAY);
                 arrayValue = value;
                 return *this;
             }
 
             inline Value& operator=(const Object& value)
             {
-                type = Type::OBJECT;
+                setType(Type::OBJECT);
                 objectValue = value;
+                sortMembers(objectValue);
                 nullValue = false;
                 return *this;
             }
@@ -145,14 +159,14 @@ namespace ouzel
             const std::string& as() const
             {
                 assert(type == Type::STRING);
-                return stringValue;
+                return (type == Type::STRING) ? stringValue : getEmptyString();
             }
 
             template<typename T, typename std::enable_if<std::is_same<T, const char*>::value>::type* = nullptr>
             const char* as() const
             {
                 assert(type == Type::STRING);
-                return stringValue.c_str();
+                return (type == Type::STRING) ? stringValue.c_str() : "";
             }
 
             template<typename T, typename std::enable_if<std::is_same<T, bool>::value>::type* = nullptr>
@@ -160,7 +174,8 @@ namespace ouzel
             {
                 assert(type == Type::BOOLEAN || type == Type::NUMBER);
                 if (type == Type::BOOLEAN) return boolValue;
-                else return doubleValue != 0.0;
+                else if (type == Type::NUMBER) return doubleValue != 0.0;
+                else return false;
             }
 
             template<typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type* = nullptr>
@@ -168,27 +183,21 @@ namespace ouzel
             {
                 assert(type == Type::BOOLEAN || type == Type::NUMBER);
                 if (type == Type::BOOLEAN) return boolValue;
-                else return static_cast<T>(doubleValue);
-            }
-
-            template<typename T, typename std::enable_if<std::is_same<T, Object>::value>::type* = nullptr>
-            inline Object& as()
-            {
-                type = Type::OBJECT;
-                return objectValue;
+                else if (type == Type::NUMBER) return static_cast<T>(doubleValue);
+                else return T();
             }
 
             template<typename T, typename std::enable_if<std::is_same<T, Object>::value>::type* = nullptr>
             inline const Object& as() const
             {
                 assert(type == Type::OBJECT);
-                return objectValue;
+                return (type == Type::OBJECT) ? objectValue : getEmptyObject();
             }
 
             template<typename T, typename std::enable_if<std::is_same<T, Array>::value>::type* = nullptr>
             inline Array& as()
             {
-                type = Type::ARRAY;
+                setType(Type::ARRAY);
                 return arrayValue;
             }
 
@@ -196,7 +205,7 @@ namespace ouzel
             inline const Array& as() const
             {
                 assert(type == Type::ARRAY);
-                return arrayValue;
+                return (type == Type::ARRAY) ? arrayValue : getEmptyArray();
             }
 
             inline bool isNull() const
@@ -208,63 +217,93 @@ namespace ouzel
             inline bool hasMember(const std::string& member) const
             {
                 assert(type == Type::OBJECT);
-                return objectValue.find(member) != objectValue.end();
+                return type == Type::OBJECT && findMember(member) != objectValue.end();
+            }
+
+            // inserts the member at its sorted position or replaces the value of an existing one
+            inline Value& insertMember(const std::string& member, Value value)
+            {
+                return (*this)[member] = std::move(value);
             }
 
             inline Value& operator[](const std::string& member)
             {
-                type = Type::OBJECT;
+                setType(Type::OBJECT);
                 nullValue = false;
-                return objectValue[member];
+
+                auto i = findMember(member);
+                if (i == objectValue.end())
+                    i = objectValue.insert(lowerBound(member), std::make_pair(member, Value()));
+
+                return i->second;
             }
 
-            inline Value operator[](const std::string& member) const
+            // returns an empty value if there is no such member
+            inline const Value& operator[](const std::string& member) const
             {
                 assert(type == Type::OBJECT);
+                if (type != Type::OBJECT) return getEmptyValue();
 
-                auto i = objectValue.find(member);
+                auto i = findMember(member);
                 if (i != objectValue.end()) return i->second;
-                else return Value();
+                else return getEmptyValue();
             }
 
             inline Value& operator[](size_t index)
             {
-                type = Type::ARRAY;
+                setType(Type::ARRAY);
                 if (index >= arrayValue.size()) arrayValue.resize(index + 1);
                 return arrayValue[index];
             }
 
-            inline Value operator[](size_t index) const
+            // returns an empty value if the index is out of range
+            inline const Value& operator[](size_t index) const
             {
                 assert(type == Type::ARRAY);
 
-                if (index < arrayValue.size()) return arrayValue[index];
-                else return Value();
+                if (type == Type::ARRAY && index < arrayValue.size()) return arrayValue[index];
+                else return getEmptyValue();
             }
 
             inline size_t getSize() const
             {
                 assert(type == Type::ARRAY);
-                return arrayValue.size();
+                return (type == Type::ARRAY) ? arrayValue.size() : 0;
             }
 
         protected:
-            void parseValue(const std::vector<Token>& tokens,
-                            std::vector<Token>::const_iterator& iterator);
-            void parseObject(const std::vector<Token>& tokens,
-                             std::vector<Token>::const_iterator& iterator);
-            void parseArray(const std::vector<Token>& tokens,
-                            std::vector<Token>::const_iterator& iterator);
+            void parseValue(const uint8_t*& iterator, const uint8_t* end);
+            void parseObject(const uint8_t*& iterator, const uint8_t* end);
+            void parseArray(const uint8_t*& iterator, const uint8_t* end);
             void encodeValue(std::vector<uint8_t>& data) const;
 
         private:
+            // returned by the const accessors for values of a different type, only the active union member can be read
+            static const Value& getEmptyValue();
+            static const std::string& getEmptyString();
+            static const Object& getEmptyObject();
+            static const Array& getEmptyArray();
+
+            void setType(Type newType);
+            void copy(const Value& other);
+            void move(Value&& other) noexcept;
+
+            // sorts the members by key, of the members with the same key the last one is kept
+            static void sortMembers(Object& members);
+            Object::iterator lowerBound(const std::string& member);
+            Object::const_iterator findMember(const std::string& member) const;
+            Object::iterator findMember(const std::string& member);
+
             Type type = Type::NONE;
-            bool boolValue = false;
             bool nullValue = false;
-            double doubleValue = 0.0;
-            Object objectValue;
-            Array arrayValue;
-            std::string stringValue;
+            union
+            {
+                double doubleValue = 0.0;
+                bool boolValue;
+                std::string stringValue;
+                Object objectValue;
+                Array arrayValue;
+            };
         };
 
         class Data final: public Value
@@ -272,6 +311,7 @@ namespace ouzel
         public:
             Data();
             Data(const std::vector<uint8_t>& data);
+            Data(const uint8_t* data, size_t size);
 
             std::vector<uint8_t> encode() const;
 
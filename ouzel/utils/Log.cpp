@@ -1,6 +1,10 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include "core/Setup.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
 #include <iostream>
 #include <string>
 
@@ -22,90 +26,381 @@
 #endif
 
 #include "Log.hpp"
+#include "Utils.hpp"
 
 namespace ouzel
 {
+    constexpr Log::Level Log::MAX_LEVEL;
+
+    // the standard streams are flushed only if flush is set
+    static void writeConsole(Log::Level level, const std::string& s, bool flush)
+    {
+        typedef Log::Level Level;
+
+#if OUZEL_PLATFORM_MACOS || OUZEL_PLATFORM_LINUX
+        switch (level)
+        {
+            case Level::ERR:
+            case Level::WARN:
+                std::cerr << s << '\n';
+                if (flush) std::cerr.flush();
+                break;
+            case Level::INFO:
+            case Level::ALL:
+                std::cout << s << '\n';
+                if (flush) std::cout.flush();
+                break;
+            default: break;
+        }
+#elif OUZEL_PLATFORM_IOS || OUZEL_PLATFORM_TVOS
+        (void)flush;
+        int priority = 0;
+        switch (level)
+        {
+            case Level::ERR: priority = LOG_ERR; break;
+            case Level::WARN: priority = LOG_WARNING; break;
+            case Level::INFO: priority = LOG_INFO; break;
+            case Level::ALL: priority = LOG_DEBUG; break;
+            default: break;
+        }
+        syslog(priority, "%s", s.c_str());
+#elif OUZEL_PLATFORM_WINDOWS
+        (void)flush;
+        int bufferSize = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (bufferSize == 0)
+            return;
+
+        ++bufferSize; // for the newline
+        std::vector<WCHAR> buffer(bufferSize);
+        if (MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, buffer.data(), bufferSize) == 0)
+            return;
+
+        StringCchCatW(buffer.data(), buffer.size(), L"\n");
+        OutputDebugStringW(buffer.data());
+
+#  if DEBUG
+        HANDLE handle = 0;
+        switch (level)
+        {
+        case Level::ERR:
+        case Level::WARN:
+            handle = GetStdHandle(STD_ERROR_HANDLE);
+            break;
+        case Level::INFO:
+        case Level::ALL:
+            handle = GetStdHandle(STD_OUTPUT_HANDLE);
+            break;
+        default: break;
+        }
+
+        if (handle)
+        {
+            DWORD bytesWritten;
+            WriteConsoleW(handle, buffer.data(), static_cast<DWORD>(wcslen(buffer.data())), &bytesWritten, nullptr);
+        }
+#  endif
+
+#elif OUZEL_PLATFORM_ANDROID
+        (void)flush;
+        int priority = 0;
+        switch (level)
+        {
+            case Level::ERR: priority = ANDROID_LOG_ERROR; break;
+            case Level::WARN: priority = ANDROID_LOG_WARN; break;
+            case Level::INFO: priority = ANDROID_LOG_INFO; break;
+            case Level::ALL: priority = ANDROID_LOG_DEBUG; break;
+            default: break;
+        }
+        __android_log_print(priority, "Ouzel", "%s", s.c_str());
+#elif OUZEL_PLATFORM_EMSCRIPTEN
+        (void)flush;
+        int flags = EM_LOG_CONSOLE;
+        if (level == Level::ERR) flags |= EM_LOG_ERROR;
+        else if (level == Level::WARN) flags |= EM_LOG_WARN;
+        emscripten_log(flags, "%s", s.c_str());
+#endif
+    }
+
     Log::~Log()
     {
         if (!s.empty())
         {
-#if OUZEL_PLATFORM_MACOS || OUZEL_PLATFORM_LINUX
-            switch (level)
+            if (logger)
+                logger->log(level, std::move(s));
+            else
+                writeConsole(level, s, true);
+
+            s.clear();
+        }
+    }
+
+    static void appendTime(std::string& str, std::chrono::system_clock::time_point time)
+    {
+        std::time_t t = std::chrono::system_clock::to_time_t(time);
+        std::tm tm;
+#if defined(_WIN32)
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        int milliseconds = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+
+        char buffer[32];
+        int length = snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d.%03d ", tm.tm_hour, tm.tm_min, tm.tm_sec, milliseconds);
+        if (length > 0) str.append(buffer, static_cast<size_t>(length));
+    }
+
+    static std::atomic<uint64_t> nextLoggerId{1};
+
+    Logger::Logger(bool initAsync):
+        async(initAsync), id(nextLoggerId++)
+    {
+#if OUZEL_MULTITHREADED
+        if (async)
+        {
+            running = true;
+            logThread = std::thread(&Logger::run, this);
+        }
+#else
+        async = false;
+#endif
+    }
+
+    Logger::~Logger()
+    {
+#if OUZEL_MULTITHREADED
+        if (logThread.joinable())
+        {
+            std::unique_lock<std::mutex> lock(runMutex);
+            running = false;
+            lock.unlock();
+            runCondition.notify_all();
+            logThread.join();
+        }
+#endif
+
+        flush();
+    }
+
+    void Logger::setFile(const std::string& newFilename, size_t newMaxFileSize, uint32_t newMaxFiles)
+    {
+        std::unique_lock<std::mutex> lock(writeMutex);
+
+        if (file.is_open()) file.close();
+
+        filename = newFilename;
+        maxFileSize = newMaxFileSize;
+        maxFiles = newMaxFiles;
+        fileSize = 0;
+
+        if (!filename.empty())
+        {
+            file.open(filename, std::ios::binary | std::ios::app | std::ios::ate);
+            if (!file.is_open())
+                throw std::runtime_error("Failed to open log file " + filename);
+
+            fileSize = static_cast<size_t>(file.tellp());
+        }
+    }
+
+    void Logger::log(Log::Level level, std::string&& str)
+    {
+        Record record;
+        record.level = level;
+        record.time = std::chrono::system_clock::now();
+        record.str = std::move(str);
+
+        if (async)
+        {
+            ThreadBuffer* threadBuffer = getThreadBuffer();
+            record.threadName = threadBuffer->threadName.load(std::memory_order_relaxed);
+
+            // never block the logging thread
+            if (!threadBuffer->records.push(std::move(record)))
+                ++threadBuffer->droppedRecords;
+
+#if OUZEL_MULTITHREADED
+            if (level == Log::Level::ERR)
+                runCondition.notify_all();
+#endif
+        }
+        else
+        {
+            record.threadName = &getCurrentThreadName();
+
+            std::unique_lock<std::mutex> lock(writeMutex);
+            batch.push_back(std::move(record));
+            write(batch);
+            batch.clear();
+        }
+    }
+
+    void Logger::flush()
+    {
+        std::unique_lock<std::mutex> lock(writeMutex);
+
+        std::vector<std::shared_ptr<ThreadBuffer>> finishedBuffers;
+
+        std::unique_lock<std::mutex> bufferLock(bufferMutex);
+        for (auto i = threadBuffers.begin(); i != threadBuffers.end();)
+        {
+            const std::shared_ptr<ThreadBuffer>& threadBuffer = *i;
+
+            // the thread can't log anymore if it has finished before its records are read
+            bool finished = threadBuffer->finished;
+
+            Record record;
+            while (threadBuffer->records.pop(record))
+                batch.push_back(std::move(record));
+
+            if (uint32_t droppedRecords = threadBuffer->droppedRecords.exchange(0))
             {
-                case Level::ERR:
-                case Level::WARN:
-                    std::cerr << s << std::endl;
-                    break;
-                case Level::INFO:
-                case Level::ALL:
-                    std::cout << s << std::endl;
-                    break;
-                default: break;
+                record.level = Log::Level::WARN;
+                record.time = std::chrono::system_clock::now();
+                record.str = std::to_string(droppedRecords) + " log messages dropped";
+                record.threadName = threadBuffer->threadName.load(std::memory_order_acquire);
+                batch.push_back(std::move(record));
             }
-#elif OUZEL_PLATFORM_IOS || OUZEL_PLATFORM_TVOS
-            int priority = 0;
-            switch (level)
+
+            if (finished)
             {
-                case Level::ERR: priority = LOG_ERR; break;
-                case Level::WARN: priority = LOG_WARNING; break;
-                case Level::INFO: priority = LOG_INFO; break;
-                case Level::ALL: priority = LOG_DEBUG; break;
-                default: break;
+                finishedBuffers.push_back(threadBuffer);
+                i = threadBuffers.erase(i);
             }
-            syslog(priority, "%s", s.c_str());
-#elif OUZEL_PLATFORM_WINDOWS
-            int bufferSize = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
-            if (bufferSize == 0)
-                return;
+            else
+                ++i;
+        }
+        bufferLock.unlock();
 
-            ++bufferSize; // for the newline
-            std::vector<WCHAR> buffer(bufferSize);
-            if (MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, buffer.data(), bufferSize) == 0)
-                return;
+        if (batch.empty()) return;
 
-            StringCchCatW(buffer.data(), buffer.size(), L"\n");
-            OutputDebugStringW(buffer.data());
+        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+            return a.time < b.time;
+        });
 
-#  if DEBUG
-            HANDLE handle = 0;
-            switch (level)
+        write(batch);
+        batch.clear();
+    }
+
+    Logger::ThreadBuffer* Logger::getThreadBuffer()
+    {
+        struct ThreadBufferHolder final
+        {
+            ~ThreadBufferHolder()
             {
-            case Level::ERR:
-            case Level::WARN:
-                handle = GetStdHandle(STD_ERROR_HANDLE);
-                break;
-            case Level::INFO:
-            case Level::ALL:
-                handle = GetStdHandle(STD_OUTPUT_HANDLE);
-                break;
-            default: break;
+                if (threadBuffer) threadBuffer->finished = true;
             }
 
-            if (handle)
+            uint64_t loggerId = 0;
+            std::shared_ptr<ThreadBuffer> threadBuffer;
+        };
+
+        static thread_local ThreadBufferHolder holder;
+
+        if (holder.loggerId != id)
+        {
+            if (holder.threadBuffer) holder.threadBuffer->finished = true;
+
+            holder.loggerId = id;
+            holder.threadBuffer = std::make_shared<ThreadBuffer>();
+            holder.threadBuffer->threadNames.push_back(getCurrentThreadName());
+            holder.threadBuffer->threadName = &holder.threadBuffer->threadNames.back();
+
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            threadBuffers.push_back(holder.threadBuffer);
+        }
+
+        ThreadBuffer* threadBuffer = holder.threadBuffer.get();
+
+        // the thread can be renamed after its first record
+        const std::string& currentThreadName = getCurrentThreadName();
+        if (*threadBuffer->threadName.load(std::memory_order_relaxed) != currentThreadName)
+        {
+            threadBuffer->threadNames.push_back(currentThreadName);
+            threadBuffer->threadName.store(&threadBuffer->threadNames.back(), std::memory_order_release);
+        }
+
+        return threadBuffer;
+    }
+
+    void Logger::write(std::vector<Record>& records)
+    {
+        std::string line;
+        std::string text;
+
+        for (const Record& record : records)
+        {
+            line.clear();
+            appendTime(line, record.time);
+
+            if (!record.threadName->empty())
             {
-                DWORD bytesWritten;
-                WriteConsoleW(handle, buffer.data(), static_cast<DWORD>(wcslen(buffer.data())), &bytesWritten, nullptr);
+                line += "[";
+                line += *record.threadName;
+                line += "] ";
             }
-#  endif
 
-#elif OUZEL_PLATFORM_ANDROID
-            int priority = 0;
-            switch (level)
+            line += record.str;
+
+            writeConsole(record.level, line, false);
+
+            if (file.is_open())
             {
-                case Level::ERR: priority = ANDROID_LOG_ERROR; break;
-                case Level::WARN: priority = ANDROID_LOG_WARN; break;
-                case Level::INFO: priority = ANDROID_LOG_INFO; break;
-                case Level::ALL: priority = ANDROID_LOG_DEBUG; break;
-                default: break;
+                text += line;
+                text += "\n";
             }
-            __android_log_print(priority, "Ouzel", "%s", s.c_str());
-#elif OUZEL_PLATFORM_EMSCRIPTEN
-            int flags = EM_LOG_CONSOLE;
-            if (level == Level::ERR) flags |= EM_LOG_ERROR;
-            else if (level == Level::WARN) flags |= EM_LOG_WARN;
-            emscripten_log(flags, "%s", s.c_str());
+        }
+
+#if OUZEL_PLATFORM_MACOS || OUZEL_PLATFORM_LINUX
+        std::cout.flush();
+        std::cerr.flush();
 #endif
-            s.clear();
+
+        if (!text.empty()) writeFile(text);
+    }
+
+    void Logger::writeFile(const std::string& str)
+    {
+        if (maxFileSize && fileSize && fileSize + str.size() > maxFileSize)
+        {
+            file.close();
+
+            if (maxFiles > 1)
+            {
+                std::remove((filename + "." + std::to_string(maxFiles - 1)).c_str());
+
+                for (uint32_t i = maxFiles - 1; i > 1; --i)
+                    std::rename((filename + "." + std::to_string(i - 1)).c_str(),
+                                (filename + "." + std::to_string(i)).c_str());
+
+                std::rename(filename.c_str(), (filename + ".1").c_str());
+            }
+
+            file.open(filename, std::ios::binary | std::ios::trunc);
+            fileSize = 0;
+
+            if (!file.is_open()) return;
         }
+
+        file.write(str.data(), static_cast<std::streamsize>(str.size()));
+        file.flush();
+        fileSize += str.size();
+    }
+
+    void Logger::run()
+    {
+#if OUZEL_MULTITHREADED
+        setCurrentThreadName("Log");
+
+        while (running)
+        {
+            // records are written in batches, errors are written right away
+            std::unique_lock<std::mutex> lock(runMutex);
+            runCondition.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+
+            flush();
+        }
+#endif
     }
 }
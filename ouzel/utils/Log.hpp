@@ -3,8 +3,19 @@
 #ifndef OUZEL_UTILS_LOG_HPP
 #define OUZEL_UTILS_LOG_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
+#include "core/Setup.h"
 #include "math/Matrix4.hpp"
 #include "math/Quaternion.hpp"
 #include "math/Size2.hpp"
@@ -12,9 +23,17 @@
 #include "math/Vector2.hpp"
 #include "math/Vector3.hpp"
 #include "math/Vector4.hpp"
+#include "utils/SpscQueue.hpp"
+
+// the most verbose level that is compiled in: 0 - off, 1 - errors, 2 - warnings, 3 - info, 4 - all
+#ifndef OUZEL_LOG_LEVEL
+#  define OUZEL_LOG_LEVEL 4
+#endif
 
 namespace ouzel
 {
+    class Logger;
+
     class Log final
     {
     public:
@@ -27,8 +46,11 @@ namespace ouzel
             ALL
         };
 
-        explicit Log(Level initLevel = Level::INFO, Level initThreshold = Level::ALL):
-            level(initLevel), threshold(initThreshold)
+        static constexpr Level MAX_LEVEL = static_cast<Level>(OUZEL_LOG_LEVEL);
+
+        // writes synchronously if there is no logger
+        explicit Log(Level initLevel = Level::INFO, Level initThreshold = Level::ALL, Logger* initLogger = nullptr):
+            level(initLevel), threshold(initThreshold), logger(initLogger)
         {
         }
 
@@ -36,6 +58,7 @@ namespace ouzel
         {
             threshold = other.threshold;
             level = other.level;
+            logger = other.logger;
             s = other.s;
         }
 
@@ -43,6 +66,7 @@ namespace ouzel
         {
             threshold = other.threshold;
             level = other.level;
+            logger = other.logger;
             other.level = Level::INFO;
             other.threshold = Level::ALL;
             s = std::move(other.s);
@@ -52,6 +76,7 @@ namespace ouzel
         {
             threshold = other.threshold;
             level = other.level;
+            logger = other.logger;
             s = other.s;
 
             return *this;
@@ -63,6 +88,7 @@ namespace ouzel
             {
                 threshold = other.threshold;
                 level = other.level;
+                logger = other.logger;
                 other.level = Level::INFO;
                 other.threshold = Level::ALL;
                 s = std::move(other.s);
@@ -73,17 +99,28 @@ namespace ouzel
 
         ~Log();
 
+        // levels above MAX_LEVEL are known at compile time, so the formatting code is removed for them
+        inline bool isEnabled() const { return level <= MAX_LEVEL && level <= threshold; }
+
         template<typename T> Log& operator<<(T val)
         {
-            if (level <= threshold)
-                s += std::to_string(val);
+            if (isEnabled())
+                append(val, std::is_floating_point<T>(), std::is_signed<T>());
+
+            return *this;
+        }
+
+        Log& operator<<(bool val)
+        {
+            if (isEnabled())
+                s += val ? "1" : "0";
 
             return *this;
         }
 
         Log& operator<<(const std::string& val)
         {
-            if (level <= threshold)
+            if (isEnabled())
                 s += val;
 
             return *this;
@@ -91,7 +128,7 @@ namespace ouzel
 
         Log& operator<<(const char* val)
         {
-            if (level <= threshold)
+            if (isEnabled())
                 s += val;
 
             return *this;
@@ -99,7 +136,7 @@ namespace ouzel
 
         Log& operator<<(char* val)
         {
-            if (level <= threshold)
+            if (isEnabled())
                 s += val;
 
             return *this;
@@ -107,7 +144,7 @@ namespace ouzel
 
         Log& operator<<(const std::vector<std::string>& val)
         {
-            if (level <= threshold)
+            if (isEnabled())
             {
                 bool first = true;
 
@@ -124,77 +161,174 @@ namespace ouzel
 
         Log& operator<<(const Matrix4& val)
         {
-            s += std::to_string(val.m[0]) + "," + std::to_string(val.m[1]) + "," + std::to_string(val.m[2]) + "," + std::to_string(val.m[3]) + "\n" +
-                std::to_string(val.m[4]) + "," + std::to_string(val.m[5]) + "," + std::to_string(val.m[6]) + "," + std::to_string(val.m[7]) + "\n" +
-                std::to_string(val.m[8]) + "," + std::to_string(val.m[9]) + "," + std::to_string(val.m[10]) + "," + std::to_string(val.m[11]) + "\n" +
-                std::to_string(val.m[12]) + "," + std::to_string(val.m[13]) + "," + std::to_string(val.m[14]) + "," + std::to_string(val.m[15]);
+            if (isEnabled())
+            {
+                for (uint32_t row = 0; row < 4; ++row)
+                {
+                    if (row) s += "\n";
+                    appendList(val.m + row * 4, 4);
+                }
+            }
 
             return *this;
         }
 
         Log& operator<<(const Quaternion& val)
         {
-            if (level <= threshold)
-            {
-                s += std::to_string(val.x) + "," + std::to_string(val.y) + "," +
-                    std::to_string(val.z) + "," + std::to_string(val.w);
-            }
+            if (isEnabled())
+                appendList(&val.x, 4);
 
             return *this;
         }
 
         Log& operator<<(const Size2& val)
         {
-            if (level <= threshold)
-                s += std::to_string(val.width) + "," + std::to_string(val.height);
+            if (isEnabled())
+                appendList(&val.width, 2);
 
             return *this;
         }
 
         Log& operator<<(const Size3& val)
         {
-            if (level <= threshold)
-                s += std::to_string(val.width) + "," + std::to_string(val.height) + "," +
-                    std::to_string(val.depth);
+            if (isEnabled())
+                appendList(&val.width, 3);
 
             return *this;
         }
 
         Log& operator<<(const Vector2& val)
         {
-            if (level <= threshold)
-                s += std::to_string(val.x) + "," + std::to_string(val.y);
+            if (isEnabled())
+                appendList(&val.x, 2);
 
             return *this;
         }
 
         Log& operator<<(const Vector3& val)
         {
-            if (level <= threshold)
-            {
-                s += std::to_string(val.x) + "," + std::to_string(val.y) + "," +
-                    std::to_string(val.z);
-            }
+            if (isEnabled())
+                appendList(&val.x, 3);
 
             return *this;
         }
 
         Log& operator<<(const Vector4& val)
         {
-            if (level <= threshold)
-            {
-                s += std::to_string(val.x) + "," + std::to_string(val.y) + "," +
-                    std::to_string(val.z) + "," + std::to_string(val.w);
-            }
+            if (isEnabled())
+                appendList(&val.x, 4);
 
             return *this;
         }
 
     private:
+        // formats numbers in place instead of concatenating temporary strings
+        template<typename T> void append(T val, std::true_type, std::true_type)
+        {
+            char buffer[64];
+            int length = snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(val));
+            if (length > 0) s.append(buffer, static_cast<size_t>(length));
+        }
+
+        template<typename T> void append(T val, std::false_type, std::true_type)
+        {
+            char buffer[32];
+            int length = snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(val));
+            if (length > 0) s.append(buffer, static_cast<size_t>(length));
+        }
+
+        template<typename T> void append(T val, std::false_type, std::false_type)
+        {
+            char buffer[32];
+            int length = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(val));
+            if (length > 0) s.append(buffer, static_cast<size_t>(length));
+        }
+
+        void appendList(const float* values, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (i) s += ",";
+                append(values[i], std::true_type(), std::true_type());
+            }
+        }
+
         Level level = Level::INFO;
         Level threshold = Log::Level::ALL;
+        Logger* logger = nullptr;
         std::string s;
     };
+
+    // collects the log records of all the threads and writes them on a background thread
+    class Logger final
+    {
+    public:
+        static const size_t THREAD_BUFFER_SIZE = 1024; // records per thread
+
+        explicit Logger(bool initAsync = true);
+        ~Logger();
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        Logger(Logger&&) = delete;
+        Logger& operator=(Logger&&) = delete;
+
+        // the file is renamed to filename.1 (and so on up to maxFiles) when it grows over maxFileSize bytes
+        void setFile(const std::string& filename, size_t maxFileSize = 10 * 1024 * 1024, uint32_t maxFiles = 4);
+
+        void log(Log::Level level, std::string&& str);
+
+        // writes all the records that have been logged so far
+        void flush();
+
+    private:
+        struct Record final
+        {
+            Log::Level level;
+            std::chrono::system_clock::time_point time;
+            std::string str;
+            const std::string* threadName; // owned by the thread buffer
+        };
+
+        struct ThreadBuffer final
+        {
+            ThreadBuffer(): records(THREAD_BUFFER_SIZE) {}
+
+            // written only by the thread, a rename adds a new name so that the queued records keep theirs
+            std::deque<std::string> threadNames;
+            std::atomic<const std::string*> threadName{nullptr}; // the last one of threadNames
+            SpscQueue<Record> records;
+            std::atomic<uint32_t> droppedRecords{0};
+            std::atomic_bool finished{false}; // the thread has exited
+        };
+
+        ThreadBuffer* getThreadBuffer();
+        void write(std::vector<Record>& batch);
+        void writeFile(const std::string& str);
+        void run();
+
+        bool async = true;
+        uint64_t id; // the thread buffers of a deleted logger are not reused by a new one at the same address
+
+        std::mutex bufferMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+
+        std::mutex writeMutex;
+        std::string filename;
+        std::ofstream file;
+        size_t fileSize = 0;
+        size_t maxFileSize = 0;
+        uint32_t maxFiles = 0;
+        std::vector<Record> batch;
+
+#if OUZEL_MULTITHREADED
+        std::atomic_bool running{false};
+        std::mutex runMutex;
+        std::condition_variable runCondition;
+        std::thread logThread;
+#endif
+    };
 }
 
 #endif // OUZEL_UTILS_LOG_HPP
@@ -1,6 +1,9 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#include <unordered_map>
 #include "OBF.hpp"
 #include "Utils.hpp"
 
@@ -156,7 +159,7 @@ namespace ouzel
 
                 offset += ret;
 
-                result[static_cast<uint32_t>(key)] = node;
+                result[static_cast<uint32_t>(key)] = std::move(node);
             }
 
             return offset - originalOffset;
@@ -173,14 +176,15 @@ namespace ouzel
 
             offset += sizeof(count);
 
+            // every element takes at least one byte
+            result.reserve(std::min(static_cast<size_t>(count), buffer.size() - offset));
+
             for (uint32_t i = 0; i < count; ++i)
             {
-                Value node;
-                uint32_t ret = node.decode(buffer, offset);
+                result.push_back(Value());
+                uint32_t ret = result.back().decode(buffer, offset);
 
                 offset += ret;
-
-                result.push_back(node);
             }
 
             return offset - originalOffset;
@@ -218,7 +222,7 @@ namespace ouzel
 
                 offset += ret;
 
-                result[key] = node;
+                result[key] = std::move(node);
             }
 
             return offset - originalOffset;
@@ -640,5 +644,363 @@ namespace ouzel
 
             return size;
         }
+
+        // view
+        static inline void checkSize(const uint8_t* position, const uint8_t* end, size_t size)
+        {
+            if (static_cast<size_t>(end - position) < size)
+                throw std::runtime_error("Not enough data");
+        }
+
+        // returns the end of the value that starts at the position
+        static const uint8_t* skipValue(const uint8_t* position, const uint8_t* end)
+        {
+            checkSize(position, end, 1);
+
+            Value::Marker marker = static_cast<Value::Marker>(*position);
+            ++position;
+
+            size_t size = 0;
+
+            switch (marker)
+            {
+                case Value::Marker::NONE: break;
+                case Value::Marker::INT8: size = sizeof(uint8_t); break;
+                case Value::Marker::INT16: size = sizeof(uint16_t); break;
+                case Value::Marker::INT32: size = sizeof(uint32_t); break;
+                case Value::Marker::INT64: size = sizeof(uint64_t); break;
+                case Value::Marker::FLOAT: size = sizeof(float); break;
+                case Value::Marker::DOUBLE: size = sizeof(double); break;
+                case Value::Marker::STRING:
+                    checkSize(position, end, sizeof(uint16_t));
+                    size = decodeUInt16Big(position);
+                    position += sizeof(uint16_t);
+                    break;
+                case Value::Marker::LONG_STRING:
+                case Value::Marker::BYTE_ARRAY:
+                    checkSize(position, end, sizeof(uint32_t));
+                    size = decodeUInt32Big(position);
+                    position += sizeof(uint32_t);
+                    break;
+                case Value::Marker::OBJECT:
+                case Value::Marker::ARRAY:
+                case Value::Marker::DICTIONARY:
+                {
+                    checkSize(position, end, sizeof(uint32_t));
+                    uint32_t count = decodeUInt32Big(position);
+                    position += sizeof(uint32_t);
+
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        if (marker == Value::Marker::OBJECT)
+                        {
+                            checkSize(position, end, sizeof(uint32_t));
+                            position += sizeof(uint32_t);
+                        }
+                        else if (marker == Value::Marker::DICTIONARY)
+                        {
+                            checkSize(position, end, sizeof(uint16_t));
+                            uint16_t length = decodeUInt16Big(position);
+                            position += sizeof(uint16_t);
+
+                            checkSize(position, end, length);
+                            position += length;
+                        }
+
+                        position = skipValue(position, end);
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
+
+            checkSize(position, end, size);
+
+            return position + size;
+        }
+
+        struct StringViewHash final
+        {
+            size_t operator()(const StringView& str) const
+            {
+                // FNV-1a
+                uint32_t hash = 2166136261U;
+
+                for (char c : str)
+                {
+                    hash ^= static_cast<uint8_t>(c);
+                    hash *= 16777619U;
+                }
+
+                return hash;
+            }
+        };
+
+        struct View::Index final
+        {
+            std::vector<const uint8_t*> elements;
+            std::unordered_map<uint32_t, const uint8_t*> keys;
+            std::unordered_map<StringView, const uint8_t*, StringViewHash> names;
+        };
+
+        View::Iterator::Iterator(const View& view):
+            marker(view.marker),
+            position(view.data + 1 + sizeof(uint32_t)),
+            bufferEnd(view.bufferEnd),
+            remaining(view.count)
+        {
+            if (remaining) readElement();
+        }
+
+        View View::Iterator::getValue() const
+        {
+            return View(value, static_cast<size_t>(bufferEnd - value));
+        }
+
+        View::Iterator& View::Iterator::operator++()
+        {
+            position = skipValue(value, bufferEnd);
+
+            if (--remaining)
+            {
+                ++key;
+                readElement();
+            }
+
+            return *this;
+        }
+
+        void View::Iterator::readElement()
+        {
+            value = position;
+
+            if (marker == Value::Marker::OBJECT)
+            {
+                checkSize(position, bufferEnd, sizeof(uint32_t));
+                key = decodeUInt32Big(position);
+                value += sizeof(uint32_t);
+            }
+            else if (marker == Value::Marker::DICTIONARY)
+            {
+                checkSize(position, bufferEnd, sizeof(uint16_t));
+                uint16_t length = decodeUInt16Big(position);
+                value += sizeof(uint16_t);
+
+                checkSize(value, bufferEnd, length);
+                name = StringView(reinterpret_cast<const char*>(value), length);
+                value += length;
+            }
+        }
+
+        View::View(const uint8_t* buffer, size_t size):
+            data(buffer), bufferEnd(buffer + size)
+        {
+            checkSize(data, bufferEnd, 1);
+
+            marker = static_cast<Value::Marker>(*data);
+
+            // the fixed size part is checked here, so that the getters don't have to
+            switch (marker)
+            {
+                case Value::Marker::NONE:
+                    type = Value::Type::NONE;
+                    break;
+                case Value::Marker::INT8:
+                case Value::Marker::INT16:
+                case Value::Marker::INT32:
+                case Value::Marker::INT64:
+                    type = Value::Type::INT;
+                    break;
+                case Value::Marker::FLOAT:
+                    type = Value::Type::FLOAT;
+                    break;
+                case Value::Marker::DOUBLE:
+                    type = Value::Type::DOUBLE;
+                    break;
+                case Value::Marker::STRING:
+                case Value::Marker::LONG_STRING:
+                    type = Value::Type::STRING;
+                    break;
+                case Value::Marker::BYTE_ARRAY:
+                    type = Value::Type::BYTE_ARRAY;
+                    break;
+                case Value::Marker::OBJECT:
+                    type = Value::Type::OBJECT;
+                    break;
+                case Value::Marker::ARRAY:
+                    type = Value::Type::ARRAY;
+                    break;
+                case Value::Marker::DICTIONARY:
+                    type = Value::Type::DICTIONARY;
+                    break;
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
+
+            if (type == Value::Type::OBJECT ||
+                type == Value::Type::ARRAY ||
+                type == Value::Type::DICTIONARY)
+            {
+                checkSize(data + 1, bufferEnd, sizeof(uint32_t));
+                count = decodeUInt32Big(data + 1);
+            }
+            else
+                bufferEnd = skipValue(data, bufferEnd);
+        }
+
+        uint64_t View::getInt() const
+        {
+            switch (marker)
+            {
+                case Value::Marker::INT8: return data[1];
+                case Value::Marker::INT16: return decodeUInt16Big(data + 1);
+                case Value::Marker::INT32: return decodeUInt32Big(data + 1);
+                case Value::Marker::INT64: return decodeUInt64Big(data + 1);
+                default: return 0;
+            }
+        }
+
+        double View::getDouble() const
+        {
+            if (marker == Value::Marker::FLOAT)
+            {
+                float result;
+                std::memcpy(&result, data + 1, sizeof(result));
+                return result;
+            }
+            else if (marker == Value::Marker::DOUBLE)
+            {
+                double result;
+                std::memcpy(&result, data + 1, sizeof(result));
+                return result;
+            }
+            else
+                return 0.0;
+        }
+
+        StringView View::getString() const
+        {
+            if (marker == Value::Marker::STRING)
+                return StringView(reinterpret_cast<const char*>(data + 1 + sizeof(uint16_t)),
+                                  decodeUInt16Big(data + 1));
+            else if (marker == Value::Marker::LONG_STRING)
+                return StringView(reinterpret_cast<const char*>(data + 1 + sizeof(uint32_t)),
+                                  decodeUInt32Big(data + 1));
+            else
+                return StringView();
+        }
+
+        ByteArrayView View::getByteArray() const
+        {
+            if (marker == Value::Marker::BYTE_ARRAY)
+                return ByteArrayView(data + 1 + sizeof(uint32_t), decodeUInt32Big(data + 1));
+            else
+                return ByteArrayView();
+        }
+
+        const uint8_t* View::findElement(uint32_t key) const
+        {
+            if (type == Value::Type::ARRAY)
+            {
+                if (key >= count) return nullptr;
+
+                if (index) return index->elements[key];
+
+                const uint8_t* position = data + 1 + sizeof(uint32_t);
+                for (uint32_t i = 0; i < key; ++i)
+                    position = skipValue(position, bufferEnd);
+
+                return position;
+            }
+            else if (type == Value::Type::OBJECT)
+            {
+                if (index)
+                {
+                    auto i = index->keys.find(key);
+                    return (i != index->keys.end()) ? i->second : nullptr;
+                }
+
+                for (Iterator i(*this); i.remaining; ++i)
+                    if (i.getKey() == key) return i.value;
+            }
+
+            return nullptr;
+        }
+
+        const uint8_t* View::findElement(const StringView& key) const
+        {
+            if (type == Value::Type::DICTIONARY)
+            {
+                if (index)
+                {
+                    auto i = index->names.find(key);
+                    return (i != index->names.end()) ? i->second : nullptr;
+                }
+
+                for (Iterator i(*this); i.remaining; ++i)
+                    if (i.getName() == key) return i.value;
+            }
+
+            return nullptr;
+        }
+
+        View View::operator[](uint32_t key) const
+        {
+            assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY);
+
+            const uint8_t* element = findElement(key);
+            return element ? View(element, static_cast<size_t>(bufferEnd - element)) : View();
+        }
+
+        View View::operator[](const StringView& key) const
+        {
+            assert(type == Value::Type::DICTIONARY);
+
+            const uint8_t* element = findElement(key);
+            return element ? View(element, static_cast<size_t>(bufferEnd - element)) : View();
+        }
+
+        View::Iterator View::begin() const
+        {
+            assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY || type == Value::Type::DICTIONARY);
+
+            return Iterator(*this);
+        }
+
+        View::Iterator View::end() const
+        {
+            return Iterator();
+        }
+
+        uint32_t View::getEncodedSize() const
+        {
+            if (!data) return 0;
+
+            return static_cast<uint32_t>(skipValue(data, bufferEnd) - data);
+        }
+
+        void View::buildIndex()
+        {
+            assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY || type == Value::Type::DICTIONARY);
+
+            std::shared_ptr<Index> newIndex = std::make_shared<Index>();
+
+            // every element takes at least one byte
+            newIndex->elements.reserve(std::min(static_cast<size_t>(count), static_cast<size_t>(bufferEnd - data)));
+
+            for (Iterator i(*this); i.remaining; ++i)
+            {
+                newIndex->elements.push_back(i.value);
+
+                // the first element with the key is found, same as when walking the buffer
+                if (type == Value::Type::OBJECT)
+                    newIndex->keys.insert(std::make_pair(i.getKey(), i.value));
+                else if (type == Value::Type::DICTIONARY)
+                    newIndex->names.insert(std::make_pair(i.getName(), i.value));
+            }
+
+            index = newIndex;
+        }
     } // namespace obf
 } // namespace ouzel
@@ -3,12 +3,16 @@
 #ifndef OUZEL_UTILS_OBF_HPP
 #define OUZEL_UTILS_OBF_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include "utils/StringView.hpp"
 
 namespace ouzel
 {
@@ -437,6 +441,154 @@ namespace ouzel
             Array arrayValue;
             Dictionary dictionaryValue;
         };
+
+        // bytes of an encoded buffer
+        class ByteArrayView final
+        {
+        public:
+            ByteArrayView() {}
+            ByteArrayView(const uint8_t* initData, uint32_t initSize):
+                data(initData), size(initSize)
+            {
+            }
+
+            inline const uint8_t* getData() const { return data; }
+            inline uint32_t getSize() const { return size; }
+
+            inline const uint8_t* begin() const { return data; }
+            inline const uint8_t* end() const { return data + size; }
+
+        private:
+            const uint8_t* data = nullptr;
+            uint32_t size = 0;
+        };
+
+        // read-only view of an encoded value that decodes only the parts that are accessed, strings and byte arrays
+        // point into the buffer, so it must outlive the view
+        class View final
+        {
+        public:
+            class Iterator final
+            {
+                friend View;
+            public:
+                // key of an object element or index of an array element
+                inline uint32_t getKey() const { return key; }
+                // key of a dictionary element
+                inline const StringView& getName() const { return name; }
+                View getValue() const;
+
+                inline View operator*() const { return getValue(); }
+
+                Iterator& operator++();
+
+                inline bool operator==(const Iterator& other) const { return remaining == other.remaining; }
+                inline bool operator!=(const Iterator& other) const { return remaining != other.remaining; }
+
+            private:
+                Iterator() {}
+                Iterator(const View& view);
+
+                void readElement();
+
+                Value::Marker marker = Value::Marker::NONE;
+                const uint8_t* position = nullptr;
+                const uint8_t* bufferEnd = nullptr;
+                const uint8_t* value = nullptr;
+                uint32_t remaining = 0;
+                uint32_t key = 0;
+                StringView name;
+            };
+
+            View() {}
+            View(const uint8_t* buffer, size_t size);
+            explicit View(const std::vector<uint8_t>& buffer, uint32_t offset = 0):
+                View(buffer.data() + std::min(static_cast<size_t>(offset), buffer.size()),
+                     buffer.size() - std::min(static_cast<size_t>(offset), buffer.size()))
+            {
+            }
+
+            inline Value::Type getType() const { return type; }
+            inline bool isIntType() const { return type == Value::Type::INT; }
+            inline bool isFloatType() const { return type == Value::Type::FLOAT || type == Value::Type::DOUBLE; }
+            inline bool isStringType() const { return type == Value::Type::STRING; }
+
+            template<typename T, typename std::enable_if<std::is_same<T, StringView>::value>::type* = nullptr>
+            StringView as() const
+            {
+                assert(type == Value::Type::STRING);
+                return getString();
+            }
+
+            template<typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+            std::string as() const
+            {
+                assert(type == Value::Type::STRING);
+                return getString().toString();
+            }
+
+            template<typename T, typename std::enable_if<std::is_same<T, ByteArrayView>::value>::type* = nullptr>
+            ByteArrayView as() const
+            {
+                assert(type == Value::Type::BYTE_ARRAY);
+                return getByteArray();
+            }
+
+            template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+            T as() const
+            {
+                assert(type == Value::Type::INT);
+                return static_cast<T>(getInt());
+            }
+
+            template<typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+            T as() const
+            {
+                assert(type == Value::Type::FLOAT || type == Value::Type::DOUBLE);
+                return static_cast<T>(getDouble());
+            }
+
+            // number of elements of an object, array or dictionary
+            inline uint32_t getSize() const
+            {
+                assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY || type == Value::Type::DICTIONARY);
+                return count;
+            }
+
+            // elements are found by walking the buffer unless the index is built, missing elements return an empty view
+            View operator[](uint32_t key) const;
+            View operator[](const StringView& key) const;
+
+            inline bool hasElement(uint32_t key) const { return findElement(key) != nullptr; }
+            inline bool hasElement(const StringView& key) const { return findElement(key) != nullptr; }
+
+            Iterator begin() const;
+            Iterator end() const;
+
+            // number of bytes the value occupies in the buffer
+            uint32_t getEncodedSize() const;
+
+            // indexes the elements of an object, array or dictionary for constant time lookups
+            void buildIndex();
+
+        private:
+            struct Index;
+
+            uint64_t getInt() const;
+            double getDouble() const;
+            StringView getString() const;
+            ByteArrayView getByteArray() const;
+
+            const uint8_t* findElement(uint32_t key) const;
+            const uint8_t* findElement(const StringView& key) const;
+
+            const uint8_t* data = nullptr; // the marker
+            const uint8_t* bufferEnd = nullptr;
+            Value::Marker marker = Value::Marker::NONE;
+            Value::Type type = Value::Type::NONE;
+            uint32_t count = 0;
+            std::shared_ptr<const Index> index;
+        };
     } // namespace obf
 } // namespace ouzel
 
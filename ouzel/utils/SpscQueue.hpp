@@ -0,0 +1,90 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_SPSCQUEUE_HPP
+#define OUZEL_UTILS_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ouzel
+{
+    // wait-free fixed capacity queue for exactly one producer thread and one consumer thread
+    template<class T>
+    class SpscQueue final
+    {
+    public:
+        explicit SpscQueue(size_t initCapacity):
+            size(initCapacity + 1), // one slot is always empty to tell a full queue from an empty one
+            elements(size)
+        {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        SpscQueue(SpscQueue&&) = delete;
+        SpscQueue& operator=(SpscQueue&&) = delete;
+
+        inline size_t getCapacity() const { return size - 1; }
+
+        // called only by the producer, returns false if the queue is full
+        bool push(const T& value)
+        {
+            size_t currentTail = tail.load(std::memory_order_relaxed);
+            size_t nextTail = (currentTail + 1) % size;
+
+            if (nextTail == head.load(std::memory_order_acquire))
+                return false;
+
+            elements[currentTail] = value;
+            tail.store(nextTail, std::memory_order_release);
+
+            return true;
+        }
+
+        // called only by the producer, returns false and leaves the value intact if the queue is full
+        bool push(T&& value)
+        {
+            size_t currentTail = tail.load(std::memory_order_relaxed);
+            size_t nextTail = (currentTail + 1) % size;
+
+            if (nextTail == head.load(std::memory_order_acquire))
+                return false;
+
+            elements[currentTail] = std::move(value);
+            tail.store(nextTail, std::memory_order_release);
+
+            return true;
+        }
+
+        // called only by the consumer, returns false if the queue is empty
+        bool pop(T& value)
+        {
+            size_t currentHead = head.load(std::memory_order_relaxed);
+
+            if (currentHead == tail.load(std::memory_order_acquire))
+                return false;
+
+            value = std::move(elements[currentHead]);
+            head.store((currentHead + 1) % size, std::memory_order_release);
+
+            return true;
+        }
+
+        bool isEmpty() const
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        const size_t size;
+        std::vector<T> elements;
+
+        std::atomic<size_t> head{0}; // written only by the consumer
+        std::atomic<size_t> tail{0}; // written only by the producer
+    };
+}
+
+#endif // OUZEL_UTILS_SPSCQUEUE_HPP
@@ -0,0 +1,64 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_STRINGVIEW_HPP
+#define OUZEL_UTILS_STRINGVIEW_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace ouzel
+{
+    // non-owning reference to a sequence of characters, the referenced memory must outlive the view
+    class StringView final
+    {
+    public:
+        StringView() {}
+        StringView(const char* initData, size_t initSize):
+            data(initData), size(initSize)
+        {
+        }
+        StringView(const char* str):
+            data(str), size(std::strlen(str))
+        {
+        }
+        StringView(const std::string& str):
+            data(str.data()), size(str.size())
+        {
+        }
+
+        inline const char* getData() const { return data; }
+        inline size_t getSize() const { return size; }
+        inline bool isEmpty() const { return size == 0; }
+
+        inline const char* begin() const { return data; }
+        inline const char* end() const { return data + size; }
+
+        inline char operator[](size_t index) const { return data[index]; }
+
+        inline std::string toString() const { return std::string(data, size); }
+
+        inline bool operator==(const StringView& other) const
+        {
+            return size == other.size && (size == 0 || std::memcmp(data, other.data, size) == 0);
+        }
+
+        inline bool operator!=(const StringView& other) const
+        {
+            return !(*this == other);
+        }
+
+        inline bool operator<(const StringView& other) const
+        {
+            int result = (size && other.size) ? std::memcmp(data, other.data, std::min(size, other.size)) : 0;
+            return result < 0 || (result == 0 && size < other.size);
+        }
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+}
+
+#endif // OUZEL_UTILS_STRINGVIEW_HPP
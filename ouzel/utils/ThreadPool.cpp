@@ -0,0 +1,66 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "ThreadPool.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    ThreadPool::ThreadPool(const std::string& initName, uint32_t threadCount):
+        name(initName)
+    {
+#if OUZEL_MULTITHREADED
+        if (threadCount == 0)
+            threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+        for (uint32_t i = 0; i < threadCount; ++i)
+            threads.push_back(std::thread(&ThreadPool::work, this));
+#else
+        (void)threadCount;
+#endif
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        std::unique_lock<std::mutex> lock(taskMutex);
+        running = false;
+        lock.unlock();
+        taskCondition.notify_all();
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    void ThreadPool::run(const std::function<void()>& task)
+    {
+        if (threads.empty())
+            task();
+        else
+        {
+            std::unique_lock<std::mutex> lock(taskMutex);
+            tasks.push(task);
+            lock.unlock();
+            taskCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::work()
+    {
+        setCurrentThreadName(name);
+
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock(taskMutex);
+            while (running && tasks.empty()) taskCondition.wait(lock);
+
+            // finish the queued tasks before exiting
+            if (tasks.empty()) break;
+
+            std::function<void()> task = std::move(tasks.front());
+            tasks.pop();
+            lock.unlock();
+
+            task();
+        }
+    }
+}
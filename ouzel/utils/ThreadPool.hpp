@@ -0,0 +1,47 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_THREADPOOL_HPP
+#define OUZEL_UTILS_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/Setup.h"
+
+namespace ouzel
+{
+    class ThreadPool final
+    {
+    public:
+        // zero thread count creates a thread for every CPU core, without threads the tasks are run by the caller
+        ThreadPool(const std::string& initName, uint32_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        void run(const std::function<void()>& task);
+
+        inline uint32_t getThreadCount() const { return static_cast<uint32_t>(threads.size()); }
+
+    private:
+        void work();
+
+        std::string name;
+        std::vector<std::thread> threads;
+        std::queue<std::function<void()>> tasks;
+        std::mutex taskMutex;
+        std::condition_variable taskCondition;
+        bool running = true;
+    };
+}
+
+#endif // OUZEL_UTILS_THREADPOOL_HPP
@@ -29,8 +29,12 @@ namespace ouzel
 
     std::mt19937 randomEngine(std::random_device{}());
 
+    static thread_local std::string currentThreadName;
+
     void setCurrentThreadName(const std::string& name)
     {
+        currentThreadName = name;
+
 #if defined(_MSC_VER)
         THREADNAME_INFO info;
         info.dwType = 0x1000;
@@ -57,4 +61,9 @@ namespace ouzel
 #  endif
 #endif
     }
+
+    const std::string& getCurrentThreadName()
+    {
+        return currentThreadName;
+    }
 }
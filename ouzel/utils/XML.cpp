@@ -1,6 +1,7 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include "XML.hpp"
 #include "Utils.hpp"
@@ -9,136 +10,105 @@ namespace ouzel
 {
     namespace xml
     {
-        static inline bool isWhitespace(uint32_t c)
+        struct Node::Source final
+        {
+            std::vector<uint8_t> data;
+            bool preserveWhitespaces = false;
+            bool preserveComments = false;
+            bool preserveProcessingInstructions = false;
+        };
+
+        static inline bool isWhitespace(char c)
         {
             return c == ' ' || c == '\t' || c == '\r' || c == '\n';
         }
 
-        static inline bool isNameStartChar(uint32_t c)
+        // all non-ASCII characters are accepted in names
+        static inline bool isNameStartChar(char c)
         {
             return (c >= 'a' && c <= 'z') ||
                 (c >= 'A' && c <= 'Z') ||
                 c == ':' || c == '_' ||
-                (c >= 0xC0 && c <= 0xD6) ||
-                (c >= 0xD8 && c <= 0xF6) ||
-                (c >= 0xF8 && c <= 0x2FF) ||
-                (c >= 0x370 && c <= 0x37D) ||
-                (c >= 0x37F && c <= 0x1FFF) ||
-                (c >= 0x200C && c <= 0x200D) ||
-                (c >= 0x2070 && c <= 0x218F);
+                static_cast<uint8_t>(c) >= 0x80;
         }
 
-        static inline bool isNameChar(uint32_t c)
+        static inline bool isNameChar(char c)
         {
             return isNameStartChar(c) ||
                 c == '-' || c == '.' ||
-                (c >= '0' && c <= '9') ||
-                c == 0xB7 ||
-                (c >= 0x0300 && c <= 0x036F) ||
-                (c >= 0x203F && c <= 0x2040);
+                (c >= '0' && c <= '9');
         }
 
-        static void skipWhitespaces(const std::vector<uint32_t>& str,
-                                    std::vector<uint32_t>::const_iterator& iterator)
+        static inline void skipWhitespaces(const char*& iterator, const char* end)
         {
-            for (;;)
-            {
-                if (iterator == str.end()) break;
-
-                if (isWhitespace(*iterator))
-                    ++iterator;
-                else
-                    break;
-            }
+            while (iterator != end && isWhitespace(*iterator)) ++iterator;
         }
 
-        static std::string parseName(const std::vector<uint32_t>& str,
-                                     std::vector<uint32_t>::const_iterator& iterator)
+        static inline bool startsWith(const char* iterator, const char* end, const char* prefix)
         {
-            std::string result;
+            size_t length = std::strlen(prefix);
+            return static_cast<size_t>(end - iterator) >= length && std::equal(prefix, prefix + length, iterator);
+        }
 
-            if (iterator == str.end())
+        static StringView parseName(const char*& iterator, const char* end)
+        {
+            if (iterator == end)
                 throw std::runtime_error("Unexpected end of data");
 
             if (!isNameStartChar(*iterator))
                 throw std::runtime_error("Invalid name start");
 
-            for (;;)
-            {
-                if (iterator == str.end())
-                    throw std::runtime_error("Unexpected end of data");
+            const char* start = iterator;
 
-                if (!isNameChar(*iterator))
-                    break;
-                else
-                {
-                    result += utf32ToUtf8(*iterator);
-                    ++iterator;
-                }
-            }
+            while (iterator != end && isNameChar(*iterator)) ++iterator;
 
-            return result;
+            if (iterator == end)
+                throw std::runtime_error("Unexpected end of data");
+
+            return StringView(start, static_cast<size_t>(iterator - start));
         }
 
-        static std::string parseEntity(const std::vector<uint32_t>& str,
-                                       std::vector<uint32_t>::const_iterator& iterator)
+        // returns the code point of the entity
+        static uint32_t parseEntity(const char*& iterator, const char* end)
         {
-            std::string result;
-
-            if (iterator == str.end())
-                throw std::runtime_error("Unexpected end of data");
-
-            if (*iterator != '&')
-                throw std::runtime_error("Expected an ampersand");
+            ++iterator; // skip the ampersand
 
-            std::string value;
+            const char* start = iterator;
 
             for (;;)
             {
-                if (++iterator == str.end())
+                if (iterator == end)
                     throw std::runtime_error("Unexpected end of data");
 
-                if (*iterator == ';')
-                {
-                    ++iterator;
-                    break;
-                }
-                else
-                    value.push_back(static_cast<char>(*iterator));
+                if (*iterator == ';') break;
+
+                ++iterator;
             }
 
-            if (value.empty())
-                throw std::runtime_error("Invalid entity");
+            StringView value(start, static_cast<size_t>(iterator - start));
+            ++iterator; // skip the semicolon
 
-            if (value == "quot")
-                result = "\"";
-            else if (value == "amp")
-                result = "&";
-            else if (value == "apos")
-                result = "'";
-            else if (value == "lt")
-                result = "<";
-            else if (value == "gt")
-                result = ">";
-            else if (value[0] == '#')
+            if (value == "quot") return '"';
+            else if (value == "amp") return '&';
+            else if (value == "apos") return '\'';
+            else if (value == "lt") return '<';
+            else if (value == "gt") return '>';
+            else if (value.getSize() >= 2 && value[0] == '#')
             {
-                if (value.length() < 2)
-                    throw std::runtime_error("Invalid entity");
-
                 uint32_t c = 0;
 
                 if (value[1] == 'x') // hex value
                 {
-                    if (value.length() != 2 + 4)
+                    if (value.getSize() < 3 || value.getSize() > 2 + 6)
                         throw std::runtime_error("Invalid entity");
 
-                    for (size_t i = 0; i < 4; ++i)
+                    for (size_t i = 2; i < value.getSize(); ++i)
                     {
                         uint8_t code = 0;
 
-                        if (value[i + 2] >= '0' && value[i + 2] <= '9') code = static_cast<uint8_t>(value[i + 2]) - '0';
-                        else if (value[i + 2] >= 'a' && value[i + 2] <='f') code = static_cast<uint8_t>(value[i + 2]) - 'a' + 10;
-                        else if (value[i + 2] >= 'A' && value[i + 2] <='F') code = static_cast<uint8_t>(value[i + 2]) - 'A' + 10;
+                        if (value[i] >= '0' && value[i] <= '9') code = static_cast<uint8_t>(value[i]) - '0';
+                        else if (value[i] >= 'a' && value[i] <='f') code = static_cast<uint8_t>(value[i]) - 'a' + 10;
+                        else if (value[i] >= 'A' && value[i] <='F') code = static_cast<uint8_t>(value[i]) - 'A' + 10;
                         else
                             throw std::runtime_error("Invalid character code");
 
@@ -147,333 +117,435 @@ namespace ouzel
                 }
                 else
                 {
-                    if (value.length() != 1 + 4)
+                    if (value.getSize() > 1 + 7)
                         throw std::runtime_error("Invalid entity");
 
-                    for (size_t i = 0; i < 4; ++i)
+                    for (size_t i = 1; i < value.getSize(); ++i)
                     {
-                        uint8_t code = 0;
-
-                        if (value[i + 1] >= '0' && value[i + 1] <= '9') code = static_cast<uint8_t>(value[i + 1]) - '0';
+                        if (value[i] >= '0' && value[i] <= '9')
+                            c = c * 10 + static_cast<uint32_t>(value[i] - '0');
                         else
                             throw std::runtime_error("Invalid character code");
-
-                        c = c * 10 + code;
                     }
                 }
 
-                result = utf32ToUtf8(c);
+                if (c > 0x10FFFF)
+                    throw std::runtime_error("Invalid character code");
+
+                return c;
             }
             else
                 throw std::runtime_error("Invalid entity");
+        }
 
-            return result;
+        // the entities are validated while reading, so decoding can't fail
+        static void decode(const StringView& str, std::string& result)
+        {
+            result.reserve(str.getSize());
+
+            const char* iterator = str.begin();
+            const char* end = str.end();
+
+            while (iterator != end)
+            {
+                const char* start = iterator;
+                while (iterator != end && *iterator != '&') ++iterator;
+
+                result.append(start, iterator);
+
+                if (iterator != end)
+                    result += utf32ToUtf8(parseEntity(iterator, end));
+            }
         }
 
-        static std::string parseString(const std::vector<uint32_t>& str,
-                                       std::vector<uint32_t>::const_iterator& iterator)
+        Reader::Reader(const uint8_t* initData, size_t initSize,
+                       bool initPreserveWhitespaces, bool detectBOM):
+            data(reinterpret_cast<const char*>(initData)),
+            iterator(data),
+            end(data + initSize),
+            preserveWhitespaces(initPreserveWhitespaces)
         {
-            std::string result;
+            // BOM
+            if (detectBOM &&
+                initSize >= 3 &&
+                initData[0] == 0xEF &&
+                initData[1] == 0xBB &&
+                initData[2] == 0xBF)
+            {
+                bom = true;
+                iterator += 3;
+            }
+        }
 
-            if (iterator == str.end())
-                throw std::runtime_error("Unexpected end of data");
+        bool Reader::next()
+        {
+            attributeCount = 0;
+            text = StringView();
 
-            if (*iterator != '"' && *iterator != '\'')
-                throw std::runtime_error("Expected quotes");
+            if (emptyElement)
+            {
+                emptyElement = false;
+                openTags.pop_back();
+                event = Event::END_TAG;
+                eventOffset = getOffset();
+                return true;
+            }
 
-            char quotes = static_cast<char>(*iterator);
+            if (event == Event::END_OF_DATA) return false;
 
-            ++iterator;
+            if (!preserveWhitespaces) skipWhitespaces(iterator, end);
 
-            for (;;)
+            eventOffset = getOffset();
+
+            if (iterator == end)
             {
-                if (iterator == str.end())
+                if (!openTags.empty())
                     throw std::runtime_error("Unexpected end of data");
 
-                if (*iterator == static_cast<uint32_t>(quotes))
-                {
-                    ++iterator;
-                    break;
-                }
-                else if (*iterator == '&')
-                {
-                    std::string entity = parseEntity(str, iterator);
-                    result += entity;
-                }
-                else
+                event = Event::END_OF_DATA;
+                name = StringView();
+                return false;
+            }
+
+            if (*iterator == '<')
+                parseMarkup();
+            else
+            {
+                const char* start = iterator;
+
+                while (iterator != end && *iterator != '<') // end of a file or start of a tag
                 {
-                    result += utf32ToUtf8(*iterator);
-                    ++iterator;
+                    if (*iterator == '&')
+                        parseEntity(iterator, end);
+                    else
+                        ++iterator;
                 }
+
+                event = Event::TEXT;
+                name = StringView();
+                text = StringView(start, static_cast<size_t>(iterator - start));
+            }
+
+            return true;
+        }
+
+        void Reader::skip()
+        {
+            if (event != Event::START_TAG)
+                throw std::runtime_error("Expected a start tag");
+
+            size_t depth = openTags.size();
+
+            while (next())
+                if (event == Event::END_TAG && openTags.size() == depth - 1)
+                    return;
+
+            throw std::runtime_error("Unexpected end of data");
+        }
+
+        std::string Reader::getValue() const
+        {
+            if (event == Event::TEXT)
+            {
+                std::string result;
+                decode(text, result);
+                return result;
             }
+            else
+                return text.toString();
+        }
 
+        std::string Reader::getAttributeValue(size_t index) const
+        {
+            std::string result;
+            decode(attributes[index].second, result);
             return result;
         }
 
-        static void encodeString(std::vector<uint8_t>& data,
-                                 const std::vector<uint32_t>& str)
+        bool Reader::getAttribute(const StringView& attributeName, std::string& value) const
         {
-            for (uint32_t c : str)
+            for (size_t i = 0; i < attributeCount; ++i)
             {
-                if (c == '"') data.insert(data.end(), {'&', 'q', 'u', 'o', 't', ';'});
-                else if (c == '&') data.insert(data.end(), {'&', 'a', 'm', 'p', ';'});
-                else if (c == '\'') data.insert(data.end(), {'&', 'a', 'p', 'o', 's', ';'});
-                else if (c == '<') data.insert(data.end(), {'&', 'l', 't', ';'});
-                else if (c == '>') data.insert(data.end(), {'&', 'g', 't', ';'});
-                else
+                if (attributes[i].first == attributeName)
                 {
-                    std::string encoded = utf32ToUtf8(c);
-                    data.insert(data.end(), encoded.begin(), encoded.end());
+                    value.clear();
+                    decode(attributes[i].second, value);
+                    return true;
                 }
             }
+
+            return false;
         }
 
-        void Node::parse(const std::vector<uint32_t>& str,
-                         std::vector<uint32_t>::const_iterator& iterator,
-                         bool preserveWhitespaces,
-                         bool preserveComments,
-                         bool preserveProcessingInstructions)
+        void Reader::parseMarkup()
         {
-            if (iterator == str.end())
+            ++iterator; // skip the left angle bracket
+
+            if (iterator == end)
                 throw std::runtime_error("Unexpected end of data");
 
-            if (*iterator == '<')
+            if (*iterator == '!') // <!
             {
-                if (++iterator == str.end())
-                    throw std::runtime_error("Unexpected end of data");
+                ++iterator;
 
-                if (*iterator == '!') // <!
+                if (startsWith(iterator, end, "--")) // <!--
                 {
-                    if (++iterator == str.end())
-                        throw std::runtime_error("Unexpected end of data");
+                    iterator += 2;
+                    const char* start = iterator;
 
-                    if (*iterator == '-') // <!-
+                    for (;;)
                     {
-                        if (++iterator == str.end())
+                        if (end - iterator < 3)
                             throw std::runtime_error("Unexpected end of data");
 
-                        if (*iterator != '-') // <!--
-                            throw std::runtime_error("Expected a comment");
-
-                        for (;;)
+                        if (iterator[0] == '-' && iterator[1] == '-') // --
                         {
-                            if (std::distance<std::vector<uint32_t>::const_iterator>(++iterator, str.end()) < 3)
-                                throw std::runtime_error("Unexpected end of data");
-
-                            if (*iterator == '-')
-                            {
-                                if (*(iterator + 1) == '-') // --
-                                {
-                                    iterator += 2;
-
-                                    if (*iterator == '>') // -->
-                                    {
-                                        ++iterator;
-                                        break;
-                                    }
-                                    else
-                                        throw std::runtime_error("Unexpected double-hyphen inside comment");
-                                }
-                            }
-
-                            value += utf32ToUtf8(*iterator);
+                            if (iterator[2] != '>') // -->
+                                throw std::runtime_error("Unexpected double-hyphen inside comment");
+
+                            break;
                         }
 
-                        type = Type::COMMENT;
-                    }
-                    else if (*iterator == '[') // <![
-                    {
                         ++iterator;
-                        std::string name;
-                        name = parseName(str, iterator);
+                    }
 
-                        if (name != "CDATA")
-                            throw std::runtime_error("Expected CDATA");
+                    text = StringView(start, static_cast<size_t>(iterator - start));
+                    iterator += 3;
+                    event = Event::COMMENT;
+                }
+                else if (startsWith(iterator, end, "[")) // <![
+                {
+                    ++iterator;
 
-                        if (iterator == str.end())
-                            throw std::runtime_error("Unexpected end of data");
+                    if (parseName(iterator, end) != "CDATA")
+                        throw std::runtime_error("Expected CDATA");
 
-                        if (*iterator != '[')
-                            throw std::runtime_error("Expected a left bracket");
+                    if (*iterator != '[')
+                        throw std::runtime_error("Expected a left bracket");
 
-                        for (;;)
-                        {
-                            if (std::distance<std::vector<uint32_t>::const_iterator>(++iterator, str.end()) < 3)
-                                throw std::runtime_error("Unexpected end of data");
-
-                            if (*iterator == ']' &&
-                                *(iterator + 1) == ']' &&
-                                *(iterator + 2) == '>')
-                            {
-                                iterator += 3;
-                                break;
-                            }
-
-                            value += utf32ToUtf8(*iterator);
-                        }
+                    const char* start = ++iterator;
 
-                        type = Type::CDATA;
+                    for (;;)
+                    {
+                        if (end - iterator < 3)
+                            throw std::runtime_error("Unexpected end of data");
+
+                        if (iterator[0] == ']' && iterator[1] == ']' && iterator[2] == '>')
+                            break;
+
+                        ++iterator;
                     }
-                    else
-                        throw std::runtime_error("Type declarations are not supported");
+
+                    text = StringView(start, static_cast<size_t>(iterator - start));
+                    iterator += 3;
+                    event = Event::CDATA;
                 }
-                else if (*iterator == '?') // <?
-                {
-                    ++iterator;
-                    value = parseName(str, iterator);
+                else
+                    throw std::runtime_error("Type declarations are not supported");
 
-                    for (;;)
-                    {
-                        skipWhitespaces(str, iterator);
+                name = StringView();
+            }
+            else if (*iterator == '?') // <?
+            {
+                ++iterator;
+                name = parseName(iterator, end);
+                parseAttributes(true);
+                event = Event::PROCESSING_INSTRUCTION;
+            }
+            else if (*iterator == '/') // </
+            {
+                ++iterator;
+                name = parseName(iterator, end);
 
-                        if (iterator == str.end())
-                            throw std::runtime_error("Unexpected end of data");
+                skipWhitespaces(iterator, end);
 
-                        if (*iterator == '?')
-                        {
-                            if (++iterator == str.end())
-                                throw std::runtime_error("Unexpected end of data");
+                if (iterator == end)
+                    throw std::runtime_error("Unexpected end of data");
 
-                            if (*iterator != '>') // ?>
-                                throw std::runtime_error("Expected a right angle bracket");
+                if (*iterator != '>')
+                    throw std::runtime_error("Expected a right angle bracket");
 
-                            ++iterator;
-                            break;
-                        }
+                ++iterator;
 
-                        std::string attribute = parseName(str, iterator);
+                if (openTags.empty() || openTags.back() != name)
+                    throw std::runtime_error("Tag not closed properly");
 
-                        skipWhitespaces(str, iterator);
+                openTags.pop_back();
+                event = Event::END_TAG;
+            }
+            else // <
+            {
+                name = parseName(iterator, end);
+                parseAttributes(false);
+                openTags.push_back(name);
+                event = Event::START_TAG;
+            }
+        }
 
-                        if (iterator == str.end())
-                            throw std::runtime_error("Unexpected end of data");
+        void Reader::parseAttributes(bool processingInstruction)
+        {
+            for (;;)
+            {
+                skipWhitespaces(iterator, end);
 
-                        if (*iterator != '=')
-                            throw std::runtime_error("Expected an equal sign");
+                if (iterator == end)
+                    throw std::runtime_error("Unexpected end of data");
 
-                        ++iterator;
+                if (processingInstruction && *iterator == '?')
+                {
+                    if (++iterator == end)
+                        throw std::runtime_error("Unexpected end of data");
 
-                        skipWhitespaces(str, iterator);
-                        attributes[attribute] = parseString(str, iterator);
-                    }
+                    if (*iterator != '>') // ?>
+                        throw std::runtime_error("Expected a right angle bracket");
 
-                    type = Type::PROCESSING_INSTRUCTION;
+                    ++iterator;
+                    break;
+                }
+                else if (!processingInstruction && *iterator == '>')
+                {
+                    ++iterator;
+                    break;
                 }
-                else // <
+                else if (!processingInstruction && *iterator == '/')
                 {
-                    value = parseName(str, iterator);
+                    if (++iterator == end)
+                        throw std::runtime_error("Unexpected end of data");
 
-                    bool tagClosed = false;
+                    if (*iterator != '>') // />
+                        throw std::runtime_error("Expected a right angle bracket");
 
-                    for (;;)
-                    {
-                        skipWhitespaces(str, iterator);
+                    emptyElement = true;
+                    ++iterator;
+                    break;
+                }
 
-                        if (iterator == str.end())
-                            throw std::runtime_error("Unexpected end of data");
+                StringView attributeName = parseName(iterator, end);
 
-                        if (*iterator == '>')
-                        {
-                            ++iterator;
-                            break;
-                        }
-                        else if (*iterator == '/')
-                        {
-                            if (++iterator == str.end())
-                                throw std::runtime_error("Unexpected end of data");
+                skipWhitespaces(iterator, end);
 
-                            if (*iterator != '>') // />
-                                throw std::runtime_error("Expected a right angle bracket");
+                if (iterator == end)
+                    throw std::runtime_error("Unexpected end of data");
 
-                            tagClosed = true;
-                            ++iterator;
-                            break;
-                        }
+                if (*iterator != '=')
+                    throw std::runtime_error("Expected an equal sign");
 
-                        std::string attribute;
-                        attribute = parseName(str, iterator);
+                ++iterator;
 
-                        skipWhitespaces(str, iterator);
+                skipWhitespaces(iterator, end);
 
-                        if (iterator == str.end())
-                            throw std::runtime_error("Unexpected end of data");
+                if (iterator == end)
+                    throw std::runtime_error("Unexpected end of data");
+
+                if (*iterator != '"' && *iterator != '\'')
+                    throw std::runtime_error("Expected quotes");
 
-                        if (*iterator != '=')
-                            throw std::runtime_error("Expected an equal sign");
+                char quotes = *iterator++;
+                const char* start = iterator;
 
+                for (;;)
+                {
+                    if (iterator == end)
+                        throw std::runtime_error("Unexpected end of data");
+
+                    if (*iterator == quotes)
+                        break;
+                    else if (*iterator == '&')
+                        parseEntity(iterator, end);
+                    else
                         ++iterator;
+                }
 
-                        skipWhitespaces(str, iterator);
+                StringView attributeValue(start, static_cast<size_t>(iterator - start));
+                ++iterator; // skip the quotes
 
-                        attributes[attribute] = parseString(str, iterator);
-                    }
+                if (attributeCount == attributes.size())
+                    attributes.push_back(std::make_pair(attributeName, attributeValue));
+                else
+                    attributes[attributeCount] = std::make_pair(attributeName, attributeValue);
 
-                    if (!tagClosed)
-                    {
-                        for (;;)
-                        {
-                            if (!preserveWhitespaces) skipWhitespaces(str, iterator);
+                ++attributeCount;
+            }
+        }
 
-                            if (iterator == str.end())
-                                throw std::runtime_error("Unexpected end of data");
+        static void encodeString(std::vector<uint8_t>& data,
+                                 const std::string& str)
+        {
+            for (char c : str)
+            {
+                if (c == '"') data.insert(data.end(), {'&', 'q', 'u', 'o', 't', ';'});
+                else if (c == '&') data.insert(data.end(), {'&', 'a', 'm', 'p', ';'});
+                else if (c == '\'') data.insert(data.end(), {'&', 'a', 'p', 'o', 's', ';'});
+                else if (c == '<') data.insert(data.end(), {'&', 'l', 't', ';'});
+                else if (c == '>') data.insert(data.end(), {'&', 'g', 't', ';'});
+                else
+                    data.push_back(static_cast<uint8_t>(c));
+            }
+        }
 
-                            if (*iterator == '<' &&
-                                iterator + 1 != str.end() &&
-                                *(iterator + 1) == '/')
-                            {
-                                ++iterator; // skip the left angle bracket
-                                ++iterator; // skip the slash
+        bool Node::read(Reader& reader, const std::shared_ptr<const Source>& documentSource)
+        {
+            switch (reader.getEvent())
+            {
+                case Reader::Event::START_TAG:
+                {
+                    type = Type::TAG;
+                    value = reader.getName().toString();
 
-                                std::string tag = parseName(str, iterator);
+                    for (size_t i = 0; i < reader.getAttributeCount(); ++i)
+                        attributes[reader.getAttributeName(i).toString()] = reader.getAttributeValue(i);
 
-                                if (tag != value)
-                                    throw std::runtime_error("Tag not closed properly");
+                    // the whole element is validated here, but its children are created only when they are accessed
+                    contentBegin = reader.getOffset();
+                    reader.skip();
+                    contentEnd = reader.getEventOffset();
 
-                                if (iterator == str.end())
-                                    throw std::runtime_error("Unexpected end of data");
+                    if (contentEnd != contentBegin) source = documentSource;
+                    return true;
+                }
+                case Reader::Event::TEXT:
+                    type = Type::TEXT;
+                    value = reader.getValue();
+                    return true;
+                case Reader::Event::CDATA:
+                    type = Type::CDATA;
+                    value = reader.getValue();
+                    return true;
+                case Reader::Event::COMMENT:
+                    type = Type::COMMENT;
+                    value = reader.getValue();
+                    return documentSource->preserveComments;
+                case Reader::Event::PROCESSING_INSTRUCTION:
+                    type = Type::PROCESSING_INSTRUCTION;
+                    value = reader.getName().toString();
 
-                                if (*iterator != '>')
-                                    throw std::runtime_error("Expected a right angle bracket");
+                    for (size_t i = 0; i < reader.getAttributeCount(); ++i)
+                        attributes[reader.getAttributeName(i).toString()] = reader.getAttributeValue(i);
 
-                                ++iterator;
+                    return documentSource->preserveProcessingInstructions;
+                default:
+                    throw std::runtime_error("Unexpected markup");
+            }
+        }
 
-                                break;
-                            }
-                            else
-                            {
-                                Node node;
-                                node.parse(str, iterator, preserveWhitespaces, preserveComments, preserveProcessingInstructions);
+        void Node::loadChildren() const
+        {
+            std::shared_ptr<const Source> documentSource = std::move(source);
+            source.reset();
 
-                                if ((preserveComments || node.getType() != Type::COMMENT) &&
-                                    (preserveProcessingInstructions || node.getType() != Type::PROCESSING_INSTRUCTION))
-                                    children.push_back(node);
-                            }
-                        }
-                    }
+            Reader reader(documentSource->data.data() + contentBegin, contentEnd - contentBegin,
+                          documentSource->preserveWhitespaces, false);
 
-                    type = Type::TAG;
-                }
-            }
-            else
+            while (reader.next())
             {
-                for (;;)
+                Node node;
+                if (node.read(reader, documentSource))
                 {
-                    if (iterator == str.end() || // end of a file
-                        *iterator == '<') // start of a tag
-                        break;
-                    else if (*iterator == '&')
-                    {
-                        std::string entity = parseEntity(str, iterator);
-                        value += entity;
-                    }
-                    else
-                    {
-                        value += utf32ToUtf8(*iterator);
-                        ++iterator;
-                    }
+                    // the reader's offsets are relative to the content of this node
+                    node.contentBegin += contentBegin;
+                    node.contentEnd += contentBegin;
+                    children.push_back(std::move(node));
                 }
-
-                type = Type::TEXT;
             }
         }
 
@@ -505,7 +577,7 @@ namespace ouzel
                         {
                             data.insert(data.end(), attribute.first.begin(), attribute.first.end());
                             data.insert(data.end(), {'=', '"'});
-                            encodeString(data, utf8ToUtf32(attribute.second));
+                            encodeString(data, attribute.second);
                             data.insert(data.end(), '"');
                         }
                     }
@@ -529,13 +601,13 @@ namespace ouzel
                         }
                     }
 
-                    if (children.empty())
+                    if (getChildren().empty())
                         data.insert(data.end(), {'/', '>'});
                     else
                     {
                         data.insert(data.end(), '>');
 
-                        for (const Node& node : children)
+                        for (const Node& node : getChildren())
                             node.encode(data);
 
                         data.insert(data.end(), {'<', '/'});
@@ -544,13 +616,13 @@ namespace ouzel
                     }
                     break;
                 case Node::Type::TEXT:
-                    encodeString(data, utf8ToUtf32(value));
+                    encodeString(data, value);
                     break;
                 default:
                     throw std::runtime_error("Unknown node type");
             }
 
-            for (const Node& node : children)
+            for (const Node& node : getChildren())
                 node.encode(data);
         }
 
@@ -559,48 +631,38 @@ namespace ouzel
         }
 
         Data::Data(const std::vector<uint8_t>& data,
+                   bool preserveWhitespaces,
+                   bool preserveComments,
+                   bool preserveProcessingInstructions):
+            Data(data.data(), data.size(),
+                 preserveWhitespaces,
+                 preserveComments,
+                 preserveProcessingInstructions)
+        {
+        }
+
+        Data::Data(const uint8_t* data, size_t size,
                    bool preserveWhitespaces,
                    bool preserveComments,
                    bool preserveProcessingInstructions)
         {
-            std::vector<uint32_t> str;
+            // the nodes keep the data until their children are loaded
+            std::shared_ptr<Node::Source> source = std::make_shared<Node::Source>();
+            source->data.assign(data, data + size);
+            source->preserveWhitespaces = preserveWhitespaces;
+            source->preserveComments = preserveComments;
+            source->preserveProcessingInstructions = preserveProcessingInstructions;
 
-            // BOM
-            if (data.size() >= 3 &&
-                data[0] == 0xEF &&
-                data[1] == 0xBB &&
-                data[2] == 0xBF)
-            {
-                bom = true;
-                str = utf8ToUtf32(std::vector<uint8_t>(data.begin() + 3, data.end()));
-            }
-            else
-            {
-                bom = false;
-                str = utf8ToUtf32(data);
-            }
+            Reader reader(source->data.data(), source->data.size(), preserveWhitespaces);
+            bom = reader.hasBOM();
 
             bool rootTagFound = false;
 
-            auto iterator = str.cbegin();
-
-            for (;;)
+            while (reader.next())
             {
-                if (!preserveWhitespaces) skipWhitespaces(str, iterator);
-
-                if (iterator == str.end()) break;
-
                 Node node;
-                node.parse(str, iterator,
-                           preserveWhitespaces,
-                           preserveComments,
-                           preserveProcessingInstructions);
-
-                if ((preserveComments || node.getType() != Node::Type::COMMENT) &&
-                    (preserveProcessingInstructions || node.getType() != Node::Type::PROCESSING_INSTRUCTION))
+                if (node.read(reader, source))
                 {
-                    children.push_back(node);
-
                     if (node.getType() == Node::Type::TAG)
                     {
                         if (rootTagFound)
@@ -608,6 +670,8 @@ namespace ouzel
                         else
                             rootTagFound = true;
                     }
+
+                    children.push_back(std::move(node));
                 }
             }
 
@@ -3,15 +3,95 @@
 #ifndef OUZEL_UTILS_XML_HPP
 #define OUZEL_UTILS_XML_HPP
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
+#include "utils/StringView.hpp"
 
 namespace ouzel
 {
     namespace xml
     {
         class Data;
+        class Node;
+
+        // pull parser that reports the markup as a sequence of events, names and raw values are views into the source
+        class Reader final
+        {
+            friend Node;
+        public:
+            enum class Event
+            {
+                NONE,
+                START_TAG,
+                END_TAG, // also reported for empty-element tags
+                TEXT,
+                CDATA,
+                COMMENT,
+                PROCESSING_INSTRUCTION,
+                END_OF_DATA
+            };
+
+            Reader(const uint8_t* initData, size_t initSize,
+                   bool initPreserveWhitespaces = false):
+                Reader(initData, initSize, initPreserveWhitespaces, true)
+            {
+            }
+
+            // returns false at the end of data
+            bool next();
+
+            // skips the content of the current start tag, the current event becomes its end tag
+            void skip();
+
+            inline Event getEvent() const { return event; }
+            inline uint32_t getDepth() const { return static_cast<uint32_t>(openTags.size()); }
+
+            // start of the current event's markup
+            inline size_t getEventOffset() const { return eventOffset; }
+            inline size_t getOffset() const { return static_cast<size_t>(iterator - data); }
+
+            inline bool hasBOM() const { return bom; }
+
+            // name of a tag or a processing instruction
+            inline const StringView& getName() const { return name; }
+
+            // raw contents of a text, CDATA section or comment
+            inline const StringView& getText() const { return text; }
+            // contents with the entities decoded
+            std::string getValue() const;
+
+            inline size_t getAttributeCount() const { return attributeCount; }
+            inline const StringView& getAttributeName(size_t index) const { return attributes[index].first; }
+            std::string getAttributeValue(size_t index) const;
+            bool getAttribute(const StringView& attributeName, std::string& value) const;
+
+        private:
+            Reader(const uint8_t* initData, size_t initSize,
+                   bool initPreserveWhitespaces, bool detectBOM);
+
+            void parseMarkup();
+            void parseAttributes(bool processingInstruction);
+
+            const char* data;
+            const char* iterator;
+            const char* end;
+            bool preserveWhitespaces;
+            bool bom = false;
+
+            Event event = Event::NONE;
+            size_t eventOffset = 0;
+            bool emptyElement = false;
+            StringView name;
+            StringView text;
+            // reused between tags
+            std::vector<std::pair<StringView, StringView>> attributes;
+            size_t attributeCount = 0;
+            std::vector<StringView> openTags;
+        };
 
         class Node final
         {
@@ -50,22 +130,35 @@ namespace ouzel
             inline const std::string& getValue() const { return value; }
             inline void getValue(const std::string& newValue) { value = newValue; }
 
-            inline const std::vector<Node>& getChildren() const { return children; }
+            inline const std::map<std::string, std::string>& getAttributes() const { return attributes; }
+
+            // the children of a tag are parsed on the first access
+            inline const std::vector<Node>& getChildren() const
+            {
+                if (source) loadChildren();
+                return children;
+            }
 
         protected:
-            void parse(const std::vector<uint32_t>& str,
-                       std::vector<uint32_t>::const_iterator& iterator,
-                       bool preserveWhitespaces = false,
-                       bool preserveComments = false,
-                       bool preserveProcessingInstructions = false);
             void encode(std::vector<uint8_t>& data) const;
 
         private:
+            struct Source;
+
+            // returns false if the node should be left out
+            bool read(Reader& reader, const std::shared_ptr<const Source>& documentSource);
+            void loadChildren() const;
+
             Type type = Type::NONE;
 
             std::string value;
             std::map<std::string, std::string> attributes;
-            std::vector<Node> children;
+            mutable std::vector<Node> children;
+
+            // unparsed content of the tag
+            mutable std::shared_ptr<const Source> source;
+            size_t contentBegin = 0;
+            size_t contentEnd = 0;
         };
 
         class Data final
@@ -76,6 +169,10 @@ namespace ouzel
                  bool preserveWhitespaces = false,
                  bool preserveComments = false,
                  bool preserveProcessingInstructions = false);
+            Data(const uint8_t* data, size_t size,
+                 bool preserveWhitespaces = false,
+                 bool preserveComments = false,
+                 bool preserveProcessingInstructions = false);
 
             std::vector<uint8_t> encode() const;
 
@@ -1,5 +1,8 @@
 #version 400
-uniform vec4 color;
+layout(std140) uniform FragmentConstants
+{
+    vec4 color;
+};
 in vec4 exColor;
 out vec4 outColor;
 void main()
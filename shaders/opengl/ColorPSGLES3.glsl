@@ -1,6 +1,9 @@
 #version 300 es
 precision mediump float;
-uniform lowp vec4 color;
+layout(std140) uniform FragmentConstants
+{
+    lowp vec4 color;
+};
 in lowp vec4 exColor;
 out vec4 outColor;
 void main()
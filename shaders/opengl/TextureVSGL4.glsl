@@ -2,7 +2,10 @@
 in vec3 position0;
 in vec4 color0;
 in vec2 texCoord0;
-uniform mat4 modelViewProj;
+layout(std140) uniform VertexConstants
+{
+    mat4 modelViewProj;
+};
 out vec4 exColor;
 out vec2 exTexCoord;
 void main()
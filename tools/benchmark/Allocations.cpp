@@ -0,0 +1,27 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// kept in its own translation unit, so that the compiler does not inline the replaced operators into the benchmark
+std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void* result = std::malloc(size ? size : 1)) return result;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,14 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+// argv[0] is the name of the benchmark, returns a non-zero value if the results of the compared implementations differ
+int commandBufferBenchmark(int argc, char* argv[]);
+int eventDispatchBenchmark(int argc, char* argv[]);
+int handleChurnBenchmark(int argc, char* argv[]);
+int jsonBenchmark(int argc, char* argv[]);
+int obfBenchmark(int argc, char* argv[]);
+
+#endif // BENCHMARKS_HPP
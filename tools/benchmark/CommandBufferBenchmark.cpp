@@ -0,0 +1,228 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <vector>
+#include "graphics/Commands.hpp"
+#include "Benchmarks.hpp"
+
+using namespace ouzel;
+using namespace graphics;
+
+// records and decodes the commands of 20000 sprites per frame, comparing the command buffer arena with
+// the previous design (a queue of individually heap allocated commands with a virtual destructor)
+
+// counted by the replaced global operator new in Allocations.cpp
+extern std::atomic<uint64_t> allocationCount;
+
+namespace
+{
+    const uint32_t FRAME_COUNT = 100;
+    const uint32_t SPRITE_COUNT = 20000;
+
+    namespace legacy
+    {
+        class Command
+        {
+        public:
+            explicit Command(graphics::Command::Type initType):
+                type(initType)
+            {
+            }
+
+            virtual ~Command() {}
+
+            const graphics::Command::Type type;
+        };
+
+        class SetPipelineStateCommand: public Command
+        {
+        public:
+            SetPipelineStateCommand(uintptr_t initBlendState,
+                                    uintptr_t initShader):
+                Command(graphics::Command::Type::SET_PIPELINE_STATE),
+                blendState(initBlendState),
+                shader(initShader)
+            {
+            }
+
+            uintptr_t blendState;
+            uintptr_t shader;
+        };
+
+        class SetShaderConstantsCommand: public Command
+        {
+        public:
+            SetShaderConstantsCommand(std::vector<std::vector<float>> initFragmentShaderConstants,
+                                      std::vector<std::vector<float>> initVertexShaderConstants):
+                Command(graphics::Command::Type::SET_SHADER_CONSTANTS),
+                fragmentShaderConstants(initFragmentShaderConstants),
+                vertexShaderConstants(initVertexShaderConstants)
+            {
+            }
+
+            std::vector<std::vector<float>> fragmentShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
+        };
+
+        class SetTexturesCommand: public Command
+        {
+        public:
+            explicit SetTexturesCommand(uintptr_t initTextures[Texture::LAYERS]):
+                Command(graphics::Command::Type::SET_TEXTURES)
+            {
+                for (uint32_t i = 0; i < Texture::LAYERS; ++i)
+                    textures[i] = initTextures[i];
+            }
+
+            uintptr_t textures[Texture::LAYERS];
+        };
+
+        class DrawCommand: public Command
+        {
+        public:
+            DrawCommand(uintptr_t initIndexBuffer,
+                        uint32_t initIndexCount,
+                        uint32_t initIndexSize,
+                        uintptr_t initVertexBuffer,
+                        DrawMode initDrawMode,
+                        uint32_t initStartIndex):
+                Command(graphics::Command::Type::DRAW),
+                indexBuffer(initIndexBuffer),
+                indexCount(initIndexCount),
+                indexSize(initIndexSize),
+                vertexBuffer(initVertexBuffer),
+                drawMode(initDrawMode),
+                startIndex(initStartIndex)
+            {
+            }
+
+            uintptr_t indexBuffer;
+            uint32_t indexCount;
+            uint32_t indexSize;
+            uintptr_t vertexBuffer;
+            DrawMode drawMode;
+            uint32_t startIndex;
+        };
+    } // namespace legacy
+
+    struct Result
+    {
+        double time;
+        uint64_t firstFrameAllocations;
+        uint64_t allocations; // after the first frame
+        uint64_t checksum;
+    };
+
+    void printResult(const char* name, const Result& result)
+    {
+        const double commandCount = static_cast<double>(FRAME_COUNT) * SPRITE_COUNT * 4;
+
+        std::printf("%s: %.2f ms, %.2f M commands/s, %llu allocations in the first frame, %.1f allocations per frame after it\n", name,
+                    result.time,
+                    commandCount / result.time / 1000.0,
+                    static_cast<unsigned long long>(result.firstFrameAllocations),
+                    static_cast<double>(result.allocations) / (FRAME_COUNT - 1));
+    }
+
+    Result measureLegacy()
+    {
+        Result result = {0.0, 0, 0, 0};
+        std::queue<std::unique_ptr<legacy::Command>> commandBuffer;
+        const float modelViewProj[16] = {1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F};
+        const float color[4] = {1.0F, 1.0F, 1.0F, 1.0F};
+
+        uint64_t startAllocations = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            for (uint32_t sprite = 0; sprite < SPRITE_COUNT; ++sprite)
+            {
+                uintptr_t textures[Texture::LAYERS] = {sprite % 16 + 1};
+
+                commandBuffer.push(std::unique_ptr<legacy::Command>(new legacy::SetPipelineStateCommand(1, 2)));
+                commandBuffer.push(std::unique_ptr<legacy::Command>(new legacy::SetShaderConstantsCommand(
+                    {std::vector<float>(color, color + 4)},
+                    {std::vector<float>(modelViewProj, modelViewProj + 16)})));
+                commandBuffer.push(std::unique_ptr<legacy::Command>(new legacy::SetTexturesCommand(textures)));
+                commandBuffer.push(std::unique_ptr<legacy::Command>(new legacy::DrawCommand(3, 6, 2, 4, DrawMode::TRIANGLE_LIST, sprite * 6)));
+            }
+
+            // the render thread pops and frees the commands one by one
+            while (!commandBuffer.empty())
+            {
+                const legacy::Command* command = commandBuffer.front().get();
+                result.checksum += command->type;
+                if (command->type == graphics::Command::Type::DRAW)
+                    result.checksum += static_cast<const legacy::DrawCommand*>(command)->startIndex;
+                commandBuffer.pop();
+            }
+
+            if (frame == 0) result.firstFrameAllocations = allocationCount - startAllocations;
+        }
+
+        result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocationCount - startAllocations - result.firstFrameAllocations;
+
+        return result;
+    }
+
+    Result measureArena()
+    {
+        Result result = {0.0, 0, 0, 0};
+        CommandBuffer commandBuffer;
+        const float modelViewProj[16] = {1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, 1.0F};
+        const float color[4] = {1.0F, 1.0F, 1.0F, 1.0F};
+
+        // the first frame grows the blocks, the render devices hand the buffer back for reuse afterwards
+        uint64_t startAllocations = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            for (uint32_t sprite = 0; sprite < SPRITE_COUNT; ++sprite)
+            {
+                uintptr_t textures[Texture::LAYERS] = {sprite % 16 + 1};
+
+                commandBuffer.push(SetPipelineStateCommand(1, 2));
+                commandBuffer.push(SetShaderConstantsCommand(commandBuffer.pushConstants(color, sizeof(color)),
+                                                             commandBuffer.pushConstants(modelViewProj, sizeof(modelViewProj))));
+                commandBuffer.push(SetTexturesCommand(textures));
+                commandBuffer.push(DrawCommand(3, 6, 2, 4, DrawMode::TRIANGLE_LIST, sprite * 6));
+            }
+
+            for (const Command* command : commandBuffer)
+            {
+                result.checksum += command->type;
+                if (command->type == Command::Type::DRAW)
+                    result.checksum += static_cast<const DrawCommand*>(command)->startIndex;
+            }
+
+            commandBuffer.clear();
+
+            if (frame == 0) result.firstFrameAllocations = allocationCount - startAllocations;
+        }
+
+        result.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocationCount - startAllocations - result.firstFrameAllocations;
+
+        return result;
+    }
+}
+
+int commandBufferBenchmark(int, char*[])
+{
+    Result legacyResult = measureLegacy();
+    Result arenaResult = measureArena();
+
+    std::printf("%u frames of %u sprites (4 commands each)\n", FRAME_COUNT, SPRITE_COUNT);
+    printResult("queue of heap allocated commands", legacyResult);
+    printResult("command buffer arena", arenaResult);
+
+    return (legacyResult.checksum == arenaResult.checksum) ? 0 : 1;
+}
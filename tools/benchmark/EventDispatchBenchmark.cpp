@@ -0,0 +1,215 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <queue>
+#include <vector>
+#include "events/EventDispatcher.hpp"
+#include "Benchmarks.hpp"
+
+using namespace ouzel;
+
+// posts and dispatches 1000000 events to 10000 handlers, comparing the per category handler lists of
+// EventDispatcher with the previous dispatcher (a single handler list and a promise for every event)
+// every handler has an update function (like an animated sprite), every 100th also handles the keyboard and the mouse,
+// every 1000th event is an update event and the others are input events
+
+namespace
+{
+    const uint32_t HANDLER_COUNT = 10000;
+    const uint32_t INPUT_HANDLER_INTERVAL = 100;
+    const uint32_t EVENT_COUNT = 1000000;
+    const uint32_t FRAME_EVENT_COUNT = 1000; // events posted before each dispatch, the last one is the update event
+    // the previous dispatcher visits every handler for every event, so it is measured over a part of the events
+    const uint32_t LEGACY_EVENT_COUNT = 10000;
+
+    namespace legacy
+    {
+        // the previous EventDispatcher, reduced to the event types of the benchmark
+        class EventDispatcher final
+        {
+        public:
+            void addEventHandler(const EventHandler* eventHandler)
+            {
+                eventHandlers.push_back(eventHandler);
+            }
+
+            std::future<bool> postEvent(std::unique_ptr<Event>&& event)
+            {
+                std::pair<std::promise<bool>, std::unique_ptr<Event>> queuedEvent;
+                queuedEvent.second = std::move(event);
+                std::future<bool> future = queuedEvent.first.get_future();
+
+                std::unique_lock<std::mutex> lock(eventQueueMutex);
+                eventQueue.push(std::move(queuedEvent));
+
+                return future;
+            }
+
+            void dispatchEvents()
+            {
+                for (;;)
+                {
+                    std::pair<std::promise<bool>, std::unique_ptr<Event>> event;
+                    {
+                        std::unique_lock<std::mutex> lock(eventQueueMutex);
+                        if (eventQueue.empty()) break;
+
+                        event = std::move(eventQueue.front());
+                        eventQueue.pop();
+                    }
+
+                    event.first.set_value(dispatchEvent(std::move(event.second)));
+                }
+            }
+
+            bool dispatchEvent(std::unique_ptr<Event>&& event)
+            {
+                bool handled = false;
+
+                for (const EventHandler* eventHandler : eventHandlers)
+                {
+                    auto i = std::find(eventHandlerDeleteSet.begin(), eventHandlerDeleteSet.end(), eventHandler);
+
+                    if (i == eventHandlerDeleteSet.end())
+                    {
+                        switch (event->type)
+                        {
+                            case Event::Type::KEY_PRESS:
+                                if (eventHandler->keyboardHandler)
+                                    handled = eventHandler->keyboardHandler(*static_cast<KeyboardEvent*>(event.get()));
+                                break;
+                            case Event::Type::MOUSE_MOVE:
+                                if (eventHandler->mouseHandler)
+                                    handled = eventHandler->mouseHandler(*static_cast<MouseEvent*>(event.get()));
+                                break;
+                            case Event::Type::UPDATE:
+                                if (eventHandler->updateHandler)
+                                    handled = eventHandler->updateHandler(*static_cast<UpdateEvent*>(event.get()));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    if (handled) break;
+                }
+
+                return handled;
+            }
+
+        private:
+            std::vector<const EventHandler*> eventHandlers;
+            std::vector<const EventHandler*> eventHandlerDeleteSet;
+
+            std::mutex eventQueueMutex;
+            std::queue<std::pair<std::promise<bool>, std::unique_ptr<Event>>> eventQueue;
+        };
+    } // namespace legacy
+
+    std::unique_ptr<Event> createEvent(uint32_t index)
+    {
+        if (index % FRAME_EVENT_COUNT == FRAME_EVENT_COUNT - 1)
+        {
+            std::unique_ptr<UpdateEvent> event(new UpdateEvent());
+            event->type = Event::Type::UPDATE;
+            event->delta = 1.0F / 60.0F;
+            return std::move(event);
+        }
+        else if (index % 2)
+        {
+            std::unique_ptr<KeyboardEvent> event(new KeyboardEvent());
+            event->type = Event::Type::KEY_PRESS;
+            event->key = input::Keyboard::Key::SPACE;
+            return std::move(event);
+        }
+        else
+        {
+            std::unique_ptr<MouseEvent> event(new MouseEvent());
+            event->type = Event::Type::MOUSE_MOVE;
+            event->position = Vector2(static_cast<float>(index % 640), static_cast<float>(index % 480));
+            return std::move(event);
+        }
+    }
+
+    template<class Dispatcher, class Post>
+    double measure(Dispatcher& dispatcher, uint32_t eventCount, Post post)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t index = 0; index < eventCount; ++index)
+        {
+            post(dispatcher, createEvent(index));
+
+            if (index % FRAME_EVENT_COUNT == FRAME_EVENT_COUNT - 1)
+                dispatcher.dispatchEvents();
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int eventDispatchBenchmark(int, char*[])
+{
+    uint64_t callCount = 0;
+    std::vector<std::unique_ptr<EventHandler>> eventHandlers;
+    eventHandlers.reserve(HANDLER_COUNT);
+
+    for (uint32_t i = 0; i < HANDLER_COUNT; ++i)
+    {
+        std::unique_ptr<EventHandler> eventHandler(new EventHandler());
+        // none of the handlers consumes the event, so that every event reaches all of them
+        eventHandler->updateHandler = [&callCount](const UpdateEvent&) { ++callCount; return false; };
+
+        if (i % INPUT_HANDLER_INTERVAL == 0)
+        {
+            eventHandler->keyboardHandler = [&callCount](const KeyboardEvent&) { ++callCount; return false; };
+            eventHandler->mouseHandler = [&callCount](const MouseEvent&) { ++callCount; return false; };
+        }
+
+        eventHandlers.push_back(std::move(eventHandler));
+    }
+
+    legacy::EventDispatcher legacyDispatcher;
+    for (const std::unique_ptr<EventHandler>& eventHandler : eventHandlers)
+        legacyDispatcher.addEventHandler(eventHandler.get());
+
+    double legacyTime = measure(legacyDispatcher, LEGACY_EVENT_COUNT, [](legacy::EventDispatcher& dispatcher, std::unique_ptr<Event>&& event) {
+        dispatcher.postEvent(std::move(event));
+    });
+    uint64_t legacyCallCount = callCount;
+
+    EventDispatcher dispatcher;
+    for (const std::unique_ptr<EventHandler>& eventHandler : eventHandlers)
+        dispatcher.addEventHandler(eventHandler.get());
+
+    callCount = 0;
+    double promiseTime = measure(dispatcher, EVENT_COUNT, [](EventDispatcher& dispatcher, std::unique_ptr<Event>&& event) {
+        dispatcher.postEvent(std::move(event));
+    });
+    uint64_t promiseCallCount = callCount;
+
+    callCount = 0;
+    double detachedTime = measure(dispatcher, EVENT_COUNT, [](EventDispatcher& dispatcher, std::unique_ptr<Event>&& event) {
+        dispatcher.postEventDetached(std::move(event));
+    });
+    uint64_t detachedCallCount = callCount;
+
+    const double legacyScale = static_cast<double>(EVENT_COUNT) / LEGACY_EVENT_COUNT;
+
+    std::printf("%u events, %u handlers\n", EVENT_COUNT, HANDLER_COUNT);
+    std::printf("single handler list: %.2f ms (measured over %u events)\n", legacyTime * legacyScale, LEGACY_EVENT_COUNT);
+    std::printf("per category handler lists: %.2f ms\n", promiseTime);
+    std::printf("per category handler lists, detached posting: %.2f ms\n", detachedTime);
+
+    // the event sequence repeats every FRAME_EVENT_COUNT events, so the calls scale with the event count
+    bool sameCalls = static_cast<double>(legacyCallCount) * legacyScale == static_cast<double>(promiseCallCount) &&
+        promiseCallCount == detachedCallCount;
+    std::printf("same handler calls: %s\n", sameCalls ? "yes" : "no");
+
+    return sameCalls ? 0 : 1;
+}
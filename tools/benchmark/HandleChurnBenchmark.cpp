@@ -0,0 +1,150 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <vector>
+#include "utils/HandleTable.hpp"
+#include "Benchmarks.hpp"
+
+using namespace ouzel;
+
+// creates and destroys resources the way textures and buffers are churned during streaming,
+// comparing the generational handle tables with the previous id allocator (a set of free ids and a vector of objects)
+
+namespace
+{
+    const uint32_t CHURN_COUNT = 100000;
+    const uint32_t LIVE_COUNT = 1000;
+
+    struct Resource
+    {
+        uint32_t data[16] = {};
+    };
+
+    class SetIdAllocator final
+    {
+    public:
+        uintptr_t getId()
+        {
+            auto i = deletedIds.begin();
+
+            if (i == deletedIds.end())
+                return ++lastId; // zero is reserved for null resource
+            else
+            {
+                uintptr_t id = *i;
+                deletedIds.erase(i);
+                return id;
+            }
+        }
+
+        void deleteId(uintptr_t id)
+        {
+            deletedIds.insert(id);
+        }
+
+    private:
+        uintptr_t lastId = 0;
+        std::set<uintptr_t> deletedIds;
+    };
+
+    template<class F>
+    double measure(F function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // removes a pseudo-random live resource
+    uintptr_t takeLive(std::vector<uintptr_t>& live, uint32_t i)
+    {
+        size_t index = (i * 7919) % live.size();
+        uintptr_t result = live[index];
+        live[index] = live.back();
+        live.pop_back();
+        return result;
+    }
+}
+
+int handleChurnBenchmark(int, char*[])
+{
+    uint32_t checksum = 0;
+
+    double setTime = measure([&checksum]() {
+        SetIdAllocator ids;
+        std::vector<std::unique_ptr<Resource>> resources;
+        std::vector<uintptr_t> live;
+
+        for (uint32_t i = 0; i < CHURN_COUNT; ++i)
+        {
+            uintptr_t id = ids.getId();
+            if (id > resources.size()) resources.resize(id);
+            resources[id - 1].reset(new Resource());
+            live.push_back(id);
+
+            checksum += resources[live[live.size() / 2] - 1]->data[0];
+
+            if (live.size() > LIVE_COUNT)
+            {
+                uintptr_t deleted = takeLive(live, i);
+                resources[deleted - 1].reset();
+                ids.deleteId(deleted);
+            }
+        }
+    });
+
+    double handleTime = measure([&checksum]() {
+        HandlePool ids;
+        HandleTable<Resource> resources;
+        std::vector<uintptr_t> live;
+
+        for (uint32_t i = 0; i < CHURN_COUNT; ++i)
+        {
+            uintptr_t handle = ids.allocate();
+            resources.insert(handle, std::unique_ptr<Resource>(new Resource()));
+            live.push_back(handle);
+
+            checksum += resources.get(live[live.size() / 2])->data[0];
+
+            if (live.size() > LIVE_COUNT)
+            {
+                uintptr_t deleted = takeLive(live, i);
+                resources.erase(deleted);
+                ids.release(deleted);
+            }
+        }
+    });
+
+    // a released handle must not resolve to the object that reuses its slot
+    HandlePool ids;
+    HandleTable<Resource> resources;
+    uintptr_t stale = ids.allocate();
+    resources.insert(stale, std::unique_ptr<Resource>(new Resource()));
+    resources.erase(stale);
+    ids.release(stale);
+    uintptr_t handle = ids.allocate();
+    resources.insert(handle, std::unique_ptr<Resource>(new Resource()));
+
+    bool staleDetected = false;
+    try
+    {
+        resources.get(stale);
+    }
+    catch (const std::runtime_error&)
+    {
+        staleDetected = true;
+    }
+
+    std::printf("%u creates and destroys with %u live resources\n", CHURN_COUNT, LIVE_COUNT);
+    std::printf("set of free ids: %.2f ms\n", setTime);
+    std::printf("handle table: %.2f ms\n", handleTime);
+    std::printf("slot reused: %s, stale handle detected: %s\n",
+                HandlePool::getIndex(stale) == HandlePool::getIndex(handle) ? "yes" : "no",
+                staleDetected ? "yes" : "no");
+
+    return (staleDetected && checksum == 0) ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "utils/JSON.hpp"
+#include "LegacyJSON.hpp"
+#include "Benchmarks.hpp"
+
+using namespace ouzel;
+
+// parses a JSON document (a generated sprite sheet of 20000 frames or the file given as the argument,
+// e.g. "./benchmark jsonparse ../../samples/Resources/run.json"), comparing json::Data with the previous parser
+
+namespace
+{
+    const uint32_t FRAME_COUNT = 20000;
+    const uint32_t PASS_COUNT = 10;
+
+    // the format of the TexturePacker sprite sheets loaded by LoaderSprite
+    std::vector<uint8_t> generateSpriteSheet()
+    {
+        std::string document = "{\"frames\":[";
+
+        for (uint32_t i = 0; i < FRAME_COUNT; ++i)
+        {
+            const std::string x = std::to_string((i % 64) * 64);
+            const std::string y = std::to_string((i / 64) * 64);
+
+            if (i > 0) document += ",";
+            document += "{\"filename\":\"frame" + std::to_string(i) + ".png\","
+                "\"frame\":{\"x\":" + x + ",\"y\":" + y + ",\"w\":64,\"h\":64},"
+                "\"rotated\":false,\"trimmed\":true,"
+                "\"spriteSourceSize\":{\"x\":2,\"y\":-3,\"w\":60,\"h\":61},"
+                "\"sourceSize\":{\"w\":64,\"h\":64},"
+                "\"pivot\":{\"x\":0.5,\"y\":0.25e+0}}";
+        }
+
+        document += "],\"meta\":{\"app\":\"http:\\/\\/www.codeandweb.com\\/texturepacker\",\"version\":\"1.0\","
+            "\"image\":\"sheet.png\",\"format\":\"RGBA8888\",\"size\":{\"w\":4096,\"h\":20032},\"scale\":\"1\"}}";
+
+        return std::vector<uint8_t>(document.begin(), document.end());
+    }
+
+    // sums the numbers, the lengths of the strings and keys and the sizes of the containers
+    template<class T>
+    double checksum(const T& value)
+    {
+        switch (value.getType())
+        {
+            case T::Type::NUMBER:
+            case T::Type::BOOLEAN:
+                return value.template as<double>();
+            case T::Type::STRING:
+                return static_cast<double>(value.template as<std::string>().size());
+            case T::Type::OBJECT:
+            {
+                if (value.isNull()) return -1.0;
+
+                double result = static_cast<double>(value.template as<typename T::Object>().size());
+                for (const auto& member : value.template as<typename T::Object>())
+                    result += static_cast<double>(member.first.size()) + checksum(member.second);
+                return result;
+            }
+            case T::Type::ARRAY:
+            {
+                double result = static_cast<double>(value.template as<typename T::Array>().size());
+                for (const auto& element : value.template as<typename T::Array>())
+                    result += checksum(element);
+                return result;
+            }
+            default:
+                return 0.0;
+        }
+    }
+
+    template<class T>
+    double measure(const std::vector<uint8_t>& data, double& result)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t pass = 0; pass < PASS_COUNT; ++pass)
+        {
+            T document(data.data(), data.size());
+            result = checksum(document);
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / PASS_COUNT;
+    }
+}
+
+int jsonBenchmark(int argc, char* argv[])
+{
+    std::vector<uint8_t> data;
+
+    if (argc > 1)
+    {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+            return 1;
+        }
+
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else
+        data = generateSpriteSheet();
+
+    double legacyChecksum = 0.0;
+    double legacyTime = measure<legacy::Data>(data, legacyChecksum);
+
+    double parsedChecksum = 0.0;
+    double time = measure<json::Data>(data, parsedChecksum);
+
+    const double megabytes = static_cast<double>(data.size()) / (1024.0 * 1024.0);
+
+    std::printf("%zu bytes, average of %u passes\n", data.size(), PASS_COUNT);
+    std::printf("tokenizing parser: %.2f ms, %.2f MB/s\n", legacyTime, megabytes / legacyTime * 1000.0);
+    std::printf("single pass parser: %.2f ms, %.2f MB/s\n", time, megabytes / time * 1000.0);
+    std::printf("same values: %s\n", (parsedChecksum == legacyChecksum) ? "yes" : "no");
+
+    return (parsedChecksum == legacyChecksum) ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#ifndef LEGACYJSON_HPP
+#define LEGACYJSON_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// the previous JSON parser (UTF-32 conversion, a token vector and values with every member side by side),
+// reduced to parsing and the const accessors
+namespace legacy
+{
+    struct Token final
+    {
+        enum class Type
+        {
+            NONE,
+            LITERAL_NUMBER, // float
+            LITERAL_STRING, // string
+            KEYWORD_TRUE, // true
+            KEYWORD_FALSE, // false
+            KEYWORD_NULL, // null
+            LEFT_BRACE, // {
+            RIGHT_BRACE, // }
+            LEFT_BRACKET, // [
+            RIGHT_BRACKET, // ]
+            COMMA, // ,
+            COLON, // :
+            OPERATOR_MINUS // -
+        };
+
+        Type type = Type::NONE;
+        std::vector<uint32_t> value;
+    };
+
+    class Value
+    {
+    public:
+        using Array = std::vector<Value>;
+        using Object = std::map<std::string, Value>;
+
+        enum class Type
+        {
+            NONE,
+            NUMBER,
+            STRING,
+            OBJECT,
+            ARRAY,
+            BOOLEAN
+        };
+
+        inline Type getType() const { return type; }
+
+        template<typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+        const std::string& as() const { return stringValue; }
+
+        template<typename T, typename std::enable_if<std::is_same<T, bool>::value>::type* = nullptr>
+        T as() const { return (type == Type::BOOLEAN) ? boolValue : doubleValue != 0.0; }
+
+        template<typename T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type* = nullptr>
+        T as() const { return (type == Type::BOOLEAN) ? boolValue : static_cast<T>(doubleValue); }
+
+        template<typename T, typename std::enable_if<std::is_same<T, Object>::value>::type* = nullptr>
+        inline const Object& as() const { return objectValue; }
+
+        template<typename T, typename std::enable_if<std::is_same<T, Array>::value>::type* = nullptr>
+        inline const Array& as() const { return arrayValue; }
+
+        inline bool isNull() const { return nullValue; }
+
+    protected:
+        void parseValue(const std::vector<Token>& tokens,
+                        std::vector<Token>::const_iterator& iterator);
+        void parseObject(const std::vector<Token>& tokens,
+                         std::vector<Token>::const_iterator& iterator);
+        void parseArray(const std::vector<Token>& tokens,
+                        std::vector<Token>::const_iterator& iterator);
+
+    private:
+        Type type = Type::NONE;
+        bool boolValue = false;
+        bool nullValue = false;
+        double doubleValue = 0.0;
+        Object objectValue;
+        Array arrayValue;
+        std::string stringValue;
+    };
+
+    class Data final: public Value
+    {
+    public:
+        Data(const uint8_t* data, size_t size);
+
+    private:
+        bool bom = false;
+    };
+} // namespace legacy
+
+#endif // LEGACYJSON_HPP
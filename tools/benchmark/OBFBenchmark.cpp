@@ -0,0 +1,159 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "utils/OBF.hpp"
+#include "Benchmarks.hpp"
+
+using namespace ouzel;
+
+// encodes and decodes a level-like dictionary of 20000 entities with 7 fields each, comparing the eager
+// Value::decode with reading the same data through obf::View
+
+namespace
+{
+    const uint32_t ENTITY_COUNT = 20000;
+    const uint32_t BLOB_SIZE = 384;
+    const uint32_t PASS_COUNT = 10;
+    const uint32_t LOOKUP_COUNT = 100000;
+
+    enum Field: uint32_t
+    {
+        ID,
+        NAME,
+        X,
+        Y,
+        HEALTH,
+        FLAGS,
+        BLOB
+    };
+
+    obf::Value generateLevel()
+    {
+        obf::Value level = obf::Value::Type::DICTIONARY;
+        obf::Value::ByteArray blob(BLOB_SIZE);
+
+        for (uint32_t i = 0; i < ENTITY_COUNT; ++i)
+        {
+            for (uint32_t b = 0; b < BLOB_SIZE; ++b)
+                blob[b] = static_cast<uint8_t>(i + b);
+
+            obf::Value entity = obf::Value::Type::OBJECT;
+            entity[ID] = i;
+            entity[NAME] = "entity" + std::to_string(i);
+            entity[X] = static_cast<float>(i % 100);
+            entity[Y] = static_cast<float>(i / 100);
+            entity[HEALTH] = 100.0 - static_cast<double>(i % 50);
+            entity[FLAGS] = static_cast<uint8_t>(i % 4);
+            entity[BLOB] = blob;
+
+            level["entity" + std::to_string(i)] = entity;
+        }
+
+        return level;
+    }
+
+    uint64_t checksum(const obf::Value& entity)
+    {
+        // the const Value::operator[] returns a copy, so the fields are read from the map
+        const obf::Value::Object& fields = entity.as<obf::Value::Object>();
+
+        uint64_t result = fields.at(ID).as<uint32_t>() + fields.at(NAME).as<std::string>().size() +
+            static_cast<uint64_t>(fields.at(X).as<float>() + fields.at(Y).as<float>() + fields.at(HEALTH).as<double>()) +
+            fields.at(FLAGS).as<uint8_t>();
+
+        for (uint8_t value : fields.at(BLOB).as<obf::Value::ByteArray>()) result += value;
+
+        return result;
+    }
+
+    uint64_t checksum(const obf::View& entity)
+    {
+        uint64_t result = entity[ID].as<uint32_t>() + entity[NAME].as<StringView>().getSize() +
+            static_cast<uint64_t>(entity[X].as<float>() + entity[Y].as<float>() + entity[HEALTH].as<double>()) +
+            entity[FLAGS].as<uint8_t>();
+
+        for (uint8_t value : entity[BLOB].as<obf::ByteArrayView>()) result += value;
+
+        return result;
+    }
+
+    template<class F>
+    double measure(uint32_t count, F function)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t pass = 0; pass < count; ++pass)
+            function();
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+}
+
+int obfBenchmark(int, char*[])
+{
+    obf::Value level = generateLevel();
+    std::vector<uint8_t> buffer;
+
+    double encodeTime = measure(PASS_COUNT, [&level, &buffer]() {
+        buffer.clear();
+        level.encode(buffer);
+    });
+
+    uint64_t decodeChecksum = 0;
+    double decodeTime = measure(PASS_COUNT, [&buffer, &decodeChecksum]() {
+        obf::Value decoded;
+        decoded.decode(buffer);
+
+        decodeChecksum = 0;
+        for (const auto& entity : decoded.as<obf::Value::Dictionary>())
+            decodeChecksum += checksum(entity.second);
+    });
+
+    uint64_t viewChecksum = 0;
+    double viewTime = measure(PASS_COUNT, [&buffer, &viewChecksum]() {
+        obf::View view(buffer);
+
+        viewChecksum = 0;
+        for (obf::View::Iterator i = view.begin(); i != view.end(); ++i)
+            viewChecksum += checksum(*i);
+    });
+
+    // reads one field of one entity, which the eager decoder can only do after decoding everything,
+    // the dictionary is encoded in key order, so the walk skips almost every entity before "entity9999"
+    const uint32_t lookupId = 9999;
+    const std::string key = "entity" + std::to_string(lookupId);
+    uint32_t id = 0;
+    double lookupTime = measure(PASS_COUNT, [&buffer, &key, &id]() {
+        id = obf::View(buffer)[key][ID].as<uint32_t>();
+    });
+
+    obf::View indexedView(buffer);
+    double indexTime = measure(1, [&indexedView]() {
+        indexedView.buildIndex();
+    });
+
+    uint64_t indexedChecksum = 0;
+    double indexedLookupTime = measure(1, [&indexedView, &indexedChecksum]() {
+        for (uint32_t i = 0; i < LOOKUP_COUNT; ++i)
+            indexedChecksum += indexedView["entity" + std::to_string(i % ENTITY_COUNT)][ID].as<uint32_t>();
+    });
+
+    const double megabytes = static_cast<double>(buffer.size()) / (1024.0 * 1024.0);
+
+    std::printf("%u entities, %zu bytes, average of %u passes\n", ENTITY_COUNT, buffer.size(), PASS_COUNT);
+    std::printf("encode: %.2f ms, %.2f MB/s\n", encodeTime, megabytes / encodeTime * 1000.0);
+    std::printf("decode and read: %.2f ms, %.2f MB/s\n", decodeTime, megabytes / decodeTime * 1000.0);
+    std::printf("view read: %.2f ms, %.2f MB/s\n", viewTime, megabytes / viewTime * 1000.0);
+    std::printf("view lookup of one field without an index: %.3f ms\n", lookupTime);
+    std::printf("index build: %.3f ms\n", indexTime);
+    std::printf("indexed lookup: %.3f us\n", indexedLookupTime * 1000.0 / LOOKUP_COUNT);
+
+    bool same = decodeChecksum == viewChecksum && id == lookupId;
+    std::printf("same values: %s\n", same ? "yes" : "no");
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdio>
+#include <cstring>
+#include "Benchmarks.hpp"
+
+// runs one benchmark (e.g. "./benchmark jsonparse ../../samples/Resources/run.json") or all of them ("./benchmark all")
+
+static const struct
+{
+    const char* name;
+    int (*function)(int argc, char* argv[]);
+} BENCHMARKS[] = {
+    {"commandbuffer", commandBufferBenchmark},
+    {"eventdispatch", eventDispatchBenchmark},
+    {"handlechurn", handleChurnBenchmark},
+    {"jsonparse", jsonBenchmark},
+    {"obf", obfBenchmark}
+};
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        bool all = std::strcmp(argv[1], "all") == 0;
+        int result = 0;
+        bool found = false;
+
+        for (const auto& benchmark : BENCHMARKS)
+        {
+            if (all || std::strcmp(argv[1], benchmark.name) == 0)
+            {
+                if (all) std::printf("%s\n", benchmark.name);
+                if (benchmark.function(argc - 1, argv + 1) != 0) result = 1;
+                found = true;
+            }
+        }
+
+        if (found) return result;
+    }
+
+    std::fprintf(stderr, "Usage: %s all", argv[0]);
+    for (const auto& benchmark : BENCHMARKS)
+        std::fprintf(stderr, "|%s", benchmark.name);
+    std::fprintf(stderr, " [arguments]\n");
+
+    return 1;
+}
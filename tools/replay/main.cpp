@@ -0,0 +1,46 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "ouzel.hpp"
+#include "graphics/CommandTrace.hpp"
+
+using namespace ouzel;
+
+// replays a command buffer trace, captured with the captureFile engine setting, and logs the frame times
+class Replay: public ouzel::Application
+{
+public:
+    explicit Replay(const std::vector<std::string>& args)
+    {
+        std::string filename;
+
+        for (auto arg = args.begin(); arg != args.end(); ++arg)
+        {
+            if (arg == args.begin())
+            {
+                // skip the first parameter
+                continue;
+            }
+
+            if (filename.empty())
+                filename = *arg;
+            else
+                engine->log(Log::Level::WARN) << "Invalid argument \"" << *arg << "\"";
+        }
+
+        if (filename.empty())
+            engine->log(Log::Level::ERR) << "Usage: replay <trace file>";
+        else
+        {
+            graphics::CommandTracePlayer player(*engine->getRenderer(), filename);
+            player.play();
+        }
+
+        engine->exit();
+    }
+};
+
+std::unique_ptr<ouzel::Application> ouzel::main(const std::vector<std::string>& args)
+{
+    return std::unique_ptr<Application>(new Replay(args));
+}